@@ -72,6 +72,7 @@ Exoplanet::Exoplanet(const QVariantMap& map)
 	starProperName = map.value("starProperName").toString();
 	RA = StelUtils::getDecAngle(map.value("RA").toString());
 	DE = StelUtils::getDecAngle(map.value("DE").toString());
+	StelUtils::spheToRect(RA, DE, XYZ);
 	distance = map.value("distance").toFloat();
 	stype = map.value("stype").toString();
 	smass = map.value("smass").toFloat();
@@ -587,7 +588,7 @@ void Exoplanet::update(double deltaTime)
 	labelsFader.update((int)(deltaTime*1000));
 }
 
-void Exoplanet::draw(StelCore* core, StelPainter *painter)
+void Exoplanet::draw(StelCore* core, StelPainter *painter, StelPainter::Sprite2dBatch& markers)
 {
 	bool visible;
 	StelSkyDrawer* sd = core->getSkyDrawer();
@@ -597,12 +598,6 @@ void Exoplanet::draw(StelCore* core, StelPainter *painter)
 	if (hasHabitableExoplanets)
 		color = habitableExoplanetMarkerColor;
 
-	StelUtils::spheToRect(RA, DE, XYZ);
-	double mag = getVMagnitudeWithExtinction(core);
-
-	painter->setBlending(true, GL_ONE, GL_ONE);
-	painter->setColor(color[0], color[1], color[2], 1);
-
 	if (timelineMode)
 	{
 		visible = isDiscovered(core);
@@ -622,19 +617,20 @@ void Exoplanet::draw(StelCore* core, StelPainter *painter)
 	// Check visibility of exoplanet system
 	if(!visible || !(painter->getProjector()->projectCheck(XYZ, win))) {return;}
 
+	double mag = getVMagnitudeWithExtinction(core);
 	float mlimit = sd->getLimitMagnitude();
 
 	if (mag <= mlimit)
 	{		
-		Exoplanet::markerTexture->bind();
 		float size = getAngularSize(NULL)*M_PI/180.*painter->getProjector()->getPixelPerRadAtCenter();
 		float shift = 5.f + size/1.6f;
 
-		painter->drawSprite2dMode(XYZ, distributionMode ? 4.f : 5.f);
+		painter->addSprite2dMode(markers, win[0], win[1], distributionMode ? 4.f : 5.f, 0.f, Vec4f(color[0], color[1], color[2], 1.f));
 
 		float coeff = 4.5f + std::log10(sradius + 0.1f);
 		if (labelsFader.getInterstate()<=0.f && !distributionMode && (mag+coeff)<mlimit && smgr->getFlagLabels() && showDesignations)
 		{
+			painter->setColor(color[0], color[1], color[2], 1);
 			painter->drawText(XYZ, getNameI18n(), 0, shift, shift, false);
 		}
 	}
@@ -29,6 +29,7 @@
 #include "StelObject.hpp"
 #include "StelTextureTypes.hpp"
 #include "StelFader.hpp"
+#include "StelPainter.hpp"
 
 //! @ingroup exoplanets
 typedef struct
@@ -48,8 +49,6 @@ typedef struct
 	int ESI;			//! Exoplanet Earth Similarity Index
 } exoplanetData;
 
-class StelPainter;
-
 //! @class Exoplanet
 //! A exoplanet object represents one pulsar on the sky.
 //! Details about the exoplanets are passed using a QVariant which contains
@@ -188,7 +187,8 @@ private:
 	static bool habitableMode;
 	static bool showDesignations;
 
-	void draw(StelCore* core, StelPainter *painter);
+	//! Add the marker of the planetary system to the batch, and draw its label.
+	void draw(StelCore* core, StelPainter *painter, StelPainter::Sprite2dBatch& markers);
 
 	int EPCount;
 	int PHEPCount;
@@ -118,6 +118,7 @@ Exoplanets::~Exoplanets()
 void Exoplanets::deinit()
 {
 	ep.clear();
+	zoneIndex.clear();
 	Exoplanet::markerTexture.clear();
 	texPointer.clear();
 }
@@ -225,11 +226,20 @@ void Exoplanets::draw(StelCore* core)
 	StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
 	StelPainter painter(prj);
 	painter.setFont(font);
-	
-	foreach (const ExoplanetP& eps, ep)
+
+	visibleEP.clear();
+	zoneIndex.findInRegion(prj->getViewportConvexPolygon()->getBoundingSphericalCaps(), visibleEP);
+
+	markerBatch.clear();
+	painter.setBlending(true, GL_ONE, GL_ONE);
+	for (int i=0; i<visibleEP.size(); ++i)
+		ep.at(visibleEP.at(i))->draw(core, &painter, markerBatch);
+
+	if (!markerBatch.isEmpty())
 	{
-		if (eps && eps->initialized)
-			eps->draw(core, &painter);
+		painter.setBlending(true, GL_ONE, GL_ONE);
+		Exoplanet::markerTexture->bind();
+		painter.drawSprite2dBatch(markerBatch);
 	}
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
@@ -265,23 +275,10 @@ QList<StelObjectP> Exoplanets::searchAround(const Vec3d& av, double limitFov, co
 	if (!flagShowExoplanets)
 		return result;
 
-	Vec3d v(av);
-	v.normalize();
-	double cosLimFov = cos(limitFov * M_PI/180.);
-	Vec3d equPos;
-
-	foreach(const ExoplanetP& eps, ep)
-	{
-		if (eps->initialized)
-		{
-			equPos = eps->XYZ;
-			equPos.normalize();
-			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2]>=cosLimFov)
-			{
-				result.append(qSharedPointerCast<StelObject>(eps));
-			}
-		}
-	}
+	QVector<int> found;
+	zoneIndex.findAround(av, limitFov, found);
+	foreach (int i, found)
+		result.append(qSharedPointerCast<StelObject>(ep.at(i)));
 
 	return result;
 }
@@ -583,6 +580,16 @@ void Exoplanets::setEPMap(const QVariantMap& map)
 		}
 
 	}
+	updateZoneIndex();
+}
+
+void Exoplanets::updateZoneIndex()
+{
+	QVector<Vec3d> positions;
+	positions.reserve(ep.size());
+	foreach (const ExoplanetP& eps, ep)
+		positions.append(eps->XYZ);
+	zoneIndex.setPositions(positions);
 }
 
 int Exoplanets::getJsonFileFormatVersion(void)
@@ -23,19 +23,21 @@
 #include "StelObject.hpp"
 #include "StelFader.hpp"
 #include "StelTextureTypes.hpp"
+#include "StelPainter.hpp"
+#include "StelZoneIndex.hpp"
 #include "Exoplanet.hpp"
 #include <QFont>
 #include <QVariantMap>
 #include <QDateTime>
 #include <QList>
 #include <QSharedPointer>
+#include <QVector>
 
 class QNetworkAccessManager;
 class QNetworkReply;
 class QSettings;
 class QTimer;
 class ExoplanetsDialog;
-class StelPainter;
 class StelButton;
 
 /*! @defgroup exoplanets Exoplanets Plug-in
@@ -341,6 +343,9 @@ private:
 	//! set items for list of struct from data map
 	void setEPMap(const QVariantMap& map);
 
+	//! rebuild the spatial index after a change of ep
+	void updateZoneIndex();
+
 	//! A fake method for strings marked for translation.
 	//! Use it instead of translations.h for N_() strings, except perhaps for
 	//! keyboard action descriptions. (It's better for them to be in a single
@@ -359,6 +364,12 @@ private:
 
 	StelTextureSP texPointer;
 	QList<ExoplanetP> ep;
+	//! positions of ep sorted by zones, to draw and search only the planetary systems in a region
+	StelZoneIndex zoneIndex;
+	//! indexes in ep of the planetary systems in view, kept to reuse the memory in the next frame
+	QVector<int> visibleEP;
+	//! markers of all planetary systems in view, drawn at once
+	StelPainter::Sprite2dBatch markerBatch;
 
 	// variables and functions for the updater
 	UpdateState updateState;
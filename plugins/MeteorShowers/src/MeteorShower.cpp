@@ -264,14 +264,18 @@ void MeteorShower::update(StelCore* core, double deltaTime)
 	}
 
 	// step through and update all active meteors
-	foreach (MeteorObj* m, m_activeMeteors)
+	// a dead meteor is replaced by the last one, so the order of the list is not kept
+	for (int i = 0; i < m_activeMeteors.size(); )
 	{
-		if (!m->update(deltaTime))
+		if (m_activeMeteors.at(i)->update(deltaTime))
 		{
-			//important to delete when no longer active
-			delete m;
-			m_activeMeteors.removeOne(m);
+			++i;
+			continue;
 		}
+		//important to delete when no longer active
+		delete m_activeMeteors.at(i);
+		m_activeMeteors[i] = m_activeMeteors.last();
+		m_activeMeteors.removeLast();
 	}
 
 	// paused | forward | backward ?
@@ -386,12 +390,17 @@ void MeteorShower::drawMeteors(StelCore *core)
 		return;
 	}
 
-	// step through and draw all active meteors
-	StelPainter painter(core->getProjection(StelCore::FrameAltAz));
+	// collect all active meteors, and draw them at once
+	float thickness, bolideSize;
+	Meteor::calculateThickness(core, thickness, bolideSize);
+	m_drawBuffer.clear();
 	foreach (MeteorObj* m, m_activeMeteors)
 	{
-		m->draw(core, painter);
+		m->append(m_drawBuffer, thickness, bolideSize);
 	}
+
+	StelPainter painter(core->getProjection(StelCore::FrameAltAz));
+	m_drawBuffer.draw(painter, m_mgr->getBolideTexture());
 }
 
 MeteorShower::Activity MeteorShower::hasGenericShower(QDate date, bool &found) const
@@ -147,6 +147,7 @@ private:
 	Activity m_activity;               //! Current activity
 
 	QList<MeteorObj*> m_activeMeteors; //! List with all the active meteors
+	Meteor::DrawBuffer m_drawBuffer;   //! Vertices of the active meteors, reused in every frame
 
 	//! Draws the radiant
 	void drawRadiant(StelCore* core);
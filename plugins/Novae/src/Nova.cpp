@@ -70,6 +70,7 @@ Nova::Nova(const QVariantMap& map)
 	m9 = map.value("m9", -1).toInt();
 	RA = StelUtils::getDecAngle(map.value("RA").toString());
 	Dec = StelUtils::getDecAngle(map.value("Dec").toString());	
+	StelUtils::spheToRect(RA, Dec, XYZ);
 	distance = map.value("distance").toDouble();
 
 	initialized = true;
@@ -331,9 +332,7 @@ void Nova::draw(StelCore* core, StelPainter* painter)
 	float size, shift;
 	double mag;
 
-	StelUtils::spheToRect(RA, Dec, XYZ);
 	mag = getVMagnitudeWithExtinction(core);
-	sd->preDrawPointSource(painter);
 	float mlimit = sd->getLimitMagnitude();
 
 	if (mag <= mlimit)
@@ -349,6 +348,4 @@ void Nova::draw(StelCore* core, StelPainter* painter)
 			painter->drawText(XYZ, name, 0, shift, shift, false);
 		}
 	}
-
-	sd->postDrawPointSource(painter);
 }
@@ -87,6 +87,7 @@ private:
 
 	Vec3d XYZ;                         // holds J2000 position
 
+	//! Draw the nova as point source, StelSkyDrawer::preDrawPointSource() must be called before.
 	void draw(StelCore* core, StelPainter* painter);
 
 	// Nova
@@ -28,6 +28,7 @@
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
 #include "StelPainter.hpp"
+#include "StelSkyDrawer.hpp"
 #include "StelTranslator.hpp"
 #include "StelTextureMgr.hpp"
 #include "LabelMgr.hpp"
@@ -193,14 +194,15 @@ void Novae::draw(StelCore* core)
 	StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
 	StelPainter painter(prj);
 	painter.setFont(font);
-	
-	foreach (const NovaP& n, nova)
-	{
-		if (n && n->initialized)
-		{
-			n->draw(core, &painter);
-		}
-	}
+	StelSkyDrawer* sd = core->getSkyDrawer();
+
+	visibleNovae.clear();
+	zoneIndex.findInRegion(prj->getViewportConvexPolygon()->getBoundingSphericalCaps(), visibleNovae);
+
+	sd->preDrawPointSource(&painter);
+	for (int i=0; i<visibleNovae.size(); ++i)
+		nova.at(visibleNovae.at(i))->draw(core, &painter);
+	sd->postDrawPointSource(&painter);
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 	{
@@ -233,23 +235,10 @@ QList<StelObjectP> Novae::searchAround(const Vec3d& av, double limitFov, const S
 {
 	QList<StelObjectP> result;
 
-	Vec3d v(av);
-	v.normalize();
-	double cosLimFov = cos(limitFov * M_PI/180.);
-	Vec3d equPos;
-
-	foreach(const NovaP& n, nova)
-	{
-		if (n->initialized)
-		{
-			equPos = n->XYZ;
-			equPos.normalize();
-			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2]>=cosLimFov)
-			{
-				result.append(qSharedPointerCast<StelObject>(n));
-			}
-		}
-	}
+	QVector<int> found;
+	zoneIndex.findAround(av, limitFov, found);
+	foreach (int i, found)
+		result.append(qSharedPointerCast<StelObject>(nova.at(i)));
 
 	return result;
 }
@@ -454,6 +443,16 @@ void Novae::setNovaeMap(const QVariantMap& map)
 			nova.append(n);
 
 	}
+	updateZoneIndex();
+}
+
+void Novae::updateZoneIndex()
+{
+	QVector<Vec3d> positions;
+	positions.reserve(nova.size());
+	foreach (const NovaP& n, nova)
+		positions.append(n->XYZ);
+	zoneIndex.setPositions(positions);
 }
 
 int Novae::getJsonFileVersion(void)
@@ -22,6 +22,7 @@
 #include "StelObjectModule.hpp"
 #include "StelObject.hpp"
 #include "StelFader.hpp"
+#include "StelZoneIndex.hpp"
 #include "Nova.hpp"
 #include "StelTextureTypes.hpp"
 #include <QFont>
@@ -30,6 +31,7 @@
 #include <QList>
 #include <QSharedPointer>
 #include <QHash>
+#include <QVector>
 
 class QNetworkAccessManager;
 class QNetworkReply;
@@ -215,12 +217,19 @@ private:
 	//! Set items for list of struct from data map
 	void setNovaeMap(const QVariantMap& map);
 
+	//! rebuild the spatial index after a change of nova
+	void updateZoneIndex();
+
 	QString novaeJsonPath;
 
 	int NovaCnt;
 
 	StelTextureSP texPointer;
 	QList<NovaP> nova;
+	//! positions of nova sorted by zones, to draw and search only the novae in a region
+	StelZoneIndex zoneIndex;
+	//! indexes in nova of the novae in view, kept to reuse the memory in the next frame
+	QVector<int> visibleNovae;
 	QHash<QString, double> novalist;
 
 	// variables and functions for the updater
@@ -81,6 +81,15 @@ const double Observability::MoonT = 29.530588;           // Moon synodic period
 const double Observability::RefFullMoon = 2451564.696; // Reference Julian date of a Full Moon.
 const double Observability::MoonPerilune = 0.0024236308; // Smallest Earth-Moon distance (in AU).
 
+// Number of yearly ephemeris tables kept in memory (one per year and body).
+static const int YEAR_TABLE_CACHE_SIZE = 32;
+// Sampling of the table used for today's events: 3 hours is short enough
+// for a cubic interpolation of the Moon, and the table spans +/- 2 days.
+static const double EVENT_TABLE_STEP = 0.125;
+static const int EVENT_TABLE_SIZE = 33;
+// The event table is rebuilt when the current date comes closer than this to its ends.
+static const double EVENT_TABLE_MARGIN = 1.25;
+
 
 Observability::Observability()
 	: configDialog(new ObservabilityDialog())
@@ -132,6 +141,8 @@ Observability::Observability()
 	isSun = false;
 	isScreen = true;
 
+	yearTables.setMaxCost(YEAR_TABLE_CACHE_SIZE);
+
 	//Get pointer to the Earth:
 	PlanetP Earth = GETSTELMODULE(SolarSystem)->getEarth();
 	myEarth = Earth.data();
@@ -1009,18 +1020,17 @@ QString Observability::formatAsDateRange(int startDay, int endDay)
 // Compute planet's position for each day of the current year:
 void Observability::updatePlanetData(StelCore *core)
 {
+	const EphemerisTable* planetTable = getYearTable(core, 3, myPlanet->getEnglishName());
 	double tempH;
 	for (int i=0; i<nDays; i++)
 	{
-		getPlanetCoords(core, yearJD[i], objectRA[i], objectDec[i], false);
+		toRADec(core->j2000ToEquinoxEqu((StelCore::matVsop87ToJ2000)*planetTable->positions.at(i), StelCore::RefractionOff),
+			objectRA[i], objectDec[i]);
 		tempH = calculateHourAngle(mylat, refractedHorizonAlt, objectDec[i]);
 		objectH0[i] = tempH;
 		objectSidT[0][i] = toUnsignedRA(objectRA[i]-tempH);
 		objectSidT[1][i] = toUnsignedRA(objectRA[i]+tempH);
 	}
-
-// Return the planet to its current time:
-	getPlanetCoords(core, myJD, objectRA[0], objectDec[0], true);
 }
 
 /////////////////////////////////////////////////
@@ -1040,22 +1050,16 @@ void Observability::updateSunData(StelCore* core)
 	nDays = (year==sameYear)?366:365;
 	
 // Compute Earth's position throughout the year:
-	Vec3d pos, sunPos;
+	const EphemerisTable* sunTable = getYearTable(core, 1, "Sun");
+	Vec3d sunPos;
 	for (int i=0; i<nDays; i++)
 	{
 		yearJD[i].first = Jan1stJD + (double)i;
 		yearJD[i].second = yearJD[i].first+core->computeDeltaT(yearJD[i].first)/86400.0;
-		myEarth->computePosition(yearJD[i].second);
-		myEarth->computeTransMatrix(yearJD[i].first, yearJD[i].second);
-		pos = myEarth->getHeliocentricEclipticPos();
-		sunPos = core->j2000ToEquinoxEqu((StelCore::matVsop87ToJ2000)*(-pos), StelCore::RefractionOff);
-		EarthPos[i] = -pos;
+		sunPos = core->j2000ToEquinoxEqu((StelCore::matVsop87ToJ2000)*sunTable->positions.at(i), StelCore::RefractionOff);
+		EarthPos[i] = -sunTable->positions.at(i);
 		toRADec(sunPos,sunRA[i],sunDec[i]);
 	};
-
-//Return the Earth to its current time:
-	myEarth->computePosition(myJD.second);
-	myEarth->computeTransMatrix(myJD.first, myJD.second);
 }
 ///////////////////////////////////////////////////
 
@@ -1142,7 +1146,7 @@ int Observability::calculateHeli(int imethod, int &heliRise, int &heliSet)
 	double hourDiffHeliRise, hourDiffHeliSet;
 	bool success = false;
 
-	for (int i=0; i<366; i++)
+	for (int i=0; i<nDays; i++)
 	{
 		if (objectH0[i]>0.0 && sunSidT[0][i]>0.0 && sunSidT[1][i]>0.0)
 		{
@@ -1200,7 +1204,7 @@ int Observability::calculateAcroCos(int &acroRise, int &acroSet,
 	double hourDiffAcroRise, hourDiffAcroSet, hourDiffCosRise, hourCosDiffSet;
 	bool success = false;
 
-	for (int i=0; i<366; i++)
+	for (int i=0; i<nDays; i++)
 	{
 		if (objectH0[i]>0.0 && sunSidT[2][i]>0.0 && sunSidT[3][i]>0.0)
 		{
@@ -1362,46 +1366,110 @@ void Observability::getMoonDistance(StelCore *core, QPair<double, double> JD, do
 
 
 //////////////////////////////////////////////
-// Get the Coords of a planet:
-void Observability::getPlanetCoords(StelCore *core, QPair<double, double> JD, double &RA, double &Dec, bool getBack)
+// Tables of geocentric positions:
+bool Observability::EphemerisTable::covers(double JD) const
 {
+	const double x = (JD-startJD)/step;
+	return x >= 1.0 && x < (double)(positions.size()-2);
+}
 
-	if (getBack)
+Vec3d Observability::EphemerisTable::interpolate(double JD) const
+{
+	const double x = (JD-startJD)/step;
+	const int i = qBound(1, (int)std::floor(x), positions.size()-3);
+	const double t = x - (double)i;
+	// Lagrange polynomials for the samples i-1, i, i+1 and i+2:
+	const double w0 = -t*(t-1.)*(t-2.)/6.;
+	const double w1 = (t+1.)*(t-1.)*(t-2.)/2.;
+	const double w2 = -(t+1.)*t*(t-2.)/2.;
+	const double w3 = (t+1.)*t*(t-1.)/6.;
+	return positions.at(i-1)*w0 + positions.at(i)*w1 + positions.at(i+1)*w2 + positions.at(i+2)*w3;
+}
+
+void Observability::fillEphemerisTable(StelCore *core, int bodyType, EphemerisTable &table)
+{
+	Planet* body = (bodyType==2) ? myMoon : myPlanet;
+	for (int i=0; i<table.positions.size(); i++)
 	{
-	// Return the planet to its current time:
-		myPlanet->computePosition(JD.second);
-		myPlanet->computeTransMatrix(JD.first, JD.second);
-		myEarth->computePosition(JD.second);
-		myEarth->computeTransMatrix(JD.first, JD.second);
-	} else
+		double JD = table.startJD + table.step*(double)i;
+		double JDE = JD + core->computeDeltaT(JD)/86400.0;
+	// The rotation matrices and orbit lines are not needed for the positions:
+		myEarth->computePositionWithoutOrbits(JDE);
+		Vec3d earthPos = myEarth->getHeliocentricEclipticPos();
+		if (bodyType==1)
+		{
+			table.positions[i] = -earthPos;
+		}
+		else
+		{
+			body->computePositionWithoutOrbits(JDE);
+			table.positions[i] = body->getHeliocentricEclipticPos() - earthPos;
+		};
+	};
+
+// Return the bodies to their current position:
+	myEarth->computePosition(myJD.second);
+	myEarth->computeTransMatrix(myJD.first, myJD.second);
+	if (bodyType!=1)
 	{
-	// Compute planet's position:
-		myPlanet->computePosition(JD.second);
-		myPlanet->computeTransMatrix(JD.first, JD.second);
-		Pos1 = myPlanet->getHeliocentricEclipticPos();
-		myEarth->computePosition(JD.second);
-		myEarth->computeTransMatrix(JD.first, JD.second);
-		Pos2 = myEarth->getHeliocentricEclipticPos();
-		LocTrans = (StelCore::matVsop87ToJ2000)*(Mat4d::translation(-Pos2));
-		Pos2 = core->j2000ToEquinoxEqu(LocTrans*Pos1, StelCore::RefractionOff);
-		toRADec(Pos2,RA,Dec);
+		body->computePosition(myJD.second);
+		body->computeTransMatrix(myJD.first, myJD.second);
 	};
+}
+
+const Observability::EphemerisTable* Observability::getYearTable(StelCore *core, int bodyType, const QString &name)
+{
+	QString key = QString("%1|%2").arg(curYear).arg(name);
+	EphemerisTable* table = yearTables.object(key);
+	if (table==NULL)
+	{
+		table = new EphemerisTable();
+		table->startJD = Jan1stJD;
+		table->step = 1.0;
+		table->positions.resize(nDays);
+		fillEphemerisTable(core, bodyType, *table);
+		yearTables.insert(key, table);
+	};
+	return table;
+}
+
+void Observability::updateEventTable(StelCore *core, int bodyType)
+{
+	QString body = (bodyType==1) ? "Sun" : ((bodyType==2) ? "Moon" : myPlanet->getEnglishName());
+	if (body==eventTableBody && eventTable.covers(myJD.first-EVENT_TABLE_MARGIN) && eventTable.covers(myJD.first+EVENT_TABLE_MARGIN))
+		return;
+
+	eventTableBody = body;
+	eventTable.step = EVENT_TABLE_STEP;
+	eventTable.startJD = myJD.first - EVENT_TABLE_STEP*(EVENT_TABLE_SIZE/2);
+	eventTable.positions.resize(EVENT_TABLE_SIZE);
+	fillEphemerisTable(core, bodyType, eventTable);
+}
 
+Vec3d Observability::getEventPosition(StelCore *core, int bodyType, double JD)
+{
+	Vec3d pos = core->j2000ToEquinoxEqu((StelCore::matVsop87ToJ2000)*eventTable.interpolate(JD), StelCore::RefractionOff);
+	if (bodyType==2)
+	{
+	// The Moon is close enough for the position of the observer to matter:
+		double JDE = JD + core->computeDeltaT(JD)/86400.0;
+		RotObserver = (Mat4d::zrotation(myEarth->getSiderealTime(JD, JDE)/Rad2Deg))*ObserverLoc;
+		pos -= RotObserver;
+	};
+	return pos;
 }
 //////////////////////////////////////////////
 
 
 
 //////////////////////////////////////////////
-// Solves Moon's, Sun's, or Planet's ephemeris by bissection.
+// Solves Moon's, Sun's, or Planet's ephemeris by iteration over the interpolated positions.
 bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 {
 
 	const int NUM_ITER = 100;
 	int i;
-	double hHoriz, ra, dec, raSun, decSun, tempH, /* tempJd, */ tempEphH, curSidT, eclLon;
-	QPair<double, double> tempJd;
-	//Vec3d Observer;
+	double hHoriz, ra, dec, raSun, decSun, tempH, tempEphH, eclLon;
 
 	hHoriz = calculateHourAngle(mylat, refractedHorizonAlt, selDec);
 	bool raises = hHoriz > 0.0;
@@ -1415,32 +1483,10 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 
 		lastType = bodyType;
 
-		myEarth->computePosition(myJD.second);
-		myEarth->computeTransMatrix(myJD.first, myJD.second);
-		Vec3d earthPos = myEarth->getHeliocentricEclipticPos();
-
-		if (bodyType == 1) // Sun position
-		{
-			Pos2 = core->j2000ToEquinoxEqu((StelCore::matVsop87ToJ2000)*(-earthPos), StelCore::RefractionOff);
-		}
-		else if (bodyType==2) // Moon position
-		{
-			curSidT = myEarth->getSiderealTime(myJD.first, myJD.second)/Rad2Deg;
-			RotObserver = (Mat4d::zrotation(curSidT))*ObserverLoc;
-			LocTrans = (StelCore::matVsop87ToJ2000)*(Mat4d::translation(-earthPos));
-			myMoon->computePosition(myJD.second);
-			myMoon->computeTransMatrix(myJD.first, myJD.second);
-			Pos1 = myMoon->getHeliocentricEclipticPos();
-			Pos2 = (core->j2000ToEquinoxEqu(LocTrans*Pos1, StelCore::RefractionOff))-RotObserver;
-		}
-		else // Planet position
-		{
-			myPlanet->computePosition(myJD.second);
-			myPlanet->computeTransMatrix(myJD.first, myJD.second);
-			Pos1 = myPlanet->getHeliocentricEclipticPos();
-			LocTrans = (StelCore::matVsop87ToJ2000)*(Mat4d::translation(-earthPos));
-			Pos2 = core->j2000ToEquinoxEqu(LocTrans*Pos1, StelCore::RefractionOff);
-		};
+// The positions for the next iterations are interpolated, the table is only
+// recomputed when the date gets close to its ends or the body changes:
+		updateEventTable(core, bodyType);
+		Pos2 = getEventPosition(core, bodyType, myJD.first);
 
 		toRADec(Pos2,ra,dec);
 		Vec3d moonAltAz = core->equinoxEquToAltAz(Pos2, StelCore::RefractionOff);
@@ -1470,21 +1516,7 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 			for (i=0; i<NUM_ITER; i++)
 			{
 	// Get modified coordinates:
-				tempJd.first = MoonRise;
-				tempJd.second=tempJd.first+core->computeDeltaT(tempJd.first)/86400.0;
-	
-				if (bodyType<3)
-				{
-					getSunMoonCoords(core, tempJd,
-					                 raSun, decSun,
-					                 ra, dec,
-					                 eclLon, false);
-				} else
-				{
-					getPlanetCoords(core, tempJd, ra, dec, false);
-				};
-
-				if (bodyType==1) {ra = raSun; dec = decSun;};
+				toRADec(getEventPosition(core, bodyType, MoonRise), ra, dec);
 
 	// Current hour angle at mod. coordinates:
 				Hcurr = toUnsignedRA(SidT-ra);
@@ -1509,20 +1541,8 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 			for (i=0; i<NUM_ITER; i++)
 			{
 	// Get modified coordinates:
-				tempJd.first = MoonSet;
-				tempJd.second=tempJd.first+core->computeDeltaT(tempJd.first)/86400.0;
+				toRADec(getEventPosition(core, bodyType, MoonSet), ra, dec);
 
-				
-				if (bodyType < 3)
-					getSunMoonCoords(core, tempJd,
-					                 raSun, decSun,
-					                 ra, dec,
-					                 eclLon, false);
-				else
-					getPlanetCoords(core, tempJd, ra, dec, false);
-				
-				if (bodyType==1) {ra = raSun; dec = decSun;};
-				
 	// Current hour angle at mod. coordinates:
 				Hcurr = toUnsignedRA(SidT-ra);
 				Hcurr -= (hasRisen)?24.:0.;
@@ -1554,21 +1574,7 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 		for (i=0; i<NUM_ITER; i++)
 		{
 			// Get modified coordinates:
-			tempJd.first = MoonCulm;
-			tempJd.second=tempJd.first+core->computeDeltaT(tempJd.first)/86400.0;
-
-
-			if (bodyType<3)
-			{
-				getSunMoonCoords(core,tempJd,raSun,decSun,ra,dec,eclLon,false);
-			} else
-			{
-				getPlanetCoords(core,tempJd,ra,dec,false);
-			};
-
-
-			if (bodyType==1) {ra = raSun; dec = decSun;};
-
+			toRADec(getEventPosition(core, bodyType, MoonCulm), ra, dec);
 
 	// Current hour angle at mod. coordinates:
 			Hcurr = toUnsignedRA(SidT-ra);
@@ -1610,7 +1616,8 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 
 			double TempFullMoon = RefFullMoon + nT*MoonT;
 
-	// Improve the estimate iteratively (Secant method over Lunar-phase vs. time):
+	// Improve the estimate iteratively (false position method over Lunar-phase vs. time,
+	// with the Illinois modification so that both ends of the bracket converge):
 
 			dT = 0.1/1440.; // 6 seconds. Our time span for the finite-difference derivative estimate.
 //			double Deriv1, Deriv2; // Variables for temporal use.
@@ -1618,6 +1625,7 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 			double Temp1, Temp2; // Variables for temporal use.
 			double iniEst1, iniEst2;  // JD values that MUST include the solution within them.
 			double Phase1;
+			int kept; // Which end of the bracket was kept in the last iteration (-1 for Sec1, 1 for Sec2).
 
 			for (int j=0; j<2; j++) 
 			{ // Two steps: one for the previos Full Moon and the other for the next one.
@@ -1637,7 +1645,7 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 				getSunMoonCoords(core,QPair<double, double>(Sec2.first, Sec2.first+Sec2.second),raSun,decSun,ra,dec,eclLon,false);
 				Temp2 = eclLon; //Lambda(RA,Dec,RAS,DecS);
 
-
+				kept = 0;
 				for (int i=0; i<100; i++) // A limit of 100 iterations.
 				{
 					Phase1 = (Sec2.first-Sec1.first)/(Temp1-Temp2)*Temp1+Sec1.first;
@@ -1648,10 +1656,14 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 					{
 						Sec2.first = Phase1;
 						Temp2 = eclLon;
+						// Sec1 kept twice in a row: halve its weight, otherwise it may never move.
+						if (kept==-1) Temp1 *= 0.5;
+						kept = -1;
 					} else {
 						Sec1.first = Phase1;
 						Temp1 = eclLon;
-
+						if (kept==1) Temp2 *= 0.5;
+						kept = 1;
 					};
 
 
@@ -1678,6 +1690,9 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 			};
 
 
+	// Return the Moon and Earth to their current position:
+			getSunMoonCoords(core, myJD, raSun, decSun, ra, dec, eclLon, true);
+
 	// Update the string shown in the screen: 
 			int fullDay, fullMonth,fullYear, fullHour, fullMinute, fullSecond;
 			double LocalPrev = prevFullMoon+GMTShift+0.5;  // Shift to the local time. 
@@ -1736,17 +1751,6 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 	}; 
 
 
-// Return the Moon and Earth to its current position:
-	if (bodyType<3)
-	{
-		getSunMoonCoords(core, myJD, raSun, decSun, ra, dec, eclLon, true);
-	}
-	else
-	{
-		getPlanetCoords(core, myJD, ra, dec, true);
-	};
-
-
 	return raises;
 }
 
@@ -19,9 +19,11 @@
 #define OBSERVABILITY_HPP_
 
 #include "StelModule.hpp"
+#include <QCache>
 #include <QFont>
 #include <QString>
 #include <QPair>
+#include <QVector>
 #include "VecMath.hpp"
 #include "SolarSystem.hpp"
 #include "Planet.hpp"
@@ -212,18 +214,8 @@ private:
 			      double& eclLon, bool getBack);
 
 
-	//! computes the selected-planet coordinates at a given Julian date.
-	//! @param core the stellarium core.
-	//! @param JD QPair for the Julian date: .first=JD(UT), .second=JDE
-	//! @param RA right ascension of the planet (in hours).
-	//! @param Dec declination of the planet (in radians).
-	//! @param getBack controls whether the planet must be returned to its original positions
-	//!        after computation.
-	void getPlanetCoords(StelCore* core,QPair<double, double> JD,
-			     double &RA, double &Dec, bool getBack);
-
 	//! Computes the Earth-Moon distance (in AU) at a given Julian date.
-	//! The parameters are similar to those of getSunMoonCoords() or getPlanetCoords().
+	//! The parameters are similar to those of getSunMoonCoords().
 	void getMoonDistance(StelCore* core, QPair<double, double> JD,
 			     double& distance, bool getBack);
 
@@ -276,6 +268,50 @@ private:
 	//! Convert an equatorial position vector to RA/Dec.
 	void toRADec(Vec3d vec3d, double& ra, double& dec);
 
+	//! Geocentric positions of a body sampled at regular time steps.
+	//! The positions are kept in the VSOP87 frame, as given by the planet ephemeris,
+	//! so that a table doesn't depend on the observer and can be reused.
+	struct EphemerisTable
+	{
+		EphemerisTable() : startJD(0.), step(1.) {}
+		//! JD(UT) of the first sample.
+		double startJD;
+		//! Interval between the samples, in days.
+		double step;
+		//! Geocentric position (in AU) at each sample.
+		QVector<Vec3d> positions;
+
+		//! Check if JD can be interpolated from samples on both sides.
+		bool covers(double JD) const;
+		//! Four-point Lagrange interpolation of the position at JD.
+		Vec3d interpolate(double JD) const;
+	};
+
+	//! Computes the geocentric positions of a body for all samples of a table.
+	//! Only the positions are updated, the bodies are returned to the current time afterwards.
+	//! @param bodyType is 1 for Sun, 2 for Moon, 3 for Solar System object (myPlanet).
+	//! @param table the table to fill, with startJD, step and the number of positions already set.
+	void fillEphemerisTable(StelCore* core, int bodyType, EphemerisTable& table);
+
+	//! Get the table with the position of a body for each day of the current year.
+	//! The tables don't depend on the location, and are kept for a few bodies and years.
+	//! The returned pointer is only valid until the next call.
+	const EphemerisTable* getYearTable(StelCore* core, int bodyType, const QString& name);
+
+	//! Make sure that eventTable holds the body for the days around the current date.
+	void updateEventTable(StelCore* core, int bodyType);
+
+	//! Get the equatorial position of the body in eventTable at a given JD(UT).
+	//! The position of the Moon is topocentric.
+	Vec3d getEventPosition(StelCore* core, int bodyType, double JD);
+
+	//! Yearly tables, by year and name of the body.
+	QCache<QString, EphemerisTable> yearTables;
+	//! Position of the body whose rise/set/transit times are shown, for the days around the current date.
+	EphemerisTable eventTable;
+	//! Name of the body in eventTable.
+	QString eventTableBody;
+
 	//! Table containing the Julian Dates of the days of the current year.
 	QPair<double, double> yearJD[366]; // GZ: This had to become a QPair of JD.first=JD_UT, JD.second=JDE
 
@@ -84,6 +84,7 @@ Pulsar::Pulsar(const QVariantMap& map)
 	eccentricity = map.value("eccentricity").toDouble();
 	RA = StelUtils::getDecAngle(map.value("RA").toString());
 	DE = StelUtils::getDecAngle(map.value("DE").toString());
+	StelUtils::spheToRect(RA, DE, XYZ);
 	w50 = map.value("w50").toFloat();
 	s400 = map.value("s400").toFloat();
 	s600 = map.value("s600").toFloat();
@@ -395,35 +396,29 @@ void Pulsar::update(double deltaTime)
 	labelsFader.update((int)(deltaTime*1000));
 }
 
-void Pulsar::draw(StelCore* core, StelPainter *painter)
+void Pulsar::draw(StelCore* core, StelPainter *painter, StelPainter::Sprite2dBatch& markers)
 {
 	StelSkyDrawer* sd = core->getSkyDrawer();
-	double mag = getVMagnitudeWithExtinction(core);
-	StelUtils::spheToRect(RA, DE, XYZ);
 
 	Vec3d win;
 	// Check visibility of pulsar
 	if (!(painter->getProjector()->projectCheck(XYZ, win)))
 		return;
 
-	painter->setBlending(true, GL_ONE, GL_ONE);
-
-	if (glitch>0 && glitchFlag)
-		painter->setColor(glitchColor[0], glitchColor[1], glitchColor[2], 1.f);
-	else
-		painter->setColor(markerColor[0], markerColor[1], markerColor[2], 1.f);
+	double mag = getVMagnitudeWithExtinction(core);
 	float mlimit = sd->getLimitMagnitude();
 
 	if (mag <= mlimit)
 	{		
-		Pulsar::markerTexture->bind();
+		const Vec3f& color = (glitch>0 && glitchFlag) ? glitchColor : markerColor;
 		float size = getAngularSize(NULL)*M_PI/180.*painter->getProjector()->getPixelPerRadAtCenter();
 		float shift = 5.f + size/1.6f;		
 
-		painter->drawSprite2dMode(XYZ, distributionMode ? 4.f : 5.f);
+		painter->addSprite2dMode(markers, win[0], win[1], distributionMode ? 4.f : 5.f, 0.f, Vec4f(color[0], color[1], color[2], 1.f));
 
 		if (labelsFader.getInterstate()<=0.f && !distributionMode && (mag+2.f)<mlimit)
 		{
+			painter->setColor(color[0], color[1], color[2], 1.f);
 			painter->drawText(XYZ, designation, 0, shift, shift, false);
 		}
 	}
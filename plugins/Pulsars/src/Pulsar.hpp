@@ -29,8 +29,7 @@
 #include "StelObject.hpp"
 #include "StelTextureTypes.hpp"
 #include "StelFader.hpp"
-
-class StelPainter;
+#include "StelPainter.hpp"
 
 //! @class Pulsar
 //! A Pulsar object represents one pulsar on the sky.
@@ -117,7 +116,8 @@ private:
 	static Vec3f markerColor;
 	static Vec3f glitchColor;
 
-	void draw(StelCore* core, StelPainter *painter);
+	//! Add the marker of the pulsar to the batch, and draw its label.
+	void draw(StelCore* core, StelPainter *painter, StelPainter::Sprite2dBatch& markers);
 
 	//! Variables for description of properties of pulsars
 	QString designation;	//! The designation of the pulsar (J2000 pulsar name)
@@ -120,6 +120,7 @@ Pulsars::~Pulsars()
 void Pulsars::deinit()
 {
 	psr.clear();
+	zoneIndex.clear();
 	Pulsar::markerTexture.clear();
 	texPointer.clear();
 }
@@ -229,11 +230,20 @@ void Pulsars::draw(StelCore* core)
 	StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
 	StelPainter painter(prj);
 	painter.setFont(font);
-	
-	foreach (const PulsarP& pulsar, psr)
+
+	visiblePSR.clear();
+	zoneIndex.findInRegion(prj->getViewportConvexPolygon()->getBoundingSphericalCaps(), visiblePSR);
+
+	markerBatch.clear();
+	painter.setBlending(true, GL_ONE, GL_ONE);
+	for (int i=0; i<visiblePSR.size(); ++i)
+		psr.at(visiblePSR.at(i))->draw(core, &painter, markerBatch);
+
+	if (!markerBatch.isEmpty())
 	{
-		if (pulsar && pulsar->initialized)
-			pulsar->draw(core, &painter);
+		painter.setBlending(true, GL_ONE, GL_ONE);
+		Pulsar::markerTexture->bind();
+		painter.drawSprite2dBatch(markerBatch);
 	}
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
@@ -271,23 +281,10 @@ QList<StelObjectP> Pulsars::searchAround(const Vec3d& av, double limitFov, const
 	if (!flagShowPulsars)
 		return result;
 
-	Vec3d v(av);
-	v.normalize();
-	double cosLimFov = cos(limitFov * M_PI/180.);
-	Vec3d equPos;
-
-	foreach(const PulsarP& pulsar, psr)
-	{
-		if (pulsar->initialized)
-		{
-			equPos = pulsar->XYZ;
-			equPos.normalize();
-			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2]>=cosLimFov)
-			{
-				result.append(qSharedPointerCast<StelObject>(pulsar));
-			}
-		}
-	}
+	QVector<int> found;
+	zoneIndex.findAround(av, limitFov, found);
+	foreach (int i, found)
+		result.append(qSharedPointerCast<StelObject>(psr.at(i)));
 
 	return result;
 }
@@ -466,6 +463,16 @@ void Pulsars::setPSRMap(const QVariantMap& map)
 			psr.append(pulsar);
 
 	}
+	updateZoneIndex();
+}
+
+void Pulsars::updateZoneIndex()
+{
+	QVector<Vec3d> positions;
+	positions.reserve(psr.size());
+	foreach (const PulsarP& pulsar, psr)
+		positions.append(pulsar->XYZ);
+	zoneIndex.setPositions(positions);
 }
 
 int Pulsars::getJsonFileFormatVersion(void)
@@ -23,12 +23,15 @@
 #include "StelObject.hpp"
 #include "StelFader.hpp"
 #include "StelTextureTypes.hpp"
+#include "StelPainter.hpp"
+#include "StelZoneIndex.hpp"
 #include "Pulsar.hpp"
 #include <QFont>
 #include <QVariantMap>
 #include <QDateTime>
 #include <QList>
 #include <QSharedPointer>
+#include <QVector>
 
 class QNetworkAccessManager;
 class QNetworkReply;
@@ -38,8 +41,6 @@ class QPixmap;
 class StelButton;
 class PulsarsDialog;
 
-class StelPainter;
-
 /*! @defgroup pulsars Pulsars Plug-in
 @{
 The %Pulsars plugin plots the position of various pulsars, with object information
@@ -260,10 +261,19 @@ private:
 	//! set items for list of struct from data map
 	void setPSRMap(const QVariantMap& map);
 
+	//! rebuild the spatial index after a change of psr
+	void updateZoneIndex();
+
 	QString jsonCatalogPath;
 
 	StelTextureSP texPointer;
 	QList<PulsarP> psr;
+	//! positions of psr sorted by zones, to draw and search only the pulsars in a region
+	StelZoneIndex zoneIndex;
+	//! indexes in psr of the pulsars in view, kept to reuse the memory in the next frame
+	QVector<int> visiblePSR;
+	//! markers of all pulsars in view, drawn at once
+	StelPainter::Sprite2dBatch markerBatch;
 
 	int PsrCount;
 
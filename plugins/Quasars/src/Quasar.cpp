@@ -64,6 +64,7 @@ Quasar::Quasar(const QVariantMap& map)
 	qRA = StelUtils::getDecAngle(map.value("RA").toString());
 	qDE = StelUtils::getDecAngle(map.value("DE").toString());
 	redshift = map.value("z").toFloat();
+	StelUtils::spheToRect(qRA, qDE, XYZ);
 
 	initialized = true;
 }
@@ -177,7 +178,7 @@ void Quasar::update(double deltaTime)
 	labelsFader.update((int)(deltaTime*1000));
 }
 
-void Quasar::draw(StelCore* core, StelPainter& painter)
+void Quasar::draw(StelCore* core, StelPainter& painter, StelPainter::Sprite2dBatch& markers)
 {
 	StelSkyDrawer* sd = core->getSkyDrawer();
 
@@ -186,25 +187,15 @@ void Quasar::draw(StelCore* core, StelPainter& painter)
 	float size, shift=0;
 	double mag;
 
-	StelUtils::spheToRect(qRA, qDE, XYZ);
-	mag = getVMagnitudeWithExtinction(core);	
-
 	if (distributionMode)
 	{
-		painter.setBlending(true, GL_ONE, GL_ONE);
-		painter.setColor(markerColor[0], markerColor[1], markerColor[2], 1);
-
-		Quasar::markerTexture->bind();
-		//size = getAngularSize(NULL)*M_PI/180.*painter.getProjector()->getPixelPerRadAtCenter();
-		if (labelsFader.getInterstate()<=0.f)
-		{
-			painter.drawSprite2dMode(XYZ, 4);			
-		}
+		Vec3d win;
+		if (labelsFader.getInterstate()<=0.f && painter.getProjector()->project(XYZ, win))
+			painter.addSprite2dMode(markers, win[0], win[1], 4.f, 0.f, Vec4f(markerColor[0], markerColor[1], markerColor[2], 1.f));
 	}
 	else
 	{
-		sd->preDrawPointSource(&painter);
-	
+		mag = getVMagnitudeWithExtinction(core);
 		if (mag <= sd->getLimitMagnitude())
 		{
 			sd->computeRCMag(mag, &rcMag);
@@ -217,8 +208,6 @@ void Quasar::draw(StelCore* core, StelPainter& painter)
 				painter.drawText(XYZ, designation, 0, shift, shift, false);
 			}
 		}
-
-		sd->postDrawPointSource(&painter);
 	}
 }
 
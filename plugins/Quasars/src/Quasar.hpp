@@ -28,9 +28,9 @@
 
 #include "StelObject.hpp"
 #include "StelTextureTypes.hpp"
+#include "StelPainter.hpp"
 #include "StelFader.hpp"
 
-class StelPainter;
 
 //! @class Quasar
 //! A Quasar object represents one Quasar on the sky.
@@ -101,7 +101,9 @@ private:
 	static bool distributionMode;
 	static Vec3f markerColor;
 
-	void draw(StelCore* core, StelPainter& painter);
+	//! Draw the quasar as point source, or add its marker to the batch in distribution mode.
+	//! StelSkyDrawer::preDrawPointSource() must be called before.
+	void draw(StelCore* core, StelPainter& painter, StelPainter::Sprite2dBatch& markers);
 	//! Calculate a color of quasar
 	//! @param b_v value of B-V color index
 	unsigned char BvToColorIndex(float b_v);
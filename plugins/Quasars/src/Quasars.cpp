@@ -19,6 +19,7 @@
 
 #include "StelProjector.hpp"
 #include "StelPainter.hpp"
+#include "StelSkyDrawer.hpp"
 #include "StelApp.hpp"
 #include "StelCore.hpp"
 #include "StelGui.hpp"
@@ -122,6 +123,7 @@ Quasars::~Quasars()
 void Quasars::deinit()
 {
 	QSO.clear();
+	zoneIndex.clear();
 	Quasar::markerTexture.clear();
 	texPointer.clear();
 }
@@ -231,11 +233,22 @@ void Quasars::draw(StelCore* core)
 	StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
 	StelPainter painter(prj);
 	painter.setFont(font);
-	
-	foreach (const QuasarP& quasar, QSO)
+	StelSkyDrawer* sd = core->getSkyDrawer();
+
+	visibleQSO.clear();
+	zoneIndex.findInRegion(prj->getViewportConvexPolygon()->getBoundingSphericalCaps(), visibleQSO);
+
+	markerBatch.clear();
+	sd->preDrawPointSource(&painter);
+	for (int i=0; i<visibleQSO.size(); ++i)
+		QSO.at(visibleQSO.at(i))->draw(core, painter, markerBatch);
+	sd->postDrawPointSource(&painter);
+
+	if (!markerBatch.isEmpty())
 	{
-		if (quasar && quasar->initialized)
-			quasar->draw(core, painter);
+		painter.setBlending(true, GL_ONE, GL_ONE);
+		Quasar::markerTexture->bind();
+		painter.drawSprite2dBatch(markerBatch);
 	}
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
@@ -273,23 +286,10 @@ QList<StelObjectP> Quasars::searchAround(const Vec3d& av, double limitFov, const
 	if (!flagShowQuasars)
 		return result;
 
-	Vec3d v(av);
-	v.normalize();
-	double cosLimFov = cos(limitFov * M_PI/180.);
-	Vec3d equPos;
-
-	foreach(const QuasarP& quasar, QSO)
-	{
-		if (quasar->initialized)
-		{
-			equPos = quasar->XYZ;
-			equPos.normalize();
-			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2]>=cosLimFov)
-			{
-				result.append(qSharedPointerCast<StelObject>(quasar));
-			}
-		}
-	}
+	QVector<int> found;
+	zoneIndex.findAround(av, limitFov, found);
+	foreach (int i, found)
+		result.append(qSharedPointerCast<StelObject>(QSO.at(i)));
 
 	return result;
 }
@@ -470,6 +470,16 @@ void Quasars::setQSOMap(const QVariantMap& map)
 			QSO.append(quasar);
 
 	}
+	updateZoneIndex();
+}
+
+void Quasars::updateZoneIndex()
+{
+	QVector<Vec3d> positions;
+	positions.reserve(QSO.size());
+	foreach (const QuasarP& quasar, QSO)
+		positions.append(quasar->XYZ);
+	zoneIndex.setPositions(positions);
 }
 
 int Quasars::getJsonFileFormatVersion(void)
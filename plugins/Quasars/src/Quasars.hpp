@@ -22,14 +22,15 @@
 #include "StelObjectModule.hpp"
 #include "StelObject.hpp"
 #include "StelTextureTypes.hpp"
+#include "StelPainter.hpp"
+#include "StelZoneIndex.hpp"
 #include "Quasar.hpp"
 #include <QFont>
 #include <QVariantMap>
 #include <QDateTime>
 #include <QList>
 #include <QSharedPointer>
-
-class StelPainter;
+#include <QVector>
 
 class QNetworkAccessManager;
 class QNetworkReply;
@@ -249,12 +250,21 @@ private:
 	//! set items for list of struct from data map
 	void setQSOMap(const QVariantMap& map);
 
+	//! rebuild the spatial index after a change of QSO
+	void updateZoneIndex();
+
 	QString catalogJsonPath;
 
 	int QsrCount;
 
 	StelTextureSP texPointer;
 	QList<QuasarP> QSO;
+	//! positions of QSO sorted by zones, to draw and search only the quasars in a region
+	StelZoneIndex zoneIndex;
+	//! indexes in QSO of the quasars in view, kept to reuse the memory in the next frame
+	QVector<int> visibleQSO;
+	//! markers of the distribution mode, drawn at once
+	StelPainter::Sprite2dBatch markerBatch;
 
 	// variables and functions for the updater
 	UpdateState updateState;
@@ -21,7 +21,7 @@
 #include <QJsonDocument>
 
 
-APIController::APIController(int prefixLength, QObject* parent) : HttpRequestHandler(parent), m_prefixLength(prefixLength)
+APIController::APIController(int prefixLength, QObject* parent) : HttpRequestHandler(parent), m_prefixLength(prefixLength), m_enabled(true)
 {
 
 }
@@ -40,6 +40,76 @@ void APIController::update(double deltaTime)
 		service->update(deltaTime);
 	}
 	mutex.unlock();
+
+	//normally the queue is already empty, because processQueue was invoked through the event loop
+	processQueue();
+}
+
+void APIController::setEnabled(bool enabled)
+{
+	QList<PendingRequestP> cancelled;
+	queueMutex.lock();
+	m_enabled = enabled;
+	if(!enabled)
+		cancelled.swap(m_queue);
+	queueMutex.unlock();
+
+	foreach(const PendingRequestP& req, cancelled)
+	{
+		req->response.setStatus(503,"Service Unavailable");
+		req->response.setData("Server is shutting down");
+		req->done.release();
+	}
+}
+
+void APIController::processQueue()
+{
+	QList<PendingRequestP> batch;
+	queueMutex.lock();
+	batch.swap(m_queue);
+	queueMutex.unlock();
+
+	//all requests which arrived since the last call are handled in one go,
+	//so the HTTP threads don't have to wait for one main thread roundtrip each
+	foreach(const PendingRequestP& req, batch)
+	{
+		if(req->isPost)
+			req->response = req->service->post(req->operation, req->parameters, req->data);
+		else
+			req->response = req->service->get(req->operation, req->parameters);
+		req->done.release();
+	}
+}
+
+APIServiceResponse APIController::runInMainThread(AbstractAPIService *service, bool isPost, const QByteArray &operation,
+						  const APIParameters &parameters, const QByteArray &data)
+{
+	PendingRequestP req(new PendingRequest());
+	req->service = service;
+	req->isPost = isPost;
+	req->operation = operation;
+	req->parameters = parameters;
+	req->data = data;
+
+	queueMutex.lock();
+	if(!m_enabled)
+	{
+		queueMutex.unlock();
+		req->response.setStatus(503,"Service Unavailable");
+		req->response.setData("Server is shutting down");
+		return req->response;
+	}
+	bool wasEmpty = m_queue.isEmpty();
+	m_queue.append(req);
+	queueMutex.unlock();
+
+	//only the first request of a batch has to wake up the main thread,
+	//the others are picked up by the same processQueue call
+	if(wasEmpty)
+		QMetaObject::invokeMethod(this,"processQueue",Qt::QueuedConnection);
+
+	req->done.acquire();
+	return req->response;
 }
 
 void APIController::registerService(AbstractAPIService *service)
@@ -85,17 +155,14 @@ void APIController::service(HttpRequest &request, HttpResponse &response)
 #ifdef FORCE_THREADED_SERVICES
 			apiresponse = sv->get(operation, request.getParameterMap());
 #else
-			if(sv->supportsThreadedOperation())
+			if(sv->supportsThreadedGet(operation))
 			{
 				apiresponse = sv->get(operation, request.getParameterMap());
 			}
 			else
 			{
-				//invoke it in the main thread!
-				QMetaObject::invokeMethod(sv,"get",Qt::BlockingQueuedConnection,
-							  Q_RETURN_ARG(APIServiceResponse, apiresponse),
-							  Q_ARG(QByteArray, operation),
-							  Q_ARG(APIParameters, request.getParameterMap()));
+				//run it in the main thread!
+				apiresponse = runInMainThread(sv, false, operation, request.getParameterMap(), QByteArray());
 			}
 #endif
 			apiresponse.applyResponse(&response);
@@ -111,11 +178,7 @@ void APIController::service(HttpRequest &request, HttpResponse &response)
 			}
 			else
 			{
-				QMetaObject::invokeMethod(sv,"post",Qt::BlockingQueuedConnection,
-							  Q_RETURN_ARG(APIServiceResponse, apiresponse),
-							  Q_ARG(QByteArray, operation),
-							  Q_ARG(APIParameters, request.getParameterMap()),
-							  Q_ARG(QByteArray, request.getBody()));
+				apiresponse = runInMainThread(sv, true, operation, request.getParameterMap(), request.getBody());
 			}
 #endif
 			apiresponse.applyResponse(&response);
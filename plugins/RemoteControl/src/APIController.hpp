@@ -24,6 +24,8 @@
 #include "AbstractAPIService.hpp"
 
 #include <QMutex>
+#include <QSemaphore>
+#include <QSharedPointer>
 
 //! @ingroup remoteControl
 //! This class handles the API-specific requests and dispatches them to the correct AbstractAPISerice implementation.
@@ -41,24 +43,57 @@ public:
 
 	//! Should be called each frame from the main thread, like from StelModule::update.
 	//! Passed on to each AbstractAPIService::update method for optional processing.
+	//! Also processes the requests still waiting for the main thread.
 	void update(double deltaTime);
 
+	//! When disabled, requests that wait for the main thread are answered with an error immediately.
+	//! This has to be done in the main thread before the HTTP server is stopped, because the server waits for its threads.
+	void setEnabled(bool enabled);
+
 	//! Handles an API-specific request. It finds out which AbstractAPIService to use
 	//! depending on the service name (first part of path until slash). An error is returned for invalid requests.
 	//! If a service was found, the request is passed on to its AbstractAPIService::get or AbstractAPIService::post
 	//! method depending on the HTTP request type.
-	//! If AbstractAPIService::supportsThreadedOperation is false, these methods are called in the Stellarium main thread
-	//! using QMetaObject::invokeMethod, otherwise they are directly executed in the current thread (HTTP worker thread).
+	//! If AbstractAPIService::supportsThreadedOperation (or AbstractAPIService::supportsThreadedGet for GET requests) is true,
+	//! these methods are directly executed in the current thread (HTTP worker thread).
+	//! Otherwise the request is added to a queue, which the main thread processes in one batch as soon as it returns
+	//! to its event loop, or at the latest in the next update(). The HTTP thread waits until its request is done.
 	virtual void service(HttpRequest& request, HttpResponse& response);
 
 	//! Registers a service with the APIController.
 	//! The AbstractAPIService::serviceName() determines the request path of the service.
 	void registerService(AbstractAPIService* service);
+private slots:
+	//! Runs all queued requests in the main thread
+	void processQueue();
+
 private:
+	//! A request waiting to be executed in the main thread
+	struct PendingRequest
+	{
+		AbstractAPIService* service;
+		bool isPost;
+		QByteArray operation;
+		APIParameters parameters;
+		QByteArray data;
+		APIServiceResponse response;
+		//released by the main thread when response is valid
+		QSemaphore done;
+	};
+	typedef QSharedPointer<PendingRequest> PendingRequestP;
+
+	//! Queues the request for the main thread and waits for its response
+	APIServiceResponse runInMainThread(AbstractAPIService* service, bool isPost, const QByteArray& operation,
+					   const APIParameters& parameters, const QByteArray& data);
+
 	int m_prefixLength;
 	typedef QMap<QByteArray,AbstractAPIService*> ServiceMap;
 	ServiceMap m_serviceMap;
 	QMutex mutex;
+
+	QList<PendingRequestP> m_queue;
+	bool m_enabled;
+	QMutex queueMutex;
 };
 
 #endif
@@ -102,6 +102,12 @@ bool AbstractAPIService::supportsThreadedOperation() const
 	return false;
 }
 
+bool AbstractAPIService::supportsThreadedGet(const QByteArray &operation) const
+{
+	Q_UNUSED(operation);
+	return supportsThreadedOperation();
+}
+
 APIServiceResponse AbstractAPIService::get(const QByteArray &operation, const APIParameters &parameters)
 {
 	APIServiceResponse response;
@@ -109,6 +109,12 @@ public:
 	//! in the HTTP threads for testing, and this method will be ignored.
 	virtual bool supportsThreadedOperation() const;
 
+	//! Return true if the GET @p operation can safely be run in the HTTP handler thread,
+	//! for example because it only reads a snapshot of the program state which the service updates in update().
+	//! This allows to answer frequent queries without waiting for the main thread.
+	//! Default implementation returns supportsThreadedOperation().
+	virtual bool supportsThreadedGet(const QByteArray& operation) const;
+
 	//! Called in the main thread each frame. Default implementation does nothing.
 	//! Can be used for ongoing actions, for example movement control.
 	virtual void update(double deltaTime);
@@ -0,0 +1,96 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "ChangeCache.hpp"
+
+#include <QDebug>
+
+ChangeCache::ChangeCache(int historySize)
+	: history(historySize)
+{
+}
+
+void ChangeCache::setState(const QJsonObject &newState)
+{
+	QMutexLocker locker(&mutex);
+	state = newState;
+}
+
+void ChangeCache::change(const QString &id, const QJsonValue &value)
+{
+	QMutexLocker locker(&mutex);
+	history.append(Entry(id,value));
+	state.insert(id,value);
+	if(!history.areIndexesValid())
+	{
+		//in theory, this can happen, but practically not so much
+		qWarning()<<"Change cache indices invalid";
+		history.clear();
+	}
+}
+
+QJsonObject ChangeCache::getChangesSinceID(int changeId, bool &fullState)
+{
+	QJsonObject obj;
+	QJsonObject changes;
+	int newId = changeId;
+	fullState = false;
+
+	mutex.lock();
+	if(history.isEmpty())
+	{
+		if(changeId!=-1)
+		{
+			//this is either the initial state (-2) or
+			//something is "broken", probably from an existing web interface that reconnected after restart
+			//force a full reload
+			changes = state;
+			fullState = true;
+			newId = -1;
+		}
+	}
+	else
+	{
+		if(changeId > history.lastIndex() || changeId < (history.firstIndex()-1))
+		{
+			//this is either the initial state (-2) or
+			//"broken" state again, force full reload
+			changes = state;
+			fullState = true;
+			newId = history.lastIndex();
+		}
+		else if(changeId < history.lastIndex())
+		{
+			//create a "diff" between changeId to lastIndex
+			for(int i = changeId+1;i<=history.lastIndex();++i)
+			{
+				const Entry& e = history.at(i);
+				changes.insert(e.id,e.value);
+			}
+			newId = history.lastIndex();
+		}
+		//else no changes happened, interface is at current state!
+	}
+	mutex.unlock();
+
+	obj.insert("changes",changes);
+	obj.insert("id",newId);
+
+	return obj;
+}
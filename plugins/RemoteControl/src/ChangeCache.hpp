@@ -0,0 +1,68 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef CHANGECACHE_HPP_
+#define CHANGECACHE_HPP_
+
+#include <QContiguousCache>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+
+//! @ingroup remoteControl
+//! Thread-safe record of the current values of a set of named items (the checkable StelActions,
+//! or the StelProperties) and of their recent changes, used by MainService.
+//!
+//! The main thread reports every change (and every newly registered item) with change(),
+//! and the HTTP threads ask for everything that changed since the last id their client has seen.
+//! Clients that just started, or whose id is not in the history any more, get the full state instead.
+class ChangeCache
+{
+public:
+	//! @param historySize the number of changes which are kept for clients lagging behind.
+	//! This only has to encompass the changes that occur between two status polls.
+	ChangeCache(int historySize = 100);
+
+	//! Replaces the full state, e.g. after re-reading all items. The history is kept.
+	void setState(const QJsonObject& state);
+	//! Records a new value for the item @p id, and adds it to the full state if it was not known yet.
+	void change(const QString& id, const QJsonValue& value);
+
+	//! Returns a JSON object with the "changes" since @p changeId and the new "id" for the client.
+	//! @param changeId the last id the client has seen, -2 if the client just started,
+	//! or -1 if it has the full state from before the first change.
+	//! @param fullState is set to true if the full state had to be returned instead of a diff
+	QJsonObject getChangesSinceID(int changeId, bool& fullState);
+
+private:
+	struct Entry
+	{
+		Entry(const QString& id, const QJsonValue& value) : id(id), value(value) {}
+		QString id;
+		QJsonValue value;
+	};
+
+	//lists the recent changes - this is a pseudo-circular buffer
+	QContiguousCache<Entry> history;
+	//current value of all items, for clients requesting a full reload
+	QJsonObject state;
+	QMutex mutex;
+};
+
+#endif
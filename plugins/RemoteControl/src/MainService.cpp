@@ -38,13 +38,19 @@
 #include <QJsonObject>
 #include <QJsonArray>
 
+//the status is considered to be polled for this long after the last request (in ms)
+#define POLL_TIMEOUT 5000
+//while nobody polls, the status snapshot is only updated this often (in ms)
+#define IDLE_SNAPSHOT_INTERVAL 1000
+//the info string of the selected object is the most expensive part of the status, it is refreshed at most this often (in ms)
+#define INFO_UPDATE_INTERVAL 250
+
 
 MainService::MainService(const QByteArray &serviceName, QObject *parent)
 	: AbstractAPIService(serviceName,parent),
 	  moveX(0),moveY(0),lastMoveUpdateTime(0),
-	  //100 should be more than enough
-	  //this only has to emcompass events that occur between 2 status updates
-	  actionCache(100), propCache(100)
+	  statusPolled(0), fullStateRequested(0),
+	  lastStatusPoll(0), lastSnapshotUpdate(0), lastInfoUpdate(0), selectionDirty(true)
 {
 	//this is run in the main thread
 	core = StelApp::getInstance().getCore();
@@ -58,9 +64,20 @@ MainService::MainService(const QByteArray &serviceName, QObject *parent)
 	skyCulMgr = &StelApp::getInstance().getSkyCultureMgr();
 
 	connect(actionMgr,SIGNAL(actionToggled(QString,bool)),this,SLOT(actionToggled(QString,bool)));
+	connect(actionMgr,SIGNAL(actionAdded(StelAction*)),this,SLOT(actionAdded(StelAction*)));
 	connect(propMgr,SIGNAL(stelPropChanged(QString,QVariant)),this,SLOT(propertyChanged(QString,QVariant)));
+	connect(propMgr,SIGNAL(stelPropRegistered(QString,QVariant)),this,SLOT(propertyChanged(QString,QVariant)));
+	connect(objMgr,&StelObjectMgr::selectedObjectChanged,this,&MainService::selectionChanged);
 
 	Q_ASSERT(this->thread()==objMgr->thread());
+
+	rebuildFullState();
+	updateStatusSnapshot();
+}
+
+bool MainService::supportsThreadedGet(const QByteArray &operation) const
+{
+	return operation=="status";
 }
 
 void MainService::update(double deltaTime)
@@ -124,6 +141,8 @@ void MainService::update(double deltaTime)
 		//this is required to enable maximal fps for smoothness
 		StelMainView::getInstance().thereWasAnEvent();
 	}
+
+	updateStatusSnapshot();
 }
 
 void MainService::getImpl(const QByteArray& operation, const APIParameters &parameters, APIServiceResponse &response)
@@ -140,72 +159,11 @@ void MainService::getImpl(const QByteArray& operation, const APIParameters &para
 		bool propOk;
 		int propId = sPropId.toInt(&propOk);
 
-		QJsonObject obj;
-
-		//// Location
-		const StelLocation& loc = core->getCurrentLocation();
-		{
-			QJsonObject obj2;
-			obj2.insert("name",loc.name);
-			obj2.insert("role",QString(loc.role));
-			obj2.insert("planet",loc.planetName);
-			obj2.insert("latitude",loc.latitude);
-			obj2.insert("longitude",loc.longitude);
-			obj2.insert("altitude",loc.altitude);
-			obj2.insert("country",loc.country);
-			obj2.insert("state",loc.state);
-			obj2.insert("landscapeKey",loc.landscapeKey);
-			obj.insert("location",obj2);
-		}
-
-		//// Time related stuff
-		{
-			double jday = core->getJD();
-			double deltaT = core->getDeltaT() * StelCore::JD_SECOND;
-
-			double gmtShift = core->getUTCOffset(jday) / 24.0;
-
-			QString utcIso = StelUtils::julianDayToISO8601String(jday,true).append('Z');
-			QString localIso = StelUtils::julianDayToISO8601String(jday+gmtShift,true);
-
-			//time zone string
-			QString timeZone = localeMgr->getPrintableTimeZoneLocal(jday);
-
-			QJsonObject obj2;
-			obj2.insert("jday",jday);
-			obj2.insert("deltaT",deltaT);
-			obj2.insert("gmtShift",gmtShift);
-			obj2.insert("timeZone",timeZone);
-			obj2.insert("utc",utcIso);
-			obj2.insert("local",localIso);
-			obj2.insert("isTimeNow",core->getIsTimeNow());
-			obj2.insert("timerate",core->getTimeRate());
-			obj.insert("time",obj2);
-		}
-
-		//// Info about selected object (only primary)
-		{
-			QString infoStr;
-			QMetaObject::invokeMethod(this,"getInfoString",SERVICE_DEFAULT_INVOKETYPE,
-						  Q_RETURN_ARG(QString,infoStr));
-			obj.insert("selectioninfo",infoStr);
-		}
-
-		//// Info about current view
-		{
-			QJsonObject obj2;
-
-			// the aim fov may lie outside the min/max bounds, so constrain it
-			double fov = mvmgr->getAimFov();
-			if(fov < mvmgr->getMinFov())
-				fov = mvmgr->getMinFov();
-			else if (fov>mvmgr->getMaxFov())
-				fov = mvmgr->getMaxFov();
-
-			obj2.insert("fov",fov);
-
-			obj.insert("view",obj2);
-		}
+		//the rest is answered from the snapshot of the last frame, we are in the HTTP thread
+		statusPolled.fetchAndStoreRelaxed(1);
+		snapshotMutex.lock();
+		QJsonObject obj = statusSnapshot;
+		snapshotMutex.unlock();
 
 		//// Info about changed actions & props (if requested)
 		{
@@ -511,153 +469,153 @@ void MainService::setFov(double fov)
 	mvmgr->zoomTo(fov,0.25f);
 }
 
-void MainService::actionToggled(const QString &id, bool val)
+void MainService::updateStatusSnapshot()
 {
-	actionMutex.lock();
-	actionCache.append(ActionCacheEntry(id,val));
-	if(!actionCache.areIndexesValid())
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	if(statusPolled.fetchAndStoreRelaxed(0))
+		lastStatusPoll = now;
+	if(fullStateRequested.fetchAndStoreRelaxed(0))
+		rebuildFullState();
+
+	//while nobody polls, the snapshot is only kept roughly up to date
+	const bool polled = (now - lastStatusPoll) < POLL_TIMEOUT;
+	if(!polled && !selectionDirty && (now - lastSnapshotUpdate) < IDLE_SNAPSHOT_INTERVAL)
+		return;
+	lastSnapshotUpdate = now;
+
+	if(selectionDirty || (polled && (now - lastInfoUpdate) >= INFO_UPDATE_INTERVAL))
 	{
-		//in theory, this can happen, but practically not so much
-		qWarning()<<"Action cache indices invalid";
-		actionCache.clear();
+		infoString = getInfoString();
+		selectionDirty = false;
+		lastInfoUpdate = now;
 	}
-	actionMutex.unlock();
-}
 
-void MainService::propertyChanged(const QString &id, const QVariant &val)
-{
-	propMutex.lock();
-	propCache.append(PropertyCacheEntry(id,val));
-	if(!propCache.areIndexesValid())
+	QJsonObject obj;
+
+	//// Location
+	const StelLocation& loc = core->getCurrentLocation();
 	{
-		//in theory, this can happen, but practically not so much
-		qWarning()<<"Property cache indices invalid";
-		propCache.clear();
+		QJsonObject obj2;
+		obj2.insert("name",loc.name);
+		obj2.insert("role",QString(loc.role));
+		obj2.insert("planet",loc.planetName);
+		obj2.insert("latitude",loc.latitude);
+		obj2.insert("longitude",loc.longitude);
+		obj2.insert("altitude",loc.altitude);
+		obj2.insert("country",loc.country);
+		obj2.insert("state",loc.state);
+		obj2.insert("landscapeKey",loc.landscapeKey);
+		obj.insert("location",obj2);
 	}
-	propMutex.unlock();
-}
-
-QJsonObject MainService::getActionChangesSinceID(int changeId)
-{
-	//changeId is the last id the interface is available
-	//or -2 if the interface just started
-	// -1 means the initial state was set
 
-	QJsonObject obj;
-	QJsonObject changes;
-	int newId = changeId;
+	//// Time related stuff
+	{
+		double jday = core->getJD();
+		double deltaT = core->getDeltaT() * StelCore::JD_SECOND;
+
+		double gmtShift = core->getUTCOffset(jday) / 24.0;
+
+		QString utcIso = StelUtils::julianDayToISO8601String(jday,true).append('Z');
+		QString localIso = StelUtils::julianDayToISO8601String(jday+gmtShift,true);
+
+		//time zone string
+		QString timeZone = localeMgr->getPrintableTimeZoneLocal(jday);
+
+		QJsonObject obj2;
+		obj2.insert("jday",jday);
+		obj2.insert("deltaT",deltaT);
+		obj2.insert("gmtShift",gmtShift);
+		obj2.insert("timeZone",timeZone);
+		obj2.insert("utc",utcIso);
+		obj2.insert("local",localIso);
+		obj2.insert("isTimeNow",core->getIsTimeNow());
+		obj2.insert("timerate",core->getTimeRate());
+		obj.insert("time",obj2);
+	}
 
+	//// Info about selected object (only primary)
+	obj.insert("selectioninfo",infoString);
 
-	actionMutex.lock();
-	if(actionCache.isEmpty())
+	//// Info about current view
 	{
-		if(changeId!=-1)
-		{
-			//this is either the initial state (-2) or
-			//something is "broken", probably from an existing web interface that reconnected after restart
-			//force a full reload
+		QJsonObject obj2;
 
-			foreach(StelAction* ac, actionMgr->getActionList())
-			{
-				if(ac->isCheckable())
-				{
-					changes.insert(ac->getId(),ac->isChecked());
-				}
-			}
-			newId = -1;
-		}
-	}
-	else
-	{
-		if(changeId > actionCache.lastIndex() || changeId < (actionCache.firstIndex()-1))
-		{
-			//this is either the initial state (-2) or
-			//"broken" state again, force full reload
-			foreach(StelAction* ac, actionMgr->getActionList())
-			{
-				if(ac->isCheckable())
-				{
-					changes.insert(ac->getId(),ac->isChecked());
-				}
-			}
-			newId = actionCache.lastIndex();
-		}
-		else if(changeId < actionCache.lastIndex())
-		{
-			//create a "diff" between changeId to lastIndex
-			for(int i = changeId+1;i<=actionCache.lastIndex();++i)
-			{
-				const ActionCacheEntry& e = actionCache.at(i);
-				changes.insert(e.action,e.val);
-			}
-			newId = actionCache.lastIndex();
-		}
-		//else no changes happened, interface is at current state!
-	}
-	actionMutex.unlock();
+		// the aim fov may lie outside the min/max bounds, so constrain it
+		double fov = mvmgr->getAimFov();
+		if(fov < mvmgr->getMinFov())
+			fov = mvmgr->getMinFov();
+		else if (fov>mvmgr->getMaxFov())
+			fov = mvmgr->getMaxFov();
 
-	obj.insert("changes",changes);
-	obj.insert("id",newId);
+		obj2.insert("fov",fov);
 
-	return obj;
+		obj.insert("view",obj2);
+	}
+
+	snapshotMutex.lock();
+	statusSnapshot = obj;
+	snapshotMutex.unlock();
 }
 
-QJsonObject MainService::getPropertyChangesSinceID(int changeId)
+void MainService::rebuildFullState()
 {
-	//changeId is the last id the interface is available
-	//or -2 if the interface just started
-	// -1 means the initial state was set
-	QJsonObject obj;
-	QJsonObject changes;
-	int newId = changeId;
-
-	propMutex.lock();
-	if(propCache.isEmpty())
+	QJsonObject actions;
+	foreach(StelAction* ac, actionMgr->getActionList())
 	{
-		if(changeId!=-1)
+		if(ac->isCheckable())
 		{
-			//this is either the initial state (-2) or
-			//something is "broken", probably from an existing web interface that reconnected after restart
-			//force a full reload
-			const StelPropertyMgr::StelPropertyMap& map = propMgr->getPropertyMap();
-			for(StelPropertyMgr::StelPropertyMap::const_iterator it = map.constBegin();
-			    it!=map.constEnd();++it)
-			{
-				changes.insert(it.key(), QJsonValue::fromVariant((*it)->getValue()));
-			}
-			newId = -1;
+			actions.insert(ac->getId(),ac->isChecked());
 		}
 	}
-	else
+	actionChanges.setState(actions);
+
+	QJsonObject props;
+	const StelPropertyMgr::StelPropertyMap& map = propMgr->getPropertyMap();
+	for(StelPropertyMgr::StelPropertyMap::const_iterator it = map.constBegin();
+	    it!=map.constEnd();++it)
 	{
-		if(changeId > propCache.lastIndex() || changeId < (propCache.firstIndex()-1))
-		{
-			//this is either the initial state (-2) or
-			//"broken" state again, force full reload
-			const StelPropertyMgr::StelPropertyMap& map = propMgr->getPropertyMap();
-			for(StelPropertyMgr::StelPropertyMap::const_iterator it = map.constBegin();
-			    it!=map.constEnd();++it)
-			{
-				changes.insert(it.key(), QJsonValue::fromVariant((*it)->getValue()));
-			}
-			newId = propCache.lastIndex();
-		}
-		else if(changeId < propCache.lastIndex())
-		{
-			//create a "diff" between changeId to lastIndex
-			for(int i = changeId+1;i<=propCache.lastIndex();++i)
-			{
-				const PropertyCacheEntry& e = propCache.at(i);
-				changes.insert(e.id,QJsonValue::fromVariant(e.val));
-			}
-			newId = propCache.lastIndex();
-		}
-		//else no changes happened, interface is at current state!
+		props.insert(it.key(), QJsonValue::fromVariant((*it)->getValue()));
 	}
-	propMutex.unlock();
+	propertyChanges.setState(props);
+}
+
+void MainService::actionToggled(const QString &id, bool val)
+{
+	actionChanges.change(id,val);
+}
 
-	obj.insert("changes",changes);
-	obj.insert("id",newId);
+void MainService::actionAdded(StelAction *action)
+{
+	//actions registered after the service was created, e.g. by plugins loaded later
+	if(action->isCheckable())
+		actionToggled(action->getId(),action->isChecked());
+}
 
+void MainService::propertyChanged(const QString &id, const QVariant &val)
+{
+	propertyChanges.change(id,QJsonValue::fromVariant(val));
+}
+
+void MainService::selectionChanged()
+{
+	selectionDirty = true;
+}
+
+QJsonObject MainService::getActionChangesSinceID(int changeId)
+{
+	bool fullState;
+	QJsonObject obj = actionChanges.getChangesSinceID(changeId,fullState);
+	//let the main thread re-read all values, in case one changed without notification
+	if(fullState)
+		fullStateRequested.fetchAndStoreRelaxed(1);
+	return obj;
+}
+
+QJsonObject MainService::getPropertyChangesSinceID(int changeId)
+{
+	bool fullState;
+	QJsonObject obj = propertyChanges.getChangesSinceID(changeId,fullState);
+	if(fullState)
+		fullStateRequested.fetchAndStoreRelaxed(1);
 	return obj;
 }
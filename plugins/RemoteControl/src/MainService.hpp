@@ -21,15 +21,17 @@
 #define MAINSERVICE_HPP_
 
 #include "AbstractAPIService.hpp"
+#include "ChangeCache.hpp"
 
 #include "StelObjectType.hpp"
 #include "VecMath.hpp"
 
-#include <QContiguousCache>
+#include <QAtomicInt>
 #include <QJsonObject>
 #include <QMutex>
 
 class StelCore;
+class StelAction;
 class StelActionMgr;
 class LandscapeMgr;
 class StelLocaleMgr;
@@ -43,6 +45,8 @@ class StelSkyCultureMgr;
 //! Implements the main API services, including the \c status operation which can be repeatedly polled to find the current state of the main program,
 //! including time, view, location, StelAction and StelProperty state changes, movement, script status ...
 //!
+//! The \c status operation is answered directly in the HTTP thread, from a snapshot which is updated in update().
+//!
 //! @see @ref rcMainService
 class MainService : public AbstractAPIService
 {
@@ -52,8 +56,10 @@ public:
 
 	virtual ~MainService() {}
 
-	//! Used to implement move functionality
+	//! Used to implement move functionality, and updates the snapshot for the \c status operation
 	virtual void update(double deltaTime) Q_DECL_OVERRIDE;
+	//! The \c status operation is thread-safe
+	virtual bool supportsThreadedGet(const QByteArray& operation) const Q_DECL_OVERRIDE;
 
 protected:
 	//! @brief Implements the GET operations
@@ -79,7 +85,9 @@ private slots:
 	void setFov(double fov);
 
 	void actionToggled(const QString& id, bool val);
+	void actionAdded(StelAction* action);
 	void propertyChanged(const QString& id, const QVariant& val);
+	void selectionChanged();
 
 private:
 	StelCore* core;
@@ -95,26 +103,29 @@ private:
 	float moveX,moveY;
 	qint64 lastMoveUpdateTime;
 
-	struct ActionCacheEntry
-	{
-		ActionCacheEntry(const QString& str,bool val) : action(str),val(val) {}
-		QString action;
-		bool val;
-	};
-
-	//lists the recently toggled actions - this is a pseudo-circular buffer
-	QContiguousCache<ActionCacheEntry> actionCache;
-	QMutex actionMutex;
+	//! Updates statusSnapshot, called from update()
+	void updateStatusSnapshot();
+	//! Re-reads all checkable actions and all properties into actionChanges and propertyChanges
+	void rebuildFullState();
+
+	//the location, time, view and selection info parts of the status, as of the last frame
+	QJsonObject statusSnapshot;
+	QMutex snapshotMutex;
+	//set by the HTTP threads when status was requested, cleared in update()
+	QAtomicInt statusPolled;
+	//set by the HTTP threads if a client needed the full action/property state
+	QAtomicInt fullStateRequested;
+	qint64 lastStatusPoll;
+	qint64 lastSnapshotUpdate;
+	qint64 lastInfoUpdate;
+	bool selectionDirty;
+	QString infoString;
+
+	//the current value of all checkable actions and their recent changes
+	ChangeCache actionChanges;
 	QJsonObject getActionChangesSinceID(int changeId);
-
-	struct PropertyCacheEntry
-	{
-		PropertyCacheEntry(const QString& str, const QVariant& val) : id(str),val(val) {}
-		QString id;
-		QVariant val;
-	};
-	QContiguousCache<PropertyCacheEntry> propCache;
-	QMutex propMutex;
+	//the current value of all properties and their recent changes
+	ChangeCache propertyChanges;
 	QJsonObject getPropertyChangesSinceID(int changeId);
 
 };
@@ -0,0 +1,57 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "ProfilerService.hpp"
+
+#include "StelApp.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelModuleProfiler.hpp"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+ProfilerService::ProfilerService(const QByteArray &serviceName, QObject *parent) : AbstractAPIService(serviceName,parent)
+{
+	profiler = StelApp::getInstance().getModuleMgr().getProfiler();
+}
+
+void ProfilerService::getImpl(const QByteArray &operation, const APIParameters &parameters, APIServiceResponse &response)
+{
+	Q_UNUSED(parameters);
+
+	if(operation=="report")
+	{
+		QJsonObject obj;
+		obj.insert("enabled",profiler->getFlagEnabled());
+		obj.insert("gpuTiming",profiler->getFlagGpuTiming());
+		obj.insert("modules",QJsonArray::fromVariantList(profiler->getProfilingReport()));
+		response.writeJSON(QJsonDocument(obj));
+	}
+	else if(operation=="csv")
+	{
+		response.setHeader("Content-Type","text/csv; charset=UTF-8");
+		response.setData(profiler->getProfilingReportCsv().toUtf8());
+	}
+	else
+	{
+		//TODO some sort of service description?
+		response.writeRequestError("unsupported operation. GET: report, csv");
+	}
+}
@@ -0,0 +1,48 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef PROFILERSERVICE_HPP_
+#define PROFILERSERVICE_HPP_
+
+#include "AbstractAPIService.hpp"
+
+class StelModuleProfiler;
+
+//! @ingroup remoteControl
+//! Provides the per-module frame time statistics of the StelModuleProfiler.
+//! The profiler itself is switched on and off with its StelProperty \c StelModuleProfiler.flagEnabled.
+//!
+//! @see \ref rcProfilerService
+class ProfilerService : public AbstractAPIService
+{
+	Q_OBJECT
+public:
+	ProfilerService(const QByteArray& serviceName, QObject* parent = 0);
+
+	virtual ~ProfilerService() {}
+
+protected:
+	//! @brief Implements the HTTP GET requests
+	//! @see \ref rcProfilerServiceGET
+	virtual void getImpl(const QByteArray& operation,const APIParameters& parameters, APIServiceResponse& response) Q_DECL_OVERRIDE;
+private:
+	StelModuleProfiler* profiler;
+};
+
+#endif
@@ -242,6 +242,7 @@ void RemoteControl::startServer()
 	//set request handler password settings
 	requestHandler->setPassword(password);
 	requestHandler->setUsePassword(usePassword);
+	requestHandler->setEnabled(true);
 	HttpListenerSettings settings;
 	settings.port = port;
 	settings.minThreads = minThreads;
@@ -253,6 +254,9 @@ void RemoteControl::stopServer()
 {
 	if(httpListener)
 	{
+		//release the threads waiting for the main thread and end the running event streams first,
+		//the listener waits for all its threads
+		requestHandler->setEnabled(false);
 		delete httpListener;
 		httpListener = NULL;
 	}
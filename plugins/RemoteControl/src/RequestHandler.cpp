@@ -26,10 +26,12 @@
 #include "LocationSearchService.hpp"
 #include "MainService.hpp"
 #include "ObjectService.hpp"
+#include "ProfilerService.hpp"
 #include "ScriptService.hpp"
 #include "SimbadService.hpp"
 #include "StelActionService.hpp"
 #include "StelPropertyService.hpp"
+#include "StreamController.hpp"
 #include "ViewService.hpp"
 
 #include "StelApp.hpp"
@@ -99,6 +101,9 @@ RequestHandler::RequestHandler(const StaticFileControllerSettings& settings, QOb
 	apiController->registerService(new LocationService("location",apiController));
 	apiController->registerService(new LocationSearchService("locationsearch",apiController));
 	apiController->registerService(new ViewService("view",apiController));
+	apiController->registerService(new ProfilerService("profiler",apiController));
+
+	streamController = new StreamController(100,10,this);
 
 	staticFiles = new StaticFileController(settings,this);
 	connect(&StelApp::getInstance(),SIGNAL(languageChanged()),this,SLOT(refreshTemplates()));
@@ -112,6 +117,13 @@ RequestHandler::~RequestHandler()
 void RequestHandler::update(double deltaTime)
 {
 	apiController->update(deltaTime);
+	streamController->update();
+}
+
+void RequestHandler::setEnabled(bool enabled)
+{
+	apiController->setEnabled(enabled);
+	streamController->setEnabled(enabled);
 }
 
 void RequestHandler::service(HttpRequest &request, HttpResponse &response)
@@ -142,7 +154,12 @@ void RequestHandler::service(HttpRequest &request, HttpResponse &response)
 	QByteArray path = request.getPath();
 	//qDebug()<<"Request path:"<<rawPath<<" decoded:"<<path;
 
-	if(path.startsWith("/api/"))
+	if(path == "/api/stream")
+	{
+		//push-based state updates, this blocks the thread until the client disconnects
+		streamController->service(request,response);
+	}
+	else if(path.startsWith("/api/"))
 	{
 		//this is an API request, pass it on
 		apiController->service(request,response);
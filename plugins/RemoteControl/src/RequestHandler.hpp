@@ -25,6 +25,7 @@
 
 class APIController;
 class StaticFileController;
+class StreamController;
 
 //! This is the main request handler for the remote control plugin, receiving and dispatching the HTTP requests.
 //! It also handles the optional simple HTTP authentication. See #service to find out how the requests are processed.
@@ -41,14 +42,21 @@ public:
 	//! The internal APIController, and all registered services are deleted
 	virtual ~RequestHandler();
 
-	//! Called in the main thread each frame, only passed on to APIController::update
+	//! Called in the main thread each frame, passed on to APIController::update and StreamController::update
 	void update(double deltaTime);
 
+	//! Enables or disables the handling of requests which need the main thread, see APIController::setEnabled,
+	//! and the \c /api/stream event stream, see StreamController::setEnabled.
+	//! This has to be disabled before the HTTP server is stopped.
+	void setEnabled(bool enabled);
+
 	//! Receives the HttpRequest from the HttpListener.
 	//! It checks the optional HTTP authentication and sets the keep-alive header if requested
 	//! by the client.
 	//!
 	//! If the authentication is correct, the request is processed according to the following rules:
+	//!  - If the request path is @c "/api/stream", the request is passed to the \ref StreamController,
+	//! which keeps the connection open and pushes state changes to the client.
 	//!  - If the request path starts with the string @c "/api/", then the request is passed to
 	//! the \ref APIController without further processing.
 	//!  - If a file specified in the special \c translate_files file is requested, the cached translated version
@@ -80,6 +88,7 @@ private:
 	QString password;
 	QByteArray passwordReply;
 	APIController* apiController;
+	StreamController* streamController;
 	StaticFileController* staticFiles;
 	QMutex templateMutex;
 
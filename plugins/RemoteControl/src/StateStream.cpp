@@ -0,0 +1,173 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StateStream.hpp"
+
+#include <QJsonDocument>
+
+StateStream::StateStream(int historySize)
+	: historySize(historySize), stateId(0), stateValid(false), closed(false), clients(0)
+{
+	Q_ASSERT(historySize>0);
+}
+
+void StateStream::merge(QJsonObject &target, const QJsonObject &diff)
+{
+	for(QJsonObject::const_iterator it = diff.constBegin(); it!=diff.constEnd(); ++it)
+	{
+		QJsonObject::iterator old = target.find(it.key());
+		if(old!=target.end() && old.value().isObject() && it.value().isObject())
+		{
+			QJsonObject obj = old.value().toObject();
+			merge(obj,it.value().toObject());
+			old.value() = obj;
+		}
+		else
+			target.insert(it.key(),it.value());
+	}
+}
+
+void StateStream::publish(const QJsonObject &diff)
+{
+	if(diff.isEmpty())
+		return;
+
+	//serialize outside of the lock, this is done only once for all clients
+	QByteArray json = QJsonDocument(diff).toJson(QJsonDocument::Compact);
+
+	QMutexLocker locker(&mutex);
+	if(!stateValid)
+		return;
+	merge(state,diff);
+	stateJson.clear();
+	history.append(Entry(diff,json));
+	while(history.size()>historySize)
+		history.removeFirst();
+	++stateId;
+	changed.wakeAll();
+}
+
+void StateStream::reset(const QJsonObject &newState)
+{
+	QMutexLocker locker(&mutex);
+	state = newState;
+	stateJson.clear();
+	history.clear();
+	stateValid = true;
+	++stateId;
+	changed.wakeAll();
+}
+
+bool StateStream::hasState() const
+{
+	QMutexLocker locker(&mutex);
+	return stateValid;
+}
+
+void StateStream::close()
+{
+	QMutexLocker locker(&mutex);
+	closed = true;
+	changed.wakeAll();
+}
+
+void StateStream::open()
+{
+	QMutexLocker locker(&mutex);
+	closed = false;
+	stateValid = false;
+	state = QJsonObject();
+	stateJson.clear();
+	history.clear();
+}
+
+bool StateStream::isClosed() const
+{
+	QMutexLocker locker(&mutex);
+	return closed;
+}
+
+int StateStream::clientCount() const
+{
+	QMutexLocker locker(&mutex);
+	return clients;
+}
+
+bool StateStream::addClient(int maxClients)
+{
+	QMutexLocker locker(&mutex);
+	if(closed || clients>=maxClients)
+		return false;
+	++clients;
+	return true;
+}
+
+void StateStream::removeClient()
+{
+	QMutexLocker locker(&mutex);
+	Q_ASSERT(clients>0);
+	--clients;
+}
+
+bool StateStream::waitForChanges(qint64 &lastId, QByteArray &data, int timeout)
+{
+	QList<Entry> missed;
+
+	mutex.lock();
+	if(!closed && (!stateValid || lastId==stateId))
+		changed.wait(&mutex,timeout);
+	if(closed || !stateValid || lastId==stateId)
+	{
+		mutex.unlock();
+		return false;
+	}
+
+	const qint64 firstId = stateId - history.size() + 1;
+	if(lastId>=firstId-1 && lastId<stateId)
+	{
+		if(lastId==stateId-1)
+		{
+			//the common case, the client is up to date
+			data = history.last().json;
+		}
+		else
+		{
+			//the QJsonObjects are implicitly shared, merge them after unlocking
+			missed = history.mid(lastId+1-firstId);
+		}
+	}
+	else
+	{
+		//new client, or the history does not reach back far enough: send a keyframe
+		if(stateJson.isEmpty())
+			stateJson = QJsonDocument(state).toJson(QJsonDocument::Compact);
+		data = stateJson;
+	}
+	lastId = stateId;
+	mutex.unlock();
+
+	if(!missed.isEmpty())
+	{
+		QJsonObject diff;
+		foreach(const Entry& e, missed)
+			merge(diff,e.diff);
+		data = QJsonDocument(diff).toJson(QJsonDocument::Compact);
+	}
+	return true;
+}
@@ -0,0 +1,103 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STATESTREAM_HPP_
+#define STATESTREAM_HPP_
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+
+//! @ingroup remoteControl
+//! Thread-safe history of state changes shared between the Stellarium main thread and the HTTP threads
+//! serving the event stream (see StreamController).
+//!
+//! The main thread publishes at most one diff per frame with publish(). Each diff is a JSON object
+//! whose keys are merged into the full state (nested objects are merged key by key, everything else replaces the old value).
+//! Every diff is serialized only once when it is published, so a client which keeps up with the stream
+//! costs nothing more than a copy of the shared QByteArray. Clients that fell behind because of their
+//! rate limit get the merge of all diffs they missed, and clients that fell out of the history (or just connected)
+//! get the full state as a keyframe.
+class StateStream
+{
+public:
+	//! @param historySize the number of diffs which are kept for clients lagging behind.
+	StateStream(int historySize = 256);
+
+	//! Merges the diff into the full state and wakes up all waiting clients.
+	//! Empty diffs, and diffs published before the first reset(), are ignored.
+	void publish(const QJsonObject& diff);
+	//! Replaces the full state and clears the history, forcing a keyframe for all clients.
+	void reset(const QJsonObject& state);
+	//! Returns true if a full state is available, i.e. reset() was called since the stream was opened.
+	bool hasState() const;
+
+	//! Lets all waiting clients return from waitForChanges() and refuses further waiting, until open() is called.
+	void close();
+	//! Re-opens the stream after close(). The state is discarded.
+	void open();
+	//! Returns true after close() was called
+	bool isClosed() const;
+
+	//! Returns the number of clients currently registered with addClient()
+	int clientCount() const;
+	//! Registers a client. Returns false if the stream is closed or @p maxClients clients are already connected.
+	bool addClient(int maxClients);
+	//! Unregisters a client registered with addClient()
+	void removeClient();
+
+	//! Blocks for at most @p timeout ms until there are changes newer than @p lastId.
+	//! @param lastId the id of the last update the client has received, or -1 if it has nothing yet.
+	//! It is updated to the id of the returned data.
+	//! @param data receives the compact JSON of the changes since @p lastId, or the full state if the history
+	//! does not reach back that far.
+	//! @return false on timeout, or if the stream has been closed.
+	bool waitForChanges(qint64& lastId, QByteArray& data, int timeout);
+
+	//! Merges the keys of @p diff into @p target, recursing into nested objects.
+	static void merge(QJsonObject& target, const QJsonObject& diff);
+
+private:
+	struct Entry
+	{
+		Entry() {}
+		Entry(const QJsonObject& diff, const QByteArray& json) : diff(diff), json(json) {}
+		QJsonObject diff;
+		QByteArray json;
+	};
+
+	//the most recent diffs, the last one has the id stateId
+	QList<Entry> history;
+	int historySize;
+	QJsonObject state;
+	//serialized version of state, created on demand
+	QByteArray stateJson;
+	//id of the newest data in state
+	qint64 stateId;
+	bool stateValid;
+	bool closed;
+	int clients;
+
+	mutable QMutex mutex;
+	QWaitCondition changed;
+};
+
+#endif
@@ -0,0 +1,339 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StreamController.hpp"
+#include "httpserver/httprequest.h"
+#include "httpserver/httpresponse.h"
+
+#include "StelApp.hpp"
+#include "StelActionMgr.hpp"
+#include "StelCore.hpp"
+#include "StelLocaleMgr.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelObjectMgr.hpp"
+#include "StelPropertyMgr.hpp"
+#include "StelUtils.hpp"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QThread>
+
+//while the time is running, the time is re-sent at most this often (in ms), clients should extrapolate in between using the timerate
+#define TIME_RESYNC_INTERVAL 1000
+//the info string of the selected object changes with time, it is re-checked at most this often (in ms)
+#define INFO_UPDATE_INTERVAL 1000
+//a comment is sent after this many ms without events, so that clients and proxies don't drop the connection
+#define KEEPALIVE_INTERVAL 15000
+
+StreamController::StreamController(int minInterval, int maxClients, QObject *parent)
+	: HttpRequestHandler(parent),
+	  minInterval(minInterval), maxClients(maxClients), active(false),
+	  locationDirty(false), timeDirty(false), selectionDirty(false),
+	  lastFov(0.), lastIsTimeNow(false), lastTimeUpdate(0), lastInfoUpdate(0)
+{
+	//this is run in the main thread
+	core = StelApp::getInstance().getCore();
+	actionMgr = StelApp::getInstance().getStelActionManager();
+	localeMgr = &StelApp::getInstance().getLocaleMgr();
+	mvmgr = GETSTELMODULE(StelMovementMgr);
+	objMgr = &StelApp::getInstance().getStelObjectMgr();
+	propMgr = StelApp::getInstance().getStelPropertyManager();
+
+	connect(actionMgr,SIGNAL(actionToggled(QString,bool)),this,SLOT(actionToggled(QString,bool)));
+	connect(actionMgr,SIGNAL(actionAdded(StelAction*)),this,SLOT(actionAdded(StelAction*)));
+	connect(propMgr,SIGNAL(stelPropChanged(QString,QVariant)),this,SLOT(propertyChanged(QString,QVariant)));
+	connect(propMgr,SIGNAL(stelPropRegistered(QString,QVariant)),this,SLOT(propertyChanged(QString,QVariant)));
+	connect(core,SIGNAL(locationChanged(StelLocation)),this,SLOT(locationChanged()));
+	connect(core,SIGNAL(timeSyncOccurred(double)),this,SLOT(timeChanged()));
+	connect(objMgr,&StelObjectMgr::selectedObjectChanged,this,&StreamController::selectionChanged);
+}
+
+StreamController::~StreamController()
+{
+}
+
+void StreamController::setEnabled(bool enabled)
+{
+	if(enabled)
+	{
+		stream.open();
+		active = false;
+	}
+	else
+		stream.close();
+}
+
+void StreamController::update()
+{
+	if(stream.clientCount()==0)
+	{
+		//nobody listens, don't collect anything
+		active = false;
+		return;
+	}
+
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	if(!active || !stream.hasState())
+	{
+		//first client connected, start with a keyframe
+		active = true;
+		actionChanges = QJsonObject();
+		propertyChanges = QJsonObject();
+		locationDirty = timeDirty = selectionDirty = false;
+		lastTimeUpdate = lastInfoUpdate = now;
+		QJsonObject state = getState();
+		lastFov = state.value("view").toObject().value("fov").toDouble();
+		lastInfoString = state.value("selectioninfo").toString();
+		lastIsTimeNow = core->getIsTimeNow();
+		stream.reset(state);
+		return;
+	}
+
+	QJsonObject diff;
+	if(!actionChanges.isEmpty())
+	{
+		diff.insert("actionChanges",actionChanges);
+		actionChanges = QJsonObject();
+	}
+	if(!propertyChanges.isEmpty())
+	{
+		diff.insert("propertyChanges",propertyChanges);
+		propertyChanges = QJsonObject();
+	}
+	if(locationDirty)
+	{
+		diff.insert("location",getLocation());
+		locationDirty = false;
+	}
+
+	const bool timeRunning = !qFuzzyIsNull(core->getTimeRate());
+	if(timeDirty || core->getIsTimeNow()!=lastIsTimeNow || (timeRunning && now-lastTimeUpdate>=TIME_RESYNC_INTERVAL))
+	{
+		diff.insert("time",getTime());
+		timeDirty = false;
+		lastIsTimeNow = core->getIsTimeNow();
+		lastTimeUpdate = now;
+	}
+
+	QJsonObject view = getView();
+	const double fov = view.value("fov").toDouble();
+	if(!qFuzzyCompare(fov,lastFov))
+	{
+		diff.insert("view",view);
+		lastFov = fov;
+	}
+
+	if(selectionDirty || (now-lastInfoUpdate>=INFO_UPDATE_INTERVAL && !objMgr->getSelectedObject().isEmpty()))
+	{
+		QString infoStr = getInfoString();
+		if(infoStr!=lastInfoString)
+		{
+			diff.insert("selectioninfo",infoStr);
+			lastInfoString = infoStr;
+		}
+		selectionDirty = false;
+		lastInfoUpdate = now;
+	}
+
+	stream.publish(diff);
+}
+
+void StreamController::actionToggled(const QString &id, bool val)
+{
+	if(active)
+		actionChanges.insert(id,val);
+}
+
+void StreamController::actionAdded(StelAction *action)
+{
+	if(active && action->isCheckable())
+		actionChanges.insert(action->getId(),action->isChecked());
+}
+
+void StreamController::propertyChanged(const QString &id, const QVariant &val)
+{
+	if(active)
+		propertyChanges.insert(id,QJsonValue::fromVariant(val));
+}
+
+void StreamController::locationChanged()
+{
+	locationDirty = true;
+}
+
+void StreamController::timeChanged()
+{
+	timeDirty = true;
+}
+
+void StreamController::selectionChanged()
+{
+	selectionDirty = true;
+}
+
+QJsonObject StreamController::getLocation() const
+{
+	const StelLocation& loc = core->getCurrentLocation();
+	QJsonObject obj;
+	obj.insert("name",loc.name);
+	obj.insert("role",QString(loc.role));
+	obj.insert("planet",loc.planetName);
+	obj.insert("latitude",loc.latitude);
+	obj.insert("longitude",loc.longitude);
+	obj.insert("altitude",loc.altitude);
+	obj.insert("country",loc.country);
+	obj.insert("state",loc.state);
+	obj.insert("landscapeKey",loc.landscapeKey);
+	return obj;
+}
+
+QJsonObject StreamController::getTime() const
+{
+	//same fields as the main/status operation
+	double jday = core->getJD();
+	double deltaT = core->getDeltaT() * StelCore::JD_SECOND;
+	double gmtShift = core->getUTCOffset(jday) / 24.0;
+
+	QJsonObject obj;
+	obj.insert("jday",jday);
+	obj.insert("deltaT",deltaT);
+	obj.insert("gmtShift",gmtShift);
+	obj.insert("timeZone",localeMgr->getPrintableTimeZoneLocal(jday));
+	obj.insert("utc",StelUtils::julianDayToISO8601String(jday,true).append('Z'));
+	obj.insert("local",StelUtils::julianDayToISO8601String(jday+gmtShift,true));
+	obj.insert("isTimeNow",core->getIsTimeNow());
+	obj.insert("timerate",core->getTimeRate());
+	return obj;
+}
+
+QJsonObject StreamController::getView() const
+{
+	// the aim fov may lie outside the min/max bounds, so constrain it
+	double fov = mvmgr->getAimFov();
+	if(fov < mvmgr->getMinFov())
+		fov = mvmgr->getMinFov();
+	else if (fov>mvmgr->getMaxFov())
+		fov = mvmgr->getMaxFov();
+
+	QJsonObject obj;
+	obj.insert("fov",fov);
+	return obj;
+}
+
+QString StreamController::getInfoString() const
+{
+	const QList<StelObjectP>& list = objMgr->getSelectedObject();
+	if(list.isEmpty())
+		return QString();
+	return list.first()->getInfoString(core,StelObject::AllInfo | StelObject::NoFont);
+}
+
+QJsonObject StreamController::getState() const
+{
+	QJsonObject obj;
+	obj.insert("location",getLocation());
+	obj.insert("time",getTime());
+	obj.insert("view",getView());
+	obj.insert("selectioninfo",getInfoString());
+
+	QJsonObject actions;
+	foreach(StelAction* ac, actionMgr->getActionList())
+	{
+		if(ac->isCheckable())
+			actions.insert(ac->getId(),ac->isChecked());
+	}
+	obj.insert("actionChanges",actions);
+
+	QJsonObject props;
+	const StelPropertyMgr::StelPropertyMap& map = propMgr->getPropertyMap();
+	for(StelPropertyMgr::StelPropertyMap::const_iterator it = map.constBegin(); it!=map.constEnd();++it)
+	{
+		props.insert(it.key(), QJsonValue::fromVariant((*it)->getValue()));
+	}
+	obj.insert("propertyChanges",props);
+
+	return obj;
+}
+
+void StreamController::service(HttpRequest &request, HttpResponse &response)
+{
+	//clients may ask for fewer events, but not for more
+	bool ok;
+	int interval = QString::fromUtf8(request.getParameter("interval")).toInt(&ok);
+	if(!ok || interval<minInterval)
+		interval = minInterval;
+
+	if(!stream.addClient(maxClients))
+	{
+		response.setStatus(503,"Service Unavailable");
+		response.write("Too many stream clients, use main/status instead",true);
+		return;
+	}
+
+	//an EventSource that reconnects sends the last id it has seen
+	qint64 lastId = request.getHeader("Last-Event-ID").toLongLong(&ok);
+	if(!ok)
+		lastId = -1;
+
+	response.setHeader("Content-Type","text/event-stream; charset=utf-8");
+	response.setHeader("Cache-Control","no-cache");
+	//reconnection delay for the EventSource, in ms
+	response.write("retry: 2000\n\n");
+	response.flush();
+
+	QElapsedTimer timer;
+	timer.start();
+	qint64 nextEvent = 0;
+	qint64 lastWrite = 0;
+	while(response.isConnected())
+	{
+		//rate limiting: changes published in the meantime are merged into the next event
+		const qint64 wait = nextEvent - timer.elapsed();
+		if(wait>0)
+			QThread::msleep(wait);
+
+		QByteArray data;
+		if(stream.waitForChanges(lastId,data,KEEPALIVE_INTERVAL))
+		{
+			QByteArray event("id: ");
+			event.append(QByteArray::number(lastId));
+			event.append("\ndata: ");
+			event.append(data);
+			event.append("\n\n");
+			response.write(event);
+			nextEvent = timer.elapsed() + interval;
+		}
+		else if(stream.isClosed())
+		{
+			break;
+		}
+		else if(timer.elapsed()-lastWrite>=KEEPALIVE_INTERVAL)
+		{
+			//writing is also the only way to notice that the client went away
+			response.write(": keepalive\n\n");
+		}
+		else
+			continue;
+		response.flush();
+		lastWrite = timer.elapsed();
+	}
+
+	stream.removeClient();
+}
@@ -0,0 +1,112 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef STREAMCONTROLLER_HPP_
+#define STREAMCONTROLLER_HPP_
+
+#include "httpserver/httprequesthandler.h"
+#include "StateStream.hpp"
+
+#include <QJsonObject>
+
+class StelCore;
+class StelAction;
+class StelActionMgr;
+class StelLocaleMgr;
+class StelMovementMgr;
+class StelObjectMgr;
+class StelPropertyMgr;
+
+//! @ingroup remoteControl
+//! Serves the \c /api/stream request, a push-based alternative to polling the \c main/status operation.
+//! The response is an endless <a href="https://www.w3.org/TR/eventsource/">Server-Sent Events</a> stream.
+//! The first event contains the full state, each following event only the parts which changed since the last event.
+//!
+//! All state is collected in the main thread: the controller listens to the StelProperty, StelAction, time and
+//! selection change signals, and once per frame in update() publishes the accumulated changes as one diff to a shared StateStream.
+//! Nothing is done while no client is connected. The HTTP threads only wait on the StateStream and write the
+//! already serialized data, so the cost for the main thread does not depend on the number of clients.
+//!
+//! @see @ref rcStream
+class StreamController : public HttpRequestHandler
+{
+	Q_OBJECT
+public:
+	//! @param minInterval the lowest allowed interval between two events sent to the same client, in ms
+	//! @param maxClients the maximal number of simultaneous stream clients. Each client occupies one HTTP thread.
+	StreamController(int minInterval = 100, int maxClients = 10, QObject* parent = 0);
+	virtual ~StreamController();
+
+	//! Called in the main thread each frame, publishes the changes since the last frame
+	void update();
+
+	//! Runs the event stream for a client until it disconnects or the stream is closed with setEnabled(false).
+	//! The client can request a larger interval between events (in ms) than the default with the \c interval parameter.
+	//! @note This method runs in an HTTP worker thread, and blocks it for the whole lifetime of the stream.
+	virtual void service(HttpRequest& request, HttpResponse& response) Q_DECL_OVERRIDE;
+
+	//! Disabling the controller ends all running streams. This has to happen before the HTTP server is stopped,
+	//! because the server waits for its threads.
+	void setEnabled(bool enabled);
+
+private slots:
+	void actionToggled(const QString& id, bool val);
+	void actionAdded(StelAction* action);
+	void propertyChanged(const QString& id, const QVariant& val);
+	void locationChanged();
+	void timeChanged();
+	void selectionChanged();
+
+private:
+	QJsonObject getLocation() const;
+	QJsonObject getTime() const;
+	QJsonObject getView() const;
+	QString getInfoString() const;
+	//! Builds the full state, used as keyframe
+	QJsonObject getState() const;
+
+	StelCore* core;
+	StelActionMgr* actionMgr;
+	StelLocaleMgr* localeMgr;
+	StelMovementMgr* mvmgr;
+	StelObjectMgr* objMgr;
+	StelPropertyMgr* propMgr;
+
+	StateStream stream;
+	int minInterval;
+	int maxClients;
+	//true while the stream has clients, checked once per frame by update()
+	bool active;
+
+	//changes collected since the last frame
+	QJsonObject actionChanges;
+	QJsonObject propertyChanges;
+	bool locationDirty;
+	bool timeDirty;
+	bool selectionDirty;
+
+	//last published values of things which are polled instead of signalled
+	double lastFov;
+	QString lastInfoString;
+	bool lastIsTimeNow;
+	qint64 lastTimeUpdate;
+	qint64 lastInfoUpdate;
+};
+
+#endif
@@ -198,5 +198,7 @@ void HttpResponse::flush()
 
 bool HttpResponse::isConnected() const
 {
-    return socket->isOpen();
+    // The disconnected() signal is not processed while a long running response blocks the thread,
+    // but the socket state is updated as soon as a write fails.
+    return socket->isOpen() && socket->state()==QAbstractSocket::ConnectedState;
 }
@@ -0,0 +1,135 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "test/testChangeCache.hpp"
+#include "StelPropertyMgr.hpp"
+
+#include <QJsonDocument>
+
+QTEST_GUILESS_MAIN(TestChangeCache)
+
+static QJsonObject parse(const QByteArray& data)
+{
+	return QJsonDocument::fromJson(data).object();
+}
+
+PropertyChangeReceiver::PropertyChangeReceiver(StelPropertyMgr *propMgr)
+{
+	connect(propMgr,SIGNAL(stelPropChanged(QString,QVariant)),this,SLOT(propertyChanged(QString,QVariant)));
+	connect(propMgr,SIGNAL(stelPropRegistered(QString,QVariant)),this,SLOT(propertyChanged(QString,QVariant)));
+
+	//same as MainService::rebuildFullState
+	QJsonObject props;
+	const StelPropertyMgr::StelPropertyMap& map = propMgr->getPropertyMap();
+	for(StelPropertyMgr::StelPropertyMap::const_iterator it = map.constBegin(); it!=map.constEnd();++it)
+		props.insert(it.key(), QJsonValue::fromVariant((*it)->getValue()));
+	cache.setState(props);
+}
+
+void PropertyChangeReceiver::propertyChanged(const QString &id, const QVariant &val)
+{
+	cache.change(id,QJsonValue::fromVariant(val));
+}
+
+void TestChangeCache::testDiffs()
+{
+	ChangeCache cache(4);
+	bool fullState;
+	cache.setState(parse("{\"a\":1,\"b\":1}"));
+
+	//nothing changed yet, a client with the initial state is up to date
+	QJsonObject obj = cache.getChangesSinceID(-1,fullState);
+	QVERIFY(!fullState);
+	QVERIFY(obj.value("changes").toObject().isEmpty());
+	QCOMPARE(obj.value("id").toInt(),-1);
+
+	cache.change("a",2);
+	cache.change("b",3);
+	cache.change("a",4);
+	obj = cache.getChangesSinceID(-1,fullState);
+	QVERIFY(!fullState);
+	QCOMPARE(obj.value("changes").toObject(),parse("{\"a\":4,\"b\":3}"));
+	const int id = obj.value("id").toInt();
+
+	obj = cache.getChangesSinceID(id,fullState);
+	QVERIFY(!fullState);
+	QVERIFY(obj.value("changes").toObject().isEmpty());
+	QCOMPARE(obj.value("id").toInt(),id);
+
+	cache.change("b",5);
+	obj = cache.getChangesSinceID(id,fullState);
+	QCOMPARE(obj.value("changes").toObject(),parse("{\"b\":5}"));
+	QCOMPARE(obj.value("id").toInt(),id+1);
+}
+
+void TestChangeCache::testFullReload()
+{
+	ChangeCache cache(4);
+	bool fullState;
+	cache.setState(parse("{\"a\":1}"));
+
+	//a starting client gets the full state
+	QJsonObject obj = cache.getChangesSinceID(-2,fullState);
+	QVERIFY(fullState);
+	QCOMPARE(obj.value("changes").toObject(),parse("{\"a\":1}"));
+	QCOMPARE(obj.value("id").toInt(),-1);
+
+	//a client which fell out of the history too
+	for(int i=0;i<10;++i)
+		cache.change("a",i);
+	obj = cache.getChangesSinceID(0,fullState);
+	QVERIFY(fullState);
+	QCOMPARE(obj.value("changes").toObject(),parse("{\"a\":9}"));
+	QCOMPARE(obj.value("id").toInt(),9);
+
+	//as does a client with an id from before a restart
+	obj = cache.getChangesSinceID(100,fullState);
+	QVERIFY(fullState);
+	QCOMPARE(obj.value("id").toInt(),9);
+}
+
+void TestChangeCache::testLateRegistration()
+{
+	StelPropertyMgr propMgr;
+	PropertyChangeReceiver receiver(&propMgr);
+	bool fullState;
+
+	//a client that already has the (empty) state
+	QJsonObject obj = receiver.cache.getChangesSinceID(-2,fullState);
+	QVERIFY(obj.value("changes").toObject().isEmpty());
+	const int id = obj.value("id").toInt();
+
+	LateModule module;
+	propMgr.registerObject(&module);
+
+	//the first full reload of a new client already contains the new property
+	obj = receiver.cache.getChangesSinceID(-2,fullState);
+	QVERIFY(fullState);
+	QCOMPARE(obj.value("changes").toObject().value("LateModule.value").toInt(),42);
+
+	//the existing client gets it as a change
+	obj = receiver.cache.getChangesSinceID(id,fullState);
+	QVERIFY(!fullState);
+	QCOMPARE(obj.value("changes").toObject(),parse("{\"LateModule.value\":42}"));
+
+	//and changes of the new property are tracked
+	module.setValue(7);
+	obj = receiver.cache.getChangesSinceID(-2,fullState);
+	QCOMPARE(obj.value("changes").toObject().value("LateModule.value").toInt(),7);
+}
@@ -0,0 +1,66 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TESTCHANGECACHE_HPP_
+#define _TESTCHANGECACHE_HPP_
+
+#include <QObject>
+#include <QtTest>
+
+#include "ChangeCache.hpp"
+
+class StelPropertyMgr;
+
+//! Stands in for a module which registers its properties late, like a plugin initialized after RemoteControl
+class LateModule : public QObject
+{
+	Q_OBJECT
+	Q_PROPERTY(int value READ getValue WRITE setValue NOTIFY valueChanged)
+public:
+	LateModule() : value(42) { setObjectName("LateModule"); }
+	int getValue() const { return value; }
+public slots:
+	void setValue(int val) { if(val!=value) { value = val; emit valueChanged(val); } }
+signals:
+	void valueChanged(int val);
+private:
+	int value;
+};
+
+//! Keeps a ChangeCache up to date with the StelProperties, wired up the same way as in MainService
+class PropertyChangeReceiver : public QObject
+{
+	Q_OBJECT
+public:
+	PropertyChangeReceiver(StelPropertyMgr* propMgr);
+	ChangeCache cache;
+private slots:
+	void propertyChanged(const QString& id, const QVariant& val);
+};
+
+class TestChangeCache : public QObject
+{
+	Q_OBJECT
+private slots:
+	void testDiffs();
+	void testFullReload();
+	void testLateRegistration();
+};
+
+#endif // _TESTCHANGECACHE_HPP_
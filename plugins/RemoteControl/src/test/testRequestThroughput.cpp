@@ -0,0 +1,236 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "test/testRequestThroughput.hpp"
+#include "APIController.hpp"
+#include "httpserver/httplistener.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+
+QTEST_GUILESS_MAIN(TestRequestThroughput)
+
+//length of one simulated frame, and how much of it the main thread is busy (in ms)
+#define FRAME_INTERVAL 50
+#define FRAME_WORK 30
+//how long the clients send requests (in ms)
+#define TEST_DURATION 2000
+
+//! Answers each request with "ok". Unless it is threaded, it checks that it really runs in the main thread.
+class DummyService : public AbstractAPIService
+{
+public:
+	DummyService(const QByteArray& name, bool threaded, QObject* parent = 0)
+		: AbstractAPIService(name,parent), threaded(threaded), wrongThread(0)
+	{
+	}
+
+	bool supportsThreadedOperation() const Q_DECL_OVERRIDE { return threaded; }
+
+	bool threaded;
+	QAtomicInt wrongThread;
+
+protected:
+	void getImpl(const QByteArray& operation, const APIParameters& parameters, APIServiceResponse& response) Q_DECL_OVERRIDE
+	{
+		Q_UNUSED(operation);
+		Q_UNUSED(parameters);
+		if(!threaded && QThread::currentThread()!=QCoreApplication::instance()->thread())
+			wrongThread.fetchAndAddRelaxed(1);
+		response.setData("ok");
+	}
+	void postImpl(const QByteArray& operation, const APIParameters& parameters, const QByteArray& data, APIServiceResponse& response) Q_DECL_OVERRIDE
+	{
+		Q_UNUSED(data);
+		getImpl(operation,parameters,response);
+	}
+};
+
+//! Sends requests over one keep-alive connection, one after another, until stopped
+class HttpClient : public QThread
+{
+public:
+	HttpClient(quint16 port, const QByteArray& request, QAtomicInt* stop)
+		: port(port), request(request), stop(stop), requests(0), failed(false)
+	{
+	}
+
+	quint16 port;
+	QByteArray request;
+	QAtomicInt* stop;
+	int requests;
+	bool failed;
+
+protected:
+	void run()
+	{
+		QTcpSocket socket;
+		socket.connectToHost(QHostAddress::LocalHost,port);
+		if(!socket.waitForConnected(5000))
+		{
+			failed = true;
+			return;
+		}
+		do
+		{
+			socket.write(request);
+			if(!readResponse(socket))
+			{
+				failed = true;
+				return;
+			}
+			++requests;
+		} while(!stop->load());
+	}
+
+private:
+	//! Reads one response with a Content-Length header, returns false on errors or if the body is not "ok"
+	bool readResponse(QTcpSocket& socket)
+	{
+		QByteArray buf;
+		int headerEnd;
+		while((headerEnd = buf.indexOf("\r\n\r\n"))<0)
+		{
+			if(!socket.waitForReadyRead(5000))
+				return false;
+			buf.append(socket.readAll());
+		}
+		int lengthIdx = buf.indexOf("Content-Length:");
+		if(lengthIdx<0 || lengthIdx>headerEnd)
+			return false;
+		int length = buf.mid(lengthIdx+15, buf.indexOf("\r\n",lengthIdx)-lengthIdx-15).trimmed().toInt();
+		while(buf.size() < headerEnd+4+length)
+		{
+			if(!socket.waitForReadyRead(5000))
+				return false;
+			buf.append(socket.readAll());
+		}
+		return buf.mid(headerEnd+4,length)=="ok";
+	}
+};
+
+void TestRequestThroughput::testThroughput_data()
+{
+	QTest::addColumn<int>("clients");
+	QTest::addColumn<bool>("threaded");
+	QTest::addColumn<bool>("post");
+	QTest::newRow("1 client, main thread GET") << 1 << false << false;
+	QTest::newRow("8 clients, main thread GET") << 8 << false << false;
+	QTest::newRow("8 clients, main thread POST") << 8 << false << true;
+	QTest::newRow("8 clients, threaded GET") << 8 << true << false;
+}
+
+void TestRequestThroughput::testThroughput()
+{
+	QFETCH(int, clients);
+	QFETCH(bool, threaded);
+	QFETCH(bool, post);
+
+	APIController controller(QByteArray("/api/").size());
+	DummyService* service = new DummyService("dummy",threaded,&controller);
+	controller.registerService(service);
+
+	HttpListenerSettings settings;
+	settings.host = "127.0.0.1";
+	settings.port = 0;
+	settings.minThreads = clients;
+	settings.maxThreads = clients+2;
+	HttpListener listener(settings,&controller);
+	QVERIFY(listener.isListening());
+
+	//the main thread renders a frame each FRAME_INTERVAL, and is blocked most of the time
+	int frames = 0;
+	QTimer frameTimer;
+	connect(&frameTimer,&QTimer::timeout,[&]()
+	{
+		QThread::msleep(FRAME_WORK);
+		controller.update(FRAME_INTERVAL/1000.);
+		++frames;
+	});
+	frameTimer.start(FRAME_INTERVAL);
+
+	QByteArray request = post ? "POST /api/dummy/op HTTP/1.1\r\nHost: localhost\r\nContent-Length: 3\r\n\r\nx=1"
+				  : "GET /api/dummy/op HTTP/1.1\r\nHost: localhost\r\n\r\n";
+	QAtomicInt stop(0);
+	QList<HttpClient*> list;
+	for(int i=0;i<clients;++i)
+	{
+		list.append(new HttpClient(listener.serverPort(),request,&stop));
+		list.last()->start();
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	QEventLoop loop;
+	QTimer::singleShot(TEST_DURATION,&loop,SLOT(quit()));
+	loop.exec();
+	stop.fetchAndStoreRelaxed(1);
+
+	//the clients may wait for one last answer from the main thread
+	foreach(HttpClient* client, list)
+	{
+		while(!client->isFinished())
+			QCoreApplication::processEvents(QEventLoop::AllEvents,10);
+	}
+	const qint64 elapsed = timer.elapsed();
+	frameTimer.stop();
+
+	int requests = 0;
+	foreach(HttpClient* client, list)
+	{
+		QVERIFY(!client->failed);
+		requests += client->requests;
+	}
+	qDeleteAll(list);
+	QCOMPARE(service->wrongThread.load(),0);
+
+	qDebug()<<requests<<"requests in"<<elapsed<<"ms,"<<frames<<"frames:"
+		<<requests*1000./elapsed<<"requests/s,"<<double(requests)/frames<<"requests/frame";
+	//the requests of all clients are processed in one batch, so each client gets
+	//at least one answer per frame no matter how busy the main thread is
+	QVERIFY(requests >= frames*clients/2);
+}
+
+void TestRequestThroughput::testShutdown()
+{
+	APIController controller(QByteArray("/api/").size());
+	controller.registerService(new DummyService("dummy",false,&controller));
+
+	HttpListenerSettings settings;
+	settings.host = "127.0.0.1";
+	settings.port = 0;
+	HttpListener* listener = new HttpListener(settings,&controller);
+
+	//a single request, nobody processes the main thread queue while the client waits for it
+	QAtomicInt stop(1);
+	HttpClient client(listener->serverPort(),"GET /api/dummy/op HTTP/1.1\r\nHost: localhost\r\n\r\n",&stop);
+	client.start();
+	QThread::msleep(200);
+
+	//disabling answers the waiting request, so the listener can be deleted without deadlock
+	controller.setEnabled(false);
+	delete listener;
+	QVERIFY(client.wait(5000));
+	//it got an error response
+	QVERIFY(client.failed);
+	QCOMPARE(client.requests,0);
+}
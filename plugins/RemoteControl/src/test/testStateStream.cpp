@@ -0,0 +1,245 @@
+/*
+ * Stellarium Remote Control plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "test/testStateStream.hpp"
+#include "StateStream.hpp"
+
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QThread>
+
+QTEST_GUILESS_MAIN(TestStateStream)
+
+static QJsonObject parse(const QByteArray& data)
+{
+	return QJsonDocument::fromJson(data).object();
+}
+
+//! Does the same as StreamController::service, but merges the events into a local state instead of writing them to a socket
+class StreamClient : public QThread
+{
+public:
+	StreamClient(StateStream* stream, int interval) : stream(stream), interval(interval), events(0), elapsed(0) {}
+
+	StateStream* stream;
+	int interval;
+	QJsonObject state;
+	int events;
+	qint64 elapsed;
+
+protected:
+	void run()
+	{
+		QElapsedTimer timer;
+		timer.start();
+		qint64 lastId = -1;
+		qint64 nextEvent = 0;
+		while(!stream->isClosed())
+		{
+			const qint64 wait = nextEvent - timer.elapsed();
+			if(wait>0)
+				QThread::msleep(wait);
+			QByteArray data;
+			if(stream->waitForChanges(lastId,data,50))
+			{
+				StateStream::merge(state,parse(data));
+				++events;
+				nextEvent = timer.elapsed() + interval;
+			}
+		}
+		elapsed = timer.elapsed();
+	}
+};
+
+void TestStateStream::testMerge()
+{
+	QJsonObject target = parse("{\"a\":1,\"obj\":{\"x\":1,\"y\":2},\"s\":\"str\"}");
+	StateStream::merge(target,parse("{\"a\":2,\"obj\":{\"y\":3,\"z\":4},\"new\":true}"));
+	QCOMPARE(target,parse("{\"a\":2,\"obj\":{\"x\":1,\"y\":3,\"z\":4},\"s\":\"str\",\"new\":true}"));
+
+	//non-object values replace objects and vice versa
+	StateStream::merge(target,parse("{\"obj\":5,\"s\":{\"k\":1}}"));
+	QCOMPARE(target.value("obj").toInt(),5);
+	QCOMPARE(target.value("s").toObject(),parse("{\"k\":1}"));
+}
+
+void TestStateStream::testDiffs()
+{
+	StateStream stream;
+	QByteArray data;
+	qint64 id = -1;
+
+	//without state, nothing is returned and publishing is ignored
+	stream.publish(parse("{\"a\":1}"));
+	QVERIFY(!stream.waitForChanges(id,data,0));
+
+	stream.reset(parse("{\"a\":1,\"props\":{\"p\":1,\"q\":1}}"));
+	QVERIFY(stream.waitForChanges(id,data,0));
+	QCOMPARE(parse(data),parse("{\"a\":1,\"props\":{\"p\":1,\"q\":1}}"));
+	//up to date, nothing new
+	QVERIFY(!stream.waitForChanges(id,data,0));
+
+	//empty diffs don't produce events
+	stream.publish(QJsonObject());
+	QVERIFY(!stream.waitForChanges(id,data,0));
+
+	stream.publish(parse("{\"props\":{\"p\":2}}"));
+	QVERIFY(stream.waitForChanges(id,data,0));
+	QCOMPARE(parse(data),parse("{\"props\":{\"p\":2}}"));
+
+	//a client which missed several diffs gets them merged
+	const qint64 oldId = id;
+	stream.publish(parse("{\"props\":{\"p\":3}}"));
+	stream.publish(parse("{\"props\":{\"q\":3}}"));
+	stream.publish(parse("{\"a\":4}"));
+	QVERIFY(stream.waitForChanges(id,data,0));
+	QCOMPARE(parse(data),parse("{\"a\":4,\"props\":{\"p\":3,\"q\":3}}"));
+	QCOMPARE(id,oldId+3);
+}
+
+void TestStateStream::testKeyframes()
+{
+	StateStream stream(4);
+	QByteArray data;
+	stream.reset(parse("{\"a\":0}"));
+	qint64 lagging = -1;
+	QVERIFY(stream.waitForChanges(lagging,data,0));
+
+	for(int i=1;i<=10;++i)
+		stream.publish(parse(QString("{\"a\":%1,\"b%1\":true}").arg(i).toUtf8()));
+
+	//the history only has the last 4 diffs, so a keyframe with the full state is sent
+	QVERIFY(stream.waitForChanges(lagging,data,0));
+	QJsonObject obj = parse(data);
+	QCOMPARE(obj.value("a").toInt(),10);
+	QCOMPARE(obj.size(),11);
+
+	//an unknown id (e.g. from before a restart) also gets a keyframe
+	qint64 unknown = lagging + 100;
+	QVERIFY(stream.waitForChanges(unknown,data,0));
+	QCOMPARE(parse(data),obj);
+	QCOMPARE(unknown,lagging);
+
+	//a reset forces a keyframe for everyone
+	stream.reset(parse("{\"c\":1}"));
+	QVERIFY(stream.waitForChanges(lagging,data,0));
+	QCOMPARE(parse(data),parse("{\"c\":1}"));
+}
+
+void TestStateStream::testClose()
+{
+	StateStream stream;
+	QVERIFY(stream.addClient(1));
+	QVERIFY(!stream.addClient(1));
+	QCOMPARE(stream.clientCount(),1);
+
+	StreamClient client(&stream,0);
+	client.start();
+	QThread::msleep(20);
+	QVERIFY(client.isRunning());
+	stream.close();
+	QVERIFY(client.wait(1000));
+	QVERIFY(!stream.addClient(10));
+
+	stream.removeClient();
+	stream.open();
+	QVERIFY(!stream.hasState());
+	QVERIFY(stream.addClient(10));
+	stream.removeClient();
+}
+
+void TestStateStream::testLoad_data()
+{
+	QTest::addColumn<int>("clients");
+	QTest::newRow("1 client") << 1;
+	QTest::newRow("10 clients") << 10;
+	QTest::newRow("100 clients") << 100;
+}
+
+void TestStateStream::testLoad()
+{
+	QFETCH(int, clients);
+	const int frames = 300;
+	const int frameTime = 2;
+	const int interval = 20;
+
+	StateStream stream;
+	QJsonObject props;
+	for(int i=0;i<200;++i)
+		props.insert(QString("Module.prop%1").arg(i),i);
+	QJsonObject initial;
+	initial.insert("propertyChanges",props);
+	stream.reset(initial);
+
+	QList<StreamClient*> list;
+	for(int i=0;i<clients;++i)
+	{
+		list.append(new StreamClient(&stream,interval));
+		list.last()->start();
+	}
+
+	//the "main thread": a few properties change each frame
+	qint64 publishTime = 0;
+	QElapsedTimer timer;
+	for(int f=0;f<frames;++f)
+	{
+		QJsonObject changes;
+		changes.insert(QString("Module.prop%1").arg(f%200),f);
+		changes.insert(QString("Module.prop%1").arg((f*7)%200),-f);
+		QJsonObject diff;
+		diff.insert("propertyChanges",changes);
+		diff.insert("frame",f);
+
+		timer.start();
+		stream.publish(diff);
+		publishTime += timer.nsecsElapsed();
+		QThread::msleep(frameTime);
+	}
+	//give the clients time to receive the last changes
+	QThread::msleep(interval*3 + 100);
+	stream.close();
+	foreach(StreamClient* client, list)
+		QVERIFY(client->wait(5000));
+
+	qDebug()<<clients<<"clients: average publish time"<<publishTime/frames/1000.<<"us";
+
+	//recreate the expected final state
+	QJsonObject expected = initial;
+	for(int f=0;f<frames;++f)
+	{
+		QJsonObject changes;
+		changes.insert(QString("Module.prop%1").arg(f%200),f);
+		changes.insert(QString("Module.prop%1").arg((f*7)%200),-f);
+		QJsonObject diff;
+		diff.insert("propertyChanges",changes);
+		diff.insert("frame",f);
+		StateStream::merge(expected,diff);
+	}
+
+	foreach(StreamClient* client, list)
+	{
+		//every client ends up with the same state, no matter how many diffs were merged
+		QCOMPARE(client->state,expected);
+		//and the rate limit was respected
+		QVERIFY(client->events>1);
+		QVERIFY2(client->events <= client->elapsed/interval + 1,
+			 qPrintable(QString("%1 events in %2 ms").arg(client->events).arg(client->elapsed)));
+	}
+	qDeleteAll(list);
+}
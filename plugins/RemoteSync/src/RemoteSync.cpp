@@ -138,7 +138,7 @@ void RemoteSync::startServer()
 {
 	if(state == IDLE)
 	{
-		server = new SyncServer(this);
+		server = new SyncServer(excludedProperties, this);
 		if(server->start(serverPort))
 			setState(SERVER);
 		else
@@ -168,7 +168,7 @@ void RemoteSync::connectToServer()
 {
 	if(state == IDLE)
 	{
-		client = new SyncClient(this);
+		client = new SyncClient(excludedProperties, this);
 		connect(client, SIGNAL(connectionError()), this, SLOT(clientConnectionFailed()));
 		connect(client, SIGNAL(connected()), this, SLOT(clientConnected()));
 		connect(client, SIGNAL(disconnected()), this, SLOT(clientDisconnected()));
@@ -224,6 +224,10 @@ void RemoteSync::loadSettings()
 	setClientServerHost(conf->value("clientServerHost","127.0.0.1").toString());
 	setClientServerPort(conf->value("clientServerPort",20180).toInt());
 	setServerPort(conf->value("serverPort",20180).toInt());
+	//by default, the mirroring and viewport offsets stay local, e.g. for a multi-projector setup
+	QStringList defaultExcludedProperties;
+	defaultExcludedProperties<<"RemoteControl.*"<<"StelCore.flipHorz"<<"StelCore.flipVert"<<"StelMovementMgr.viewportHorizontalOffsetTarget"<<"StelMovementMgr.viewportVerticalOffsetTarget";
+	excludedProperties = conf->value("excludedProperties",defaultExcludedProperties).toStringList();
 	conf->endGroup();
 }
 
@@ -233,6 +237,7 @@ void RemoteSync::saveSettings()
 	conf->setValue("clientServerHost",clientServerHost);
 	conf->setValue("clientServerPort",clientServerPort);
 	conf->setValue("serverPort",serverPort);
+	conf->setValue("excludedProperties",excludedProperties);
 	conf->endGroup();
 }
 
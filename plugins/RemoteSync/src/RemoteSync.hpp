@@ -22,6 +22,7 @@
 
 #include <QFont>
 #include <QKeyEvent>
+#include <QStringList>
 
 #include "StelModule.hpp"
 
@@ -123,6 +124,8 @@ private:
 	int clientServerPort;
 	//the port used in server mode
 	int serverPort;
+	//wildcard patterns of StelProperty IDs which are not synced
+	QStringList excludedProperties;
 	SyncState state;
 
 	SyncServer* server;
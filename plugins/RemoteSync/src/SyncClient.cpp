@@ -29,8 +29,8 @@
 
 using namespace SyncProtocol;
 
-SyncClient::SyncClient(QObject *parent)
-	: QObject(parent), isConnecting(false), server(NULL), timeoutTimerId(-1)
+SyncClient::SyncClient(const QStringList &excludedProperties, QObject *parent)
+	: QObject(parent), isConnecting(false), server(NULL), timeoutTimerId(-1), excludedProperties(excludedProperties)
 {
 }
 
@@ -56,6 +56,8 @@ void SyncClient::connectToServer(const QString &host, const int port)
 	handlerList[TIME] = new ClientTimeHandler();
 	handlerList[LOCATION] = new ClientLocationHandler();
 	handlerList[SELECTION] = new ClientSelectionHandler();
+	handlerList[VIEW] = new ClientViewHandler();
+	handlerList[STELPROPERTY] = new ClientStelPropertyHandler(excludedProperties);
 
 	server = new SyncRemotePeer(new QTcpSocket(this), true, handlerList );
 	connect(server->sock, SIGNAL(connected()), this, SLOT(socketConnected()));
@@ -21,6 +21,7 @@
 #define SYNCCLIENT_HPP_
 
 #include <QObject>
+#include <QStringList>
 #include <QTcpSocket>
 
 class SyncMessageHandler;
@@ -31,7 +32,8 @@ class SyncClient : public QObject
 {
 	Q_OBJECT
 public:
-	SyncClient(QObject* parent = 0);
+	//! @param excludedProperties wildcard patterns of StelProperty IDs which should not be changed by the server
+	SyncClient(const QStringList& excludedProperties, QObject* parent = 0);
 	virtual ~SyncClient();
 
 	//! True if the connection has been established completely
@@ -63,6 +65,7 @@ private:
 	SyncRemotePeer* server;
 	int timeoutTimerId;
 	QVector<SyncMessageHandler*> handlerList;
+	QStringList excludedProperties;
 
 	friend class ClientErrorHandler;
 };
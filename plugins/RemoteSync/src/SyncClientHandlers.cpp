@@ -26,6 +26,9 @@
 #include "StelTranslator.hpp"
 #include "StelObserver.hpp"
 #include "StelObjectMgr.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelPropertyMgr.hpp"
 
 using namespace SyncProtocol;
 
@@ -241,3 +244,54 @@ bool ClientSelectionHandler::handleMessage(QDataStream &stream, SyncRemotePeer &
 
 	return true;
 }
+
+ClientViewHandler::ClientViewHandler()
+{
+	mvMgr = GETSTELMODULE(StelMovementMgr);
+}
+
+bool ClientViewHandler::handleMessage(QDataStream &stream, SyncRemotePeer &peer)
+{
+	View msg;
+	bool ok = msg.deserialize(stream, peer.msgHeader.dataSize);
+
+	if(!ok)
+		return false;
+
+	mvMgr->setViewDirectionJ2000(msg.viewDirectionJ2000);
+	mvMgr->setFov(msg.fov);
+
+	return true;
+}
+
+ClientStelPropertyHandler::ClientStelPropertyHandler(const QStringList &excludedProperties)
+{
+	propMgr = StelApp::getInstance().getStelPropertyManager();
+	decoder.setExcludedProperties(excludedProperties);
+}
+
+bool ClientStelPropertyHandler::handleMessage(QDataStream &stream, SyncRemotePeer &peer)
+{
+	StelPropertyUpdate msg;
+	bool ok = msg.deserialize(stream, peer.msgHeader.dataSize);
+
+	if(!ok)
+		return false;
+
+	bool isKeyframe;
+	values.clear();
+	if(!decoder.decode(msg.payload,values,isKeyframe))
+		return false;
+
+	for(SyncPropertyDecoder::tValueList::const_iterator it = values.constBegin(); it!=values.constEnd(); ++it)
+	{
+		//keyframes repeat the full state, only touch the properties which actually differ
+		if(isKeyframe && SyncPropertyCodec::encode(propMgr->getStelPropertyValue(it->first)) == SyncPropertyCodec::encode(it->second))
+			continue;
+
+		//this fails if the property does not exist here, e.g. because a plugin is not loaded, which is not an error
+		propMgr->setStelPropertyValue(it->first,it->second);
+	}
+
+	return true;
+}
@@ -21,6 +21,7 @@
 #define SYNCCLIENTHANDLERS_HPP_
 
 #include "SyncProtocol.hpp"
+#include "SyncPropertyCodec.hpp"
 
 class SyncClient;
 class StelCore;
@@ -86,4 +87,29 @@ private:
 	StelObjectMgr* objMgr;
 };
 
+class StelMovementMgr;
+
+class ClientViewHandler : public ClientHandler
+{
+public:
+	ClientViewHandler();
+	bool handleMessage(QDataStream &stream, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
+private:
+	StelMovementMgr* mvMgr;
+};
+
+class StelPropertyMgr;
+
+class ClientStelPropertyHandler : public ClientHandler
+{
+public:
+	//! @param excludedProperties wildcard patterns of property IDs which are not changed by the server
+	ClientStelPropertyHandler(const QStringList& excludedProperties);
+	bool handleMessage(QDataStream &stream, SyncRemotePeer &peer) Q_DECL_OVERRIDE;
+private:
+	StelPropertyMgr* propMgr;
+	SyncPropertyDecoder decoder;
+	SyncPropertyDecoder::tValueList values;
+};
+
 #endif
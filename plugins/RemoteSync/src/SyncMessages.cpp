@@ -169,3 +169,41 @@ bool Selection::deserialize(QDataStream &stream, tPayloadSize dataSize)
 	stream>>selectedObjectNames;
 	return !stream.status();
 }
+
+View::View()
+	: fov(0.0)
+{
+
+}
+
+void View::serialize(QDataStream &stream) const
+{
+	stream<<viewDirectionJ2000[0];
+	stream<<viewDirectionJ2000[1];
+	stream<<viewDirectionJ2000[2];
+	stream<<fov;
+}
+
+bool View::deserialize(QDataStream &stream, tPayloadSize dataSize)
+{
+	if(dataSize != 32)
+		return false;
+
+	stream>>viewDirectionJ2000[0];
+	stream>>viewDirectionJ2000[1];
+	stream>>viewDirectionJ2000[2];
+	stream>>fov;
+	return !stream.status();
+}
+
+void StelPropertyUpdate::serialize(QDataStream &stream) const
+{
+	//the payload is already encoded, write it without length prefix
+	stream.writeRawData(payload.constData(),payload.size());
+}
+
+bool StelPropertyUpdate::deserialize(QDataStream &stream, tPayloadSize dataSize)
+{
+	payload.resize(dataSize);
+	return stream.readRawData(payload.data(),dataSize) == dataSize;
+}
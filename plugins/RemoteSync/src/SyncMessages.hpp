@@ -22,6 +22,7 @@
 
 #include "SyncProtocol.hpp"
 #include "StelLocation.hpp"
+#include "VecMath.hpp"
 
 class ErrorMessage : public SyncMessage
 {
@@ -117,6 +118,35 @@ public:
 	QList<QString> selectedObjectNames;
 };
 
+class View : public SyncMessage
+{
+public:
+	View();
+
+	SyncProtocol::SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::VIEW; }
+
+	void serialize(QDataStream &stream) const Q_DECL_OVERRIDE;
+	bool deserialize(QDataStream &stream, SyncProtocol::tPayloadSize dataSize) Q_DECL_OVERRIDE;
+
+	Vec3d viewDirectionJ2000; //corresponds to StelMovementMgr::getViewDirectionJ2000
+	double fov;
+};
+
+//! Carries a payload created by SyncPropertyEncoder, the message itself does not interpret the data.
+class StelPropertyUpdate : public SyncMessage
+{
+public:
+	StelPropertyUpdate() {}
+	StelPropertyUpdate(const QByteArray& payload) : payload(payload) {}
+
+	SyncProtocol::SyncMessageType getMessageType() const Q_DECL_OVERRIDE { return SyncProtocol::STELPROPERTY; }
+
+	void serialize(QDataStream &stream) const Q_DECL_OVERRIDE;
+	bool deserialize(QDataStream &stream, SyncProtocol::tPayloadSize dataSize) Q_DECL_OVERRIDE;
+
+	QByteArray payload;
+};
+
 class Alive : public SyncMessage
 {
 public:
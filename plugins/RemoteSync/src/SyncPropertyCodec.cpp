@@ -0,0 +1,430 @@
+/*
+ * Stellarium Remote Sync plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "SyncPropertyCodec.hpp"
+#include "SyncProtocol.hpp"
+#include "VecMath.hpp"
+
+#include <QDebug>
+#include <cstring>
+
+using namespace SyncPropertyCodec;
+
+//QDataStream writes floats with 8 bytes unless the precision of the whole stream is changed,
+//so floats are written as their bit pattern
+static void writeFloat(QDataStream& stream, float f)
+{
+	quint32 bits;
+	std::memcpy(&bits,&f,sizeof(bits));
+	stream<<bits;
+}
+
+static float readFloat(QDataStream& stream)
+{
+	quint32 bits = 0;
+	stream>>bits;
+	float f;
+	std::memcpy(&f,&bits,sizeof(f));
+	return f;
+}
+
+namespace SyncPropertyCodec
+{
+
+bool writeValue(QDataStream &stream, const QVariant &value)
+{
+	const int type = value.userType();
+	switch (type)
+	{
+		case QMetaType::Bool:
+			stream<<quint8(value.toBool() ? BOOL_TRUE : BOOL_FALSE);
+			return true;
+		case QMetaType::Int:
+		case QMetaType::Short:
+		case QMetaType::UShort:
+		case QMetaType::SChar:
+		case QMetaType::UChar:
+		{
+			const int i = value.toInt();
+			if(i>=-128 && i<=127)
+				stream<<quint8(INT8)<<qint8(i);
+			else
+				stream<<quint8(INT32)<<qint32(i);
+			return true;
+		}
+		case QMetaType::UInt:
+		case QMetaType::Long:
+		case QMetaType::LongLong:
+			stream<<quint8(INT64)<<qint64(value.toLongLong());
+			return true;
+		case QMetaType::Float:
+			stream<<quint8(FLOAT);
+			writeFloat(stream,value.toFloat());
+			return true;
+		case QMetaType::Double:
+		{
+			//many double properties hold values like 0.5 or 1.0, which need only 4 bytes
+			const double d = value.toDouble();
+			const float f = static_cast<float>(d);
+			if(static_cast<double>(f) == d)
+			{
+				stream<<quint8(FLOAT);
+				writeFloat(stream,f);
+			}
+			else
+				stream<<quint8(DOUBLE)<<d;
+			return true;
+		}
+		case QMetaType::QString:
+			stream<<quint8(STRING)<<value.toString().toUtf8();
+			return true;
+		default:
+			break;
+	}
+
+	if(type == qMetaTypeId<Vec3f>())
+	{
+		const Vec3f v = value.value<Vec3f>();
+		stream<<quint8(VEC3F);
+		writeFloat(stream,v[0]);
+		writeFloat(stream,v[1]);
+		writeFloat(stream,v[2]);
+		return true;
+	}
+	if(type == qMetaTypeId<Vec3d>())
+	{
+		const Vec3d v = value.value<Vec3d>();
+		stream<<quint8(VEC3D)<<v[0]<<v[1]<<v[2];
+		return true;
+	}
+	if(QMetaType::typeFlags(type) & QMetaType::IsEnumeration)
+	{
+		//enum properties accept their integer value when written
+		bool ok;
+		const int i = value.toInt(&ok);
+		return ok && writeValue(stream,QVariant(i));
+	}
+	if(type != QMetaType::UnknownType && type < QMetaType::User)
+	{
+		//all built-in types can be streamed, just not as compact as the cases above
+		stream<<quint8(VARIANT)<<value;
+		return true;
+	}
+	return false;
+}
+
+bool readValue(QDataStream &stream, quint8 type, QVariant &value)
+{
+	switch (type)
+	{
+		case BOOL_FALSE:
+			value = false;
+			break;
+		case BOOL_TRUE:
+			value = true;
+			break;
+		case INT8:
+		{
+			qint8 i;
+			stream>>i;
+			value = int(i);
+			break;
+		}
+		case INT32:
+		{
+			qint32 i;
+			stream>>i;
+			value = int(i);
+			break;
+		}
+		case INT64:
+		{
+			qint64 i;
+			stream>>i;
+			value = qlonglong(i);
+			break;
+		}
+		case FLOAT:
+			//decoded as double, which can also be written to float properties
+			value = static_cast<double>(readFloat(stream));
+			break;
+		case DOUBLE:
+		{
+			double d;
+			stream>>d;
+			value = d;
+			break;
+		}
+		case STRING:
+		{
+			QByteArray str;
+			stream>>str;
+			value = QString::fromUtf8(str);
+			break;
+		}
+		case VEC3F:
+		{
+			Vec3f v;
+			v[0] = readFloat(stream);
+			v[1] = readFloat(stream);
+			v[2] = readFloat(stream);
+			value = QVariant::fromValue(v);
+			break;
+		}
+		case VEC3D:
+		{
+			Vec3d v;
+			stream>>v[0]>>v[1]>>v[2];
+			value = QVariant::fromValue(v);
+			break;
+		}
+		case VARIANT:
+			stream>>value;
+			break;
+		default:
+			return false;
+	}
+	return stream.status() == QDataStream::Ok;
+}
+
+QByteArray encode(const QVariant &value)
+{
+	QByteArray data;
+	QDataStream stream(&data,QIODevice::WriteOnly);
+	stream.setVersion(SyncProtocol::SYNC_DATASTREAM_VERSION);
+	if(!writeValue(stream,value))
+		return QByteArray();
+	return data;
+}
+
+void Filter::setPatterns(const QStringList &patterns)
+{
+	this->patterns.clear();
+	foreach(const QString& pattern, patterns)
+	{
+		this->patterns.append(QRegExp(pattern,Qt::CaseSensitive,QRegExp::Wildcard));
+	}
+}
+
+bool Filter::isExcluded(const QString &id) const
+{
+	foreach(const QRegExp& exp, patterns)
+	{
+		if(exp.exactMatch(id))
+			return true;
+	}
+	return false;
+}
+
+}
+
+SyncPropertyEncoder::SyncPropertyEncoder(int maxPayloadSize)
+	: maxPayloadSize(maxPayloadSize)
+{
+}
+
+void SyncPropertyEncoder::setExcludedProperties(const QStringList &patterns)
+{
+	filter.setPatterns(patterns);
+	ignored.clear();
+}
+
+void SyncPropertyEncoder::setValue(const QString &id, const QVariant &value)
+{
+	quint16 num;
+	QHash<QString,quint16>::const_iterator it = numbers.constFind(id);
+	if(it != numbers.constEnd())
+		num = it.value();
+	else
+	{
+		//first change of this property, decide once if it should be synced
+		if(ignored.contains(id))
+			return;
+		if(filter.isExcluded(id) || encode(value).isEmpty())
+		{
+			ignored.insert(id);
+			return;
+		}
+		if(properties.size() > 0xFFFF)
+		{
+			qWarning()<<"[SyncPropertyEncoder] Too many properties, ignoring"<<id;
+			ignored.insert(id);
+			return;
+		}
+
+		num = static_cast<quint16>(properties.size());
+		Property prop;
+		prop.id = id;
+		prop.announced = false;
+		prop.dirty = false;
+		properties.append(prop);
+		numbers.insert(id,num);
+	}
+
+	Property& prop = properties[num];
+	prop.value = value;
+	if(!prop.dirty)
+	{
+		prop.dirty = true;
+		dirty.append(num);
+	}
+}
+
+void SyncPropertyEncoder::markSynchronized()
+{
+	for(QVector<Property>::iterator it = properties.begin(); it!=properties.end(); ++it)
+	{
+		it->sent = encode(it->value);
+		it->announced = true;
+		it->dirty = false;
+	}
+	dirty.clear();
+}
+
+void SyncPropertyEncoder::encodeChanges(QList<QByteArray> &payloads)
+{
+	QList<QByteArray> result;
+	foreach(quint16 num, dirty)
+	{
+		Property& prop = properties[num];
+		prop.dirty = false;
+
+		const QByteArray value = encode(prop.value);
+		if(value.isEmpty() || value == prop.sent)
+			continue;
+
+		QByteArray entry;
+		if(!prop.announced)
+			entry = nameEntry(num,prop.id);
+		entry.append(valueEntry(num,value));
+		if(append(result,entry,0))
+		{
+			prop.sent = value;
+			prop.announced = true;
+		}
+	}
+	dirty.clear();
+	payloads.append(result);
+}
+
+void SyncPropertyEncoder::encodeKeyframe(QList<QByteArray> &payloads) const
+{
+	QList<QByteArray> result;
+	for(int num = 0; num<properties.size(); ++num)
+	{
+		const Property& prop = properties.at(num);
+		const QByteArray value = encode(prop.value);
+		if(value.isEmpty())
+			continue;
+
+		//a name and its value always end up in the same payload
+		QByteArray entry = nameEntry(static_cast<quint16>(num),prop.id);
+		entry.append(valueEntry(static_cast<quint16>(num),value));
+		append(result,entry,KEYFRAME);
+	}
+	payloads.append(result);
+}
+
+bool SyncPropertyEncoder::append(QList<QByteArray> &payloads, const QByteArray &entry, quint8 flags) const
+{
+	if(entry.size() + 1 > maxPayloadSize)
+	{
+		qWarning()<<"[SyncPropertyEncoder] Value too large for a sync message, skipped";
+		return false;
+	}
+	if(payloads.isEmpty() || payloads.last().size() + entry.size() > maxPayloadSize)
+		payloads.append(QByteArray(1,static_cast<char>(flags)));
+	payloads.last().append(entry);
+	return true;
+}
+
+QByteArray SyncPropertyEncoder::nameEntry(quint16 num, const QString &id)
+{
+	QByteArray entry;
+	QDataStream stream(&entry,QIODevice::WriteOnly);
+	stream.setVersion(SyncProtocol::SYNC_DATASTREAM_VERSION);
+	stream<<num<<quint8(NAME)<<id.toUtf8();
+	return entry;
+}
+
+QByteArray SyncPropertyEncoder::valueEntry(quint16 num, const QByteArray &value)
+{
+	QByteArray entry;
+	entry.reserve(sizeof(num) + value.size());
+	entry.append(static_cast<char>(num >> 8));
+	entry.append(static_cast<char>(num & 0xFF));
+	entry.append(value);
+	return entry;
+}
+
+void SyncPropertyDecoder::setExcludedProperties(const QStringList &patterns)
+{
+	filter.setPatterns(patterns);
+	for(int i = 0; i<names.size(); ++i)
+		excluded[i] = filter.isExcluded(names.at(i));
+}
+
+bool SyncPropertyDecoder::decode(const QByteArray &payload, tValueList &values, bool &isKeyframe)
+{
+	QDataStream stream(payload);
+	stream.setVersion(SyncProtocol::SYNC_DATASTREAM_VERSION);
+
+	quint8 flags;
+	stream>>flags;
+	if(stream.status() != QDataStream::Ok)
+		return false;
+	isKeyframe = flags & KEYFRAME;
+
+	while(!stream.atEnd())
+	{
+		quint16 num;
+		quint8 type;
+		stream>>num>>type;
+		if(stream.status() != QDataStream::Ok)
+			return false;
+
+		if(type == NAME)
+		{
+			QByteArray name;
+			stream>>name;
+			if(num >= names.size())
+			{
+				names.resize(num + 1);
+				excluded.resize(num + 1);
+			}
+			names[num] = QString::fromUtf8(name);
+			excluded[num] = filter.isExcluded(names.at(num));
+			continue;
+		}
+
+		//a value for a property which was never introduced means we missed something
+		QVariant value;
+		if(num >= names.size() || names.at(num).isEmpty() || !readValue(stream,type,value))
+			return false;
+		if(!excluded.at(num))
+			values.append(qMakePair(names.at(num),value));
+	}
+	return stream.status() == QDataStream::Ok;
+}
+
+void SyncPropertyDecoder::clear()
+{
+	names.clear();
+	excluded.clear();
+}
@@ -0,0 +1,169 @@
+/*
+ * Stellarium Remote Sync plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef SYNCPROPERTYCODEC_HPP_
+#define SYNCPROPERTYCODEC_HPP_
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QRegExp>
+#include <QSet>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+//! Encoding of StelProperty values for the STELPROPERTY sync message.
+//!
+//! A payload consists of a flag byte, followed by entries until the end of the payload.
+//! Each entry starts with a quint16 property number and a quint8 type tag:
+//! - tag NAME introduces a property: the UTF-8 property ID follows, and the number is used for this ID from now on.
+//!   A name is only sent the first time a property is broadcast, and in every keyframe.
+//! - all other tags are a value, encoded as compactly as the tag allows (booleans in the tag itself,
+//!   small integers in one byte, doubles which are exactly representable as float in 4 bytes, and so on).
+//!
+//! Entries never span payloads, so a large keyframe can be split into several messages.
+namespace SyncPropertyCodec
+{
+	enum Flags
+	{
+		KEYFRAME = 0x01 //this payload is (part of) the full state, and not only the changes
+	};
+
+	enum ValueType
+	{
+		NAME = 0,
+		BOOL_FALSE,
+		BOOL_TRUE,
+		INT8,
+		INT32,
+		INT64,
+		FLOAT,
+		DOUBLE,
+		STRING,
+		VEC3F,
+		VEC3D,
+		VARIANT, //any other Qt type which can be written to a QDataStream
+		VALUETYPE_MAX = VARIANT
+	};
+
+	//! Writes the type tag and the value, returns false if the value can not be encoded (nothing is written then)
+	bool writeValue(QDataStream& stream, const QVariant& value);
+	//! Reads a value with the given type tag
+	bool readValue(QDataStream& stream, quint8 type, QVariant& value);
+	//! Returns the encoded form of the value, or an empty array if it can not be encoded.
+	//! Can be used to compare values independently of their QVariant type.
+	QByteArray encode(const QVariant& value);
+
+	//! Filters property IDs by a list of wildcard patterns, like "RemoteSync.*"
+	class Filter
+	{
+	public:
+		void setPatterns(const QStringList& patterns);
+		bool isExcluded(const QString& id) const;
+	private:
+		QList<QRegExp> patterns;
+	};
+}
+
+//! Server side state of the StelProperty sync.
+//! Collects property changes during a frame and encodes them as compact payloads.
+//! A property which changes several times during a frame is sent only once, with its last value,
+//! and changes which result in the value which was last sent are dropped.
+//! The cost of a frame only depends on the number of changed properties, not on the number of synced ones.
+class SyncPropertyEncoder
+{
+public:
+	//! @param maxPayloadSize the size limit for a single payload. Larger updates are split into several payloads.
+	SyncPropertyEncoder(int maxPayloadSize);
+
+	//! Properties matching one of these wildcard patterns are ignored by setValue()
+	void setExcludedProperties(const QStringList& patterns);
+
+	//! Records the new value of a property, to be sent with the next encodeChanges() call.
+	//! Values of types which can not be encoded are ignored.
+	void setValue(const QString& id, const QVariant& value);
+	//! Treats the current values as known to all clients. This can be used after the initial values
+	//! were set, while there are no clients yet: every client receives a keyframe first anyway.
+	void markSynchronized();
+	//! Returns true if setValue() was called since the last encodeChanges()
+	bool hasChanges() const { return !dirty.isEmpty(); }
+	//! Returns the number of properties known to the encoder
+	int propertyCount() const { return properties.size(); }
+
+	//! Encodes the changes since the last call into one or more payloads.
+	//! Nothing is appended if no value actually changed.
+	void encodeChanges(QList<QByteArray>& payloads);
+	//! Encodes the names and values of all properties, flagged as keyframe.
+	//! This also contains all pending changes, but they are still sent with the next encodeChanges()
+	//! as other clients may not have received the keyframe.
+	void encodeKeyframe(QList<QByteArray>& payloads) const;
+
+private:
+	struct Property
+	{
+		QString id;
+		QVariant value;
+		//the encoded form of the value last included in encodeChanges()
+		QByteArray sent;
+		//true if the name was already broadcast
+		bool announced;
+		bool dirty;
+	};
+
+	//appends an entry to the last payload, or starts a new one if it does not fit,
+	//returns false if the entry is larger than a payload
+	bool append(QList<QByteArray>& payloads, const QByteArray& entry, quint8 flags) const;
+	static QByteArray nameEntry(quint16 num, const QString& id);
+	static QByteArray valueEntry(quint16 num, const QByteArray& value);
+
+	int maxPayloadSize;
+	QVector<Property> properties;
+	QHash<QString,quint16> numbers;
+	//numbers of the properties changed since the last encodeChanges()
+	QVector<quint16> dirty;
+	SyncPropertyCodec::Filter filter;
+	//properties which are excluded, or have a type which can not be encoded
+	QSet<QString> ignored;
+};
+
+//! Client side state of the StelProperty sync, decodes payloads created by a SyncPropertyEncoder
+class SyncPropertyDecoder
+{
+public:
+	typedef QList<QPair<QString,QVariant> > tValueList;
+
+	//! Properties matching one of these wildcard patterns are skipped by decode()
+	void setExcludedProperties(const QStringList& patterns);
+
+	//! Decodes a payload, and appends the contained values to @p values.
+	//! @param isKeyframe set to true if the payload is part of a keyframe
+	//! @return false if the payload is malformed
+	bool decode(const QByteArray& payload, tValueList& values, bool& isKeyframe);
+	//! Forgets all property names
+	void clear();
+private:
+	QVector<QString> names;
+	QVector<bool> excluded;
+	SyncPropertyCodec::Filter filter;
+};
+
+#endif
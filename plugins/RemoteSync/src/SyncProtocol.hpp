@@ -32,7 +32,7 @@ namespace SyncProtocol
 //Important: All data should use the sized typedefs provided by Qt (i.e. qint32 instead of 4 byte int on x86)
 
 //! Should be changed with every breaking change
-const quint8 SYNC_PROTOCOL_VERSION = 1;
+const quint8 SYNC_PROTOCOL_VERSION = 2;
 const QDataStream::Version SYNC_DATASTREAM_VERSION = QDataStream::Qt_5_0;
 //! Magic value for protocol used during connection. Should NEVER change.
 const QByteArray SYNC_MAGIC_VALUE = "StellariumSyncPluginProtocol";
@@ -69,6 +69,8 @@ enum SyncMessageType
 	TIME, //time jumps + time scale updates
 	LOCATION, //location changes
 	SELECTION,
+	VIEW, //view direction and field of view
+	STELPROPERTY, //StelProperty changes, see SyncPropertyCodec
 
 	ALIVE, //sent from a peer after no data was sent for about 5 seconds to indicate it is still alive
 	MSGTYPE_MAX = ALIVE,
@@ -99,6 +101,12 @@ inline QDebug& operator<<(QDebug& deb, SyncMessageType msg)
 		case SyncProtocol::SELECTION:
 			deb<<"SELECTION";
 			break;
+		case SyncProtocol::VIEW:
+			deb<<"VIEW";
+			break;
+		case SyncProtocol::STELPROPERTY:
+			deb<<"STELPROPERTY";
+			break;
 		case SyncProtocol::ALIVE:
 			deb<<"ALIVE";
 			break;
@@ -29,8 +29,8 @@
 
 using namespace SyncProtocol;
 
-SyncServer::SyncServer(QObject* parent)
-	: QObject(parent)
+SyncServer::SyncServer(const QStringList& excludedProperties, QObject* parent)
+	: QObject(parent), excludedProperties(excludedProperties)
 {
 	qserver = new QTcpServer(this);
 	connect(qserver,SIGNAL(newConnection()), this, SLOT(handleNewConnection()));
@@ -61,6 +61,8 @@ bool SyncServer::start(int port)
 		addSender(new TimeEventSender());
 		addSender(new LocationEventSender());
 		addSender(new SelectionEventSender());
+		addSender(new ViewEventSender());
+		addSender(new StelPropertyEventSender(excludedProperties));
 
 		timeoutTimerId = startTimer(5000,Qt::VeryCoarseTimer);
 	}
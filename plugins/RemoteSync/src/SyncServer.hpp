@@ -23,6 +23,7 @@
 #include "SyncProtocol.hpp"
 #include <QObject>
 #include <QAbstractSocket>
+#include <QStringList>
 #include <QDateTime>
 #include <QUuid>
 
@@ -35,7 +36,8 @@ class SyncServer : public QObject
 	Q_OBJECT
 
 public:
-	SyncServer(QObject* parent = 0);
+	//! @param excludedProperties wildcard patterns of StelProperty IDs which should not be synced
+	SyncServer(const QStringList& excludedProperties, QObject* parent = 0);
 	virtual ~SyncServer();
 
 	//! This should be called in the StelModule::update function
@@ -80,6 +82,7 @@ private:
 
 	QByteArray broadcastBuffer;
 	int timeoutTimerId;
+	QStringList excludedProperties;
 	friend class ServerAuthHandler;
 };
 
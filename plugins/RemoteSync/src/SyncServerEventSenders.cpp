@@ -22,8 +22,16 @@
 
 #include "StelApp.hpp"
 #include "StelCore.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelMovementMgr.hpp"
 #include "StelObserver.hpp"
 #include "StelObjectMgr.hpp"
+#include "StelPropertyMgr.hpp"
+
+#include <QDateTime>
+
+//all clients receive a keyframe of the StelProperty state this often (in ms)
+#define PROPERTY_KEYFRAME_INTERVAL 10000
 
 
 SyncServerEventSender::SyncServerEventSender()
@@ -102,3 +110,93 @@ Selection SelectionEventSender::constructMessage()
 
 	return msg;
 }
+
+ViewEventSender::ViewEventSender()
+{
+	mvMgr = GETSTELMODULE(StelMovementMgr);
+	lastView = constructMessage();
+}
+
+View ViewEventSender::constructMessage()
+{
+	View msg;
+	msg.viewDirectionJ2000 = mvMgr->getViewDirectionJ2000();
+	msg.fov = mvMgr->getCurrentFov();
+	return msg;
+}
+
+void ViewEventSender::update()
+{
+	//the view changes through many different ways (mouse, keys, scripts, auto moves), so just compare
+	View view = constructMessage();
+	if(view.viewDirectionJ2000 != lastView.viewDirectionJ2000 || view.fov != lastView.fov)
+	{
+		lastView = view;
+		isDirty = true;
+	}
+	TypedSyncServerEventSender<View>::update();
+}
+
+StelPropertyEventSender::StelPropertyEventSender(const QStringList &excludedProperties)
+	: encoder(SyncProtocol::SYNC_MAX_PAYLOAD_SIZE)
+{
+	propMgr = StelApp::getInstance().getStelPropertyManager();
+	const StelPropertyMgr::StelPropertyMap& map = propMgr->getPropertyMap();
+
+	//read-only properties can't be set on the clients anyway
+	QStringList excluded = excludedProperties;
+	for(StelPropertyMgr::StelPropertyMap::const_iterator it = map.constBegin(); it!=map.constEnd(); ++it)
+	{
+		if((*it)->isReadOnly())
+			excluded.append(it.key());
+	}
+	encoder.setExcludedProperties(excluded);
+
+	//start with the current state, which is sent to clients as keyframe when they connect
+	for(StelPropertyMgr::StelPropertyMap::const_iterator it = map.constBegin(); it!=map.constEnd(); ++it)
+	{
+		encoder.setValue(it.key(),(*it)->getValue());
+	}
+	encoder.markSynchronized();
+	lastKeyframeTime = QDateTime::currentMSecsSinceEpoch();
+
+	connect(propMgr,SIGNAL(stelPropChanged(QString,QVariant)),this,SLOT(propertyChanged(QString,QVariant)));
+	qDebug()<<"[SyncServer] Syncing"<<encoder.propertyCount()<<"StelProperties";
+}
+
+void StelPropertyEventSender::propertyChanged(const QString &id, const QVariant &value)
+{
+	//only recorded here, a property changing many times in a frame is only sent once
+	encoder.setValue(id,value);
+}
+
+void StelPropertyEventSender::newClientConnected(SyncRemotePeer &client)
+{
+	payloads.clear();
+	encoder.encodeKeyframe(payloads);
+	foreach(const QByteArray& payload, payloads)
+	{
+		client.writeMessage(StelPropertyUpdate(payload));
+	}
+}
+
+void StelPropertyEventSender::update()
+{
+	payloads.clear();
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	if(now - lastKeyframeTime >= PROPERTY_KEYFRAME_INTERVAL)
+	{
+		//the keyframe contains everything, so pending changes don't need to be sent separately
+		encoder.encodeChanges(payloads);
+		payloads.clear();
+		encoder.encodeKeyframe(payloads);
+		lastKeyframeTime = now;
+	}
+	else if(encoder.hasChanges())
+		encoder.encodeChanges(payloads);
+
+	foreach(const QByteArray& payload, payloads)
+	{
+		broadcastMessage(StelPropertyUpdate(payload));
+	}
+}
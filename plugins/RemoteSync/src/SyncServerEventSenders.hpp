@@ -22,10 +22,13 @@
 
 #include "SyncProtocol.hpp"
 #include "SyncMessages.hpp"
+#include "SyncPropertyCodec.hpp"
 
 class SyncServer;
 class StelCore;
+class StelMovementMgr;
 class StelObjectMgr;
+class StelPropertyMgr;
 
 //! Subclasses of this class notify clients of state changes.
 class SyncServerEventSender : public QObject
@@ -128,4 +131,42 @@ private:
 	StelObjectMgr* objMgr;
 };
 
+//! Notifies clients of changes of the view direction and field of view.
+//! There is no signal for these, so they are compared with the last sent values each frame.
+class ViewEventSender : public TypedSyncServerEventSender<View>
+{
+	Q_OBJECT
+public:
+	ViewEventSender();
+protected:
+	View constructMessage() Q_DECL_OVERRIDE;
+	void update() Q_DECL_OVERRIDE;
+private:
+	StelMovementMgr* mvMgr;
+	View lastView;
+};
+
+//! Notifies clients of StelProperty changes, which covers the landscape, display flags, colors and so on.
+//! Changes are collected during the frame and sent in update() as compact delta messages (see SyncPropertyEncoder).
+//! New clients receive all property values as a keyframe, and this keyframe is also repeated for all clients
+//! from time to time, to correct clients that were changed locally.
+class StelPropertyEventSender : public SyncServerEventSender
+{
+	Q_OBJECT
+public:
+	//! @param excludedProperties wildcard patterns of property IDs which should not be synced
+	StelPropertyEventSender(const QStringList& excludedProperties);
+protected:
+	void newClientConnected(SyncRemotePeer& client) Q_DECL_OVERRIDE;
+	void update() Q_DECL_OVERRIDE;
+private slots:
+	void propertyChanged(const QString& id, const QVariant& value);
+private:
+	StelPropertyMgr* propMgr;
+	SyncPropertyEncoder encoder;
+	//re-used for each frame to avoid allocations
+	QList<QByteArray> payloads;
+	qint64 lastKeyframeTime;
+};
+
 #endif
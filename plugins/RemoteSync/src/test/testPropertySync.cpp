@@ -0,0 +1,462 @@
+/*
+ * Stellarium Remote Sync plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "test/testPropertySync.hpp"
+#include "SyncPropertyCodec.hpp"
+#include "SyncProtocol.hpp"
+#include "VecMath.hpp"
+
+#include <QElapsedTimer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+
+QTEST_GUILESS_MAIN(TestPropertySync)
+
+//number of simulated frames in the loopback test, and property changes per frame
+#define FRAMES 200
+#define CHANGES 20
+//largest encoded change: number, type tag and a Vec3f
+#define MAX_ENTRY_SIZE (2+1+12)
+
+using namespace SyncPropertyCodec;
+
+//! Puts a SyncMessage header in front of the payload, like SyncMessage::createFullMessage
+static QByteArray frameMessage(quint8 type, const QByteArray& payload)
+{
+	QByteArray msg;
+	QDataStream stream(&msg,QIODevice::WriteOnly);
+	stream.setVersion(SyncProtocol::SYNC_DATASTREAM_VERSION);
+	stream<<type<<static_cast<SyncProtocol::tPayloadSize>(payload.size());
+	stream.writeRawData(payload.constData(),payload.size());
+	return msg;
+}
+
+//! Decodes all payloads, which is expected to succeed
+static SyncPropertyDecoder::tValueList decodeAll(SyncPropertyDecoder& decoder, const QList<QByteArray>& payloads, bool* keyframe = NULL)
+{
+	SyncPropertyDecoder::tValueList values;
+	foreach(const QByteArray& payload, payloads)
+	{
+		bool isKeyframe;
+		if(!decoder.decode(payload,values,isKeyframe))
+			qWarning()<<"decoding failed";
+		if(keyframe)
+			*keyframe = isKeyframe;
+	}
+	return values;
+}
+
+//! Receives sync messages, like a SyncClient with only the StelProperty handler, until an ALIVE message arrives
+class PropertyClient : public QThread
+{
+public:
+	PropertyClient(quint16 port)
+		: port(port), messages(0), bytes(0), failed(false)
+	{
+	}
+
+	quint16 port;
+	int messages;
+	qint64 bytes;
+	bool failed;
+	//the encoded values the client ended up with
+	QHash<QString,QByteArray> state;
+
+protected:
+	void run()
+	{
+		QTcpSocket socket;
+		socket.connectToHost(QHostAddress::LocalHost,port);
+		if(!socket.waitForConnected(5000))
+		{
+			failed = true;
+			return;
+		}
+
+		SyncPropertyDecoder decoder;
+		SyncPropertyDecoder::tValueList values;
+		forever
+		{
+			QByteArray header = read(socket,SyncProtocol::SYNC_HEADER_SIZE);
+			if(header.isEmpty())
+				return;
+			const quint8 type = static_cast<quint8>(header.at(0));
+			const int size = (static_cast<quint8>(header.at(1))<<8) | static_cast<quint8>(header.at(2));
+			QByteArray payload = read(socket,size);
+			if(failed)
+				return;
+			bytes += header.size() + size;
+			if(type == SyncProtocol::ALIVE)
+				return;
+
+			bool isKeyframe;
+			values.clear();
+			if(type != SyncProtocol::STELPROPERTY || !decoder.decode(payload,values,isKeyframe))
+			{
+				failed = true;
+				return;
+			}
+			++messages;
+			for(SyncPropertyDecoder::tValueList::const_iterator it = values.constBegin(); it!=values.constEnd(); ++it)
+				state.insert(it->first,encode(it->second));
+		}
+	}
+
+private:
+	QByteArray read(QTcpSocket& socket, int size)
+	{
+		while(socket.bytesAvailable() < size)
+		{
+			if(!socket.waitForReadyRead(5000))
+			{
+				failed = true;
+				return QByteArray();
+			}
+		}
+		return socket.read(size);
+	}
+};
+
+//! Value number @p version of property @p i, the types alternate like in a real property set
+static QVariant makeValue(int i, int version)
+{
+	switch (i%4)
+	{
+		case 0:
+			return QVariant(bool((i+version)%2));
+		case 1:
+			return QVariant(version*3+i);
+		case 2:
+			return QVariant(version*0.1+i);
+		default:
+			return QVariant::fromValue(Vec3f(version,i,0.5f));
+	}
+}
+
+void TestPropertySync::testValues_data()
+{
+	QTest::addColumn<QVariant>("value");
+	QTest::addColumn<int>("size");
+	QTest::newRow("bool") << QVariant(true) << 1;
+	QTest::newRow("small int") << QVariant(-5) << 2;
+	QTest::newRow("int") << QVariant(100000) << 5;
+	QTest::newRow("long long") << QVariant(Q_INT64_C(10000000000)) << 9;
+	QTest::newRow("float") << QVariant(0.1f) << 5;
+	QTest::newRow("double as float") << QVariant(0.5) << 5;
+	QTest::newRow("double") << QVariant(0.1) << 9;
+	QTest::newRow("string") << QVariant(QString("guereins")) << 13;
+	QTest::newRow("Vec3f") << QVariant::fromValue(Vec3f(0.1f,0.2f,0.3f)) << 13;
+	QTest::newRow("Vec3d") << QVariant::fromValue(Vec3d(0.1,0.2,0.3)) << 25;
+	QTest::newRow("string list") << QVariant(QStringList() << "a" << "b") << -1;
+}
+
+void TestPropertySync::testValues()
+{
+	QFETCH(QVariant, value);
+	QFETCH(int, size);
+
+	const QByteArray encoded = encode(value);
+	QVERIFY(!encoded.isEmpty());
+	if(size>=0)
+		QCOMPARE(encoded.size(),size);
+
+	SyncPropertyEncoder encoder(SyncProtocol::SYNC_MAX_PAYLOAD_SIZE);
+	encoder.setValue("Test.value",value);
+	QList<QByteArray> payloads;
+	encoder.encodeChanges(payloads);
+	QCOMPARE(payloads.size(),1);
+
+	SyncPropertyDecoder decoder;
+	SyncPropertyDecoder::tValueList values = decodeAll(decoder,payloads);
+	QCOMPARE(values.size(),1);
+	QCOMPARE(values.first().first,QString("Test.value"));
+	//the QVariant type may differ (e.g. float is decoded as double), but not the value
+	QCOMPARE(encode(values.first().second),encoded);
+}
+
+void TestPropertySync::testInterning()
+{
+	SyncPropertyEncoder encoder(SyncProtocol::SYNC_MAX_PAYLOAD_SIZE);
+	SyncPropertyDecoder decoder;
+	QList<QByteArray> payloads;
+
+	encoder.setValue("TestModule.first",1);
+	encoder.setValue("TestModule.second",true);
+	encoder.encodeChanges(payloads);
+	QCOMPARE(payloads.size(),1);
+	QVERIFY(payloads.first().contains("TestModule.first"));
+	QCOMPARE(decodeAll(decoder,payloads).size(),2);
+
+	//the second time, only the numbers are sent: flags + (number, type, int8)
+	payloads.clear();
+	encoder.setValue("TestModule.first",2);
+	encoder.encodeChanges(payloads);
+	QCOMPARE(payloads.size(),1);
+	QCOMPARE(payloads.first().size(),1+4);
+
+	SyncPropertyDecoder::tValueList values = decodeAll(decoder,payloads);
+	QCOMPARE(values.size(),1);
+	QCOMPARE(values.first().first,QString("TestModule.first"));
+	QCOMPARE(values.first().second.toInt(),2);
+}
+
+void TestPropertySync::testCoalescing()
+{
+	SyncPropertyEncoder encoder(SyncProtocol::SYNC_MAX_PAYLOAD_SIZE);
+	SyncPropertyDecoder decoder;
+	QList<QByteArray> payloads;
+
+	//many changes during one frame result in a single value
+	for(int i=0;i<=100;++i)
+		encoder.setValue("Test.value",i);
+	QVERIFY(encoder.hasChanges());
+	encoder.encodeChanges(payloads);
+	SyncPropertyDecoder::tValueList values = decodeAll(decoder,payloads);
+	QCOMPARE(values.size(),1);
+	QCOMPARE(values.first().second.toInt(),100);
+
+	//changes which end at the last sent value are not sent at all
+	payloads.clear();
+	encoder.setValue("Test.value",5);
+	encoder.setValue("Test.value",100);
+	encoder.encodeChanges(payloads);
+	QVERIFY(payloads.isEmpty());
+	QVERIFY(!encoder.hasChanges());
+}
+
+void TestPropertySync::testKeyframe()
+{
+	SyncPropertyEncoder encoder(SyncProtocol::SYNC_MAX_PAYLOAD_SIZE);
+	SyncPropertyDecoder decoder;
+	QList<QByteArray> payloads;
+
+	encoder.setValue("Test.a",1);
+	encoder.setValue("Test.b",2);
+	encoder.setValue("Test.c",3);
+	encoder.encodeChanges(payloads);
+	decodeAll(decoder,payloads);
+
+	//a late client can't make sense of the changes, the names were already sent
+	payloads.clear();
+	encoder.setValue("Test.b",20);
+	encoder.encodeChanges(payloads);
+	SyncPropertyDecoder lateDecoder;
+	SyncPropertyDecoder::tValueList values;
+	bool isKeyframe;
+	QVERIFY(!lateDecoder.decode(payloads.first(),values,isKeyframe));
+	QCOMPARE(decodeAll(decoder,payloads).size(),1);
+
+	//it needs the keyframe first
+	payloads.clear();
+	encoder.encodeKeyframe(payloads);
+	isKeyframe = false;
+	values = decodeAll(lateDecoder,payloads,&isKeyframe);
+	QVERIFY(isKeyframe);
+	QCOMPARE(values.size(),3);
+	QCOMPARE(values.at(1).first,QString("Test.b"));
+	QCOMPARE(values.at(1).second.toInt(),20);
+
+	//afterwards, the changes are understood by both
+	payloads.clear();
+	encoder.setValue("Test.c",30);
+	encoder.encodeChanges(payloads);
+	QCOMPARE(decodeAll(lateDecoder,payloads).size(),1);
+	QCOMPARE(decodeAll(decoder,payloads).size(),1);
+}
+
+void TestPropertySync::testSplit()
+{
+	const int maxSize = 64;
+	SyncPropertyEncoder encoder(maxSize);
+	for(int i=0;i<50;++i)
+		encoder.setValue(QString("Test.property%1").arg(i),i*1000);
+
+	QList<QByteArray> payloads;
+	encoder.encodeKeyframe(payloads);
+	QVERIFY(payloads.size()>1);
+	foreach(const QByteArray& payload, payloads)
+	{
+		QVERIFY(payload.size()<=maxSize);
+		QCOMPARE(int(payload.at(0)),int(KEYFRAME));
+	}
+
+	SyncPropertyDecoder decoder;
+	SyncPropertyDecoder::tValueList values = decodeAll(decoder,payloads);
+	QCOMPARE(values.size(),50);
+	QCOMPARE(values.last().second.toInt(),49000);
+}
+
+void TestPropertySync::testExclusion()
+{
+	SyncPropertyEncoder encoder(SyncProtocol::SYNC_MAX_PAYLOAD_SIZE);
+	encoder.setExcludedProperties(QStringList() << "Hidden.*");
+	encoder.setValue("Hidden.value",1);
+	encoder.setValue("Shown.value",1);
+	encoder.setValue("Shown.other",2);
+	//types without encoding are ignored
+	encoder.setValue("Shown.unsupported",QVariant::fromValue(Vec4f(1.f,2.f,3.f,4.f)));
+	QCOMPARE(encoder.propertyCount(),2);
+
+	QList<QByteArray> payloads;
+	encoder.encodeChanges(payloads);
+
+	//the client side filter skips values, but still understands the rest
+	SyncPropertyDecoder decoder;
+	decoder.setExcludedProperties(QStringList() << "Shown.other");
+	SyncPropertyDecoder::tValueList values = decodeAll(decoder,payloads);
+	QCOMPARE(values.size(),1);
+	QCOMPARE(values.first().first,QString("Shown.value"));
+}
+
+void TestPropertySync::testLoopback_data()
+{
+	QTest::addColumn<int>("properties");
+	QTest::addColumn<int>("clients");
+	QTest::newRow("100 properties, 1 client") << 100 << 1;
+	QTest::newRow("100 properties, 6 clients") << 100 << 6;
+	QTest::newRow("1000 properties, 6 clients") << 1000 << 6;
+	QTest::newRow("10000 properties, 6 clients") << 10000 << 6;
+}
+
+void TestPropertySync::testLoopback()
+{
+	QFETCH(int, properties);
+	QFETCH(int, clients);
+
+	QTcpServer server;
+	QVERIFY(server.listen(QHostAddress::LocalHost));
+
+	SyncPropertyEncoder encoder(SyncProtocol::SYNC_MAX_PAYLOAD_SIZE);
+	QVector<QString> names;
+	QHash<QString,QVariant> current;
+	for(int i=0;i<properties;++i)
+	{
+		names.append(QString("Module%1.property%2").arg(i/50).arg(i));
+		current.insert(names.last(),makeValue(i,0));
+		encoder.setValue(names.last(),current.value(names.last()));
+	}
+	encoder.markSynchronized();
+
+	//like SyncServer::clientAuthenticated, new clients get a keyframe
+	QList<QTcpSocket*> sockets;
+	QList<QByteArray> payloads;
+	qint64 keyframeBytes = 0;
+	auto acceptClients = [&]()
+	{
+		while(server.hasPendingConnections())
+		{
+			QTcpSocket* sock = server.nextPendingConnection();
+			sock->setSocketOption(QAbstractSocket::LowDelayOption,1);
+			sockets.append(sock);
+			payloads.clear();
+			encoder.encodeKeyframe(payloads);
+			keyframeBytes = 0;
+			foreach(const QByteArray& payload, payloads)
+			{
+				QByteArray msg = frameMessage(SyncProtocol::STELPROPERTY,payload);
+				keyframeBytes += msg.size();
+				sock->write(msg);
+			}
+		}
+	};
+
+	//all clients except the last one are there from the start, the last one joins half way through
+	QList<PropertyClient*> list;
+	for(int i=0;i<clients;++i)
+		list.append(new PropertyClient(server.serverPort()));
+	for(int i=0;i<clients-1;++i)
+		list.at(i)->start();
+	while(sockets.size()<clients-1)
+	{
+		QVERIFY(server.waitForNewConnection(5000));
+		acceptClients();
+	}
+
+	QElapsedTimer timer;
+	qint64 encodeTime = 0;
+	qint64 deltaBytes = 0;
+	QByteArray buffer;
+	for(int frame=1;frame<=FRAMES;++frame)
+	{
+		if(frame == FRAMES/2)
+			list.last()->start();
+		server.waitForNewConnection(0);
+		acceptClients();
+
+		//each property is changed twice, only the last value should be sent
+		for(int k=0;k<CHANGES;++k)
+		{
+			const int idx = ((frame*CHANGES+k)*7919) % properties;
+			encoder.setValue(names.at(idx),makeValue(idx,-frame));
+			current.insert(names.at(idx),makeValue(idx,frame));
+			encoder.setValue(names.at(idx),current.value(names.at(idx)));
+		}
+
+		//this is the work done by StelPropertyEventSender::update and SyncServer::broadcastMessage each frame
+		timer.start();
+		payloads.clear();
+		encoder.encodeChanges(payloads);
+		buffer.clear();
+		foreach(const QByteArray& payload, payloads)
+			buffer.append(frameMessage(SyncProtocol::STELPROPERTY,payload));
+		encodeTime += timer.nsecsElapsed();
+		deltaBytes += buffer.size();
+
+		foreach(QTcpSocket* sock, sockets)
+		{
+			sock->write(buffer);
+			sock->flush();
+		}
+	}
+
+	while(sockets.size()<clients)
+	{
+		QVERIFY(server.waitForNewConnection(5000));
+		acceptClients();
+	}
+	foreach(QTcpSocket* sock, sockets)
+	{
+		sock->write(frameMessage(SyncProtocol::ALIVE,QByteArray()));
+		while(sock->bytesToWrite()>0)
+			QVERIFY(sock->waitForBytesWritten(5000));
+	}
+
+	foreach(PropertyClient* client, list)
+		QVERIFY(client->wait(10000));
+
+	//all clients, including the late one, end up with the server state
+	qint64 receivedBytes = 0;
+	foreach(PropertyClient* client, list)
+	{
+		QVERIFY(!client->failed);
+		QCOMPARE(client->state.size(),properties);
+		foreach(const QString& name, names)
+			QCOMPARE(client->state.value(name),encode(current.value(name)));
+		receivedBytes += client->bytes;
+	}
+	qDeleteAll(list);
+	qDeleteAll(sockets);
+
+	qDebug()<<properties<<"properties,"<<clients<<"clients: keyframe"<<keyframeBytes<<"bytes,"
+		<<double(deltaBytes)/FRAMES<<"bytes/frame,"<<encodeTime/1000./FRAMES<<"us/frame to encode,"
+		<<receivedBytes<<"bytes received in total";
+	//the size of a frame only depends on the number of changes, not on the number of properties
+	QVERIFY(deltaBytes <= qint64(FRAMES)*(SyncProtocol::SYNC_HEADER_SIZE + 1 + CHANGES*MAX_ENTRY_SIZE));
+}
@@ -0,0 +1,43 @@
+/*
+ * Stellarium Remote Sync plugin
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _TESTPROPERTYSYNC_HPP_
+#define _TESTPROPERTYSYNC_HPP_
+
+#include <QObject>
+#include <QtTest>
+
+//! Tests the StelProperty sync encoding (SyncPropertyEncoder/SyncPropertyDecoder),
+//! and measures it with several clients over loopback connections.
+class TestPropertySync : public QObject
+{
+	Q_OBJECT
+private slots:
+	void testValues_data();
+	void testValues();
+	void testInterning();
+	void testCoalescing();
+	void testKeyframe();
+	void testSplit();
+	void testExclusion();
+	void testLoopback_data();
+	void testLoopback();
+};
+
+#endif // _TESTPROPERTYSYNC_HPP_
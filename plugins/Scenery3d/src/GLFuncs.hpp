@@ -33,10 +33,13 @@ class GLExtFuncs : public QOpenGLFunctions_1_0
 public:
 	//! Since 3.2
 	PFNGLFRAMEBUFFERTEXTUREPROC glFramebufferTexture;
+	//! Since 1.4, may be NULL on ES contexts
+	PFNGLMULTIDRAWELEMENTSPROC glMultiDrawElements;
 
 	void init(QOpenGLContext* ctx)
 	{
 		glFramebufferTexture = (PFNGLFRAMEBUFFERTEXTUREPROC)ctx->getProcAddress("glFramebufferTexture");
+		glMultiDrawElements = ctx->isOpenGLES() ? Q_NULLPTR : (PFNGLMULTIDRAWELEMENTSPROC)ctx->getProcAddress("glMultiDrawElements");
 
 		if(!ctx->isOpenGLES())
 			initializeOpenGLFunctions();
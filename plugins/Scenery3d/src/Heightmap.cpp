@@ -99,23 +99,43 @@ void Heightmap::initGrid()
 {
 	grid = new GridSpace[GRID_LENGTH*GRID_LENGTH];
 
-	for (int y = 0; y < GRID_LENGTH; y++)
+	//a flat extent can not contain any face, as face_in_area requires a real overlap
+	if (xMax <= xMin || yMax <= yMin)
+		return;
+
+	//each face is only tested against the grid spaces around its bounding box, instead of all of them
+	for(unsigned int i=0; i<obj->m_numberOfTriangles; ++i)
 	{
-		for (int x = 0; x < GRID_LENGTH; x++)
+		const unsigned int* pTriangle = &(obj->m_indexArray.at(i*3));
+
+		float f_xmin = INF, f_ymin = INF, f_xmax = -INF, f_ymax = -INF;
+		for(int j=0; j<3; j++)
 		{
-			float xmin = this->xMin + (x * (this->xMax - this->xMin)) / GRID_LENGTH;
-			float ymin = this->yMin + (y * (this->yMax - this->yMin)) / GRID_LENGTH;
-			float xmax = this->xMin + ((x+1) * (this->xMax - this->xMin)) / GRID_LENGTH;
-			float ymax = this->yMin + ((y+1) * (this->yMax - this->yMin)) / GRID_LENGTH;
+			const OBJ::Vertex& pVertex = obj->m_vertexArray.at(pTriangle[j]);
+			f_xmin = std::min(f_xmin, pVertex.position[0]);
+			f_ymin = std::min(f_ymin, pVertex.position[1]);
+			f_xmax = std::max(f_xmax, pVertex.position[0]);
+			f_ymax = std::max(f_ymax, pVertex.position[1]);
+		}
 
-			FaceVector* faces = &grid[y*GRID_LENGTH + x].faces;
+		//one more space on each side, the exact test is done by face_in_area
+		const int x0 = std::max(0, static_cast<int>((f_xmin - xMin) / (xMax - xMin) * GRID_LENGTH) - 1);
+		const int y0 = std::max(0, static_cast<int>((f_ymin - yMin) / (yMax - yMin) * GRID_LENGTH) - 1);
+		const int x1 = std::min(GRID_LENGTH-1, static_cast<int>((f_xmax - xMin) / (xMax - xMin) * GRID_LENGTH) + 1);
+		const int y1 = std::min(GRID_LENGTH-1, static_cast<int>((f_ymax - yMin) / (yMax - yMin) * GRID_LENGTH) + 1);
 
-			for(unsigned int i=0; i<obj->m_numberOfTriangles; ++i)
+		for (int y = y0; y <= y1; y++)
+		{
+			for (int x = x0; x <= x1; x++)
 			{
-				const unsigned int* pTriangle = &(obj->m_indexArray.at(i*3));
+				float xmin = this->xMin + (x * (this->xMax - this->xMin)) / GRID_LENGTH;
+				float ymin = this->yMin + (y * (this->yMax - this->yMin)) / GRID_LENGTH;
+				float xmax = this->xMin + ((x+1) * (this->xMax - this->xMin)) / GRID_LENGTH;
+				float ymax = this->yMin + ((y+1) * (this->yMax - this->yMin)) / GRID_LENGTH;
+
 				if(face_in_area(*obj, pTriangle, xmin, ymin, xmax, ymax))
 				{
-					faces->push_back(*pTriangle);
+					grid[y*GRID_LENGTH + x].faces.push_back(*pTriangle);
 				}
 			}
 		}
@@ -50,8 +50,11 @@
 #include "StelTextureMgr.hpp"
 #include "StelUtils.hpp"
 
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDir>
 #include <QElapsedTimer>
+#include <QFileInfo>
 #include <QOpenGLVertexArrayObject>
 #include <QTemporaryFile>
 #include <QDebug>
@@ -216,6 +219,9 @@ void OBJ::clean()
 		m_vertexArrayObject->destroy();
 
 	m_stelModels.clear();
+	m_bvhNodes.clear();
+	m_bvhModelIds.clear();
+	m_bvhModelBoxes.clear();
 	m_materials.clear();
 	m_vertexArray.clear();
 	m_indexArray.clear();
@@ -270,6 +276,27 @@ bool OBJ::load(const QString& filename, const enum vertexOrder order, bool rebui
 	QElapsedTimer timer;
 	timer.start();
 
+	//Extract the base path, will be used to load the MTL file later on
+	m_basePath.clear();
+	m_basePath = StelFileMgr::dirName(filename) + "/";
+
+	//the mesh cache contains the result of all the processing below
+	const QString cachePath = meshCachePath(filename);
+	if(loadMeshCache(cachePath, order, rebuildNormals))
+	{
+		qDebug()<<"[OBJ] Loaded"<<QDir::toNativeSeparators(filename)<<"from mesh cache in"<<timer.elapsed()<<"ms";
+		qDebug()<<"[OBJ] Triangles#:"<<m_numberOfTriangles<<", Vertices#:"<<m_vertexArray.size()<<", StelModels#:"<<m_numberOfStelModels;
+		if(!checkVertexCount())
+		{
+			clean();
+			return false;
+		}
+		m_loaded = true;
+		return true;
+	}
+	m_sourceFiles.clear();
+	m_sourceFiles.append(filename);
+
 	QFile* qtFile = getFile(filename);
 
 	qint64 decTime = timer.restart();
@@ -278,10 +305,6 @@ bool OBJ::load(const QString& filename, const enum vertexOrder order, bool rebui
 	if(!qtFile)
 		return false;
 
-	//Extract the base path, will be used to load the MTL file later on
-	m_basePath.clear();
-	m_basePath = StelFileMgr::dirName(filename) + "/";
-
 	MatCacheT materialCache;
 
 	//Parse the file
@@ -298,15 +321,10 @@ bool OBJ::load(const QString& filename, const enum vertexOrder order, bool rebui
 	//Done parsing, close file
 	fclose(pFile);
 
-	//check if we support rendering the number of vertices loaded
-	if(indexBufferType == GL_UNSIGNED_SHORT)
+	if(!checkVertexCount())
 	{
-		if((m_vertexArray.size() - 1) > std::numeric_limits<unsigned short>::max())
-		{
-			qCritical()<<"[OBJ] This scene is too complex to be rendered on your hardware. Vertices:"<<m_vertexArray.size()<<", hardware maximum:"<<std::numeric_limits<unsigned short>::max()+1;
-			delete qtFile;
-			return false;
-		}
+		delete qtFile;
+		return false;
 	}
 
 	qint64 secondPassTime = timer.restart();
@@ -346,9 +364,206 @@ bool OBJ::load(const QString& filename, const enum vertexOrder order, bool rebui
 	m_loaded = true;
 
 	delete qtFile; //this will also delete the temp file if one was used
+
+	saveMeshCache(cachePath, order, rebuildNormals);
+	return true;
+}
+
+bool OBJ::checkVertexCount() const
+{
+	//check if we support rendering the number of vertices loaded
+	if(indexBufferType == GL_UNSIGNED_SHORT)
+	{
+		if((m_vertexArray.size() - 1) > std::numeric_limits<unsigned short>::max())
+		{
+			qCritical()<<"[OBJ] This scene is too complex to be rendered on your hardware. Vertices:"<<m_vertexArray.size()<<", hardware maximum:"<<std::numeric_limits<unsigned short>::max()+1;
+			return false;
+		}
+	}
+	return true;
+}
+
+//Version of the mesh cache format, increase this when the cached data or the processing in load() changes
+static const quint32 MESH_CACHE_VERSION = 1;
+
+QString OBJ::meshCachePath(const QString &filename)
+{
+	//scenes often use the same model file names, so the path is part of the cache name
+	const QFileInfo info(filename);
+	const QByteArray pathHash = QCryptographicHash::hash(info.absoluteFilePath().toUtf8(), QCryptographicHash::Md5).toHex().left(12);
+	return StelFileMgr::getCacheDir() + "/scenery3d/" + info.completeBaseName() + "_" + pathHash + ".mesh";
+}
+
+//writes the size and modification time of a source file, used to detect if the cache is outdated
+static void writeSourceStamp(QDataStream& out, const QString& filename)
+{
+	const QFileInfo info(filename);
+	out << filename << qint64(info.size()) << info.lastModified().toMSecsSinceEpoch();
+}
+
+static QDataStream& operator<<(QDataStream& out, const OBJ::Material& mat)
+{
+	out << qint32(mat.illum) << mat.name << mat.ambient << mat.diffuse << mat.specular << mat.emission
+	    << mat.shininess << mat.alpha << mat.alphatest << mat.backfacecull << mat.hasSpecularity << mat.hasTransparency
+	    << mat.textureName << mat.bumpMapName << mat.heightMapName << mat.emissiveMapName;
+	return out;
+}
+
+static QDataStream& operator>>(QDataStream& in, OBJ::Material& mat)
+{
+	qint32 illum;
+	in >> illum >> mat.name >> mat.ambient >> mat.diffuse >> mat.specular >> mat.emission
+	   >> mat.shininess >> mat.alpha >> mat.alphatest >> mat.backfacecull >> mat.hasSpecularity >> mat.hasTransparency
+	   >> mat.textureName >> mat.bumpMapName >> mat.heightMapName >> mat.emissiveMapName;
+	mat.illum = static_cast<OBJ::Material::Illum>(illum);
+	return in;
+}
+
+bool OBJ::loadMeshCache(const QString &cachePath, const vertexOrder order, bool rebuildNormals)
+{
+	QFile cache(cachePath);
+	if(!cache.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream in(&cache);
+	in.setVersion(QDataStream::Qt_5_2);
+	in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+	quint32 version, vertexSize;
+	qint32 cachedOrder;
+	bool cachedRebuildNormals;
+	in >> version >> vertexSize >> cachedOrder >> cachedRebuildNormals;
+	if(in.status()!=QDataStream::Ok || version!=MESH_CACHE_VERSION || vertexSize!=sizeof(Vertex)
+			|| cachedOrder!=order || cachedRebuildNormals!=rebuildNormals)
+		return false;
+
+	//the cache is outdated if the OBJ file or one of its MTL files changed
+	qint32 sourceCount;
+	in >> sourceCount;
+	for(int i=0;i<sourceCount && in.status()==QDataStream::Ok;++i)
+	{
+		QString filename;
+		qint64 size, modified;
+		in >> filename >> size >> modified;
+		const QFileInfo info(filename);
+		if(!info.exists() || info.size()!=size || info.lastModified().toMSecsSinceEpoch()!=modified)
+		{
+			qDebug()<<"[OBJ] Mesh cache is outdated, reloading"<<QDir::toNativeSeparators(filename);
+			return false;
+		}
+	}
+
+	//written as quint32, but larger values than qint32 can hold are invalid anyway
+	qint32 numberOfVertices, numberOfIndices;
+	in >> m_hasPositions >> m_hasTextureCoords >> m_hasNormals >> m_hasTangents >> m_hasStelModels
+	   >> m_numberOfVertexCoords >> m_numberOfTextureCoords >> m_numberOfNormals >> m_numberOfTriangles
+	   >> m_numberOfMaterials >> m_numberOfStelModels >> pBoundingBox.min >> pBoundingBox.max
+	   >> numberOfVertices >> numberOfIndices;
+	//the counts are trusted from here on, so they must at least fit the arrays and the byte sizes read below
+	if(in.status()!=QDataStream::Ok || numberOfVertices<0 || numberOfIndices<0
+			|| numberOfVertices>std::numeric_limits<int>::max()/int(sizeof(Vertex))
+			|| numberOfIndices>std::numeric_limits<int>::max()/int(sizeof(unsigned int))
+			|| int(m_numberOfMaterials)<0 || int(m_numberOfStelModels)<0)
+	{
+		qWarning()<<"[OBJ] Invalid mesh cache"<<QDir::toNativeSeparators(cachePath);
+		clean();
+		return false;
+	}
+
+	m_materials.resize(m_numberOfMaterials);
+	for(int i=0;i<m_materials.size();++i)
+		in >> m_materials[i];
+
+	m_stelModels.resize(m_numberOfStelModels);
+	for(int i=0;i<m_stelModels.size();++i)
+	{
+		StelModel& model = m_stelModels[i];
+		qint32 startIndex, triangleCount, materialIndex;
+		in >> startIndex >> triangleCount >> materialIndex >> model.bbox.min >> model.bbox.max >> model.centroid;
+		if(materialIndex<0 || materialIndex>=m_materials.size()
+				|| startIndex<0 || triangleCount<0 || startIndex>numberOfIndices
+				|| triangleCount>(numberOfIndices-startIndex)/3)
+		{
+			in.setStatus(QDataStream::ReadCorruptData);
+			break;
+		}
+		model.startIndex = startIndex;
+		model.triangleCount = triangleCount;
+		model.pMaterial = &m_materials.at(materialIndex);
+	}
+
+	//the vertex and index arrays are stored as they are in memory
+	m_vertexArray.resize(numberOfVertices);
+	m_indexArray.resize(numberOfIndices);
+	const int vertexBytes = numberOfVertices * sizeof(Vertex);
+	const int indexBytes = numberOfIndices * sizeof(unsigned int);
+	if(in.status()!=QDataStream::Ok
+			|| in.readRawData(reinterpret_cast<char*>(m_vertexArray.data()), vertexBytes)!=vertexBytes
+			|| in.readRawData(reinterpret_cast<char*>(m_indexArray.data()), indexBytes)!=indexBytes)
+	{
+		qWarning()<<"[OBJ] Could not read mesh cache"<<QDir::toNativeSeparators(cachePath);
+		clean();
+		return false;
+	}
+
+	//a stale or corrupt cache could otherwise make the BVH or the draw calls read past the vertex array
+	for(int i=0;i<m_indexArray.size();++i)
+	{
+		if(m_indexArray.at(i)>=unsigned(numberOfVertices))
+		{
+			qWarning()<<"[OBJ] Invalid vertex index in mesh cache"<<QDir::toNativeSeparators(cachePath);
+			clean();
+			return false;
+		}
+	}
 	return true;
 }
 
+void OBJ::saveMeshCache(const QString &cachePath, const vertexOrder order, bool rebuildNormals) const
+{
+	QDir().mkpath(QFileInfo(cachePath).absolutePath());
+	QFile cache(cachePath);
+	if(!cache.open(QIODevice::WriteOnly))
+	{
+		qWarning()<<"[OBJ] Could not write mesh cache"<<QDir::toNativeSeparators(cachePath);
+		return;
+	}
+
+	QDataStream out(&cache);
+	out.setVersion(QDataStream::Qt_5_2);
+	out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+	out << MESH_CACHE_VERSION << quint32(sizeof(Vertex)) << qint32(order) << rebuildNormals;
+	out << qint32(m_sourceFiles.size());
+	foreach(const QString& filename, m_sourceFiles)
+		writeSourceStamp(out, filename);
+
+	out << m_hasPositions << m_hasTextureCoords << m_hasNormals << m_hasTangents << m_hasStelModels
+	    << m_numberOfVertexCoords << m_numberOfTextureCoords << m_numberOfNormals << m_numberOfTriangles
+	    << m_numberOfMaterials << m_numberOfStelModels << pBoundingBox.min << pBoundingBox.max
+	    << quint32(m_vertexArray.size()) << quint32(m_indexArray.size());
+
+	foreach(const Material& mat, m_materials)
+		out << mat;
+
+	foreach(const StelModel& model, m_stelModels)
+	{
+		out << qint32(model.startIndex) << qint32(model.triangleCount) << qint32(model.pMaterial - m_materials.constData())
+		    << model.bbox.min << model.bbox.max << model.centroid;
+	}
+
+	out.writeRawData(reinterpret_cast<const char*>(m_vertexArray.constData()), m_vertexArray.size() * sizeof(Vertex));
+	out.writeRawData(reinterpret_cast<const char*>(m_indexArray.constData()), m_indexArray.size() * sizeof(unsigned int));
+
+	cache.close();
+	//an incomplete cache is removed
+	if(out.status()!=QDataStream::Ok || cache.error()!=QFileDevice::NoError)
+	{
+		qWarning()<<"[OBJ] Could not write mesh cache"<<QDir::toNativeSeparators(cachePath);
+		cache.remove();
+	}
+}
+
 void OBJ::addFaceAttrib(AttributeVector &attributeArray, uint index, int material, int object)
 {
 	attributeArray[index].materialIndex = material;
@@ -1199,6 +1414,7 @@ bool OBJ::importMaterials(const QString& filename, MatCacheT& materialCache)
 
 	if (!pFile)
 		return false;
+	m_sourceFiles.append(filename);
 
 	Material* pMaterial = 0;
 	int iTmp = 0;
@@ -1601,6 +1817,189 @@ void OBJ::finalizeForRendering()
 			break;
 		}
 	}
+
+	//re-order the triangles in the index array like the models, so that the models of a material are stored successively
+	//this allows the renderer to merge them into a single draw call
+	QVector<unsigned int> sortedIndices;
+	QVector<int> sortedStarts;
+	sortedIndices.reserve(m_indexArray.size());
+	sortedStarts.reserve(m_stelModels.size());
+	for(int i=0;i<m_stelModels.size();++i)
+	{
+		const StelModel& model = m_stelModels.at(i);
+		sortedStarts.append(sortedIndices.size());
+		for(int j=model.startIndex;j<model.startIndex+model.triangleCount*3;++j)
+			sortedIndices.append(m_indexArray.at(j));
+	}
+	//every triangle belongs to exactly one model
+	if(sortedIndices.size() == m_indexArray.size())
+	{
+		m_indexArray = sortedIndices;
+		for(int i=0;i<m_stelModels.size();++i)
+			m_stelModels[i].startIndex = sortedStarts.at(i);
+	}
+	else
+		qWarning()<<"[OBJ] StelModels do not cover the index array, triangles are not re-ordered";
+
+	//the ids are assigned after sorting, so that drawing all models in id order gives the material-sorted order
+	for(int i=0;i<m_stelModels.size();++i)
+	{
+		m_stelModels[i].id = i;
+	}
+	buildBVH();
+}
+
+//the maximum number of StelModels in a BVH leaf
+static const int BVH_LEAF_SIZE = 4;
+
+void OBJ::buildBVH()
+{
+	m_bvhNodes.clear();
+	m_bvhModelIds.clear();
+	m_bvhModelBoxes.clear();
+	if(m_stelModels.isEmpty())
+		return;
+
+	m_bvhModelIds.reserve(m_stelModels.size());
+	for(int i=0;i<m_stelModels.size();++i)
+		m_bvhModelIds.append(m_stelModels.at(i).id);
+
+	//a binary tree has at most 2n-1 nodes
+	m_bvhNodes.reserve(2 * m_stelModels.size());
+	buildBVHNode(0, m_bvhModelIds.size());
+
+	//the StelModels are re-ordered by the transparency sort, so the leaves keep their own copy of the boxes
+	m_bvhModelBoxes.resize(m_bvhModelIds.size());
+	for(int i=0;i<m_bvhModelIds.size();++i)
+		m_bvhModelBoxes[i] = m_stelModels.at(m_bvhModelIds.at(i)).bbox;
+}
+
+//orders StelModel ids by the centroid coordinate on one axis
+struct BVHCentroidCompFunc
+{
+	BVHCentroidCompFunc(const QVector<OBJ::StelModel>& models, int axis) : models(models), axis(axis) {}
+	bool operator()(int lhs, int rhs) const { return models.at(lhs).centroid[axis] < models.at(rhs).centroid[axis]; }
+	const QVector<OBJ::StelModel>& models;
+	int axis;
+};
+
+int OBJ::buildBVHNode(int firstModel, int modelCount)
+{
+	const int nodeIdx = m_bvhNodes.size();
+	BVHNode node;
+	node.secondChild = -1;
+	node.firstModel = firstModel;
+	node.modelCount = modelCount;
+
+	//the node box contains the model boxes, the centroid box is used to find the split axis
+	AABB centroidBox;
+	for(int i=firstModel;i<firstModel+modelCount;++i)
+	{
+		const StelModel& model = m_stelModels.at(m_bvhModelIds.at(i));
+		node.bbox.expand(model.bbox.min);
+		node.bbox.expand(model.bbox.max);
+		centroidBox.expand(model.centroid);
+	}
+	m_bvhNodes.append(node);
+
+	if(modelCount<=BVH_LEAF_SIZE)
+		return nodeIdx;
+
+	//split at the median along the longest axis of the centroids
+	const Vec3f extent = centroidBox.max - centroidBox.min;
+	int axis = 0;
+	if(extent[1]>extent[axis])
+		axis = 1;
+	if(extent[2]>extent[axis])
+		axis = 2;
+
+	const int half = modelCount / 2;
+	std::nth_element(m_bvhModelIds.begin()+firstModel, m_bvhModelIds.begin()+firstModel+half, m_bvhModelIds.begin()+firstModel+modelCount,
+			 BVHCentroidCompFunc(m_stelModels, axis));
+
+	buildBVHNode(firstModel, half);
+	const int secondChild = buildBVHNode(firstModel + half, modelCount - half);
+	m_bvhNodes[nodeIdx].secondChild = secondChild;
+	return nodeIdx;
+}
+
+int OBJ::cullStelModels(const QMatrix4x4 &mvp, QVector<bool> &visible) const
+{
+	visible.fill(false, m_stelModels.size());
+	if(m_bvhNodes.isEmpty())
+		return 0;
+
+	//extract the clip planes from the matrix rows, the normals point into the frustum
+	//this does not need normalized planes because only the sign of the distance is used
+	const QVector4D r0 = mvp.row(0), r1 = mvp.row(1), r2 = mvp.row(2), r3 = mvp.row(3);
+	const QVector4D clip[6] = { r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2 };
+	Vec4f planes[6];
+	for(int i=0;i<6;++i)
+		planes[i] = Vec4f(clip[i].x(), clip[i].y(), clip[i].z(), clip[i].w());
+
+	return cullBVHNode(0, planes, false, visible);
+}
+
+//tests an AABB against the frustum planes
+//returns -1 if the box is completely outside, 1 if it is completely inside and 0 if it intersects the frustum boundary
+static int classifyBox(const AABB& box, const Vec4f* planes)
+{
+	int result = 1;
+	for(int i=0;i<6;++i)
+	{
+		const Vec4f& p = planes[i];
+		//the corner furthest along the plane normal decides if the box is outside,
+		//the opposite corner if it is completely inside
+		const float distPos = p[0] * (p[0]>=0.0f ? box.max[0] : box.min[0])
+				    + p[1] * (p[1]>=0.0f ? box.max[1] : box.min[1])
+				    + p[2] * (p[2]>=0.0f ? box.max[2] : box.min[2]) + p[3];
+		if(distPos<0.0f)
+			return -1;
+		const float distNeg = p[0] * (p[0]>=0.0f ? box.min[0] : box.max[0])
+				    + p[1] * (p[1]>=0.0f ? box.min[1] : box.max[1])
+				    + p[2] * (p[2]>=0.0f ? box.min[2] : box.max[2]) + p[3];
+		if(distNeg<0.0f)
+			result = 0;
+	}
+	return result;
+}
+
+int OBJ::cullBVHNode(int nodeIdx, const Vec4f *planes, bool inside, QVector<bool> &visible) const
+{
+	const BVHNode& node = m_bvhNodes.at(nodeIdx);
+
+	if(!inside)
+	{
+		const int cls = classifyBox(node.bbox, planes);
+		if(cls<0)
+			return 0;
+		inside = cls>0;
+	}
+
+	if(inside)
+	{
+		//all models of a fully contained node are visible without further tests
+		for(int i=node.firstModel;i<node.firstModel+node.modelCount;++i)
+			visible[m_bvhModelIds.at(i)] = true;
+		return node.modelCount;
+	}
+
+	if(node.secondChild<0)
+	{
+		//leaf intersecting the frustum boundary, test its models separately
+		int count = 0;
+		for(int i=node.firstModel;i<node.firstModel+node.modelCount;++i)
+		{
+			if(classifyBox(m_bvhModelBoxes.at(i), planes)>=0)
+			{
+				visible[m_bvhModelIds.at(i)] = true;
+				++count;
+			}
+		}
+		return count;
+	}
+
+	return cullBVHNode(nodeIdx + 1, planes, false, visible) + cullBVHNode(node.secondChild, planes, false, visible);
 }
 
 void OBJ::uploadBuffersGL()
@@ -1819,6 +2218,9 @@ size_t OBJ::memoryUsage()
 {
 	size_t sz = sizeof(*this);
 	sz+= m_stelModels.capacity() * (sizeof(StelModel) );
+	sz+= m_bvhNodes.capacity() * sizeof(BVHNode);
+	sz+= m_bvhModelIds.capacity() * sizeof(int);
+	sz+= m_bvhModelBoxes.capacity() * sizeof(AABB);
 	sz+= m_materials.capacity() * sizeof(Material);
 	sz+= m_vertexArray.capacity() * sizeof(Vertex);
 	sz+= m_indexArray.capacity() * sizeof(unsigned int);
@@ -1850,6 +2252,9 @@ OBJ& OBJ::operator=(const OBJ& other)
 	m_basePath = other.m_basePath;
 
 	m_stelModels = other.m_stelModels;
+	m_bvhNodes = other.m_bvhNodes;
+	m_bvhModelIds = other.m_bvhModelIds;
+	m_bvhModelBoxes = other.m_bvhModelBoxes;
 	m_materials = other.m_materials;
 	m_vertexArray = other.m_vertexArray;
 	m_indexArray = other.m_indexArray;
@@ -48,6 +48,7 @@
 #include <QFile>
 #include <QOpenGLBuffer>
 #include <QOpenGLVertexArrayObject>
+#include <QStringList>
 
 #include "StelTexture.hpp"
 #include "VecMath.hpp"
@@ -165,6 +166,8 @@ public:
 		AABB bbox;
 		//The centroid location of all vertices of this model
 		Vec3f centroid;
+		//Stable index of this model, which does not change when the models are re-ordered for rendering
+		int id;
 	};
 
 	//! Initializes values
@@ -174,7 +177,9 @@ public:
 
 	//! Cleanup, will be called inside the destructor
 	void clean();
-	//! Loads the given obj file and, if specified rebuilds normals
+	//! Loads the given obj file and, if specified rebuilds normals.
+	//! The processed mesh is stored in a binary cache in the user's cache directory, which is used instead of
+	//! the OBJ file on the next load, as long as the OBJ and MTL files are unchanged.
 	bool load(const QString& filename, const enum vertexOrder order, bool rebuildNormals = false);
 	//! Transform all the vertices through multiplication with a 4x4 matrix.
 	//! @param mat Matrix to multiply vertices with.
@@ -185,6 +190,7 @@ public:
 	const StelModel& getStelModel(int i) const;
 
 	//! This should be called after textures are loaded, and will re-order the StelModels to be grouped by their material.
+	//! The triangles in the index array are re-ordered the same way, so it must be called before uploadBuffersGL().
 	//! Furthermore, this is a prerequisite for transparencyDepthSort.
 	void finalizeForRendering();
 
@@ -192,6 +198,13 @@ public:
 	//! They are sorted so that they can be drawn back-to-front.
 	void transparencyDepthSort(const Vec3f& position);
 
+	//! Determines which StelModels may be visible in the view volume of the given model-view-projection matrix.
+	//! The bounding boxes are tested against a bounding volume hierarchy built in finalizeForRendering(),
+	//! so whole groups of models outside the view are rejected with a single test.
+	//! @param visible is resized to the number of StelModels, and indexed with StelModel::id
+	//! @return the number of visible models
+	int cullStelModels(const QMatrix4x4& mvp, QVector<bool>& visible) const;
+
 	//! Getters for various datastructures
 	int getNumberOfIndices() const;
 	int getNumberOfStelModels() const;
@@ -257,6 +270,16 @@ private:
 	typedef QMap<QString,int> MatCacheT;
 	typedef QMap<int, QVector<int> > VertCacheT;
 
+	//! A node of the bounding volume hierarchy over the StelModels
+	struct BVHNode
+	{
+		AABB bbox;
+		//index of the second child node, the first child directly follows its parent. -1 for leaf nodes.
+		int secondChild;
+		//range in m_bvhModelIds covered by this node
+		int firstModel, modelCount;
+	};
+
 	void addFaceAttrib(AttributeVector& attributeArray, uint index, int material, int object);
 	void addTrianglePos(const PosVector& vertexCoords, VertCacheT &vertexCache, unsigned int index, int v0, int v1, int v2);
 	void addTrianglePosNormal(const PosVector &vertexCoords, const VF3Vector& normals, VertCacheT &vertexCache, unsigned int index,
@@ -283,8 +306,22 @@ private:
 	//! Imports material file and fills the material datastructure
 	bool importMaterials(const QString& filename, MatCacheT& materialCache);
 	QString absolutePath(QString path);
+	//! Returns false if the number of vertices is too large for the supported index buffer type
+	bool checkVertexCount() const;
+	//! Returns the mesh cache file for an OBJ file
+	static QString meshCachePath(const QString& filename);
+	//! Loads the processed mesh from the cache. Returns false if there is no valid cache for these load parameters.
+	bool loadMeshCache(const QString& cachePath, const vertexOrder order, bool rebuildNormals);
+	//! Writes the processed mesh into the cache
+	void saveMeshCache(const QString& cachePath, const vertexOrder order, bool rebuildNormals) const;
 	//! Determine the bounding box extrema
 	void findBounds();
+	//! Builds the bounding volume hierarchy over the StelModel bounding boxes
+	void buildBVH();
+	//! Recursively builds the BVH for the given range of m_bvhModelIds, and returns the index of the new node
+	int buildBVHNode(int firstModel, int modelCount);
+	//! Recursively tests a BVH node against the frustum planes. If inside is true, the node is known to be fully inside the frustum.
+	int cullBVHNode(int nodeIdx, const Vec4f* planes, bool inside, QVector<bool>& visible) const;
 	//! Binds the GL buffers to the vertex attributes
 	void bindBuffersGL();
 	//! Releases vertex attribute bindings and buffers
@@ -324,9 +361,17 @@ private:
 
 	//! Base path to this file
 	QString m_basePath;
+	//! The OBJ and MTL files read by load(), used to check if the mesh cache is outdated
+	QStringList m_sourceFiles;
 
 	//! Datastructures
 	QVector<StelModel> m_stelModels;
+	//! The bounding volume hierarchy, the root is the first node
+	QVector<BVHNode> m_bvhNodes;
+	//! StelModel ids in the order referenced by the BVH leaves
+	QVector<int> m_bvhModelIds;
+	//! The bounding boxes of the models in m_bvhModelIds
+	QVector<AABB> m_bvhModelBoxes;
 	QVector<Material> m_materials;
 	QVector<Vertex> m_vertexArray;
 	QVector<unsigned int> m_indexArray;
@@ -74,11 +74,12 @@ Scenery3d::Scenery3d(Scenery3dMgr* parent)
       absolutePosition(0.0, 0.0, 0.0), moveVector(0.0, 0.0, 0.0), movement(0.0f,0.0f,0.0f), eye_height(0.0f),
       core(NULL), landscapeMgr(NULL),  heightmap(NULL), heightmapLoad(NULL),
       mainViewUp(0.0, 0.0, 1.0), mainViewDir(1.0, 0.0, 0.0), viewPos(0.0, 0.0, 0.0),
-      drawnTriangles(0), drawnModels(0), materialSwitches(0), shaderSwitches(0),
+      drawnTriangles(0), drawnModels(0), drawCalls(0), materialSwitches(0), shaderSwitches(0),
       requiresCubemap(false), cubemappingUsedLastFrame(false),
       lazyDrawing(false), updateOnlyDominantOnMoving(true), updateSecondDominantOnMoving(true), needsMovementEndUpdate(false),
       needsCubemapUpdate(true), needsMovementUpdate(false), lazyInterval(2.0), lastCubemapUpdate(0.0), lastCubemapUpdateRealTime(0), lastMovementEndRealTime(0),
       cubeMapCubeTex(0), cubeMapCubeDepth(0), cubeMapTex(), cubeRB(0), dominantFace(0), secondDominantFace(1), cubeFBO(0), cubeSideFBO(), cubeMappingCreated(false),
+      cubeFaceUpdateCount(0),
       cubeVertexBuffer(QOpenGLBuffer::VertexBuffer), transformedCubeVertexBuffer(QOpenGLBuffer::VertexBuffer), cubeIndexBuffer(QOpenGLBuffer::IndexBuffer), cubeIndexCount(0),
       lightOrthoNear(0.1f), lightOrthoFar(1000.0f), parallaxScale(0.015f)
 {
@@ -89,6 +90,14 @@ Scenery3d::Scenery3d(Scenery3dMgr* parent)
 	Q_ASSERT(cubeMapTex[0]==0);
 	Q_ASSERT(cubeSideFBO[0]==0);
 
+	for(int i=0;i<6;++i)
+	{
+		cubeFaceVisible[i] = true;
+		cubeFaceStale[i] = true;
+		cubeFaceUpdate[i] = 0;
+	}
+	cubemapShadowState.valid = false;
+
 	shaderParameters.openglES = false;
 	shaderParameters.shadowTransform = false;
 	shaderParameters.pixelLighting = false;
@@ -246,6 +255,7 @@ void Scenery3d::finalizeLoad()
 	StelApp::getInstance().ensureGLContextCurrent();
 
 	currentScene = loadingScene;
+	cubemapShadowState.valid = false;
 
 	//move load data to current one
 	objModel = objModelLoad;
@@ -254,10 +264,10 @@ void Scenery3d::finalizeLoad()
 	groundModelLoad.clear();
 
 	//upload GL
-	objModel->uploadBuffersGL();
 	objModel->uploadTexturesGL();
-	//call this after texture load
+	//call this after texture load, and before the buffer upload because it re-orders the triangles
 	objModel->finalizeForRendering();
+	objModel->uploadBuffersGL();
 
 	//the ground model needs no opengl uploads, so we skip them
 
@@ -687,6 +697,12 @@ bool Scenery3d::drawArrays(bool shading, bool blendAlphaAdditive)
 			break;
 	}
 
+	//find the models in the view volume of this pass
+	//the geometry shader renders all cubemap faces at once with a single matrix, so nothing can be culled there
+	const bool cull = !shaderParameters.geometryShader;
+	if(cull)
+		objModel->cullStelModels(projectionMatrix * modelViewMatrix, modelVisibility);
+
 	//bind VAO
 	objModel->bindGL();
 
@@ -694,13 +710,17 @@ bool Scenery3d::drawArrays(bool shading, bool blendAlphaAdditive)
 	bool backfaceCullState = true;
 	bool success = true;
 
-	//TODO optimize: clump models with same material together when first loading to minimize state changes
+	//the models are sorted by material in OBJ::finalizeForRendering, and the models of a material are stored successively in the index buffer
+	//so all visible models of a material are collected into one batch, and submitted when the material changes
 	const OBJ::Material* lastMaterial = NULL;
+	size_t batchEnd = 0;
 	bool blendEnabled = false;
 	for(int i=0; i<objModel->getNumberOfStelModels(); i++)
 	{
 
 		const OBJ::StelModel* pStelModel = &objModel->getStelModel(i);
+		if(cull && !modelVisibility.at(pStelModel->id))
+			continue;
 		const OBJ::Material* pMaterial = pStelModel->pMaterial;
 		Q_ASSERT(pMaterial);
 
@@ -708,6 +728,9 @@ bool Scenery3d::drawArrays(bool shading, bool blendAlphaAdditive)
 
 		if(lastMaterial!=pMaterial)
 		{
+			//the collected models must be drawn before the state changes
+			submitBatch(indexDataType);
+
 			++materialSwitches;
 			lastMaterial = pMaterial;
 
@@ -762,7 +785,7 @@ bool Scenery3d::drawArrays(bool shading, bool blendAlphaAdditive)
 
 			if(pMaterial->hasTransparency )
 			{
-				//TODO provide Z-sorting for transparent objects (center of bounding box should be fine)
+				//transparent models are depth sorted by OBJ::transparencyDepthSort, a batch keeps that order
 				if(!blendEnabled)
 				{
 					glEnable(GL_BLEND);
@@ -794,10 +817,20 @@ bool Scenery3d::drawArrays(bool shading, bool blendAlphaAdditive)
 			}
 		}
 
-		GET_GLERROR()
-		glDrawElements(GL_TRIANGLES, pStelModel->triangleCount * 3, indexDataType, reinterpret_cast<const void*>(pStelModel->startIndex * indexDataTypeSize));
+		//merge the model with the previous one if their indices are adjacent
+		const GLsizei count = pStelModel->triangleCount * 3;
+		const size_t offset = pStelModel->startIndex * indexDataTypeSize;
+		if(!batchCounts.isEmpty() && batchEnd == offset)
+			batchCounts.last() += count;
+		else
+		{
+			batchCounts.append(count);
+			batchOffsets.append(reinterpret_cast<const void*>(offset));
+		}
+		batchEnd = offset + count * indexDataTypeSize;
 		drawnTriangles+=pStelModel->triangleCount;
 	}
+	submitBatch(indexDataType);
 
 	if(!backfaceCullState)
 		glEnable(GL_CULL_FACE);
@@ -814,6 +847,31 @@ bool Scenery3d::drawArrays(bool shading, bool blendAlphaAdditive)
 	return success;
 }
 
+void Scenery3d::submitBatch(GLenum indexDataType)
+{
+	if(batchCounts.isEmpty())
+		return;
+
+	GET_GLERROR()
+#ifndef QT_OPENGL_ES_2
+	if(batchCounts.size()>1 && glExtFuncs->glMultiDrawElements)
+	{
+		glExtFuncs->glMultiDrawElements(GL_TRIANGLES, batchCounts.constData(), indexDataType, batchOffsets.constData(), batchCounts.size());
+		++drawCalls;
+	}
+	else
+#endif
+	{
+		for(int i=0;i<batchCounts.size();++i)
+			glDrawElements(GL_TRIANGLES, batchCounts.at(i), indexDataType, batchOffsets.at(i));
+		drawCalls+=batchCounts.size();
+	}
+
+	//keeps the allocated memory for the next batch
+	batchCounts.resize(0);
+	batchOffsets.resize(0);
+}
+
 void Scenery3d::computeFrustumSplits(const Vec3d viewPos, const Vec3d viewDir, const Vec3d viewUp)
 {
 	//the frustum arrays all already contain the same adjusted frustum from adjustFrustum
@@ -1051,6 +1109,9 @@ bool Scenery3d::renderShadowMaps()
 	if(fixShadowData)
 		return true;
 
+	//the shadow maps are overwritten, generateCubeMap sets this again if they are its perspective shadows
+	cubemapShadowState.valid = false;
+
 	shaderParameters.shadowTransform = true;
 
 	//projection matrix gets updated below in updateCropMatrix
@@ -1450,71 +1511,69 @@ void Scenery3d::renderShadowMapsForFace(int face)
 	glViewport(0, 0, cubemapSize, cubemapSize);
 }
 
+void Scenery3d::renderCubeFace(int face, const QMatrix4x4 &squareProjection)
+{
+	if(shaderParameters.shadows && fullCubemapShadows)
+	{
+		//in the BASIC and FULL modes, the shadow frustum needs to be adapted to the cube side
+		renderShadowMapsForFace(face);
+		//projection needs to be reset
+		projectionMatrix = squareProjection;
+	}
+
+	//bind a single side of the cube
+	glBindFramebuffer(GL_FRAMEBUFFER, cubeSideFBO[face]);
+
+	modelViewMatrix = cubeRotation[face];
+	modelViewMatrix.translate(absolutePosition.v[0], absolutePosition.v[1], absolutePosition.v[2]);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	drawArrays(true,true);
+
+	cubeFaceStale[face] = false;
+	cubeFaceUpdate[face] = cubeFaceUpdateCount;
+}
+
 void Scenery3d::renderIntoCubemapSixPasses()
 {
 	//store current projection (= 90° cube projection)
 	QMatrix4x4 squareProjection = projectionMatrix;
+	++cubeFaceUpdateCount;
 
 	if(needsMovementUpdate && updateOnlyDominantOnMoving)
 	{
-		if(shaderParameters.shadows && fullCubemapShadows)
-		{
-			//in the BASIC and FULL modes, the shadow frustum needs to be adapted to the cube side
-			renderShadowMapsForFace(dominantFace);
-			//projection needs to be reset
-			projectionMatrix = squareProjection;
-		}
-
 		//update only the dominant face
-		glBindFramebuffer(GL_FRAMEBUFFER, cubeSideFBO[dominantFace]);
-
-		modelViewMatrix = cubeRotation[dominantFace];
-		modelViewMatrix.translate(absolutePosition.v[0], absolutePosition.v[1], absolutePosition.v[2]);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		drawArrays(true,true);
+		renderCubeFace(dominantFace, squareProjection);
 
 		if(updateSecondDominantOnMoving)
 		{
-			if(shaderParameters.shadows && fullCubemapShadows)
-			{
-				//in the BASIC and FULL modes, the shadow frustum needs to be adapted to the cube side
-				renderShadowMapsForFace(secondDominantFace);
-				//projection needs to be reset
-				projectionMatrix = squareProjection;
-			}
-
 			//update also the second-most dominant face
-			glBindFramebuffer(GL_FRAMEBUFFER, cubeSideFBO[secondDominantFace]);
-
-			modelViewMatrix = cubeRotation[secondDominantFace];
-			modelViewMatrix.translate(absolutePosition.v[0], absolutePosition.v[1], absolutePosition.v[2]);
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-			drawArrays(true,true);
+			renderCubeFace(secondDominantFace, squareProjection);
 		}
 	}
 	else
 	{
-		//traditional 6-pass version
+		//on a cubemap update, only the faces in the viewport are rendered now, the others become stale
+		//stale faces are rendered as soon as they become visible, or one by one on the next frames
 		for(int i=0;i<6;++i)
 		{
-			if(shaderParameters.shadows && fullCubemapShadows)
+			if(needsCubemapUpdate && !cubeFaceVisible[i])
+				cubeFaceStale[i] = true;
+			else if(needsCubemapUpdate || (cubeFaceStale[i] && cubeFaceVisible[i]))
+				renderCubeFace(i, squareProjection);
+		}
+
+		for(int budget = STALE_FACE_BUDGET; budget>0; --budget)
+		{
+			int oldest = -1;
+			for(int i=0;i<6;++i)
 			{
-				//in the BASIC and FULL modes, the shadow frustum needs to be adapted to the cube side
-				renderShadowMapsForFace(i);
-				//projection needs to be reset
-				projectionMatrix = squareProjection;
+				if(cubeFaceStale[i] && cubeFaceUpdate[i] < cubeFaceUpdateCount && (oldest<0 || cubeFaceUpdate[i]<cubeFaceUpdate[oldest]))
+					oldest = i;
 			}
-
-			//bind a single side of the cube
-			glBindFramebuffer(GL_FRAMEBUFFER, cubeSideFBO[i]);
-
-			modelViewMatrix = cubeRotation[i];
-			modelViewMatrix.translate(absolutePosition.v[0], absolutePosition.v[1], absolutePosition.v[2]);
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-			drawArrays(true,true);
+			if(oldest<0)
+				break;
+			renderCubeFace(oldest, squareProjection);
 		}
 	}
 }
@@ -1538,9 +1597,29 @@ void Scenery3d::generateCubeMap()
 			float fov = altAzProjector->getFov();
 			float aspect = (float)altAzProjector->getViewportWidth() / (float)altAzProjector->getViewportHeight();
 
-			adjustShadowFrustum(viewPos,mainViewDir,mainViewUp,fov,aspect);
-			if(!renderShadowMaps())
-				return; //shadow map rendering failed, do an early abort
+			//the shadow maps are reused if neither the view nor the light moved noticeably since they were rendered
+			//the tolerance of the light direction is about 0.08°, which the sun moves in 20 seconds
+			const CubemapShadowState& last = cubemapShadowState;
+			const bool shadowsValid = last.valid && last.lightSource == lightInfo.lightSource
+					&& last.lightDirection.dot(lightInfo.lightDirectionV3f) > 1.0f - 1e-6f
+					&& last.viewPos == viewPos && last.viewDir == mainViewDir
+					&& last.fov == fov && last.aspect == aspect && last.frustumSplits == shaderParameters.frustumSplits;
+
+			if(!shadowsValid)
+			{
+				adjustShadowFrustum(viewPos,mainViewDir,mainViewUp,fov,aspect);
+				if(!renderShadowMaps())
+					return; //shadow map rendering failed, do an early abort
+
+				cubemapShadowState.valid = true;
+				cubemapShadowState.lightSource = lightInfo.lightSource;
+				cubemapShadowState.lightDirection = lightInfo.lightDirectionV3f;
+				cubemapShadowState.viewPos = viewPos;
+				cubemapShadowState.viewDir = mainViewDir;
+				cubemapShadowState.fov = fov;
+				cubemapShadowState.aspect = aspect;
+				cubemapShadowState.frustumSplits = shaderParameters.frustumSplits;
+			}
 		}
 	}
 
@@ -1736,9 +1815,54 @@ void Scenery3d::drawDirect() // for Perspective Projection only!
 
 }
 
+void Scenery3d::updateCubeFaceVisibility()
+{
+	const int vtxCount = cubeVertices.size() / 6;
+	for(int face=0;face<6;++face)
+	{
+		cubeFaceVisible[face] = false;
+		Vec3f win;
+		for(int i=face*vtxCount;i<(face+1)*vtxCount;++i)
+		{
+			if(altAzProjector->projectCheck(cubeVertices.at(i),win))
+			{
+				cubeFaceVisible[face] = true;
+				break;
+			}
+		}
+	}
+
+	//a face can cover the viewport without any of its vertices inside, when the field of view is small
+	//so the faces hit by a grid of view rays are visible too
+	const Vec4i& vp = altAzProjector->getViewport();
+	for(int y=0;y<=4;++y)
+	{
+		for(int x=0;x<=4;++x)
+		{
+			Vec3d dir;
+			if(!altAzProjector->unProject(vp[0] + x * vp[2] / 4.0, vp[1] + y * vp[3] / 4.0, dir))
+				continue;
+			//same face order as the cube vertices: +x, -x, +y, -y, +z, -z
+			int axis = qAbs(dir[0])<qAbs(dir[1]) ? 1 : 0;
+			if(qAbs(dir[2])>qAbs(dir[axis]))
+				axis = 2;
+			cubeFaceVisible[axis*2 + (dir[axis]<0.0)] = true;
+		}
+	}
+}
+
 void Scenery3d::drawWithCubeMap()
 {
-	if(needsCubemapUpdate || needsMovementUpdate)
+	bool staleFaces = false;
+	if(cubemappingMode != S3DEnum::CM_CUBEMAP_GSACCEL)
+	{
+		//the 6-pass modes can update single faces
+		updateCubeFaceVisibility();
+		for(int i=0;i<6;++i)
+			staleFaces = staleFaces || cubeFaceStale[i];
+	}
+
+	if(needsCubemapUpdate || needsMovementUpdate || staleFaces)
 	{
 		//lazy redrawing: update cubemap in slower intervals
 		generateCubeMap();
@@ -1929,6 +2053,9 @@ void Scenery3d::drawDebug()
     str = QString("%1 mats, %2 shaders").arg(materialSwitches).arg(shaderSwitches);
     painter.drawText(screen_x, screen_y, str);
     screen_y -= 15.0f;
+    str = QString("%1 draw calls").arg(drawCalls);
+    painter.drawText(screen_x, screen_y, str);
+    screen_y -= 15.0f;
     str = "View Pos";
     painter.drawText(screen_x, screen_y, str);
     screen_y -= 15.0f;
@@ -2532,6 +2659,8 @@ bool Scenery3d::initCubemapping()
 
 	//reset cubemap timer to make sure it is rerendered immediately after re-init
 	invalidateCubemap();
+	for(int i=0;i<6;++i)
+		cubeFaceStale[i] = true;
 
 	qDebug()<<"[Scenery3d] Initializing cubemap...done!";
 
@@ -2565,6 +2694,7 @@ void Scenery3d::deleteShadowmapping()
 bool Scenery3d::initShadowmapping()
 {
 	deleteShadowmapping();
+	cubemapShadowState.valid = false;
 
 	bool valid = false;
 
@@ -2715,7 +2845,7 @@ void Scenery3d::draw(StelCore* core)
 	defaultFBO = StelApp::getInstance().getDefaultFBO();
 
 	//reset render statistic
-	drawnTriangles = drawnModels = materialSwitches = shaderSwitches = 0;
+	drawnTriangles = drawnModels = drawCalls = materialSwitches = shaderSwitches = 0;
 
 	requiresCubemap = core->getCurrentProjectionType() != StelCore::ProjectionPerspective;
 	//update projector from core
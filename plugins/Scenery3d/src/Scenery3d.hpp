@@ -211,7 +211,12 @@ private:
 	Vec3d mainViewDir;
 	Vec3d viewPos;
 
-	int drawnTriangles,drawnModels;
+	int drawnTriangles,drawnModels,drawCalls;
+	//! Visibility of the StelModels in the current pass, indexed by StelModel::id
+	QVector<bool> modelVisibility;
+	//! Index ranges collected by drawArrays() for the current material, as element counts and byte offsets into the index buffer
+	QVector<GLsizei> batchCounts;
+	QVector<const void*> batchOffsets;
 	int materialSwitches, shaderSwitches;
 
 	/// ---- Cubemapping variables ----
@@ -233,6 +238,26 @@ private:
 	GLuint cubeRB; //renderbuffer for depth of a single face in TEXTURES and CUBEMAP modes (attached to multiple FBOs)
 	int dominantFace,secondDominantFace;
 
+	//face scheduling for the TEXTURES and CUBEMAP modes: only the faces covering the viewport are updated with the cubemap,
+	//the others are marked stale and updated on later frames, at most STALE_FACE_BUDGET per frame
+	static const int STALE_FACE_BUDGET = 1;
+	bool cubeFaceVisible[6]; //true if the face is (partly) inside the viewport of the current frame
+	bool cubeFaceStale[6]; //true if the face content is older than the last cubemap update
+	int cubeFaceUpdate[6]; //value of cubeFaceUpdateCount when the face was last rendered, the oldest stale face is updated first
+	int cubeFaceUpdateCount;
+
+	//the parameters the perspective shadow maps of the cubemap were last rendered with
+	//if they are unchanged, the shadow maps are reused on the next cubemap update
+	struct CubemapShadowState
+	{
+		bool valid;
+		ShadowCaster lightSource;
+		Vec3f lightDirection;
+		Vec3d viewPos, viewDir;
+		float fov, aspect;
+		int frustumSplits;
+	} cubemapShadowState;
+
 	//because of use that deviates very much from QOpenGLFramebufferObject typical usage, we manage the FBOs ourselves
 	GLuint cubeFBO; //used in CUBEMAP_GSACCEL mode - only a single FBO exists, with a cubemap for color and one for depth
 	GLuint cubeSideFBO[6]; //used in TEXTURES and CUBEMAP mode, 6 textures/cube faces for color and a shared depth renderbuffer (we don't require the depth after rendering)
@@ -326,6 +351,10 @@ private:
 	void drawDirect();
 	//! When another projection than perspective is selected, rendering is performed using a cubemap.
 	void drawWithCubeMap();
+	//! Finds the cube faces which are visible in the current viewport
+	void updateCubeFaceVisibility();
+	//! Renders a single face in renderIntoCubemapSixPasses
+	void renderCubeFace(int face, const QMatrix4x4& squareProjection);
 	//! Performs the actual rendering of the shadow map
 	bool renderShadowMaps();
 	//! Creates shadowmaps for the specified cubemap face
@@ -339,9 +368,12 @@ private:
 	//! Uses the StelPainter to draw a warped cube textured with our cubemap
 	void drawFromCubeMap();
 	//! This is the method that performs the actual drawing.
-	//! If shading is true, a suitable shader for each material is selected and initialized. Submits 1 draw call for each StelModel.
+	//! If shading is true, a suitable shader for each material is selected and initialized. The StelModels
+	//! which are inside the view volume of the current projectionMatrix and modelViewMatrix are submitted in one batch per material.
 	//! @return false on shader errors
 	bool drawArrays(bool shading=true, bool blendAlphaAdditive=false);
+	//! Draws the index ranges collected in batchCounts and batchOffsets, using a single glMultiDrawElements call where supported
+	void submitBatch(GLenum indexDataType);
 
 
 	// --- shading related stuff ---
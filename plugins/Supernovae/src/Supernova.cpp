@@ -60,6 +60,7 @@ Supernova::Supernova(const QVariantMap& map)
 	peakJD = map.value("peakJD").toDouble();
 	snra = StelUtils::getDecAngle(map.value("alpha").toString());
 	snde = StelUtils::getDecAngle(map.value("delta").toString());
+	StelUtils::spheToRect(snra, snde, XYZ);
 	note = map.value("note").toString();
 	distance = map.value("distance").toDouble();
 
@@ -255,9 +256,7 @@ void Supernova::draw(StelCore* core, StelPainter& painter)
 	float size, shift;
 	double mag;
 
-	StelUtils::spheToRect(snra, snde, XYZ);
 	mag = getVMagnitudeWithExtinction(core);
-	sd->preDrawPointSource(&painter);
 	float mlimit = sd->getLimitMagnitude();
 	
 	if (mag <= mlimit)
@@ -272,6 +271,4 @@ void Supernova::draw(StelCore* core, StelPainter& painter)
 			painter.drawText(XYZ, designation, 0, shift, shift, false);
 		}
 	}
-
-	sd->postDrawPointSource(&painter);
 }
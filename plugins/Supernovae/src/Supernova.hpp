@@ -92,6 +92,7 @@ private:
 
 	static StelTextureSP hintTexture;
 
+	//! Draw the supernova as point source, StelSkyDrawer::preDrawPointSource() must be called before.
 	void draw(StelCore* core, StelPainter& painter);
 
 	// Supernova
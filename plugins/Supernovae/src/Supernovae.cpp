@@ -18,6 +18,7 @@
 
 #include "StelProjector.hpp"
 #include "StelPainter.hpp"
+#include "StelSkyDrawer.hpp"
 #include "StelApp.hpp"
 #include "StelCore.hpp"
 #include "StelGui.hpp"
@@ -105,6 +106,7 @@ Supernovae::~Supernovae()
 
 void Supernovae::deinit()
 {
+	zoneIndex.clear();
 	texPointer.clear();
 }
 
@@ -199,12 +201,15 @@ void Supernovae::draw(StelCore* core)
 	StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
 	StelPainter painter(prj);
 	painter.setFont(font);
-	
-	foreach (const SupernovaP& sn, snstar)
-	{
-		if (sn && sn->initialized)
-			sn->draw(core, painter);
-	}
+	StelSkyDrawer* sd = core->getSkyDrawer();
+
+	visibleSNe.clear();
+	zoneIndex.findInRegion(prj->getViewportConvexPolygon()->getBoundingSphericalCaps(), visibleSNe);
+
+	sd->preDrawPointSource(&painter);
+	for (int i=0; i<visibleSNe.size(); ++i)
+		snstar.at(visibleSNe.at(i))->draw(core, painter);
+	sd->postDrawPointSource(&painter);
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 		drawPointer(core, painter);
@@ -236,23 +241,10 @@ QList<StelObjectP> Supernovae::searchAround(const Vec3d& av, double limitFov, co
 {
 	QList<StelObjectP> result;
 
-	Vec3d v(av);
-	v.normalize();
-	double cosLimFov = cos(limitFov * M_PI/180.);
-	Vec3d equPos;
-
-	foreach(const SupernovaP& sn, snstar)
-	{
-		if (sn->initialized)
-		{
-			equPos = sn->XYZ;
-			equPos.normalize();
-			if (equPos[0]*v[0] + equPos[1]*v[1] + equPos[2]*v[2]>=cosLimFov)
-			{
-				result.append(qSharedPointerCast<StelObject>(sn));
-			}
-		}
-	}
+	QVector<int> found;
+	zoneIndex.findAround(av, limitFov, found);
+	foreach (int i, found)
+		result.append(qSharedPointerCast<StelObject>(snstar.at(i)));
 
 	return result;
 }
@@ -414,6 +406,16 @@ void Supernovae::setSNeMap(const QVariantMap& map)
 			snstar.append(sn);
 
 	}
+	updateZoneIndex();
+}
+
+void Supernovae::updateZoneIndex()
+{
+	QVector<Vec3d> positions;
+	positions.reserve(snstar.size());
+	foreach (const SupernovaP& sn, snstar)
+		positions.append(sn->XYZ);
+	zoneIndex.setPositions(positions);
 }
 
 int Supernovae::getJsonFileVersion(void)
@@ -23,6 +23,7 @@
 #include "StelObject.hpp"
 #include "StelFader.hpp"
 #include "StelTextureTypes.hpp"
+#include "StelZoneIndex.hpp"
 #include "Supernova.hpp"
 #include <QFont>
 #include <QVariantMap>
@@ -30,6 +31,7 @@
 #include <QList>
 #include <QSharedPointer>
 #include <QHash>
+#include <QVector>
 
 class QNetworkAccessManager;
 class QNetworkReply;
@@ -212,12 +214,19 @@ private:
 	//! Set items for list of struct from data map
 	void setSNeMap(const QVariantMap& map);
 
+	//! rebuild the spatial index after a change of snstar
+	void updateZoneIndex();
+
 	QString sneJsonPath;
 
 	int SNCount;
 
 	StelTextureSP texPointer;
 	QList<SupernovaP> snstar;
+	//! positions of snstar sorted by zones, to draw and search only the supernovae in a region
+	StelZoneIndex zoneIndex;
+	//! indexes in snstar of the supernovae in view, kept to reuse the memory in the next frame
+	QVector<int> visibleSNe;
 	QHash<QString, double> snlist;
 
 	// variables and functions for the updater
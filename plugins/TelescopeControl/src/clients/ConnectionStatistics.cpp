@@ -0,0 +1,56 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ *
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "ConnectionStatistics.hpp"
+
+// Gain of the exponential smoothing, the one used for the jitter in RFC 3550
+static const double SMOOTHING = 1./16.;
+
+void ConnectionStatistics::reset(void)
+{
+	positionCount = 0;
+	lastSentTime = 0;
+	lastLatency = 0;
+	latency = 0.;
+	jitter = 0.;
+	interval = 0.;
+}
+
+void ConnectionStatistics::addPosition(qint64 sentTime, qint64 receivedTime)
+{
+	const qint64 newLatency = receivedTime - sentTime;
+	if (positionCount == 0)
+	{
+		latency = newLatency;
+	}
+	else
+	{
+		latency += (newLatency - latency) * SMOOTHING;
+		jitter += (qAbs(newLatency - lastLatency) - jitter) * SMOOTHING;
+		const double newInterval = sentTime - lastSentTime;
+		if (positionCount == 1)
+			interval = newInterval;
+		else
+			interval += (newInterval - interval) * SMOOTHING;
+	}
+	lastSentTime = sentTime;
+	lastLatency = newLatency;
+	positionCount++;
+}
@@ -0,0 +1,61 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ *
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _CONNECTION_STATISTICS_HPP_
+#define _CONNECTION_STATISTICS_HPP_
+
+#include <QtGlobal>
+
+//! Timing of the position updates received from a telescope.
+//! The latency of an update is the time between the moment the position was sent
+//! by the server and the moment the client has received it. For the clients talking
+//! directly to a device, it is the time needed to hand it over to the main thread.
+//! The jitter is the mean deviation of the latency between consecutive updates,
+//! estimated as in RFC 3550. All values are smoothed over the last updates.
+class ConnectionStatistics
+{
+public:
+	ConnectionStatistics(void) {reset();}
+	
+	//! Add the timing of a received position.
+	//! @param sentTime the time of the position given by the server, in microseconds.
+	//! @param receivedTime the time the position has been received, in microseconds.
+	void addPosition(qint64 sentTime, qint64 receivedTime);
+	void reset(void);
+	
+	int getPositionCount(void) const {return positionCount;}
+	//! @return the latency in microseconds.
+	double getLatency(void) const {return latency;}
+	//! @return the jitter in microseconds.
+	double getJitter(void) const {return jitter;}
+	//! @return the number of position updates per second.
+	double getUpdateRate(void) const {return (interval > 0.) ? 1000000./interval : 0.;}
+	
+private:
+	int positionCount;
+	qint64 lastSentTime;
+	qint64 lastLatency;
+	double latency;
+	double jitter;
+	//! mean time between two updates, in microseconds
+	double interval;
+};
+
+#endif //_CONNECTION_STATISTICS_HPP_
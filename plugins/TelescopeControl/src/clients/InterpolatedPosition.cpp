@@ -25,10 +25,16 @@
 
 #include "InterpolatedPosition.hpp"
 
-InterpolatedPosition::InterpolatedPosition() :
-		end_position(positions+(sizeof(positions)/sizeof(positions[0])))
+// Positions older than the time delay are kept for this long,
+// as the time delay is not exactly the age of the shown position
+static const qint64 KEEP_MARGIN_MICROS = 1000000;
+
+InterpolatedPosition::InterpolatedPosition()
+	: positions(16)
+	, first(0)
+	, count(0)
+	, timeDelay(0)
 {
-	reset();
 }
 
 InterpolatedPosition::~InterpolatedPosition()
@@ -38,62 +44,78 @@ InterpolatedPosition::~InterpolatedPosition()
 
 void InterpolatedPosition::reset()
 {
-	for (position_pointer = positions; position_pointer < end_position; position_pointer++)
-	{
-		position_pointer->server_micros = INT64_MAX;
-		position_pointer->client_micros = INT64_MAX;
-		position_pointer->pos[0] = 0.0;
-		position_pointer->pos[1] = 0.0;
-		position_pointer->pos[2] = 0.0;
-		position_pointer->status = 0;
-	}
-	position_pointer = positions;
+	first = 0;
+	count = 0;
 }
 
 void InterpolatedPosition::add(Vec3d &position, qint64 clientTime, qint64 serverTime, int status)
 {
+	// forget the positions which can't be shown anymore, keeping the newest
+	// one before the oldest time still needed for the interpolation:
+	const qint64 oldestNeeded = clientTime - timeDelay - KEEP_MARGIN_MICROS;
+	while (count > 1 && at(1).client_micros < oldestNeeded)
+	{
+		first = (first + 1) % positions.size();
+		count--;
+	}
+
+	if (count == positions.size())
+	{
+		// unroll the ring into a larger array
+		QVector<Position> larger(2 * positions.size());
+		for (int i = 0; i < count; i++)
+			larger[i] = at(i);
+		positions.swap(larger);
+		first = 0;
+	}
+
 	// remember the time and received position so that later we
 	// will know where the telescope is pointing to:
-	position_pointer++;
-	if (position_pointer >= end_position)
-		position_pointer = positions;
-
-	position_pointer->pos = position;
-	position_pointer->server_micros = serverTime;
-	position_pointer->client_micros = clientTime;
-	position_pointer->status = status;
+	Position &p = positions[(first + count) % positions.size()];
+	p.pos = position;
+	p.server_micros = serverTime;
+	p.client_micros = clientTime;
+	p.status = status;
+	count++;
 }
 
 Vec3d InterpolatedPosition::get(qint64 now) const
 {
-	if (position_pointer->client_micros == INT64_MAX)
+	if (count == 0)
 	{
 		return Vec3d(0,0,0);
 	}
+	if (now <= at(0).client_micros)
+	{
+		return at(0).pos;
+	}
+	if (now >= at(count - 1).client_micros)
+	{
+		return at(count - 1).pos;
+	}
 
-	const Position *p = position_pointer;
-	do
+	// binary search of the positions received just before and after now
+	int before = 0;
+	int after = count - 1;
+	while (after - before > 1)
 	{
-		const Position *pp = p;
-		if (pp == positions) pp = end_position;
-		pp--;
-		if (pp->client_micros == INT64_MAX) break;
-		if (pp->client_micros <= now && now <= p->client_micros)
+		const int middle = (before + after) / 2;
+		if (at(middle).client_micros <= now)
+			before = middle;
+		else
+			after = middle;
+	}
+
+	const Position &pp = at(before);
+	const Position &p = at(after);
+	if (pp.client_micros != p.client_micros)
+	{
+		Vec3d rval = p.pos * (now - pp.client_micros) + pp.pos * (p.client_micros - now);
+		double f = rval.lengthSquared();
+		if (f > 0.0)
 		{
-			if (pp->client_micros != p->client_micros)
-			{
-				Vec3d rval = p->pos * (now - pp->client_micros) + pp->pos * (p->client_micros - now);
-				double f = rval.lengthSquared();
-				if (f > 0.0)
-				{
-					return (1.0/std::sqrt(f))*rval;
-				}
-			}
-			break;
+			return (1.0/std::sqrt(f))*rval;
 		}
-		p = pp;
 	}
-	while (p != position_pointer);
-
-	return Vec3d(p->pos);
+	return Vec3d(p.pos);
 }
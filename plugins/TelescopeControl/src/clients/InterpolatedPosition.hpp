@@ -32,6 +32,8 @@
 
 #include "VecMath.hpp"
 
+#include <QVector>
+
 //! A telescope's position at a given time.
 //! This structure used to be defined inline in TelescopeTCP.
 struct Position
@@ -42,22 +44,34 @@ struct Position
 	int status;
 };
 
+//! The positions received from a telescope, kept for as long as they are needed
+//! to interpolate the position at a time in the past.
+//! The positions are kept in a ring buffer which grows when needed, so that
+//! telescopes sending many updates per second are also covered for the whole time delay.
 class InterpolatedPosition {
 public:
 	InterpolatedPosition();
 	~InterpolatedPosition();
 	
+	//! Add a position, clientTime must not be smaller than the one of the previous position.
 	void add(Vec3d& position, qint64 clientTime, qint64 serverTime, int status = 0);
 	//! returns the current interpolated position
 	Vec3d get(qint64 time) const;
 	//! resets/initializes the array of positions kept for position interpolation
 	void reset();
-	bool isKnown() const {return (position_pointer->client_micros != INT64_MAX);}
+	bool isKnown() const {return count > 0;}
+	//! Set how long the client waits before showing a position, in microseconds.
+	//! Older positions are dropped.
+	void setTimeDelay(qint64 delay) {timeDelay = delay;}
 	
 private:
-	Position positions[16];
-	Position *position_pointer;
-	Position *const end_position;
+	//! Return the i-th position, starting from the oldest one.
+	const Position &at(int i) const {return positions.at((first + i) % positions.size());}
+	
+	QVector<Position> positions;
+	int first;
+	int count;
+	qint64 timeDelay;
 };
  
  #endif //_INTEPOLATED_POSITION_HPP_
@@ -139,6 +139,14 @@ QString TelescopeClient::getInfoString(const StelCore* core, const InfoStringGro
 
 	oss << getTelescopeInfoString(core, flags);
 
+	if (flags&Extra && statistics.getPositionCount() > 1)
+	{
+		oss << q_("Position updates: %1/s, latency: %2 ms, jitter: %3 ms")
+		       .arg(statistics.getUpdateRate(), 0, 'f', 1)
+		       .arg(statistics.getLatency()/1000., 0, 'f', 1)
+		       .arg(statistics.getJitter()/1000., 0, 'f', 1) << "<br />";
+	}
+
 	postProcessInfoString(str, flags);
 
 	return str;
@@ -243,8 +251,11 @@ TelescopeTCP::TelescopeTCP(const QString &name, const QString &params, Equinox e
 	end_of_timeout = -0x8000000000000000LL;
 	
 	interpolatedPosition.reset();
+	interpolatedPosition.setTimeDelay(time_delay);
 	
 	connect(tcpSocket, SIGNAL(connected()), this, SLOT(socketConnected()));
+	// read the positions as soon as they arrive, not only once per frame
+	connect(tcpSocket, SIGNAL(readyRead()), this, SLOT(socketReadyRead()));
 	connect(tcpSocket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(socketFailed(QAbstractSocket::SocketError)));
 }
 
@@ -260,6 +271,7 @@ void TelescopeTCP::hangup(void)
 	wait_for_connection_establishment = false;
 	
 	interpolatedPosition.reset();
+	statistics.reset();
 }
 
 //! queues a GOTO command with the specified position to the write buffer.
@@ -445,7 +457,9 @@ void TelescopeTCP::performReading(void)
 						const StelCore* core = StelApp::getInstance().getCore();
 						j2000Position = core->equinoxEquToJ2000(position, StelCore::RefractionOff);
 					}
-					interpolatedPosition.add(j2000Position, getNow(), server_micros, status);
+					const qint64 client_micros = getNow();
+					interpolatedPosition.add(j2000Position, client_micros, server_micros, status);
+					statistics.addPosition(server_micros, client_micros);
 				}
 				break;
 				default:
@@ -517,13 +531,6 @@ void TelescopeTCP::performCommunication()
 	if (tcpSocket->state() == QAbstractSocket::ConnectedState)
 	{
 		performWriting();
-		
-		if (tcpSocket->bytesAvailable() > 0)
-		{
-			//If performReading() is called when there are no bytes to read,
-			//it closes the connection
-			performReading();
-		}
 	}
 }
 
@@ -533,6 +540,16 @@ void TelescopeTCP::socketConnected(void)
 	tcpSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
 }
 
+void TelescopeTCP::socketReadyRead(void)
+{
+	//If performReading() is called when there are no bytes to read,
+	//it closes the connection
+	while (tcpSocket->state() == QAbstractSocket::ConnectedState && tcpSocket->bytesAvailable() > 0)
+	{
+		performReading();
+	}
+}
+
 //TODO: More informative error messages?
 void TelescopeTCP::socketFailed(QAbstractSocket::SocketError)
 {
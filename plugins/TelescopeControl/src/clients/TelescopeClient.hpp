@@ -36,6 +36,7 @@
 #include "StelApp.hpp"
 #include "StelObject.hpp"
 #include "InterpolatedPosition.hpp"
+#include "ConnectionStatistics.hpp"
 
 class StelCore;
 
@@ -68,6 +69,7 @@ public:
 	//! - Name
 	//! - RaDecJ2000
 	//! - RaDec
+	//! - Extra (timing of the position updates)
 	//! - PlainText
 	//! @param core the StelCore object
 	//! @param flags a set of InfoStringGroup items to include in the return value.
@@ -90,6 +92,8 @@ protected:
 	TelescopeClient(const QString &name);
 	QString nameI18n;
 	const QString name;
+	//! Timing of the received positions, only used from the main thread
+	ConnectionStatistics statistics;
 
 	virtual QString getTelescopeInfoString(const StelCore* core, const InfoStringGroup& flags) const
 	{
@@ -208,6 +212,7 @@ private:
 	
 private slots:
 	void socketConnected(void);
+	void socketReadyRead(void);
 	void socketFailed(QAbstractSocket::SocketError socketError);
 };
 
@@ -29,6 +29,7 @@
 #include "Lx200Connection.hpp"
 #include "Lx200Command.hpp"
 #include "LogFile.hpp"
+#include "ServerThread.hpp"
 #include "StelCore.hpp"
 
 #include <QRegExp>
@@ -44,6 +45,7 @@ TelescopeClientDirectLx200::TelescopeClientDirectLx200 (const QString &name, con
 	, last_ra(0)
 	, queue_get_position(true)
 	, next_pos_time(0)
+	, connected(0)
 {
 	interpolatedPosition.reset();
 	
@@ -71,6 +73,7 @@ TelescopeClientDirectLx200::TelescopeClientDirectLx200 (const QString &name, con
 		qWarning() << "ERROR creating TelescopeClientDirectLx200: time_delay not valid (should be less than 10000000)";
 		return;
 	}
+	interpolatedPosition.setTimeDelay(time_delay);
 	
 	//end_of_timeout = -0x8000000000000000LL;
 	
@@ -95,6 +98,15 @@ TelescopeClientDirectLx200::TelescopeClientDirectLx200 (const QString &name, con
 	queue_get_position = true;
 	next_pos_time = -0x8000000000000000LL;
 	answers_received = false;
+	
+	connected.storeRelease(1);
+	ServerThread::addServer(this);
+}
+
+TelescopeClientDirectLx200::~TelescopeClientDirectLx200(void)
+{
+	// wait until the thread doesn't use this object anymore
+	ServerThread::removeServer(this);
 }
 
 //! queues a GOTO command
@@ -122,7 +134,9 @@ void TelescopeClientDirectLx200::telescopeGoto(const Vec3d &j2000Pos, StelObject
 		unsigned int ra_int = (unsigned int)floor(0.5 + ra*(((unsigned int)0x80000000)/M_PI));
 		int dec_int = (int)floor(0.5 + dec*(((unsigned int)0x80000000)/M_PI));
 
-		gotoReceived(ra_int, dec_int);
+		const GotoCommand command = {ra_int, dec_int};
+		if (!gotoCommands.push(command))
+			qDebug() << "TelescopeClientDirectLx200(" << name << ")::telescopeGoto: too many pending commands, ignoring this one";
 	}
 	/*
 		else
@@ -145,15 +159,33 @@ Vec3d TelescopeClientDirectLx200::getJ2000EquatorialPos(const StelCore*) const
 	return interpolatedPosition.get(now);
 }
 
+//! takes over the positions received by the ServerThread
 bool TelescopeClientDirectLx200::prepareCommunication()
 {
-	//TODO: Nothing to prepare?
+	const qint64 now = getNow();
+	ReceivedPosition received;
+	while (receivedPositions.pop(received))
+	{
+		const double ra  =  received.ra_int * (M_PI/(unsigned int)0x80000000);
+		const double dec = received.dec_int * (M_PI/(unsigned int)0x80000000);
+		const double cdec = cos(dec);
+		Vec3d position(cos(ra)*cdec, sin(ra)*cdec, sin(dec));
+		Vec3d j2000Position = position;
+		if (equinox == EquinoxJNow)
+		{
+			const StelCore* core = StelApp::getInstance().getCore();
+			j2000Position = core->equinoxEquToJ2000(position, StelCore::RefractionOff);
+		}
+		//Server time is the time of reception, because this class is the server
+		interpolatedPosition.add(j2000Position, received.client_micros, received.client_micros, received.status);
+		statistics.addPosition(received.client_micros, now);
+	}
 	return true;
 }
 
 void TelescopeClientDirectLx200::performCommunication()
 {
-	step(10000);
+	//The serial connection is handled by the ServerThread
 }
 
 void TelescopeClientDirectLx200::communicationResetReceived(void)
@@ -207,8 +239,18 @@ void TelescopeClientDirectLx200::decReceived(unsigned int dec_int)
 	queue_get_position = true;
 }
 
-void TelescopeClientDirectLx200::step(long long int timeout_micros)
+//! Called by the ServerThread before waiting for the device.
+void TelescopeClientDirectLx200::prepareStep(void)
 {
+	if (!lx200)
+		return;
+	
+	GotoCommand command;
+	while (gotoCommands.pop(command))
+	{
+		gotoReceived(command.ra_int, command.dec_int);
+	}
+	
 	long long int now = GetNow();
 	if (queue_get_position && now >= next_pos_time)
 	{
@@ -217,33 +259,31 @@ void TelescopeClientDirectLx200::step(long long int timeout_micros)
 		queue_get_position = false;
 		next_pos_time = now + 500000;// 500000;
 	}
-	Server::step(timeout_micros);
+}
+
+void TelescopeClientDirectLx200::connectionClosed(Socket *s)
+{
+	if (s == lx200)
+	{
+		lx200 = NULL;
+		connected.storeRelease(0);
+	}
 }
 
 bool TelescopeClientDirectLx200::isConnected(void) const
 {
-	return (!lx200->isClosed());//TODO
+	return (connected.loadAcquire() != 0);
 }
 
 bool TelescopeClientDirectLx200::isInitialized(void) const
 {
-	return (!lx200->isClosed());
+	return (connected.loadAcquire() != 0);
 }
 
 //Merged from Connection::sendPosition() and TelescopeTCP::performReading()
+//Called in the ServerThread, the position is converted in the main thread by prepareCommunication()
 void TelescopeClientDirectLx200::sendPosition(unsigned int ra_int, int dec_int, int status)
 {
-	//Server time is "now", because this class is the server
-	const qint64 server_micros = (qint64) getNow();
-	const double ra  =  ra_int * (M_PI/(unsigned int)0x80000000);
-	const double dec = dec_int * (M_PI/(unsigned int)0x80000000);
-	const double cdec = cos(dec);
-	Vec3d position(cos(ra)*cdec, sin(ra)*cdec, sin(dec));
-	Vec3d j2000Position = position;
-	if (equinox == EquinoxJNow)
-	{
-		const StelCore* core = StelApp::getInstance().getCore();
-		j2000Position = core->equinoxEquToJ2000(position, StelCore::RefractionOff);
-	}
-	interpolatedPosition.add(j2000Position, getNow(), server_micros, status);
+	const ReceivedPosition position = {ra_int, dec_int, status, getNow()};
+	receivedPositions.push(position);
 }
@@ -34,21 +34,21 @@
 #include "StelObject.hpp"
 
 #include "Server.hpp" //from the telescope server source tree
+#include "LockFreeQueue.hpp" //from the telescope server source tree
 #include "TelescopeClient.hpp" //from the plug-in's source tree
 
 class Lx200Connection;
 
 //! Telescope client that connects directly to a Meade LX200 through a serial port.
 //! This class has been created by merging the code of TelescopeTCP and ServerLx200.
+//! The serial connection is handled by the ServerThread, the positions and the
+//! goto commands are passed between it and the main thread with lock-free queues.
 class TelescopeClientDirectLx200 : public TelescopeClient, public Server
 {
 	Q_OBJECT
 public:
 	TelescopeClientDirectLx200(const QString &name, const QString &parameters, Equinox eq = EquinoxJ2000);
-	~TelescopeClientDirectLx200(void)
-	{
-		//hangup();
-	}
+	~TelescopeClientDirectLx200(void);
 	
 	//======================================================================
 	// Methods inherited from TelescopeClient
@@ -56,7 +56,7 @@ public:
 	
 	//======================================================================
 	// Methods inherited from Server
-	virtual void step(long long int timeout_micros);
+	void prepareStep(void);
 	void communicationResetReceived(void);
 	void longFormatUsedReceived(bool long_format);
 	void raReceived(unsigned int ra_int);
@@ -76,6 +76,7 @@ private:
 	void sendPosition(unsigned int ra_int, int dec_int, int status);
 	//TODO: Find out if this method is needed. It's called by Connection.
 	void gotoReceived(unsigned int ra_int, int dec_int);
+	void connectionClosed(Socket *s);
 	
 private:
 	void hangup(void);
@@ -98,6 +99,27 @@ private:
 	unsigned int last_ra;
 	bool queue_get_position;
 	long long int next_pos_time;
+	
+	//======================================================================
+	// Communication between the ServerThread and the main thread
+	struct ReceivedPosition
+	{
+		unsigned int ra_int;
+		int dec_int;
+		int status;
+		qint64 client_micros;
+	};
+	struct GotoCommand
+	{
+		unsigned int ra_int;
+		int dec_int;
+	};
+	//! Positions received by the ServerThread, converted by prepareCommunication()
+	LockFreeQueue<ReceivedPosition, 256> receivedPositions;
+	//! Goto commands given in the main thread, sent by prepareStep()
+	LockFreeQueue<GotoCommand, 16> gotoCommands;
+	//! Whether the serial connection is still open, set by the ServerThread
+	QAtomicInt connected;
 };
 
 #endif //_TELESCOPE_CLIENT_DIRECT_LX200_
@@ -34,6 +34,7 @@
 #include "StelObject.hpp"
 
 #include "Server.hpp" //from the telescope server source tree
+#include "LockFreeQueue.hpp" //from the telescope server source tree
 #include "TelescopeClient.hpp" //from the plug-in's source tree
 #include "InterpolatedPosition.hpp"
 
@@ -41,15 +42,14 @@ class NexStarConnection;
 
 //! Telescope client that connects directly to a Celestron NexStar through a serial port.
 //! This class has been created by merging the code of TelescopeTCP and ServerNexStar.
+//! The serial connection is handled by the ServerThread, the positions and the
+//! goto commands are passed between it and the main thread with lock-free queues.
 class TelescopeClientDirectNexStar : public TelescopeClient, public Server
 {
 	Q_OBJECT
 public:
 	TelescopeClientDirectNexStar(const QString &name, const QString &parameters, Equinox eq = EquinoxJ2000);
-	~TelescopeClientDirectNexStar(void)
-	{
-		//hangup();
-	}
+	~TelescopeClientDirectNexStar(void);
 	
 	//======================================================================
 	// Methods inherited from TelescopeClient
@@ -57,7 +57,7 @@ public:
 	
 	//======================================================================
 	// Methods inherited from Server
-	virtual void step(long long int timeout_micros);
+	void prepareStep(void);
 	void communicationResetReceived(void);
 	void raReceived(unsigned int ra_int);
 	void decReceived(unsigned int dec_int);
@@ -76,6 +76,7 @@ private:
 	void sendPosition(unsigned int ra_int, int dec_int, int status);
 	//TODO: Find out if this method is needed. It's called by Connection.
 	void gotoReceived(unsigned int ra_int, int dec_int);
+	void connectionClosed(Socket *s);
 	
 private:
 	void hangup(void);
@@ -96,6 +97,27 @@ private:
 	unsigned int last_ra;
 	bool queue_get_position;
 	long long int next_pos_time;
+	
+	//======================================================================
+	// Communication between the ServerThread and the main thread
+	struct ReceivedPosition
+	{
+		unsigned int ra_int;
+		int dec_int;
+		int status;
+		qint64 client_micros;
+	};
+	struct GotoCommand
+	{
+		unsigned int ra_int;
+		int dec_int;
+	};
+	//! Positions received by the ServerThread, converted by prepareCommunication()
+	LockFreeQueue<ReceivedPosition, 256> receivedPositions;
+	//! Goto commands given in the main thread, sent by prepareStep()
+	LockFreeQueue<GotoCommand, 16> gotoCommands;
+	//! Whether the serial connection is still open, set by the ServerThread
+	QAtomicInt connected;
 };
 
 #endif //_TELESCOPE_CLIENT_DIRECT_LX200_
@@ -0,0 +1,73 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ *
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _LOCK_FREE_QUEUE_HPP_
+#define _LOCK_FREE_QUEUE_HPP_
+
+#include <QAtomicInt>
+
+//! Queue of fixed capacity for exactly one producer thread and one consumer thread.
+//! It is used to hand over positions and commands between the ServerThread
+//! and the main thread, so that neither of them ever waits for the other.
+//! @tparam Size the queue holds at most Size-1 items.
+template<class T, int Size>
+class LockFreeQueue
+{
+public:
+	LockFreeQueue(void) : head(0), tail(0) {}
+	
+	//! Append an item. Must only be called by the producer thread.
+	//! @return false if the queue is full, the item is then dropped.
+	bool push(const T &item)
+	{
+		const int t = tail.load();
+		const int next = (t + 1) % Size;
+		if (next == head.loadAcquire())
+			return false;
+		items[t] = item;
+		tail.storeRelease(next);
+		return true;
+	}
+	
+	//! Take the oldest item. Must only be called by the consumer thread.
+	//! @return false if the queue is empty.
+	bool pop(T &item)
+	{
+		const int h = head.load();
+		if (h == tail.loadAcquire())
+			return false;
+		item = items[h];
+		head.storeRelease((h + 1) % Size);
+		return true;
+	}
+	
+private:
+	T items[Size];
+	//! Index of the next item to pop, only written by the consumer
+	QAtomicInt head;
+	//! Index of the next free place, only written by the producer
+	QAtomicInt tail;
+	
+	// no copying
+	LockFreeQueue(const LockFreeQueue&);
+	const LockFreeQueue &operator=(const LockFreeQueue&);
+};
+
+#endif //_LOCK_FREE_QUEUE_HPP_
@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 #define _LOG_FILE_H_
 
 #include <QTextStream>
+#include <QThreadStorage>
 
 long long int GetNow(void);
 
@@ -38,6 +39,33 @@ public:
 
 QTextStream &operator<<(QTextStream &o, const Now &now);
 
-extern QTextStream *log_file;
+//! Pointer to the log stream of the current thread.
+//! The main thread and the ServerThread select the log of the telescope
+//! they are working for, so each thread keeps its own stream.
+class LogFilePointer
+{
+public:
+	LogFilePointer &operator=(QTextStream *stream)
+	{
+		current.localData().stream = stream;
+		return *this;
+	}
+	QTextStream &operator*(void) const {return *get();}
+	QTextStream *get(void) const
+	{
+		return current.hasLocalData() ? current.localData().stream : NULL;
+	}
+	
+private:
+	struct Stream
+	{
+		Stream(void) : stream(NULL) {}
+		QTextStream *stream;
+	};
+	// QThreadStorage would delete a pointer, so it is wrapped
+	mutable QThreadStorage<Stream> current;
+};
+
+extern LogFilePointer log_file;
 
 #endif
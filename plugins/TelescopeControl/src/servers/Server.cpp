@@ -36,7 +36,13 @@ void Server::SocketList::clear(void)
 	list<Socket*>::clear();
 }
 
+Server::Server(void)
+	: server_log_file(log_file.get())
+{
+}
+
 Server::Server(int)
+	: server_log_file(log_file.get())
 {
 	//Socket *listener = new Listener(*this, port);
 	//socket_list.push_back(listener);
@@ -59,6 +65,7 @@ void Server::step(long long int timeout_micros)
 	FD_ZERO(&write_fds);
 	int fd_max = -1;
 	
+	prepareStep();
 	for (SocketList::const_iterator it(socket_list.begin());
 	     it != socket_list.end();
 	     it++)
@@ -74,21 +81,32 @@ void Server::step(long long int timeout_micros)
 	const int select_rc = select(fd_max+1, &read_fds, &write_fds, 0, &tv);
 	if (select_rc > 0)
 	{
-		SocketList::iterator it(socket_list.begin());
-		while (it != socket_list.end())
+		for (SocketList::const_iterator it(socket_list.begin());
+		     it != socket_list.end();
+		     it++)
 		{
 			(*it)->handleSelectFds(read_fds, write_fds);
-			if ((*it)->isClosed())
-			{
-				SocketList::iterator tmp(it);
-				it++;
-				delete (*tmp);
-				socket_list.erase(tmp);
-			}
-			else
-			{
-				it++;
-			}
+		}
+		removeClosedConnections();
+	}
+}
+
+void Server::removeClosedConnections(void)
+{
+	SocketList::iterator it(socket_list.begin());
+	while (it != socket_list.end())
+	{
+		if ((*it)->isClosed())
+		{
+			SocketList::iterator tmp(it);
+			it++;
+			connectionClosed(*tmp);
+			delete (*tmp);
+			socket_list.erase(tmp);
+		}
+		else
+		{
+			it++;
 		}
 	}
 }
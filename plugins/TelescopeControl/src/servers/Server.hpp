@@ -29,6 +29,7 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 using namespace std;
 
 class Socket;
+class QTextStream;
 
 //! Base class for telescope server classes. A true telescope server class
 //! should inherit Server and implement device-specific functions.
@@ -42,13 +43,20 @@ class Socket;
 //! a serial connection to the device. The step() method calls
 //! Socket::prepareSelectFds() and Socket::handleSelectFds() for each connection
 //! in the list. These methods are reimplemented for each class.
+//! Servers registered with ServerThread::addServer() are not stepped by their
+//! owner anymore, their connections are handled by the ServerThread instead.
 class Server
 {
 public:
-	Server(void) {}
+	Server(void);
 	Server(int port);
 	virtual ~Server(void) {}
 	virtual void step(long long int timeout_micros);
+	//! Called before waiting for I/O, by step() and by the ServerThread.
+	//! Reimplement it to queue periodic commands to the device.
+	virtual void prepareStep(void) {}
+	//! The log stream that was selected when the server was created.
+	QTextStream *getLogFile(void) const {return server_log_file;}
 	
 protected:
 	void sendPosition(unsigned int ra_int, int dec_int, int status);
@@ -63,6 +71,8 @@ protected:
 			socket_list.push_back(s);
 	}
 	void closeAcceptedConnections(void);
+	//! Called before a closed connection is removed from the list and deleted.
+	virtual void connectionClosed(Socket *) {}
 	friend class Listener;
 	
 private:
@@ -78,6 +88,12 @@ private:
 	};
 	//! A list of the connections maintained by the server.
 	SocketList socket_list;
+	
+	//! Deletes the connections that have been closed.
+	void removeClosedConnections(void);
+	friend class ServerThread;
+	
+	QTextStream *server_log_file;
 };
 
 #endif
@@ -0,0 +1,136 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ *
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "ServerThread.hpp"
+#include "Server.hpp"
+#include "Socket.hpp"
+#include "LogFile.hpp"
+
+// Longest time select() waits, which is also the longest delay before
+// a command queued by the main thread is seen by prepareStep(), and
+// before a server added or removed by the main thread is taken into account
+static const long STEP_TIMEOUT_MICROS = 10000;
+
+ServerThread *ServerThread::instance = NULL;
+QList<Server*> ServerThread::added_servers;
+
+void ServerThread::addServer(Server *server)
+{
+	if (!instance)
+	{
+		instance = new ServerThread();
+		instance->start();
+	}
+	QMutexLocker locker(&instance->mutex);
+	instance->pending_additions.append(server);
+	added_servers.append(server);
+}
+
+void ServerThread::removeServer(Server *server)
+{
+	if (!instance || !added_servers.removeOne(server))
+		return;
+	{
+		QMutexLocker locker(&instance->mutex);
+		if (instance->pending_additions.removeAll(server) == 0)
+		{
+			// The thread may be using the server, wait until it has dropped it
+			instance->pending_removals.append(server);
+			while (instance->pending_removals.contains(server))
+				instance->removals_done.wait(&instance->mutex);
+		}
+		if (!added_servers.isEmpty())
+			return;
+	}
+	instance->stop_requested.storeRelease(1);
+	instance->wait();
+	delete instance;
+	instance = NULL;
+}
+
+void ServerThread::updateServers(void)
+{
+	QMutexLocker locker(&mutex);
+	servers.append(pending_additions);
+	pending_additions.clear();
+	if (!pending_removals.isEmpty())
+	{
+		foreach (Server *server, pending_removals)
+			servers.removeAll(server);
+		pending_removals.clear();
+		removals_done.wakeAll();
+	}
+}
+
+void ServerThread::run(void)
+{
+	while (!stop_requested.loadAcquire())
+	{
+		updateServers();
+		fd_set read_fds, write_fds;
+		FD_ZERO(&read_fds);
+		FD_ZERO(&write_fds);
+		int fd_max = -1;
+		
+		foreach (Server *server, servers)
+		{
+			log_file = server->getLogFile();
+			server->prepareStep();
+			for (Server::SocketList::const_iterator it(server->socket_list.begin());
+			     it != server->socket_list.end();
+			     it++)
+			{
+				(*it)->prepareSelectFds(read_fds, write_fds, fd_max);
+			}
+		}
+		
+		if (fd_max < 0)
+		{
+			// Nothing to wait for, e.g. serial ports on Windows,
+			// which are read and written in prepareSelectFds()
+			foreach (Server *server, servers)
+			{
+				log_file = server->getLogFile();
+				server->removeClosedConnections();
+			}
+			usleep(STEP_TIMEOUT_MICROS);
+			continue;
+		}
+		
+		struct timeval tv;
+		tv.tv_sec = 0;
+		tv.tv_usec = STEP_TIMEOUT_MICROS;
+		const int select_rc = select(fd_max+1, &read_fds, &write_fds, 0, &tv);
+		if (select_rc > 0)
+		{
+			foreach (Server *server, servers)
+			{
+				log_file = server->getLogFile();
+				for (Server::SocketList::const_iterator it(server->socket_list.begin());
+				     it != server->socket_list.end();
+				     it++)
+				{
+					(*it)->handleSelectFds(read_fds, write_fds);
+				}
+				server->removeClosedConnections();
+			}
+		}
+	}
+}
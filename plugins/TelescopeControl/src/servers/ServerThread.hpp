@@ -0,0 +1,77 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ *
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _SERVER_THREAD_HPP_
+#define _SERVER_THREAD_HPP_
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+class Server;
+
+//! Thread handling the connections of all servers that talk directly to a device,
+//! like TelescopeClientDirectLx200 and TelescopeClientDirectNexStar.
+//! A single select() waits for the descriptors of all connections, so the
+//! devices are served as soon as they answer, independently of the frame rate,
+//! and the main thread never waits for I/O.
+//! Servers registered here are called from this thread only: Server::prepareStep(),
+//! the socket handlers and the callbacks of the device commands all run in it.
+//! Data going to and coming from the main thread has to be passed with a LockFreeQueue.
+class ServerThread : public QThread
+{
+public:
+	//! Start handling the connections of a server, starting the thread if needed.
+	//! Must be called from the main thread.
+	static void addServer(Server *server);
+	//! Stop handling the connections of a server. When the function returns,
+	//! the thread does not use the server anymore, so it can be deleted.
+	//! The thread is stopped when no servers are left.
+	//! Does nothing if the server was not added, e.g. when the client failed to open its port.
+	//! Must be called from the main thread.
+	static void removeServer(Server *server);
+	
+protected:
+	void run(void);
+	
+private:
+	ServerThread(void) : stop_requested(0) {}
+	//! Apply the pending additions and removals to the list of servers,
+	//! and wake up removeServer(). Called by the thread at the start of each step.
+	void updateServers(void);
+	
+	static ServerThread *instance;
+	//! Servers added and not removed, only used by the main thread
+	static QList<Server*> added_servers;
+	//! Servers handled by the thread, only used by the thread
+	QList<Server*> servers;
+	//! Protects the pending changes below. It is never held during select(),
+	//! so the main thread waits at most one step of the thread.
+	QMutex mutex;
+	QList<Server*> pending_additions;
+	QList<Server*> pending_removals;
+	//! Signaled when the thread has applied the pending removals
+	QWaitCondition removals_done;
+	QAtomicInt stop_requested;
+};
+
+#endif //_SERVER_THREAD_HPP_
@@ -0,0 +1,85 @@
+/*
+ * Stellarium Telescope Control Plug-in
+ *
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+
+#include "test/testServerThread.hpp"
+#include "Server.hpp"
+#include "ServerThread.hpp"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+QTEST_GUILESS_MAIN(TestServerThread)
+
+//! A server without connections, counting the steps of the ServerThread
+class CountingServer : public Server
+{
+public:
+	CountingServer(void) : steps(0) {}
+	void prepareStep(void) {steps.ref();}
+	QAtomicInt steps;
+private:
+	void gotoReceived(unsigned int, int) {}
+};
+
+//! Return true if the server is stepped again within one second
+static bool isStepped(CountingServer& server)
+{
+	const int start = server.steps.loadAcquire();
+	QElapsedTimer timer;
+	timer.start();
+	while (timer.elapsed() < 1000)
+	{
+		if (server.steps.loadAcquire() >= start+3)
+			return true;
+		QTest::qSleep(10);
+	}
+	return false;
+}
+
+void TestServerThread::testAddRemove()
+{
+	CountingServer first, second;
+	ServerThread::addServer(&first);
+	QVERIFY(isStepped(first));
+	ServerThread::addServer(&second);
+	QVERIFY(isStepped(second));
+
+	ServerThread::removeServer(&first);
+	// removeServer() returns once the thread dropped the server
+	const int steps = first.steps.loadAcquire();
+	QVERIFY(isStepped(second));
+	QCOMPARE(first.steps.loadAcquire(), steps);
+
+	ServerThread::removeServer(&second);
+}
+
+void TestServerThread::testRemoveUnknownServer()
+{
+	CountingServer running, neverAdded;
+	ServerThread::addServer(&running);
+	QVERIFY(isStepped(running));
+
+	ServerThread::removeServer(&neverAdded);
+	QVERIFY(isStepped(running));
+	QCOMPARE(neverAdded.steps.loadAcquire(), 0);
+
+	ServerThread::removeServer(&running);
+}
@@ -93,7 +93,16 @@ void CLIProcessor::parseCLIArgsPreConfig(const QStringList& argList)
 		          << "--projection-type       : Specify projection type, e.g. stereographic\n"
 		          << "--restore-defaults      : Delete existing config.ini and use defaults\n"
 		          << "--multires-image        : With filename / URL argument, specify a\n"
-		          << "                          multi-resolution image to load\n";
+		          << "                          multi-resolution image to load\n"
+		          << "--headless              : Render without a window, using the Qt offscreen\n"
+		          << "                          platform unless QT_QPA_PLATFORM is set\n"
+		          << "--benchmark             : With number of frames, render these frames as\n"
+		          << "                          fast as possible, log the frame times and quit\n"
+		          << "--benchmark-size        : Frame size for --benchmark, e.g. 1280x720\n"
+		          << "--benchmark-step        : Simulated seconds between benchmark frames\n"
+		          << "                          (default 1/30)\n"
+		          << "--benchmark-output      : Write the time of each benchmark frame to a CSV file\n"
+		          << "--benchmark-checksums   : Add an MD5 checksum of each frame to the output\n";
 		exit(0);
 	}
 
@@ -173,6 +182,10 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 	float fov;
 	QString landscapeId, homePlanet, longitude, latitude, skyDate, skyTime;
 	QString projectionType, screenshotDir, multiresImage, startupScript;
+	int benchmarkFrames;
+	double benchmarkStep;
+	QString benchmarkSize, benchmarkOutput;
+	bool benchmarkChecksums;
 #ifdef ENABLE_SPOUT
 	QString spoutStr, spoutName;
 #endif
@@ -193,6 +206,11 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 		screenshotDir = argsGetOptionWithArg(argList, "", "--screenshot-dir", "").toString();
 		multiresImage = argsGetOptionWithArg(argList, "", "--multires-image", "").toString();
 		startupScript = argsGetOptionWithArg(argList, "", "--startup-script", "").toString();
+		benchmarkFrames = argsGetOptionWithArg(argList, "", "--benchmark", 0).toInt();
+		benchmarkSize = argsGetOptionWithArg(argList, "", "--benchmark-size", "").toString();
+		benchmarkStep = argsGetOptionWithArg(argList, "", "--benchmark-step", 0.).toDouble();
+		benchmarkOutput = argsGetOptionWithArg(argList, "", "--benchmark-output", "").toString();
+		benchmarkChecksums = argsGetOption(argList, "", "--benchmark-checksums");
 #ifdef ENABLE_SPOUT
 		// For now, we default to spout=sky when no extra option is given. Later, we should also accept "all".
 		// Unfortunately, this still throws an exception when no optarg string is given.
@@ -266,6 +284,16 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 		qApp->setProperty("onetime_startup_script", startupScript);
 	}
 
+	if (benchmarkFrames>0)
+	{
+		// Will be observed in StelMainView::init()
+		qApp->setProperty("onetime_benchmark_frames", benchmarkFrames);
+		qApp->setProperty("onetime_benchmark_size", benchmarkSize);
+		qApp->setProperty("onetime_benchmark_step", benchmarkStep);
+		qApp->setProperty("onetime_benchmark_output", benchmarkOutput);
+		qApp->setProperty("onetime_benchmark_checksums", benchmarkChecksums);
+	}
+
 	if (fov>0.0) confSettings->setValue("navigation/init_fov", fov);
 	if (!projectionType.isEmpty()) confSettings->setValue("projection/type", projectionType);
 	if (!screenshotDir.isEmpty())
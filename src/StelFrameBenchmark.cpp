@@ -0,0 +1,134 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelFrameBenchmark.hpp"
+#include "StelOpenGL.hpp"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QTextStream>
+
+#include <algorithm>
+
+StelFrameBenchmark::StelFrameBenchmark(int frames, const QSize& frameSize, double timeStep, QObject* parent)
+	: QObject(parent)
+	, frames(frames)
+	, frameSize(frameSize)
+	, timeStep(timeStep)
+	, flagChecksums(false)
+{
+	times.reserve(frames);
+}
+
+StelFrameBenchmark* StelFrameBenchmark::fromCommandLine(QObject* parent)
+{
+	const int frames = qApp->property("onetime_benchmark_frames").toInt();
+	if (frames<=0)
+		return NULL;
+
+	QSize size(1280, 720);
+	const QStringList sizeStr = qApp->property("onetime_benchmark_size").toString().split('x');
+	if (sizeStr.size()==2 && sizeStr.at(0).toInt()>0 && sizeStr.at(1).toInt()>0)
+		size = QSize(sizeStr.at(0).toInt(), sizeStr.at(1).toInt());
+	else if (!sizeStr.first().isEmpty())
+		qWarning() << "WARNING: --benchmark-size argument has unrecognised format (I want WIDTHxHEIGHT), using" << size;
+
+	double step = qApp->property("onetime_benchmark_step").toDouble();
+	if (step<=0.)
+		step = 1./30.;
+
+	// random elements like meteors should be the same in every run
+	qsrand(1);
+
+	StelFrameBenchmark* benchmark = new StelFrameBenchmark(frames, size, step, parent);
+	benchmark->setOutputFile(qApp->property("onetime_benchmark_output").toString());
+	benchmark->setFlagChecksums(qApp->property("onetime_benchmark_checksums").toBool());
+	qDebug() << "Benchmark:" << frames << "frames of" << size << "with a time step of" << step << "s";
+	return benchmark;
+}
+
+double StelFrameBenchmark::beginFrame()
+{
+	timer.start();
+	return timeStep;
+}
+
+void StelFrameBenchmark::endFrame()
+{
+	if (isFinished())
+		return;
+
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	// The draw calls only queue the work, the frame is complete when the GL is done with it
+	gl->glFinish();
+	times.append(timer.nsecsElapsed()/1e6);
+
+	if (flagChecksums)
+	{
+		GLint viewport[4];
+		gl->glGetIntegerv(GL_VIEWPORT, viewport);
+		QByteArray pixels(viewport[2]*viewport[3]*4, 0);
+		gl->glReadPixels(viewport[0], viewport[1], viewport[2], viewport[3], GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		checksums.append(QCryptographicHash::hash(pixels, QCryptographicHash::Md5).toHex());
+	}
+
+	if (isFinished())
+	{
+		writeReport();
+		emit finished();
+	}
+}
+
+void StelFrameBenchmark::writeReport() const
+{
+	QVector<double> sorted = times;
+	std::sort(sorted.begin(), sorted.end());
+	double sum = 0.;
+	foreach (double t, times)
+		sum += t;
+	const int n = sorted.size();
+	qDebug() << qPrintable(QString("Benchmark: %1 frames in %2 s, mean %3 ms (%4 fps), median %5 ms, 95th percentile %6 ms, min %7 ms, max %8 ms")
+			       .arg(n).arg(sum/1000., 0, 'f', 3).arg(sum/n, 0, 'f', 3).arg(1000.*n/sum, 0, 'f', 1)
+			       .arg(sorted.at(n/2), 0, 'f', 3).arg(sorted.at(qMin(n-1, n*95/100)), 0, 'f', 3)
+			       .arg(sorted.first(), 0, 'f', 3).arg(sorted.last(), 0, 'f', 3));
+
+	if (outputFile.isEmpty())
+		return;
+	QFile file(outputFile);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+	{
+		qWarning() << "ERROR: cannot write benchmark results to" << QDir::toNativeSeparators(outputFile);
+		return;
+	}
+	QTextStream out(&file);
+	out << (flagChecksums ? "frame,ms,md5\n" : "frame,ms\n");
+	for (int i=0; i<n; ++i)
+	{
+		out << i << ',' << QString::number(times.at(i), 'f', 3);
+		if (flagChecksums)
+			out << ',' << checksums.at(i);
+		out << '\n';
+	}
+	qDebug() << "Benchmark results written to" << QDir::toNativeSeparators(outputFile);
+}
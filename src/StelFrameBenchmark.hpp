@@ -0,0 +1,81 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELFRAMEBENCHMARK_HPP_
+#define _STELFRAMEBENCHMARK_HPP_
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSize>
+#include <QStringList>
+#include <QVector>
+
+//! @class StelFrameBenchmark
+//! Renders a fixed number of frames back to back, and reports the time each frame took (CLI option --benchmark).
+//! The simulation advances by a fixed time step per frame instead of the wall clock time, so that together with
+//! --sky-date, --sky-time and a --startup-script driving the view, the same frames are rendered on every run.
+//! The time of a frame includes the update and draw calls of all modules, and waiting for the GL commands to finish.
+//! Optionally, an MD5 checksum of each rendered frame is recorded, which allows to compare the output of two runs.
+class StelFrameBenchmark : public QObject
+{
+	Q_OBJECT
+public:
+	//! @param frames the number of frames to render
+	//! @param frameSize the size of the view in pixels
+	//! @param timeStep the simulated time between two frames in seconds
+	StelFrameBenchmark(int frames, const QSize& frameSize, double timeStep, QObject* parent=NULL);
+
+	//! Create a benchmark from the options set by the CLIProcessor.
+	//! @return NULL if no benchmark was requested
+	static StelFrameBenchmark* fromCommandLine(QObject* parent=NULL);
+
+	//! Write the per-frame timings as CSV to this file instead of only logging a summary
+	void setOutputFile(const QString& path) {outputFile=path;}
+	//! Record an MD5 checksum of the pixels of each frame
+	void setFlagChecksums(bool b) {flagChecksums=b;}
+
+	const QSize& getFrameSize() const {return frameSize;}
+	bool isFinished() const {return times.size()>=frames;}
+
+	//! Call before updating the modules.
+	//! @return the time step to use for the update, in seconds
+	double beginFrame();
+	//! Call after drawing the modules, while the GL context and the framebuffer drawn to are still bound.
+	void endFrame();
+
+signals:
+	//! Emitted after the last frame, when the report has been written
+	void finished();
+
+private:
+	void writeReport() const;
+
+	int frames;
+	QSize frameSize;
+	double timeStep;
+	QString outputFile;
+	bool flagChecksums;
+
+	QElapsedTimer timer;
+	//! Frame times in milliseconds
+	QVector<double> times;
+	QStringList checksums;
+};
+
+#endif // _STELFRAMEBENCHMARK_HPP_
@@ -29,6 +29,7 @@
 #include "StelUtils.hpp"
 #include "StelActionMgr.hpp"
 #include "StelOpenGL.hpp"
+#include "StelFrameBenchmark.hpp"
 
 #include <QDebug>
 #include <QDir>
@@ -343,6 +344,9 @@ protected:
 		double dt = now - previousPaintTime;
 		//qDebug()<<"dt"<<dt;
 		previousPaintTime = now;
+		// benchmark frames are independent of the time it took to render the previous ones
+		if (mainView->benchmark)
+			dt = mainView->benchmark->beginFrame();
 
 		//important to call this, or Qt may have invalid state after we have drawn (wrong textures, etc...)
 		painter->beginNativePainting();
@@ -363,6 +367,8 @@ protected:
 		StelApp& app = StelApp::getInstance();
 		app.update(dt); // may also issue GL calls
 		app.draw();
+		if (mainView->benchmark)
+			mainView->benchmark->endFrame();
 		painter->endNativePainting();
 
 		mainView->drawEnded();
@@ -550,7 +556,8 @@ StelMainView::StelMainView(QSettings* settings)
 	  flagOverwriteScreenshots(false),
 	  screenShotPrefix("stellarium-"),
 	  screenShotDir(""),
-	  cursorTimeout(-1.f), flagCursorTimeout(false), maxfps(10000.f)
+	  cursorTimeout(-1.f), flagCursorTimeout(false), maxfps(10000.f),
+	  benchmark(NULL)
 {
 	setAttribute(Qt::WA_OpaquePaintEvent);
 	setAutoFillBackground(false);
@@ -752,6 +759,9 @@ void StelMainView::init()
 	stelApp->setGui(gui);
 
 	stelApp->init(conf);
+	benchmark = StelFrameBenchmark::fromCommandLine(this);
+	if (benchmark)
+		connect(benchmark, SIGNAL(finished()), stelApp, SLOT(quit()), Qt::QueuedConnection);
 	//this makes sure the app knows how large the window is
 	connect(stelScene,SIGNAL(sceneRectChanged(QRectF)),stelApp,SLOT(glWindowHasBeenResized(QRectF)));
 	//also immediately set the current values
@@ -785,6 +795,12 @@ void StelMainView::init()
 		     conf->value("video/screen_h", screenGeom.height()).toInt());
 
 	bool fullscreen = conf->value("video/fullscreen", true).toBool();
+	if (benchmark)
+	{
+		// all benchmark runs render frames of the same size
+		size = benchmark->getFrameSize();
+		fullscreen = false;
+	}
 
 	// Without this, the screen is not shown on a Mac + we should use resize() for correct work of fullscreen/windowed mode switch. --AW WTF???
 	resize(size);
@@ -1296,6 +1312,10 @@ void StelMainView::thereWasAnEvent()
 
 bool StelMainView::needsMaxFPS() const
 {
+	// A benchmark renders frames as fast as possible
+	if (benchmark)
+		return true;
+
 	const double now = StelApp::getTotalRunTime();
 
 	// Determines when the next display will need to be triggered
@@ -34,6 +34,7 @@ class StelGraphicsScene;
 class QMoveEvent;
 class QResizeEvent;
 class StelGuiBase;
+class StelFrameBenchmark;
 class QMoveEvent;
 class QSettings;
 
@@ -235,6 +236,9 @@ private:
 	float maxfps;
 	QTimer* minFpsTimer;
 
+	//! Set when running with the --benchmark option
+	StelFrameBenchmark* benchmark;
+
 #ifdef OPENGL_DEBUG_LOGGING
 	QOpenGLDebugLogger* glLogger;
 #endif
@@ -181,6 +181,8 @@ signals:
 	//! @param id The id of the action that was toggled
 	//! @param value The new value of the action
 	void actionToggled(const QString& id, bool value);
+	//! Emitted after a new action has been added with addAction() and connected to its target
+	void actionAdded(StelAction* action);
 
 	void shortcutsChanged();
 
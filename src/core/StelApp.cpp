@@ -22,6 +22,8 @@
 #include "StelCore.hpp"
 #include "StelMainView.hpp"
 #include "StelUtils.hpp"
+#include "StelStartupProfile.hpp"
+#include "StelModuleProfiler.hpp"
 #include "StelTextureMgr.hpp"
 #include "StelObjectMgr.hpp"
 #include "ConstellationMgr.hpp"
@@ -78,6 +80,7 @@
 #include <QTextStream>
 #include <QTimer>
 #include <QDir>
+#include <QtConcurrent>
 #include <QCoreApplication>
 #include <QScreen>
 #include <QDateTime>
@@ -220,6 +223,7 @@ StelApp::StelApp(StelMainView *parent)
 	, audioMgr(NULL)
 	, videoMgr(NULL)
 	, skyImageMgr(NULL)
+	, startupProfile(new StelStartupProfile())
 #ifndef DISABLE_SCRIPTING
 	, scriptAPIProxy(NULL)
 	, scriptMgr(NULL)
@@ -291,6 +295,7 @@ StelApp::~StelApp()
 	delete moduleMgr; moduleMgr=NULL; // Delete the secondary instance
 	delete actionMgr; actionMgr = NULL;
 	delete propMgr; propMgr = NULL;
+	delete startupProfile; startupProfile = NULL;
 
 	Q_ASSERT(singleton);
 	singleton = NULL;
@@ -423,6 +428,10 @@ void StelApp::init(QSettings* conf)
 
 	//create non-StelModule managers
 	propMgr = new StelPropertyMgr();
+	StelModuleProfiler* profiler = getModuleMgr().getProfiler();
+	propMgr->registerObject(profiler);
+	profiler->setFlagEnabled(confSettings->value("devel/flag_module_profiling", false).toBool());
+	profiler->setFlagGpuTiming(confSettings->value("devel/flag_module_gpu_profiling", false).toBool());
 	localeMgr = new StelLocaleMgr();
 	skyCultureMgr = new StelSkyCultureMgr();
 	propMgr->registerObject(skyCultureMgr);
@@ -431,91 +440,82 @@ void StelApp::init(QSettings* conf)
 
 	// Stel Object Data Base manager
 	stelObjectMgr = new StelObjectMgr();
-	stelObjectMgr->init();
-	getModuleMgr().registerModule(stelObjectMgr);	
+	initModule(stelObjectMgr);
 
 	localeMgr->init();
 
+	// The modules which spend most of their initialization on reading catalogs are created first,
+	// so that their data is loaded in worker threads while the modules before them are initialized.
+	StarMgr* hip_stars = new StarMgr();
+	NebulaMgr* nebulas = new NebulaMgr();
+	startPreloading(QList<StelModule*>() << hip_stars << nebulas);
+
 	// Init the solar system first
 	SolarSystem* ssystem = new SolarSystem();
-	ssystem->init();
-	getModuleMgr().registerModule(ssystem);
+	initModule(ssystem);
 
 	// Load hipparcos stars & names
-	StarMgr* hip_stars = new StarMgr();
-	hip_stars->init();
-	getModuleMgr().registerModule(hip_stars);
+	initModule(hip_stars);
 
-	core->init();
+	{
+		StelStartupProfile::Step step(startupProfile, "StelCore", "init");
+		core->init();
+	}
 
 	// Init nebulas
-	NebulaMgr* nebulas = new NebulaMgr();
-	nebulas->init();
-	getModuleMgr().registerModule(nebulas);
+	initModule(nebulas);
 
 	// Init milky way
 	MilkyWay* milky_way = new MilkyWay();
-	milky_way->init();
-	getModuleMgr().registerModule(milky_way);
+	initModule(milky_way);
 
 	// Init zodiacal light
 	ZodiacalLight* zodiacal_light = new ZodiacalLight();
-	zodiacal_light->init();
-	getModuleMgr().registerModule(zodiacal_light);
+	initModule(zodiacal_light);
 
 	// Init sky image manager
 	skyImageMgr = new StelSkyLayerMgr();
-	skyImageMgr->init();
-	getModuleMgr().registerModule(skyImageMgr);
+	initModule(skyImageMgr);
 
 	// Toast surveys
 	ToastMgr* toasts = new ToastMgr();
-	toasts->init();
-	getModuleMgr().registerModule(toasts);
+	initModule(toasts);
 
 	// Init audio manager
 	audioMgr = new StelAudioMgr();
 
 	// Init video manager
 	videoMgr = new StelVideoMgr();
-	videoMgr->init();
-	getModuleMgr().registerModule(videoMgr);
+	initModule(videoMgr);
 
 	// Constellations
 	ConstellationMgr* constellations = new ConstellationMgr(hip_stars);
-	constellations->init();
-	getModuleMgr().registerModule(constellations);
+	initModule(constellations);
 
 	// Asterisms
 	AsterismMgr* asterisms = new AsterismMgr(hip_stars);
-	asterisms->init();
-	getModuleMgr().registerModule(asterisms);
+	initModule(asterisms);
 
 	// Landscape, atmosphere & cardinal points section
 	LandscapeMgr* landscape = new LandscapeMgr();
-	landscape->init();
-	getModuleMgr().registerModule(landscape);
+	initModule(landscape);
 
 	GridLinesMgr* gridLines = new GridLinesMgr();
-	gridLines->init();
-	getModuleMgr().registerModule(gridLines);
+	initModule(gridLines);
 
 	// Sporadic Meteors
 	SporadicMeteorMgr* meteors = new SporadicMeteorMgr(10, 72);
-	meteors->init();
-	getModuleMgr().registerModule(meteors);
+	initModule(meteors);
 
 	// User labels
 	LabelMgr* skyLabels = new LabelMgr();
-	skyLabels->init();
-	getModuleMgr().registerModule(skyLabels);
+	initModule(skyLabels);
 
 	skyCultureMgr->init();
 
 	// Init custom objects
 	CustomObjectMgr* custObj = new CustomObjectMgr();
-	custObj->init();
-	getModuleMgr().registerModule(custObj);
+	initModule(custObj);
 
 	//Create the script manager here, maybe some modules/plugins may want to connect to it
 	//It has to be initialized later after all modules have been loaded by calling initScriptMgr
@@ -597,9 +597,53 @@ void StelApp::initPlugIns()
 		if (m!=NULL)
 		{
 			moduleMgr->registerModule(m, true);
+			StelStartupProfile::Step step(startupProfile, m->objectName(), "init");
 			m->init();
 		}
 	}
+
+	if (confSettings->value("devel/flag_startup_profile", false).toBool())
+		startupProfile->writeToFile(StelFileMgr::getUserDir() + "/startup_profile.json");
+}
+
+static void preloadModule(StelStartupProfile* profile, StelModule* m, QList<QFuture<void> > dependencies)
+{
+	for (int i=0; i<dependencies.size(); ++i)
+		dependencies[i].waitForFinished();
+	StelStartupProfile::Step step(profile, m->objectName(), "preload");
+	m->preload();
+}
+
+void StelApp::startPreloading(const QList<StelModule*>& modules)
+{
+	foreach (StelModule* m, modules)
+	{
+		QList<QFuture<void> > dependencies;
+		foreach (const QString& id, m->getPreloadDependencies())
+		{
+			// The dependencies were queued first, so the thread pool has started them already
+			// or will start them before this one, and waiting for them can't block all threads.
+			if (preloads.contains(id))
+				dependencies << preloads.value(id);
+			else
+				qWarning() << "The preload of" << m->objectName() << "depends on" << id << "which is not preloaded before, ignored";
+		}
+		preloads.insert(m->objectName(), QtConcurrent::run(preloadModule, startupProfile, m, dependencies));
+	}
+}
+
+void StelApp::initModule(StelModule* m)
+{
+	if (preloads.contains(m->objectName()))
+		preloads.value(m->objectName()).waitForFinished();
+	else
+		preloadModule(startupProfile, m, QList<QFuture<void> >());
+
+	{
+		StelStartupProfile::Step step(startupProfile, m->objectName(), "init");
+		m->init();
+	}
+	getModuleMgr().registerModule(m);
 }
 
 void StelApp::deinit()
@@ -615,6 +659,9 @@ void StelApp::deinit()
 	QCoreApplication::processEvents();
 	getModuleMgr().unloadAllPlugins();
 	QCoreApplication::processEvents();
+	// disabling the profiler releases its GL timer queries, which are deleted at the end of a frame
+	getModuleMgr().getProfiler()->setFlagEnabled(false);
+	getModuleMgr().getProfiler()->endFrame();
 	StelPainter::deinitGLShaders();
 }
 
@@ -655,9 +702,12 @@ void StelApp::update(double deltaTime)
 	moduleMgr->update();
 
 	// Send the event to every StelModule
+	StelModuleProfiler* profiler = moduleMgr->getProfiler();
 	foreach (StelModule* i, moduleMgr->getCallOrders(StelModule::ActionUpdate))
 	{
+		profiler->begin(i, StelModule::ActionUpdate);
 		i->update(deltaTime);
+		profiler->end();
 	}
 
 	stelObjectMgr->update(deltaTime);
@@ -699,11 +749,15 @@ void StelApp::draw()
 
 	core->preDraw();
 
+	StelModuleProfiler* profiler = moduleMgr->getProfiler();
 	const QList<StelModule*> modules = moduleMgr->getCallOrders(StelModule::ActionDraw);
 	foreach(StelModule* module, modules)
 	{
+		profiler->begin(module, StelModule::ActionDraw);
 		module->draw(core);
+		profiler->end();
 	}
+	profiler->endFrame();
 	core->postDraw();
 #ifdef ENABLE_SPOUT
 	// At this point, the sky scene has been drawn, but no GUI panels.
@@ -22,6 +22,8 @@
 
 #include <QString>
 #include <QObject>
+#include <QFuture>
+#include <QMap>
 #include "StelModule.hpp"
 
 // Predeclaration of some classes
@@ -49,6 +51,7 @@ class StelScriptMgr;
 class StelActionMgr;
 class StelPropertyMgr;
 class StelProgressController;
+class StelStartupProfile;
 
 #ifdef 	ENABLE_SPOUT
 class SpoutSender;
@@ -134,6 +137,11 @@ public:
 	//! Return the property manager
 	StelPropertyMgr* getStelPropertyManager() {return propMgr;}
 
+	//! Get the timeline of the preloading and the initialization of the modules.
+	//! It is written to startup_profile.json in the user directory after the plugins are initialized
+	//! if devel/flag_startup_profile is set in the configuration.
+	const StelStartupProfile* getStartupProfile() const {return startupProfile;}
+
 	//! Get the video manager
 	StelVideoMgr* getStelVideoMgr() {return videoMgr;}
 
@@ -341,6 +349,17 @@ private:
 
 	StelSkyLayerMgr* skyImageMgr;
 
+	//! Start the preload() of the modules in the global thread pool. The preload of a module starts once
+	//! the preload of its dependencies finished, which have to be started before by this method.
+	void startPreloading(const QList<StelModule*>& modules);
+	//! Wait for the preload of the module to finish, or preload it right away if it wasn't started,
+	//! then initialize it and register it with the module manager.
+	void initModule(StelModule* m);
+
+	StelStartupProfile* startupProfile;
+	//! Preloads started by startPreloading(), by module ID
+	QMap<QString, QFuture<void> > preloads;
+
 #ifndef DISABLE_SCRIPTING
 	// The script API proxy object (for bridging threads)
 	StelMainScriptAPIProxy* scriptAPIProxy;
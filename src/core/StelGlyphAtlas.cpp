@@ -0,0 +1,212 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelGlyphAtlas.hpp"
+
+#include <QDebug>
+#include <QFont>
+#include <QGlyphRun>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QPainter>
+#include <QRawFont>
+#include <QTextLayout>
+#include <QtMath>
+
+// Cost limit of the layout cache, in glyphs
+static const int LAYOUT_CACHE_LIMIT = 50000;
+// Free space around each glyph, so that linear filtering of rotated text doesn't pick up the neighbours
+static const int GLYPH_PADDING = 1;
+
+StelGlyphAtlas::StelGlyphAtlas(int size)
+	: atlasSize(size)
+	, image(size, size, QImage::Format_RGBA8888)
+	, texture(0)
+	, dirtyTop(size)
+	, dirtyBottom(0)
+	, shelfX(0)
+	, shelfY(0)
+	, shelfHeight(0)
+	, layouts(LAYOUT_CACHE_LIMIT)
+{
+	image.fill(Qt::transparent);
+}
+
+StelGlyphAtlas::~StelGlyphAtlas()
+{
+	if (texture)
+		qWarning() << "StelGlyphAtlas: texture was not deleted";
+}
+
+const StelGlyphAtlas::TextLayout* StelGlyphAtlas::layoutText(const QString& str, const QFont& font)
+{
+	const QByteArray key = str.toUtf8() + '\0' + font.key().toUtf8();
+	const TextLayout* cached = layouts.object(key);
+	if (cached)
+		return cached;
+
+	QTextLayout textLayout(str, font);
+	textLayout.beginLayout();
+	QTextLine line = textLayout.createLine();
+	textLayout.endLayout();
+
+	TextLayout* result = new TextLayout();
+	if (line.isValid())
+	{
+		// Qt positions the glyphs with y pointing down from the top of the line
+		const qreal ascent = line.ascent();
+		foreach (const QGlyphRun& run, textLayout.glyphRuns())
+		{
+			const QRawFont rawFont = run.rawFont();
+			const QVector<quint32> indexes = run.glyphIndexes();
+			const QVector<QPointF> positions = run.positions();
+			for (int i=0; i<indexes.size(); ++i)
+			{
+				const Glyph* glyph = getGlyph(rawFont, indexes.at(i));
+				if (!glyph)
+				{
+					delete result;
+					return NULL;
+				}
+				if (glyph->size.isEmpty())
+					continue;
+
+				const int originX = qRound(positions.at(i).x());
+				const int originY = qRound(ascent - positions.at(i).y());
+				GlyphQuad quad;
+				quad.rect = QRect(originX + glyph->offset.x(), originY - glyph->offset.y() - glyph->size.height(), glyph->size.width(), glyph->size.height());
+				quad.texRect = QRectF((qreal)glyph->pos.x()/atlasSize, (qreal)glyph->pos.y()/atlasSize,
+						      (qreal)glyph->size.width()/atlasSize, (qreal)glyph->size.height()/atlasSize);
+				result->append(quad);
+			}
+		}
+	}
+
+	// the cache owns the layout now, and may evict it on the next insert
+	layouts.insert(key, result, qMin(result->size()+1, LAYOUT_CACHE_LIMIT));
+	return result;
+}
+
+const StelGlyphAtlas::Glyph* StelGlyphAtlas::getGlyph(const QRawFont& rawFont, quint32 glyphIndex)
+{
+	const QString key = QString("%1|%2|%3|%4").arg(rawFont.familyName()).arg(rawFont.styleName()).arg(rawFont.pixelSize()).arg(glyphIndex);
+	QHash<QString, Glyph>::const_iterator it = glyphs.constFind(key);
+	if (it!=glyphs.constEnd())
+		return &it.value();
+
+	Glyph glyph;
+	const QRectF br = rawFont.boundingRect(glyphIndex);
+	if (!br.isEmpty())
+	{
+		glyph.offset = QPoint(qFloor(br.left())-GLYPH_PADDING, qFloor(br.top())-GLYPH_PADDING);
+		glyph.size = QSize(qCeil(br.right())+GLYPH_PADDING-glyph.offset.x(), qCeil(br.bottom())+GLYPH_PADDING-glyph.offset.y());
+		if (glyph.size.width()>atlasSize || glyph.size.height()>atlasSize)
+		{
+			qWarning() << "StelGlyphAtlas: glyph too large for the atlas, skipped" << glyph.size;
+			glyph.size = QSize();
+		}
+	}
+
+	if (!glyph.size.isEmpty())
+	{
+		if (!allocate(glyph.size, glyph.pos))
+			return NULL;
+
+		QGlyphRun run;
+		run.setRawFont(rawFont);
+		run.setGlyphIndexes(QVector<quint32>() << glyphIndex);
+		run.setPositions(QVector<QPointF>() << QPointF(glyph.pos.x()-glyph.offset.x(), glyph.pos.y()-glyph.offset.y()));
+		QPainter painter(&image);
+		painter.setPen(Qt::white);
+		painter.drawGlyphRun(QPointF(0, 0), run);
+		painter.end();
+
+		dirtyTop = qMin(dirtyTop, glyph.pos.y());
+		dirtyBottom = qMax(dirtyBottom, glyph.pos.y()+glyph.size.height());
+	}
+
+	return &glyphs.insert(key, glyph).value();
+}
+
+bool StelGlyphAtlas::allocate(const QSize& size, QPoint& pos)
+{
+	const int w = size.width()+GLYPH_PADDING;
+	const int h = size.height()+GLYPH_PADDING;
+	if (shelfX+w>atlasSize)
+	{
+		// start a new shelf
+		shelfY += shelfHeight;
+		shelfX = 0;
+		shelfHeight = 0;
+	}
+	if (shelfX+w>atlasSize || shelfY+h>atlasSize)
+		return false;
+
+	pos = QPoint(shelfX, shelfY);
+	shelfX += w;
+	shelfHeight = qMax(shelfHeight, h);
+	return true;
+}
+
+void StelGlyphAtlas::clear()
+{
+	glyphs.clear();
+	layouts.clear();
+	image.fill(Qt::transparent);
+	shelfX = shelfY = shelfHeight = 0;
+	// the stale texture content is overwritten by new glyphs before it is used again
+	dirtyTop = atlasSize;
+	dirtyBottom = 0;
+}
+
+void StelGlyphAtlas::bind()
+{
+	QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+	if (!texture)
+	{
+		gl->glGenTextures(1, &texture);
+		gl->glBindTexture(GL_TEXTURE_2D, texture);
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlasSize, atlasSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.constBits());
+		dirtyTop = atlasSize;
+		dirtyBottom = 0;
+		return;
+	}
+
+	gl->glBindTexture(GL_TEXTURE_2D, texture);
+	if (dirtyBottom>dirtyTop)
+	{
+		// only the rows containing new glyphs are uploaded
+		gl->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, dirtyTop, atlasSize, dirtyBottom-dirtyTop, GL_RGBA, GL_UNSIGNED_BYTE, image.constScanLine(dirtyTop));
+		dirtyTop = atlasSize;
+		dirtyBottom = 0;
+	}
+}
+
+void StelGlyphAtlas::deleteTexture()
+{
+	if (texture)
+	{
+		QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &texture);
+		texture = 0;
+	}
+}
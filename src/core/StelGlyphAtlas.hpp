@@ -0,0 +1,106 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELGLYPHATLAS_HPP_
+#define _STELGLYPHATLAS_HPP_
+
+#include "StelOpenGL.hpp"
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QRect>
+#include <QRectF>
+#include <QVector>
+
+class QFont;
+class QRawFont;
+
+//! @class StelGlyphAtlas
+//! A single texture holding the rasterized glyphs of all text drawn by StelPainter in text texture mode (CLI option -t).
+//! Each glyph of a font is rendered only once into the atlas. A string is laid out once per font,
+//! the resulting list of glyph quads is cached, so drawing a known label only appends vertices to a batch.
+//! When the atlas is full, it has to be cleared with clear(), after which it fills up again with the glyphs in use.
+class StelGlyphAtlas
+{
+public:
+	//! A glyph of a laid out string
+	struct GlyphQuad
+	{
+		//! Position and size in pixels, relative to the start of the baseline of the string, with the y axis pointing up.
+		//! The y coordinate is the bottom of the glyph.
+		QRect rect;
+		//! Texture coordinates in the atlas, the top of the rect is the top of the glyph
+		QRectF texRect;
+	};
+	typedef QVector<GlyphQuad> TextLayout;
+
+	//! @param size the width and height of the atlas texture in pixels
+	explicit StelGlyphAtlas(int size=1024);
+	~StelGlyphAtlas();
+
+	//! Get the glyph quads of a string drawn with the given font, rendering the missing glyphs into the atlas.
+	//! @return NULL if the atlas is full. The returned layout is only valid until the next call.
+	const TextLayout* layoutText(const QString& str, const QFont& font);
+
+	//! Remove all glyphs and cached layouts.
+	//! Quads obtained before must not be drawn after that, as their space will be reused for other glyphs.
+	void clear();
+
+	//! Upload the glyphs added since the last call, and bind the atlas texture to the current texture unit.
+	//! Requires a current GL context.
+	void bind();
+
+	//! Delete the GL texture. Requires the GL context used by bind().
+	void deleteTexture();
+
+private:
+	struct Glyph
+	{
+		//! Top left corner in the atlas
+		QPoint pos;
+		//! Offset of the top left corner of the glyph image from the glyph origin, in Qt coordinates (y pointing down)
+		QPoint offset;
+		QSize size;
+	};
+
+	//! @return NULL if the glyph doesn't fit into the atlas anymore
+	const Glyph* getGlyph(const QRawFont& rawFont, quint32 glyphIndex);
+	//! Find free space using simple shelf packing, as glyphs of a font have similar heights
+	bool allocate(const QSize& size, QPoint& pos);
+
+	int atlasSize;
+	QImage image;
+	GLuint texture;
+
+	//! Rows of the image which have to be uploaded on the next bind()
+	int dirtyTop;
+	int dirtyBottom;
+
+	int shelfX;
+	int shelfY;
+	int shelfHeight;
+
+	//! Rendered glyphs, by font and glyph index
+	QHash<QString, Glyph> glyphs;
+	//! Laid out strings, by string and font
+	QCache<QByteArray, TextLayout> layouts;
+};
+
+#endif // _STELGLYPHATLAS_HPP_
@@ -37,10 +37,16 @@
 #include <QUrl>
 #include <QUrlQuery>
 #include <QSettings>
+#include <QSet>
 #include <QTimeZone>
 
 TimezoneNameMap StelLocationMgr::locationDBToIANAtranslations;
 
+// Size of the cells of the location index in degrees
+static const float INDEX_CELL_SIZE = 2.f;
+static const int INDEX_LAT_CELLS = 90;
+static const int INDEX_LON_CELLS = 180;
+
 #ifdef ENABLE_GPS
 #ifdef ENABLE_LIBGPS
 LibGPSLookupHelper::LibGPSLookupHelper(QObject *parent)
@@ -296,7 +302,7 @@ void NMEALookupHelper::nmeaTimeout()
 #endif
 
 StelLocationMgr::StelLocationMgr()
-	: nmeaHelper(NULL), libGpsHelper(NULL)
+	: indexValid(false), nmeaHelper(NULL), libGpsHelper(NULL)
 {
 	// initialize the static QMap first if necessary.
 	if (locationDBToIANAtranslations.count()==0)
@@ -359,7 +365,7 @@ StelLocationMgr::~StelLocationMgr()
 }
 
 StelLocationMgr::StelLocationMgr(const LocationList &locations)
-	: nmeaHelper(NULL), libGpsHelper(NULL)
+	: indexValid(false), nmeaHelper(NULL), libGpsHelper(NULL)
 {
 	setLocations(locations);
 
@@ -374,6 +380,7 @@ void StelLocationMgr::setLocations(const LocationList &locations)
 	{
 		this->locations.insert(it->getID(),*it);
 	}
+	indexValid = false;
 
 	emit locationListChanged();
 }
@@ -418,29 +425,39 @@ LocationMap StelLocationMgr::loadCitiesBin(const QString& fileName)
 		in.setVersion(QDataStream::Qt_5_2);
 		in >> res;
 	}
+	internStrings(res);
+
 	// Now res has all location data. However, some timezone names are not available in various versions of Qt.
 	// Sanity checks: It seems we must translate timezone names. Quite a number on Windows, but also still some on Linux.
-	QList<QByteArray> availableTimeZoneList=QTimeZone::availableTimeZoneIds();
+	// The database only uses a few hundred different names, so each of them is only checked once.
+	const QList<QByteArray> availableTimeZoneIds=QTimeZone::availableTimeZoneIds();
+	const QSet<QByteArray> availableTimeZones=availableTimeZoneIds.toSet();
+	QHash<QString, QString> checkedTZnames;
 	QStringList unknownTZlist;
 	QMap<QString, StelLocation>::iterator i=res.begin();
 	while (i!=res.end())
 	{
-		StelLocation loc=i.value();
-		if ((loc.ianaTimeZone!="LMST") &&  (loc.ianaTimeZone!="LTST") && ( ! availableTimeZoneList.contains(loc.ianaTimeZone.toUtf8())) )
+		const QString& tzName=i.value().ianaTimeZone;
+		QHash<QString, QString>::const_iterator checked=checkedTZnames.constFind(tzName);
+		if (checked==checkedTZnames.constEnd())
 		{
-			// TZ name which is currently unknown to Qt detected. See if we can translate it, if not: complain to qDebug().
-			QString fixTZname=sanitizeTimezoneStringFromLocationDB(loc.ianaTimeZone);
-			if (availableTimeZoneList.contains(fixTZname.toUtf8()))
+			QString fixTZname=tzName;
+			if ((tzName!="LMST") &&  (tzName!="LTST") && ( ! availableTimeZones.contains(tzName.toUtf8())) )
 			{
-				loc.ianaTimeZone=fixTZname;
-				i.value() = loc;
-			}
-			else
-			{
-				qDebug() << "StelLocationMgr::loadCitiesBin(): TimeZone for " << loc.name <<  " not found: " << loc.ianaTimeZone;
-				unknownTZlist.append(loc.ianaTimeZone);
+				// TZ name which is currently unknown to Qt detected. See if we can translate it, if not: complain to qDebug().
+				fixTZname=sanitizeTimezoneStringFromLocationDB(tzName);
+				if (!availableTimeZones.contains(fixTZname.toUtf8()))
+				{
+					unknownTZlist.append(tzName);
+					fixTZname=tzName;
+				}
 			}
+			checked=checkedTZnames.insert(tzName, fixTZname);
 		}
+		if (checked.value()!=tzName)
+			i.value().ianaTimeZone=checked.value();
+		else if (unknownTZlist.contains(tzName))
+			qDebug() << "StelLocationMgr::loadCitiesBin(): TimeZone for " << i.value().name <<  " not found: " << tzName;
 		++i;
 	}
 	if (unknownTZlist.length()>0)
@@ -597,6 +614,7 @@ bool StelLocationMgr::saveUserLocation(const StelLocation& loc)
 
 	// Add in the program
 	locations[loc.getID()]=loc;
+	indexValid = false;
 
 	//emit before saving the list
 	emit locationListChanged();
@@ -655,6 +673,7 @@ bool StelLocationMgr::deleteUserLocation(const QString& id)
 		return false;
 
 	locations.remove(id);
+	indexValid = false;
 
 	//emit before saving the list
 	emit locationListChanged();
@@ -802,18 +821,82 @@ void StelLocationMgr::changeLocationFromNetworkLookup()
 	networkReply->deleteLater();
 }
 
+void StelLocationMgr::internStrings(LocationMap& locations)
+{
+	// The locations are copies of each other's strings afterwards, so the data of each string is only stored once
+	QSet<QString> strings;
+	for (LocationMap::iterator iter=locations.begin(); iter!=locations.end(); ++iter)
+	{
+		StelLocation& loc = iter.value();
+		loc.country = *strings.insert(loc.country);
+		loc.state = *strings.insert(loc.state);
+		loc.planetName = *strings.insert(loc.planetName);
+		loc.ianaTimeZone = *strings.insert(loc.ianaTimeZone);
+	}
+}
+
+void StelLocationMgr::updateIndex()
+{
+	if (indexValid)
+		return;
+
+	cellIndex.clear();
+	countryIndex.clear();
+	for (LocationMap::const_iterator iter=locations.constBegin(); iter!=locations.constEnd(); ++iter)
+	{
+		const StelLocation& loc = iter.value();
+		countryIndex[loc.country].append(iter.key());
+
+		QVector<IndexCell>& cells = cellIndex[loc.planetName];
+		if (cells.isEmpty())
+			cells.resize(INDEX_LAT_CELLS*INDEX_LON_CELLS);
+		const int latCell = qBound(0, (int)std::floor((loc.latitude+90.f)/INDEX_CELL_SIZE), INDEX_LAT_CELLS-1);
+		const int lonCell = qBound(0, (int)std::floor((loc.longitude+180.f)/INDEX_CELL_SIZE), INDEX_LON_CELLS-1);
+		IndexedLocation entry;
+		entry.id = iter.key();
+		entry.longitude = loc.longitude;
+		entry.latitude = loc.latitude;
+		cells[latCell*INDEX_LON_CELLS+lonCell].append(entry);
+	}
+	indexValid = true;
+}
+
 LocationMap StelLocationMgr::pickLocationsNearby(const QString planetName, const float longitude, const float latitude, const float radiusDegrees)
 {
 	QMap<QString, StelLocation> results;
-	QMapIterator<QString, StelLocation> iter(locations);
-	while (iter.hasNext())
+	updateIndex();
+	QHash<QString, QVector<IndexCell> >::const_iterator planetCells = cellIndex.constFind(planetName);
+	if (planetCells==cellIndex.constEnd())
+		return results;
+	const QVector<IndexCell>& cells = planetCells.value();
+
+	// The cells overlapping the bounding box of the circle, in longitude the box grows towards the poles
+	const int latBegin = qMax(0, (int)std::floor((latitude-radiusDegrees+90.f)/INDEX_CELL_SIZE));
+	const int latEnd = qMin(INDEX_LAT_CELLS-1, (int)std::floor((latitude+radiusDegrees+90.f)/INDEX_CELL_SIZE));
+	const float maxLatitude = std::fabs(latitude)+radiusDegrees;
+	int lonBegin = 0;
+	int lonEnd = INDEX_LON_CELLS-1;
+	if (maxLatitude<90.f)
+	{
+		const float lonRadius = radiusDegrees/std::cos(maxLatitude*M_PI/180.f);
+		if (lonRadius<180.f)
+		{
+			lonBegin = (int)std::floor((longitude-lonRadius+180.f)/INDEX_CELL_SIZE);
+			lonEnd = (int)std::floor((longitude+lonRadius+180.f)/INDEX_CELL_SIZE);
+		}
+	}
+
+	for (int latCell=latBegin; latCell<=latEnd; ++latCell)
 	{
-		iter.next();
-		const StelLocation *loc=&iter.value();
-		if ( (loc->planetName == planetName) &&
-				(StelLocation::distanceDegrees(longitude, latitude, loc->longitude, loc->latitude) <= radiusDegrees) )
+		for (int lonCell=lonBegin; lonCell<=lonEnd; ++lonCell)
 		{
-			results.insert(iter.key(), iter.value());
+			// wrap around the date line
+			const int wrappedLonCell = (lonCell%INDEX_LON_CELLS+INDEX_LON_CELLS)%INDEX_LON_CELLS;
+			foreach (const IndexedLocation& entry, cells.at(latCell*INDEX_LON_CELLS+wrappedLonCell))
+			{
+				if (StelLocation::distanceDegrees(longitude, latitude, entry.longitude, entry.latitude) <= radiusDegrees)
+					results.insert(entry.id, locations.value(entry.id));
+			}
 		}
 	}
 	return results;
@@ -822,16 +905,9 @@ LocationMap StelLocationMgr::pickLocationsNearby(const QString planetName, const
 LocationMap StelLocationMgr::pickLocationsInCountry(const QString country)
 {
 	QMap<QString, StelLocation> results;
-	QMapIterator<QString, StelLocation> iter(locations);
-	while (iter.hasNext())
-	{
-		iter.next();
-		const StelLocation *loc=&iter.value();
-		if (loc->country == country)
-		{
-			results.insert(iter.key(), iter.value());
-		}
-	}
+	updateIndex();
+	foreach (const QString& id, countryIndex.value(country))
+		results.insert(id, locations.value(id));
 	return results;
 }
 
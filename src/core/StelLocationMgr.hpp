@@ -24,6 +24,8 @@
 #include <QObject>
 #include <QMetaType>
 #include <QMap>
+#include <QHash>
+#include <QVector>
 
 typedef QList<StelLocation> LocationList;
 typedef QMap<QString,StelLocation> LocationMap;
@@ -79,6 +81,7 @@ public:
 	bool deleteUserLocation(const QString& id);
 
 	//! Find list of locations within @param radiusDegrees of selected (usually screen-clicked) coordinates.
+	//! Only the cells of the location index near the given coordinates are searched.
 	LocationMap pickLocationsNearby(const QString planetName, const float longitude, const float latitude, const float radiusDegrees);
 	//! Find list of locations in a particular country only.
 	LocationMap pickLocationsInCountry(const QString country);
@@ -133,9 +136,29 @@ private:
 	//! Load cities from a file
 	static LocationMap loadCities(const QString& fileName, bool isUserLocation);
 	static LocationMap loadCitiesBin(const QString& fileName);
+	//! Make the locations share a single copy of their repeated strings (country, planet, time zone...)
+	static void internStrings(LocationMap& locations);
+
+	//! An entry of the location index
+	struct IndexedLocation
+	{
+		QString id;
+		float longitude;
+		float latitude;
+	};
+	typedef QVector<IndexedLocation> IndexCell;
+	//! Build the location index if the list of locations changed since it was last built
+	void updateIndex();
 
 	//! The list of all loaded locations
 	LocationMap locations;
+	//! Whether the index below matches the location list
+	bool indexValid;
+	//! For each planet, the locations sorted into cells of INDEX_CELL_SIZE degrees of latitude and longitude.
+	//! The cell for a position is at [latitude cell*INDEX_LON_CELLS + longitude cell].
+	QHash<QString, QVector<IndexCell> > cellIndex;
+	//! The IDs of the locations of each country
+	QHash<QString, QStringList> countryIndex;
 	//! A Map which has to be used to replace, system- and Qt-version dependent,
 	//! timezone names from our location database to the code names currently used by Qt.
 	//! Required to avoid https://bugs.launchpad.net/stellarium/+bug/1662132,
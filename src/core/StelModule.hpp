@@ -21,6 +21,7 @@
 #define _STELMODULE_HPP_
 
 #include <QString>
+#include <QStringList>
 #include <QObject>
 
 // Predeclaration
@@ -63,6 +64,15 @@ public:
 	//! If the initialization takes significant time, the progress should be displayed on the loading bar.
 	virtual void init() = 0;
 
+	//! Load the data of the module which needs neither the GL context nor other modules, like parsing catalog files.
+	//! StelApp calls this in a worker thread, while other modules are initialized, and calls init() only after it finished.
+	//! It must therefore not use the settings, the GUI, GL, or the state of other modules.
+	//! The default implementation does nothing.
+	virtual void preload() {;}
+
+	//! Get the IDs of the modules whose preload() has to finish before the preload() of this module starts.
+	virtual QStringList getPreloadDependencies() const {return QStringList();}
+
 	//! Called before the module will be delete, and before the openGL context is suppressed.
 	//! Deinitialize all openGL texture in this method.
 	virtual void deinit() {;}
@@ -23,6 +23,7 @@
 #include <QDir>
 
 #include "StelModuleMgr.hpp"
+#include "StelModuleProfiler.hpp"
 #include "StelApp.hpp"
 #include "StelModule.hpp"
 #include "StelFileMgr.hpp"
@@ -34,6 +35,7 @@
 
 StelModuleMgr::StelModuleMgr() : callingListsToRegenerate(true), pluginDescriptorListLoaded(false)
 {
+	profiler = new StelModuleProfiler(this);
 	qRegisterMetaType<StelModule::StelModuleSelectAction>("StelModule::StelModuleSelectAction");
 	// Initialize empty call lists for each possible actions
 	callOrders[StelModule::ActionDraw]=QList<StelModule*>();
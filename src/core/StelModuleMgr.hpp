@@ -26,6 +26,8 @@
 #include "StelModule.hpp"
 #include "StelPluginInterface.hpp"
 
+class StelModuleProfiler;
+
 //! @def GETSTELMODULE(m)
 //! Return a pointer on a StelModule from its QMetaObject name @a m
 #define GETSTELMODULE( m ) (( m *)StelApp::getInstance().getModuleMgr().getModule( #m ))
@@ -81,6 +83,9 @@ public:
 		return callOrders[action];
 	}
 
+	//! Get the profiler measuring the update() and draw() calls of the modules
+	StelModuleProfiler* getProfiler() {return profiler;}
+
 	//! Contains the information read from the module.ini file
 	struct PluginDescriptor
 	{
@@ -116,6 +121,8 @@ private:
 
 	QMap<QString, StelModuleMgr::PluginDescriptor> pluginDescriptorList;
 	bool pluginDescriptorListLoaded;
+
+	StelModuleProfiler* profiler;
 };
 
 #endif // _STELMODULEMGR_HPP_
@@ -0,0 +1,341 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelModuleProfiler.hpp"
+#include "StelPainter.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#ifndef QT_OPENGL_ES_2
+#include <QOpenGLTimerQuery>
+#endif
+
+#include <algorithm>
+
+static QString actionName(StelModule::StelModuleActionName action)
+{
+	switch (action)
+	{
+		case StelModule::ActionDraw:
+			return "draw";
+		case StelModule::ActionUpdate:
+			return "update";
+		default:
+			return QString::number(action);
+	}
+}
+
+StelModuleProfiler::ActionStats::ActionStats()
+	: action(StelModule::ActionDraw)
+	, next(0)
+	, nextGpu(0)
+	, currentQuery(-1)
+{
+	for (int i=0; i<GPU_QUERIES; ++i)
+	{
+		queries[i] = NULL;
+		pending[i] = false;
+	}
+}
+
+StelModuleProfiler::StelModuleProfiler(QObject* parent)
+	: QObject(parent)
+	, enabled(false)
+	, gpuTiming(false)
+	, current(NULL)
+	, startTime(0)
+	, startDrawCalls(0)
+	, startVertices(0)
+{
+	setObjectName("StelModuleProfiler");
+}
+
+StelModuleProfiler::~StelModuleProfiler()
+{
+	clear();
+#ifndef QT_OPENGL_ES_2
+	qDeleteAll(unusedQueries);
+#endif
+}
+
+void StelModuleProfiler::begin(const StelModule* module, StelModule::StelModuleActionName action)
+{
+	if (!enabled)
+		return;
+	Q_ASSERT(current==NULL);
+
+	ActionStats*& s = stats[module->objectName() + '/' + actionName(action)];
+	if (!s)
+	{
+		s = new ActionStats();
+		s->module = module->objectName();
+		s->action = action;
+	}
+	current = s;
+
+#ifndef QT_OPENGL_ES_2
+	if (gpuTiming && action==StelModule::ActionDraw)
+	{
+		collectGpuResults(*s);
+		// Use the next query whose result was already collected, or skip this frame if all are still in flight
+		for (int i=0; i<GPU_QUERIES; ++i)
+		{
+			if (s->pending[i])
+				continue;
+			if (!s->queries[i])
+			{
+				s->queries[i] = new QOpenGLTimerQuery();
+				if (!s->queries[i]->create())
+				{
+					qWarning() << "StelModuleProfiler: GL timer queries are not supported, GPU timing disabled";
+					delete s->queries[i];
+					s->queries[i] = NULL;
+					gpuTiming = false;
+					emit flagGpuTimingChanged(false);
+					break;
+				}
+			}
+			s->queries[i]->begin();
+			s->currentQuery = i;
+			break;
+		}
+	}
+#endif
+
+	startDrawCalls = StelPainter::getDrawCallCount();
+	startVertices = StelPainter::getDrawnVertexCount();
+	startTime = timer.nsecsElapsed();
+}
+
+void StelModuleProfiler::end()
+{
+	if (!current)
+		return;
+	const float cpuTime = (timer.nsecsElapsed()-startTime)/1e6f;
+	ActionStats& s = *current;
+	current = NULL;
+
+#ifndef QT_OPENGL_ES_2
+	if (s.currentQuery>=0)
+	{
+		s.queries[s.currentQuery]->end();
+		s.pending[s.currentQuery] = true;
+		s.currentQuery = -1;
+	}
+#endif
+
+	const int drawCalls = StelPainter::getDrawCallCount()-startDrawCalls;
+	const int vertices = StelPainter::getDrawnVertexCount()-startVertices;
+	if (s.cpuTimes.size()<PROFILER_WINDOW)
+	{
+		s.cpuTimes.append(cpuTime);
+		s.drawCalls.append(drawCalls);
+		s.vertices.append(vertices);
+	}
+	else
+	{
+		s.cpuTimes[s.next] = cpuTime;
+		s.drawCalls[s.next] = drawCalls;
+		s.vertices[s.next] = vertices;
+	}
+	s.next = (s.next+1)%PROFILER_WINDOW;
+}
+
+void StelModuleProfiler::collectGpuResults(ActionStats& s)
+{
+#ifndef QT_OPENGL_ES_2
+	for (int i=0; i<GPU_QUERIES; ++i)
+	{
+		if (!s.pending[i] || !s.queries[i]->isResultAvailable())
+			continue;
+		const float gpuTime = s.queries[i]->waitForResult()/1e6f;
+		s.pending[i] = false;
+		if (s.gpuTimes.size()<PROFILER_WINDOW)
+			s.gpuTimes.append(gpuTime);
+		else
+			s.gpuTimes[s.nextGpu] = gpuTime;
+		s.nextGpu = (s.nextGpu+1)%PROFILER_WINDOW;
+	}
+#else
+	Q_UNUSED(s);
+#endif
+}
+
+void StelModuleProfiler::endFrame()
+{
+	// Queries can only be deleted while the GL context is current, which is the case here
+#ifndef QT_OPENGL_ES_2
+	qDeleteAll(unusedQueries);
+#endif
+	unusedQueries.clear();
+
+	if (!enabled)
+		return;
+	if (reportTimer.elapsed()>=1000)
+	{
+		updateReport();
+		reportTimer.restart();
+	}
+}
+
+void StelModuleProfiler::updateReport()
+{
+	report.clear();
+	foreach (const ActionStats* s, stats)
+	{
+		const int frames = s->cpuTimes.size();
+		if (frames==0)
+			continue;
+
+		QVector<float> sorted = s->cpuTimes;
+		std::sort(sorted.begin(), sorted.end());
+		float cpuSum = 0.f;
+		qint64 drawCallSum = 0;
+		qint64 vertexSum = 0;
+		for (int i=0; i<frames; ++i)
+		{
+			cpuSum += sorted.at(i);
+			drawCallSum += s->drawCalls.at(i);
+			vertexSum += s->vertices.at(i);
+		}
+		float gpuMean = -1.f;
+		if (!s->gpuTimes.isEmpty())
+		{
+			float gpuSum = 0.f;
+			foreach (float t, s->gpuTimes)
+				gpuSum += t;
+			gpuMean = gpuSum/s->gpuTimes.size();
+		}
+
+		QVariantMap entry;
+		entry["module"] = s->module;
+		entry["action"] = actionName(s->action);
+		entry["frames"] = frames;
+		entry["cpuMean"] = cpuSum/frames;
+		entry["cpuMedian"] = sorted.at(frames/2);
+		entry["cpu95"] = sorted.at(qMin(frames-1, frames*95/100));
+		entry["cpuMax"] = sorted.last();
+		entry["gpuMean"] = gpuMean;
+		entry["drawCalls"] = (double)drawCallSum/frames;
+		entry["vertices"] = (double)vertexSum/frames;
+		report << entry;
+	}
+	emit profilingReportChanged(report);
+}
+
+QString StelModuleProfiler::getProfilingReportCsv() const
+{
+	static const char* const columns[] = {"module", "action", "frames", "cpuMean", "cpuMedian", "cpu95", "cpuMax", "gpuMean", "drawCalls", "vertices"};
+	static const int columnCount = sizeof(columns)/sizeof(columns[0]);
+
+	QStringList header;
+	for (int i=0; i<columnCount; ++i)
+		header << columns[i];
+	QString csv = header.join(',') + '\n';
+	foreach (const QVariant& v, report)
+	{
+		const QVariantMap entry = v.toMap();
+		QStringList row;
+		for (int i=0; i<columnCount; ++i)
+		{
+			const QVariant value = entry.value(columns[i]);
+			if (value.type()==QVariant::Double)
+				row << QString::number(value.toDouble(), 'f', 3);
+			else
+				row << value.toString();
+		}
+		csv += row.join(',') + '\n';
+	}
+	return csv;
+}
+
+bool StelModuleProfiler::dumpProfilingReport(const QString& fileName) const
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+	{
+		qWarning() << "StelModuleProfiler: could not write" << QDir::toNativeSeparators(fileName);
+		return false;
+	}
+	QTextStream out(&file);
+	out << getProfilingReportCsv();
+	return true;
+}
+
+void StelModuleProfiler::setFlagEnabled(bool b)
+{
+	if (b==enabled)
+		return;
+	enabled = b;
+	if (enabled)
+	{
+		timer.start();
+		reportTimer.start();
+	}
+	else
+	{
+		clear();
+		report.clear();
+		emit profilingReportChanged(report);
+	}
+	emit flagEnabledChanged(b);
+}
+
+void StelModuleProfiler::setFlagGpuTiming(bool b)
+{
+	if (b==gpuTiming)
+		return;
+	gpuTiming = b;
+	if (!gpuTiming)
+	{
+		foreach (ActionStats* s, stats)
+		{
+			releaseQueries(*s);
+			s->gpuTimes.clear();
+			s->nextGpu = 0;
+		}
+	}
+	emit flagGpuTimingChanged(b);
+}
+
+void StelModuleProfiler::releaseQueries(ActionStats& s)
+{
+	for (int i=0; i<GPU_QUERIES; ++i)
+	{
+		if (s.queries[i])
+			unusedQueries << s.queries[i];
+		s.queries[i] = NULL;
+		s.pending[i] = false;
+	}
+	s.currentQuery = -1;
+}
+
+void StelModuleProfiler::clear()
+{
+	foreach (ActionStats* s, stats)
+	{
+		releaseQueries(*s);
+		delete s;
+	}
+	stats.clear();
+	current = NULL;
+}
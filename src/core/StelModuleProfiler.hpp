@@ -0,0 +1,137 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELMODULEPROFILER_HPP_
+#define _STELMODULEPROFILER_HPP_
+
+#include "StelModule.hpp"
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QObject>
+#include <QVariantList>
+#include <QVector>
+
+class QOpenGLTimerQuery;
+
+//! @class StelModuleProfiler
+//! Measures the time spent in the update() and draw() methods of each module, and the number of
+//! draw calls and vertices each module submits through StelPainter.
+//! The measurements of the last PROFILER_WINDOW frames are kept for each module and action,
+//! and summarized once per second into the profilingReport property.
+//! Optionally, the GPU time of the draw() calls is measured with GL timer queries.
+//!
+//! The profiler is owned by the StelModuleMgr, and is disabled by default (config option devel/flag_module_profiling).
+class StelModuleProfiler : public QObject
+{
+	Q_OBJECT
+	Q_PROPERTY(bool flagEnabled
+		   READ getFlagEnabled
+		   WRITE setFlagEnabled
+		   NOTIFY flagEnabledChanged)
+	Q_PROPERTY(bool flagGpuTiming
+		   READ getFlagGpuTiming
+		   WRITE setFlagGpuTiming
+		   NOTIFY flagGpuTimingChanged)
+	Q_PROPERTY(QVariantList profilingReport
+		   READ getProfilingReport
+		   NOTIFY profilingReportChanged)
+
+public:
+	//! Number of frames over which the statistics are computed
+	static const int PROFILER_WINDOW = 240;
+
+	StelModuleProfiler(QObject* parent=NULL);
+	~StelModuleProfiler();
+
+	//! Start measuring an action of a module. Measurements can't be nested.
+	void begin(const StelModule* module, StelModule::StelModuleActionName action);
+	//! Stop measuring the action started with begin().
+	void end();
+	//! Has to be called once per frame after drawing, with the GL context current. Updates the report once per second.
+	void endFrame();
+
+	bool getFlagEnabled() const {return enabled;}
+	bool getFlagGpuTiming() const {return gpuTiming;}
+
+	//! Get the statistics of the last second. Each entry is a map with the keys
+	//! module, action, frames, cpuMean, cpuMedian, cpu95, cpuMax, gpuMean (all times in ms),
+	//! drawCalls and vertices (means per frame). gpuMean is -1 when GPU timing is not available.
+	QVariantList getProfilingReport() const {return report;}
+	//! Get the report as CSV, with a header line.
+	QString getProfilingReportCsv() const;
+
+public slots:
+	//! Enable the profiler. Disabling it discards all measurements.
+	void setFlagEnabled(bool b);
+	//! Measure the GPU time of the draw() calls. Needs OpenGL 3.3 or GL_ARB_timer_query, and is not available with OpenGL ES.
+	void setFlagGpuTiming(bool b);
+	//! Write the report as CSV file.
+	//! @return false if the file could not be written
+	bool dumpProfilingReport(const QString& fileName) const;
+
+signals:
+	void flagEnabledChanged(bool b);
+	void flagGpuTimingChanged(bool b);
+	void profilingReportChanged(const QVariantList& report);
+
+private:
+	//! Number of GPU queries used in turn per module, results are usually available 1 or 2 frames later
+	static const int GPU_QUERIES = 3;
+
+	//! Measurements of one action of one module
+	struct ActionStats
+	{
+		ActionStats();
+		QString module;
+		StelModule::StelModuleActionName action;
+		//! Rolling windows of the measurements of the last frames
+		QVector<float> cpuTimes;
+		QVector<float> gpuTimes;
+		QVector<int> drawCalls;
+		QVector<int> vertices;
+		int next;
+		int nextGpu;
+		QOpenGLTimerQuery* queries[GPU_QUERIES];
+		bool pending[GPU_QUERIES];
+		int currentQuery;
+	};
+
+	void collectGpuResults(ActionStats& stats);
+	//! Hand the GL timer queries over to unusedQueries
+	void releaseQueries(ActionStats& stats);
+	void updateReport();
+	void clear();
+
+	bool enabled;
+	bool gpuTiming;
+	QMap<QString, ActionStats*> stats;
+	//! The measurement started by begin()
+	ActionStats* current;
+	QElapsedTimer timer;
+	qint64 startTime;
+	quint64 startDrawCalls;
+	quint64 startVertices;
+	QElapsedTimer reportTimer;
+	QVariantList report;
+	//! Queries which are deleted in the next endFrame(), as they need the GL context
+	QList<QOpenGLTimerQuery*> unusedQueries;
+};
+
+#endif // _STELMODULEPROFILER_HPP_
@@ -211,6 +211,12 @@ public slots:
 	void zoomTo(double aimFov, float moveDuration = 1.);
 	//! Get the current Field Of View in degrees
 	double getCurrentFov() const {return currentFov;}
+	//! Set the current Field Of View in degrees immediately, constrained to the minimum and maximum FOV.
+	//! Use zoomTo() for a smooth change.
+	void setFov(double f)
+	{
+		currentFov=qMax(minFov, qMin(f, maxFov));
+	}
 
 	//! Return the initial default FOV in degree.
 	double getInitFov() const {return initFov;}
@@ -325,10 +331,6 @@ private:
 	double minFov;     // Minimum FOV in degrees
 	double maxFov;     // Maximum FOV in degrees
 	double deltaFov;   // requested change of FOV (degrees) used during zooming.
-	void setFov(double f)
-	{
-		currentFov=qMax(minFov, qMin(f, maxFov));
-	}
 	// immediately add deltaFov argument to FOV - does not change private var.
 	void changeFov(double deltaFov);
 
@@ -20,6 +20,7 @@
 #include "StelPainter.hpp"
 
 #include "StelApp.hpp"
+#include "StelGlyphAtlas.hpp"
 #include "StelLocaleMgr.hpp"
 #include "StelProjector.hpp"
 #include "StelProjectorClasses.hpp"
@@ -33,19 +34,17 @@
 #include <QMutex>
 #include <QVarLengthArray>
 #include <QPaintEngine>
-#include <QCache>
 #include <QOpenGLPaintDevice>
 #include <QOpenGLShader>
-#include <QOpenGLTexture>
 #include <QApplication>
 
-static const int TEX_CACHE_LIMIT = 7000000;
-
 #ifndef NDEBUG
 QMutex* StelPainter::globalMutex = new QMutex();
 #endif
 
-QCache<QByteArray, StringTexture> StelPainter::texCache(TEX_CACHE_LIMIT);
+StelGlyphAtlas* StelPainter::glyphAtlas=NULL;
+quint64 StelPainter::drawCallCount=0;
+quint64 StelPainter::drawnVertexCount=0;
 QOpenGLShaderProgram* StelPainter::texturesShaderProgram=NULL;
 QOpenGLShaderProgram* StelPainter::basicShaderProgram=NULL;
 QOpenGLShaderProgram* StelPainter::colorShaderProgram=NULL;
@@ -139,6 +138,8 @@ StelPainter::StelPainter(const StelProjectorP& proj) : QOpenGLFunctions(QOpenGLC
 
 void StelPainter::setProjector(const StelProjectorP& p)
 {
+	// pending text was laid out for the old viewport
+	flushText();
 	prj=p;
 	// Init GL viewport to current projector values
 	glViewport(prj->viewportXywh[0], prj->viewportXywh[1], prj->viewportXywh[2], prj->viewportXywh[3]);
@@ -147,6 +148,8 @@ void StelPainter::setProjector(const StelProjectorP& p)
 
 StelPainter::~StelPainter()
 {
+	flushText();
+
 	//reset opengl state
 	glState.reset();
 
@@ -591,49 +594,89 @@ void StelPainter::drawText(const Vec3d& v, const QString& str, float angleDeg, f
  Draw the string at the given position and angle with the given font
 *************************************************************************/
 
-// Methods taken from text-use-opengl-buffer
-// Container for one cached string texture
-struct StringTexture
+void StelPainter::addTextToBatch(float x, float y, const QString& str, float angleDeg, float xshift, float yshift)
 {
-	QOpenGLTexture* texture;
-	QSize size;
-	QSizeF getTexSize() const {
-		return QSizeF((float)size.width() / texture->width(),
-			      (float)size.height() / texture->height());
+	if (!glyphAtlas)
+		glyphAtlas = new StelGlyphAtlas();
+
+	QFont tmpFont = currentFont;
+	tmpFont.setPixelSize(currentFont.pixelSize()*prj->getDevicePixelsPerPixel()*StelApp::getInstance().getGlobalScalingRatio());
+	const StelGlyphAtlas::TextLayout* layout = glyphAtlas->layoutText(str, tmpFont);
+	if (!layout)
+	{
+		// The atlas is full: draw the pending text while its glyphs are still there, and start over
+		flushText();
+		glyphAtlas->clear();
+		layout = glyphAtlas->layoutText(str, tmpFont);
+		if (!layout)
+		{
+			qWarning() << "StelPainter: text does not fit into the glyph atlas:" << str;
+			return;
+		}
 	}
 
-	StringTexture(QOpenGLTexture* tex, const QSize& size) :
-	     texture(tex), size(size) {}
-	~StringTexture() {delete texture;}
-};
+	const bool rotated = std::fabs(angleDeg)>0.01f;
+	const float cosr = rotated ? std::cos(angleDeg * M_PI/180.) : 1.f;
+	const float sinr = rotated ? std::sin(angleDeg * M_PI/180.) : 0.f;
+	if (!rotated)
+	{
+		// whole pixels keep unrotated text crisp
+		x = int(x + xshift);
+		y = int(y + yshift);
+		xshift = yshift = 0.f;
+	}
 
-StringTexture* StelPainter::getTexTexture(const QString& str, int pixelSize)
+	foreach (const StelGlyphAtlas::GlyphQuad& quad, *layout)
+	{
+		// two triangles per glyph, in the same order as addSprite2dMode()
+		const float left = quad.rect.left()+xshift, right = left+quad.rect.width();
+		const float bottom = quad.rect.top()+yshift, top = bottom+quad.rect.height();
+		const float corners[] = {left, bottom, right, bottom, left, top, left, top, right, bottom, right, top};
+		const float s0 = quad.texRect.left(), s1 = quad.texRect.right();
+		const float t0 = quad.texRect.top(), t1 = quad.texRect.bottom();
+		// the top of the glyph is at the top of the atlas texture rect
+		const float texCoords[] = {s0, t1, s1, t1, s0, t0, s0, t0, s1, t1, s1, t0};
+		for (int i=0; i<12; i+=2)
+		{
+			textBatch.vertices.append(Vec2f(x + corners[i] * cosr - corners[i+1] * sinr, y + corners[i] * sinr + corners[i+1] * cosr));
+			textBatch.texCoords.append(Vec2f(texCoords[i], texCoords[i+1]));
+			textBatch.colors.append(currentColor);
+		}
+	}
+}
+
+void StelPainter::flushText()
 {
-	// Render first the text into a QPixmap, then create a QOpenGLTexture
-	// from it.  We could optimize by directly using a QImage, but for some
-	// reason the result is not exactly the same than with a QPixmap.
-	QByteArray hash = str.toUtf8() + QByteArray::number(pixelSize);
-	StringTexture* cachedTex = texCache.object(hash);
-	if (cachedTex)
-		return cachedTex;
-	QFont tmpFont = currentFont;
-	tmpFont.setPixelSize(currentFont.pixelSize()*prj->getDevicePixelsPerPixel()*StelApp::getInstance().getGlobalScalingRatio());
-	QRect strRect = QFontMetrics(tmpFont).boundingRect(str);
-	int w = strRect.width()+1+(int)(0.02f*strRect.width());
-	int h = strRect.height();
-
-	QPixmap strImage = QPixmap(StelUtils::getBiggerPowerOfTwo(w), StelUtils::getBiggerPowerOfTwo(h));
-	strImage.fill(Qt::transparent);
-	QPainter painter(&strImage);
-	tmpFont.setStyleStrategy(QFont::NoAntialias);
-	painter.setFont(tmpFont);
-	//painter.setRenderHints(QPainter::TextAntialiasing);
-	painter.setPen(Qt::white);
-	painter.drawText(-strRect.x(), -strRect.y(), str);
-	StringTexture* newTex = new StringTexture(new QOpenGLTexture(strImage.toImage()), QSize(w, h));
-	texCache.insert(hash, newTex, 3*w*h);
-	// simply returning newTex is dangerous as the object is owned by the cache now. (Coverity Scan barks.)
-	return texCache.object(hash);
+	if (textBatch.isEmpty())
+		return;
+
+	// Drawing the text must not disturb what the caller has set up for its next drawing
+	const ArrayDesc oldVertexArray = vertexArray, oldTexCoordArray = texCoordArray, oldColorArray = colorArray, oldNormalArray = normalArray;
+	GLint oldActiveTexture, oldTexture;
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &oldActiveTexture);
+	glActiveTexture(GL_TEXTURE0);
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &oldTexture);
+
+	//text drawing requires blending, but we reset GL state afterwards if necessary
+	bool oldBlending = glState.blend;
+	GLenum oldSrc = glState.blendSrc, oldDst = glState.blendDst;
+	setBlending(true);
+	glyphAtlas->bind();
+
+	// drawFromArray() flushes textBatch, so take the vertices out of it first
+	Sprite2dBatch batch;
+	qSwap(batch, textBatch);
+	drawSprite2dBatch(batch);
+	batch.clear();
+	qSwap(batch, textBatch);
+
+	setBlending(oldBlending, oldSrc, oldDst);
+	glBindTexture(GL_TEXTURE_2D, oldTexture);
+	glActiveTexture(oldActiveTexture);
+	vertexArray = oldVertexArray;
+	texCoordArray = oldTexCoordArray;
+	colorArray = oldColorArray;
+	normalArray = oldNormalArray;
 }
 
 void StelPainter::drawText(float x, float y, const QString& str, float angleDeg, float xshift, float yshift, bool noGravity)
@@ -644,59 +687,11 @@ void StelPainter::drawText(float x, float y, const QString& str, float angleDeg,
 	}
 	else if (qApp->property("text_texture")==true) // CLI option -t given?
 	{
-		//qDebug() <<  "Text texture" << str;
-		// This is taken from branch text-use-opengl-buffer. This is essential on devices like Raspberry Pi (2016-03).
-		StringTexture* tex = getTexTexture(str, currentFont.pixelSize());
-		Q_ASSERT(tex);
+		// This is essential on devices like Raspberry Pi (2016-03).
+		// Glyphs come from a shared atlas, all text is drawn in one call when the next other drawing happens
 		if (!noGravity)
 			angleDeg += prj->defaultAngleForGravityText;
-		tex->texture->bind();
-
-		static float vertexData[8];
-		// compute the vertex coordinates applying the translation and the rotation
-		static const float vertexBase[] = {0., 0., 1., 0., 0., 1., 1., 1.};
-		if (std::fabs(angleDeg)>1.f*M_PI/180.f)
-		{
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			const float cosr = std::cos(angleDeg * M_PI/180.);
-			const float sinr = std::sin(angleDeg * M_PI/180.);
-			for (int i = 0; i < 8; i+=2)
-			{
-				vertexData[i] = int(x + (tex->size.width()*vertexBase[i]+xshift) * cosr - (tex->size.height()*vertexBase[i+1]+yshift) * sinr);
-				vertexData[i+1] = int(y  + (tex->size.width()*vertexBase[i]+xshift) * sinr + (tex->size.height()*vertexBase[i+1]+yshift) * cosr);
-			}
-		}
-		else
-		{
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-			for (int i = 0; i < 8; i+=2)
-			{
-				vertexData[i] = int(x + tex->size.width()*vertexBase[i]+xshift);
-				vertexData[i+1] = int(y  + tex->size.height()*vertexBase[i+1]+yshift);
-			}
-		}
-
-		float* texCoords = new float[8];
-		for (int i=0;i<4;i++)
-		{
-			texCoords[i*2+0] = tex->getTexSize().width() * (i % 2);
-			texCoords[i*2+1] = tex->getTexSize().height() * (1 - i / 2);
-		}
-		setTexCoordPointer(2, GL_FLOAT, texCoords);
-
-		//text drawing requires blending, but we reset GL state afterwards if necessary
-		bool oldBlending = glState.blend;
-		GLenum oldSrc = glState.blendSrc, oldDst = glState.blendDst;
-		setBlending(true);
-		enableClientStates(true, true);
-		setVertexPointer(2, GL_FLOAT, vertexData);
-		drawFromArray(TriangleStrip, 4, 0, false);
-		setBlending(oldBlending, oldSrc, oldDst);
-		enableClientStates(false, false);
-		tex->texture->release();
-		delete[] texCoords;
+		addTextToBatch(x, y, str, angleDeg, xshift, yshift);
 	}
 	else
 	{
@@ -929,6 +924,95 @@ void StelPainter::drawPath(const QVector<Vec3d> &points, const QVector<Vec4f> &c
 	Q_ASSERT(smallCircleColorArray.isEmpty());
 }
 
+// Clip the 2D segment win1-win2 against the viewport rectangle with the Liang-Barsky algorithm.
+// Return false if the segment doesn't intersect the viewport. Otherwise t0 and t1 are the parameters
+// of the ends of the visible part along the segment, 0 and 1 meaning that the ends are inside.
+static bool clipSegmentToViewport(const Vec4i& vp, const Vec3d& win1, const Vec3d& win2, double& t0, double& t1)
+{
+	const double dx = win2[0]-win1[0];
+	const double dy = win2[1]-win1[1];
+	const double p[4] = {-dx, dx, -dy, dy};
+	const double q[4] = {win1[0]-vp[0], vp[0]+vp[2]-win1[0], win1[1]-vp[1], vp[1]+vp[3]-win1[1]};
+	t0 = 0.;
+	t1 = 1.;
+	for (int i = 0; i < 4; ++i)
+	{
+		if (p[i]==0.)
+		{
+			// Parallel to this edge
+			if (q[i]<0.)
+				return false;
+		}
+		else
+		{
+			const double t = q[i]/p[i];
+			if (p[i]<0.)
+			{
+				if (t>t1)
+					return false;
+				if (t>t0)
+					t0 = t;
+			}
+			else
+			{
+				if (t<t0)
+					return false;
+				if (t<t1)
+					t1 = t;
+			}
+		}
+	}
+	return true;
+}
+
+void StelPainter::addPathToLineBatch(LineBatch& batch, const QVector<Vec3d>& points, const SphericalCap& cullingCap, const Vec4f& color,
+				     void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData), void* userData) const
+{
+	const Vec4i& viewport = prj->getViewport();
+	// Each point is projected once, the state of the previous point is kept for the current segment
+	Vec3d win1, win2;
+	bool valid1 = false;
+	double t0, t1;
+	for (int i = 0; i < points.size(); ++i)
+	{
+		const Vec3d& p2 = points.at(i);
+		const bool valid2 = p2*cullingCap.n>=cullingCap.d && prj->project(p2, win2);
+
+		// The segment is kept if any part of it is in the viewport, even when both ends are outside
+		if (valid1 && valid2 && clipSegmentToViewport(viewport, win1, win2, t0, t1) && !prj->intersectViewportDiscontinuity(points.at(i-1), p2))
+		{
+			batch.vertices.append(Vec2f(win1[0], win1[1]));
+			batch.vertices.append(Vec2f(win2[0], win2[1]));
+			batch.colors.append(color);
+			batch.colors.append(color);
+			if (viewportEdgeIntersectCallback)
+			{
+				// We crossed the edge of the view port, the direction points outside as in drawSmallCircleArc()
+				const Vec3d d = win2-win1;
+				if (t0>0.)
+					viewportEdgeIntersectCallback(win1+d*t0, win1-win2, userData);
+				if (t1<1.)
+					viewportEdgeIntersectCallback(win1+d*t1, d, userData);
+			}
+		}
+
+		win1 = win2;
+		valid1 = valid2;
+	}
+}
+
+void StelPainter::drawLineBatch(const LineBatch& batch)
+{
+	if (batch.isEmpty())
+		return;
+
+	enableClientStates(true, false, true);
+	setVertexPointer(2, GL_FLOAT, batch.vertices.constData());
+	setColorPointer(4, GL_FLOAT, batch.colors.constData());
+	drawFromArray(Lines, batch.vertices.size(), 0, false);
+	enableClientStates(false);
+}
+
 // Project the passed triangle on the screen ensuring that it will look smooth, even for non linear distortion
 // by splitting it into subtriangles.
 void StelPainter::projectSphericalTriangle(const SphericalCap* clippingCap, const Vec3d* vertices, QVarLengthArray<Vec3f, 4096>* outVertices,
@@ -1700,6 +1784,39 @@ void StelPainter::drawSprite2dMode(float x, float y, float radius, float rotatio
 	enableClientStates(false);
 }
 
+void StelPainter::addSprite2dMode(Sprite2dBatch& batch, float x, float y, float radius, float rotation, const Vec4f& color) const
+{
+	static const Vec2f texCoordData[] = {Vec2f(0.f,0.f), Vec2f(1.f,0.f), Vec2f(0.f,1.f), Vec2f(0.f,1.f), Vec2f(1.f,0.f), Vec2f(1.f,1.f)};
+	static const float vertexBase[] = {-1., -1., 1., -1., -1., 1., -1., 1., 1., -1., 1., 1.};
+	const float cosr = std::cos(rotation / 180 * M_PI);
+	const float sinr = std::sin(rotation / 180 * M_PI);
+
+	// Takes into account device pixel density and global scale ratio, as we are drawing 2D stuff.
+	radius *= prj->getDevicePixelsPerPixel()*StelApp::getInstance().getGlobalScalingRatio();
+
+	// Two triangles instead of a strip, so that all sprites of the batch can be drawn at once
+	for (int i = 0; i < 12; i+=2)
+	{
+		batch.vertices.append(Vec2f(x + radius * vertexBase[i] * cosr - radius * vertexBase[i+1] * sinr,
+					    y + radius * vertexBase[i] * sinr + radius * vertexBase[i+1] * cosr));
+		batch.texCoords.append(texCoordData[i/2]);
+		batch.colors.append(color);
+	}
+}
+
+void StelPainter::drawSprite2dBatch(const Sprite2dBatch& batch)
+{
+	if (batch.isEmpty())
+		return;
+
+	enableClientStates(true, true, true);
+	setVertexPointer(2, GL_FLOAT, batch.vertices.constData());
+	setTexCoordPointer(2, GL_FLOAT, batch.texCoords.constData());
+	setColorPointer(4, GL_FLOAT, batch.colors.constData());
+	drawFromArray(Triangles, batch.vertices.size(), 0, false);
+	enableClientStates(false);
+}
+
 void StelPainter::drawRect2d(float x, float y, float width, float height, bool textured)
 {
 	static float vertexData[] = {-10.,-10.,10.,-10., 10.,10., -10.,10.};
@@ -2098,7 +2215,12 @@ void StelPainter::deinitGLShaders()
 	texturesShaderProgram = NULL;
 	delete texturesColorShaderProgram;
 	texturesColorShaderProgram = NULL;
-	texCache.clear();
+	if (glyphAtlas)
+	{
+		glyphAtlas->deleteTexture();
+		delete glyphAtlas;
+		glyphAtlas = NULL;
+	}
 }
 
 
@@ -2130,6 +2252,9 @@ void StelPainter::enableClientStates(bool vertex, bool texture, bool color, bool
 
 void StelPainter::drawFromArray(DrawingMode mode, int count, int offset, bool doProj, const unsigned short* indices)
 {
+	// keep the drawing order with text drawn before
+	flushText();
+
 	ArrayDesc projectedVertexArray = vertexArray;
 	if (doProj)
 	{
@@ -2200,6 +2325,7 @@ void StelPainter::drawFromArray(DrawingMode mode, int count, int offset, bool do
 		glDrawElements(mode, count, GL_UNSIGNED_SHORT, indices + offset);
 	else
 		glDrawArrays(mode, offset, count);
+	countDrawCall(count);
 
 	if (pr==texturesColorShaderProgram)
 	{
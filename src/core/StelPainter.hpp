@@ -122,6 +122,30 @@ public:
 	//! @param clippingCap if not set to NULL, tells the painter to try to clip part of the region outside the cap.
 	void drawGreatCircleArc(const Vec3d& start, const Vec3d& stop, const SphericalCap* clippingCap=NULL, void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData)=NULL, void* userData=NULL);
 
+	//! Vertex data of 2D line segments with individual colors, collected with addPathToLineBatch()
+	//! so that many lines, even of different colors and frames, can be drawn with a single drawLineBatch() call.
+	struct LineBatch
+	{
+		QVector<Vec2f> vertices;
+		QVector<Vec4f> colors;
+		bool isEmpty() const {return vertices.isEmpty();}
+		//! Remove all lines, but keep the allocated memory for the next frame.
+		void clear() {vertices.resize(0); colors.resize(0);}
+	};
+
+	//! Project a path defined by a list of points and add its visible parts to a batch as separate line segments.
+	//! Unlike drawSmallCircleArc(), the path is not tesselated further, so the points must be close enough
+	//! for the line to look smooth with the current projection. Segments crossing a viewport discontinuity are skipped.
+	//! Each time the path crosses the edge of the viewport, the viewportEdgeIntersectCallback is called like in drawSmallCircleArc().
+	//! @param cullingCap only the segments with both ends inside this cap are projected.
+	//! It must contain all segments intersecting the viewport.
+	//! @param color the color of the path, the current painter color is not used.
+	void addPathToLineBatch(LineBatch& batch, const QVector<Vec3d>& points, const SphericalCap& cullingCap, const Vec4f& color,
+				void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData)=NULL, void* userData=NULL) const;
+
+	//! Draw all line segments of a batch in a single draw call.
+	void drawLineBatch(const LineBatch& batch);
+
 	//! Draw a curve defined by a list of points.
 	//! The points should be already tesselated to ensure that the path will look smooth.
 	//! The algorithm take care of cutting the path if it crosses a viewport discontinutiy.
@@ -150,6 +174,25 @@ public:
 	//! @param rotation rotation angle in degree.
 	void drawSprite2dMode(float x, float y, float radius, float rotation);
 
+	//! Vertex data of textured 2D sprites with individual colors, collected with addSprite2dMode()
+	//! so that many sprites sharing a texture can be drawn with a single drawSprite2dBatch() call.
+	struct Sprite2dBatch
+	{
+		QVector<Vec2f> vertices;
+		QVector<Vec2f> texCoords;
+		QVector<Vec4f> colors;
+		bool isEmpty() const {return vertices.isEmpty();}
+		//! Remove all sprites, but keep the allocated memory for the next frame.
+		void clear() {vertices.resize(0); texCoords.resize(0); colors.resize(0);}
+	};
+
+	//! Add a rotated square to a batch, with the same geometry as drawSprite2dMode(x, y, radius, rotation) would draw.
+	//! @param color the color of this sprite, the current painter color is not used.
+	void addSprite2dMode(Sprite2dBatch& batch, float x, float y, float radius, float rotation, const Vec4f& color) const;
+
+	//! Draw all sprites of a batch using the current texture, in a single draw call.
+	void drawSprite2dBatch(const Sprite2dBatch& batch);
+
 	//! Draw a GL_POINT at the given position.
 	//! @param x x position in the viewport in pixels.
 	//! @param y y position in the viewport in pixels.
@@ -259,6 +302,14 @@ public:
 	//! This method needs to be called once before exit.
 	static void deinitGLShaders();
 
+	//! Count a draw call for the statistics of the module profiler.
+	//! drawFromArray() counts its calls itself, code calling GL directly should call this.
+	static void countDrawCall(int vertexCount) {++drawCallCount; drawnVertexCount+=vertexCount;}
+	//! Get the number of draw calls counted since the start of the program.
+	static quint64 getDrawCallCount() {return drawCallCount;}
+	//! Get the number of vertices drawn since the start of the program.
+	static quint64 getDrawnVertexCount() {return drawnVertexCount;}
+
 	// Thoses methods should eventually be replaced by a single setVertexArray
 	//! use instead of glVertexPointer
 	void setVertexPointer(int size, int type, const void* pointer) {
@@ -333,9 +384,18 @@ private:
 		QOpenGLFunctions* gl;
 	} glState;
 
-	// From text-use-opengl-buffer
-	static QCache<QByteArray, struct StringTexture> texCache;
-	struct StringTexture* getTexTexture(const QString& str, int pixelSize);
+	static quint64 drawCallCount;
+	static quint64 drawnVertexCount;
+
+	//! Glyphs of the text drawn in text texture mode (CLI option -t), shared by all painters
+	static class StelGlyphAtlas* glyphAtlas;
+	//! Text quads of the current painter which were not drawn yet
+	Sprite2dBatch textBatch;
+	//! Add the glyph quads of a string to textBatch
+	void addTextToBatch(float x, float y, const QString& str, float angleDeg, float xshift, float yshift);
+	//! Draw the pending text in a single call. This is done before anything else is drawn, so that
+	//! the drawing order is kept, and when the painter is destroyed.
+	void flushText();
 
 	//! Struct describing one opengl array
 	typedef struct ArrayDesc
@@ -94,6 +94,7 @@ StelProperty* StelPropertyMgr::registerProperty(const QString &id, QObject *targ
 #endif
 
 	propMap.insert(id,stelProp);
+	emit stelPropRegistered(id,value);
 	return stelProp;
 }
 
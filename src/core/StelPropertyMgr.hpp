@@ -308,6 +308,10 @@ signals:
 	//! @param id The unique id of the property that was changed
 	//! @param value The new value of the property
 	void stelPropChanged(const QString& id, const QVariant& value);
+	//! Emitted after a new StelProperty has been registered
+	//! @param id The unique id of the new property
+	//! @param value The current value of the property
+	void stelPropRegistered(const QString& id, const QVariant& value);
 private:
 	StelProperty* registerProperty(const QString &id, QObject *target, const QMetaProperty& prop);
 
@@ -410,6 +410,7 @@ void StelSkyDrawer::postDrawPointSource(StelPainter* sPainter)
 	starShaderProgram->enableAttributeArray(starShaderVars.texCoord);
 	
 	glDrawArrays(GL_TRIANGLES, 0, nbPointSources*6);
+	StelPainter::countDrawCall(nbPointSources*6);
 	
 	starShaderProgram->disableAttributeArray(starShaderVars.pos);
 	starShaderProgram->disableAttributeArray(starShaderVars.color);
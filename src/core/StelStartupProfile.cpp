@@ -0,0 +1,110 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelStartupProfile.hpp"
+#include "StelJsonParser.hpp"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QThread>
+#include <QVariantMap>
+
+StelStartupProfile::Step::Step(StelStartupProfile* profile, const QString& module, const QString& phase)
+	: profile(profile)
+{
+	entry.module = module;
+	entry.phase = phase;
+	entry.mainThread = QThread::currentThread()==QCoreApplication::instance()->thread();
+	entry.bytesRead = processBytesRead();
+	entry.start = profile->elapsed();
+}
+
+StelStartupProfile::Step::~Step()
+{
+	entry.duration = profile->elapsed()-entry.start;
+	if (entry.bytesRead>=0)
+		entry.bytesRead = processBytesRead()-entry.bytesRead;
+	profile->addEntry(entry);
+}
+
+StelStartupProfile::StelStartupProfile()
+{
+	timer.start();
+}
+
+qint64 StelStartupProfile::processBytesRead()
+{
+#ifdef Q_OS_LINUX
+	// rchar counts all bytes read by the process, also the ones served from the page cache
+	QFile io("/proc/self/io");
+	if (io.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		foreach (const QByteArray& line, io.readAll().split('\n'))
+		{
+			if (line.startsWith("rchar:"))
+				return line.mid(6).trimmed().toLongLong();
+		}
+	}
+#endif
+	return -1;
+}
+
+void StelStartupProfile::addEntry(const Entry& entry)
+{
+	QMutexLocker locker(&mutex);
+	entries.append(entry);
+}
+
+QList<StelStartupProfile::Entry> StelStartupProfile::getEntries() const
+{
+	QMutexLocker locker(&mutex);
+	return entries;
+}
+
+bool StelStartupProfile::writeToFile(const QString& fileName) const
+{
+	QVariantList list;
+	foreach (const Entry& e, getEntries())
+	{
+		QVariantMap m;
+		m["module"] = e.module;
+		m["phase"] = e.phase;
+		m["mainThread"] = e.mainThread;
+		m["start"] = e.start;
+		m["duration"] = e.duration;
+		m["bytesRead"] = e.bytesRead;
+		list << m;
+	}
+	QVariantMap profile;
+	profile["total"] = elapsed();
+	profile["entries"] = list;
+
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+	{
+		qWarning() << "Could not write the startup profile to" << QDir::toNativeSeparators(fileName);
+		return false;
+	}
+	StelJsonParser::write(profile, &file);
+	file.close();
+	qDebug() << "Startup profile written to" << QDir::toNativeSeparators(fileName);
+	return true;
+}
@@ -0,0 +1,82 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELSTARTUPPROFILE_HPP_
+#define _STELSTARTUPPROFILE_HPP_
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+//! @class StelStartupProfile
+//! Timeline of the startup of the program: when the preloading and the initialization of each module
+//! started, how long it took, and how many bytes the process read meanwhile.
+//! Entries can be recorded from any thread. The timeline is written as JSON by writeToFile().
+class StelStartupProfile
+{
+public:
+	//! A recorded step of the startup
+	struct Entry
+	{
+		QString module;
+		//! "preload" or "init"
+		QString phase;
+		//! true if the step ran in the main thread
+		bool mainThread;
+		//! Start time in ms since the creation of the profile
+		qint64 start;
+		//! Wall time in ms
+		qint64 duration;
+		//! Bytes read by the whole process during the step, or -1 if unknown.
+		//! Includes the reads of steps running at the same time in other threads.
+		qint64 bytesRead;
+	};
+
+	//! Measures a step from its construction until it is destroyed
+	class Step
+	{
+	public:
+		Step(StelStartupProfile* profile, const QString& module, const QString& phase);
+		~Step();
+	private:
+		StelStartupProfile* profile;
+		Entry entry;
+	};
+
+	StelStartupProfile();
+
+	//! Get the number of ms since the creation of the profile
+	qint64 elapsed() const {return timer.elapsed();}
+	//! Get the number of bytes read by the process so far, or -1 if this is not supported on this platform
+	static qint64 processBytesRead();
+
+	void addEntry(const Entry& entry);
+	QList<Entry> getEntries() const;
+
+	//! Write the timeline as JSON, with the total startup time and the entries in the order they finished.
+	bool writeToFile(const QString& fileName) const;
+
+private:
+	QElapsedTimer timer;
+	mutable QMutex mutex;
+	QList<Entry> entries;
+};
+
+#endif // _STELSTARTUPPROFILE_HPP_
@@ -0,0 +1,157 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelZoneIndex.hpp"
+#include "StelGeodesicGrid.hpp"
+
+#include <cmath>
+
+// Larger searches don't gain anything from the zones, and the search polygon
+// built in findAround() is only valid for small areas.
+static const double MAX_ZONE_SEARCH_FOV = 45.;
+
+StelZoneIndex::StelZoneIndex(int level)
+	: level(level)
+	, grid(new StelGeodesicGrid(level))
+{
+}
+
+StelZoneIndex::~StelZoneIndex()
+{
+	delete grid;
+}
+
+void StelZoneIndex::clear()
+{
+	positions.clear();
+	objects.clear();
+	zoneStart.clear();
+}
+
+void StelZoneIndex::setPositions(const QVector<Vec3d>& newPositions)
+{
+	clear();
+	const int nbObjects = newPositions.size();
+	if (nbObjects==0)
+		return;
+
+	// Count the objects of each zone, then place them with a counting sort
+	QVector<int> objectZones(nbObjects);
+	zoneStart.fill(0, StelGeodesicGrid::nrOfZones(level)+1);
+	for (int i=0; i<nbObjects; ++i)
+	{
+		Vec3d pos = newPositions.at(i);
+		pos.normalize();
+		const int zone = grid->getZoneNumberForPoint(Vec3f(pos[0], pos[1], pos[2]), level);
+		objectZones[i] = zone;
+		++zoneStart[zone+1];
+	}
+	for (int z=1; z<zoneStart.size(); ++z)
+		zoneStart[z] += zoneStart.at(z-1);
+
+	QVector<int> next = zoneStart;
+	positions.resize(nbObjects);
+	objects.resize(nbObjects);
+	for (int i=0; i<nbObjects; ++i)
+	{
+		const int k = next[objectZones.at(i)]++;
+		positions[k] = newPositions.at(i);
+		positions[k].normalize();
+		objects[k] = i;
+	}
+}
+
+void StelZoneIndex::appendZone(int zone, const Vec3d& v, double cosLimit, QVector<int>& result) const
+{
+	const int end = zoneStart.at(zone+1);
+	for (int k=zoneStart.at(zone); k<end; ++k)
+	{
+		if (positions.at(k)*v>=cosLimit)
+			result.append(objects.at(k));
+	}
+}
+
+void StelZoneIndex::findInRegion(const QVector<SphericalCap>& region, QVector<int>& result) const
+{
+	if (objects.isEmpty())
+		return;
+
+	// every object passes the distance test
+	const Vec3d v(1., 0., 0.);
+	const double cosLimit = -2.;
+	const GeodesicSearchResult* searchResult = grid->search(region, level);
+	int zone;
+	for (GeodesicSearchInsideIterator it(*searchResult, level); (zone = it.next()) >= 0;)
+		appendZone(zone, v, cosLimit, result);
+	for (GeodesicSearchBorderIterator it(*searchResult, level); (zone = it.next()) >= 0;)
+		appendZone(zone, v, cosLimit, result);
+}
+
+void StelZoneIndex::findAround(const Vec3d& av, double limitFov, QVector<int>& result) const
+{
+	if (objects.isEmpty())
+		return;
+
+	Vec3d v(av);
+	v.normalize();
+	const double cosLimit = std::cos(limitFov*M_PI/180.);
+	if (limitFov>=MAX_ZONE_SEARCH_FOV)
+	{
+		for (int k=0; k<positions.size(); ++k)
+		{
+			if (positions.at(k)*v>=cosLimit)
+				result.append(objects.at(k));
+		}
+		return;
+	}
+
+	// Build a square around v containing the searched circle, as done by StarMgr::searchAround().
+	// The zone search is only exact for half spaces going through the origin, so
+	// the square is used instead of the circle itself.
+	int i = 0;
+	if (std::fabs(v[1])<std::fabs(v[i]))
+		i = 1;
+	if (std::fabs(v[2])<std::fabs(v[i]))
+		i = 2;
+	Vec3d h0(0.,0.,0.);
+	h0[i] = 1.;
+	Vec3d h1 = h0 ^ v;
+	h1.normalize();
+	h0 = h1 ^ v;
+	h0.normalize();
+	const double f = 1.4142136*std::tan(limitFov*M_PI/180.);
+	h0 *= f;
+	h1 *= f;
+	Vec3d e0 = v + h0;
+	Vec3d e1 = v + h1;
+	Vec3d e2 = v - h0;
+	Vec3d e3 = v - h1;
+	e0.normalize();
+	e1.normalize();
+	e2.normalize();
+	e3.normalize();
+	const SphericalConvexPolygon square(e3, e2, e1, e0);
+
+	const GeodesicSearchResult* searchResult = grid->search(square.getBoundingSphericalCaps(), level);
+	int zone;
+	for (GeodesicSearchInsideIterator it(*searchResult, level); (zone = it.next()) >= 0;)
+		appendZone(zone, v, cosLimit, result);
+	for (GeodesicSearchBorderIterator it(*searchResult, level); (zone = it.next()) >= 0;)
+		appendZone(zone, v, cosLimit, result);
+}
@@ -0,0 +1,78 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELZONEINDEX_HPP_
+#define _STELZONEINDEX_HPP_
+
+#include "StelSphereGeometry.hpp"
+#include "VecMath.hpp"
+
+#include <QVector>
+
+class StelGeodesicGrid;
+
+//! @class StelZoneIndex
+//! Spatial index for catalogs of fixed point-like objects, like the ones shown by the Quasars or Pulsars plugins.
+//! The objects are sorted by the zone of a StelGeodesicGrid they lie in, and their positions are stored
+//! in one array in zone order, so that a query only looks at the objects of the zones overlapping the searched region.
+//! Objects are identified by their index in the list passed to setPositions().
+class StelZoneIndex
+{
+public:
+	//! @param level the level of the geodesic grid, the index has 20*4^level zones.
+	explicit StelZoneIndex(int level=3);
+	~StelZoneIndex();
+
+	//! Replace all objects of the index.
+	//! @param positions the J2000 equatorial positions, they don't need to be normalized.
+	void setPositions(const QVector<Vec3d>& positions);
+	//! Remove all objects.
+	void clear();
+	//! Return the number of objects in the index.
+	int size() const {return objects.size();}
+
+	//! Find the objects in the zones overlapping a convex region, e.g. the bounding caps of the viewport.
+	//! Objects in the zones on the border of the region may be outside of the region.
+	//! @param region the half spaces defining the region, see StelGeodesicGrid::search()
+	//! @param result the numbers of the found objects are appended to it.
+	void findInRegion(const QVector<SphericalCap>& region, QVector<int>& result) const;
+
+	//! Find the objects within a given angular distance of a direction.
+	//! @param v the searched direction in J2000 equatorial coordinates.
+	//! @param limitFov the angular distance in degrees.
+	//! @param result the numbers of the found objects are appended to it.
+	void findAround(const Vec3d& v, double limitFov, QVector<int>& result) const;
+
+private:
+	Q_DISABLE_COPY(StelZoneIndex)
+
+	//! Append the objects of a zone which are at least at cosLimit from v.
+	void appendZone(int zone, const Vec3d& v, double cosLimit, QVector<int>& result) const;
+
+	int level;
+	StelGeodesicGrid* grid;
+	//! Normalized positions of the objects, in zone order.
+	QVector<Vec3d> positions;
+	//! Numbers of the objects, in zone order.
+	QVector<int> objects;
+	//! The objects of zone z are in the range [zoneStart[z], zoneStart[z+1]) of the arrays above.
+	QVector<int> zoneStart;
+};
+
+#endif // _STELZONEINDEX_HPP_
@@ -25,10 +25,21 @@
 #include "StelCore.hpp"
 #include "StelPainter.hpp"
 #include "StelFileMgr.hpp"
+#include "StelModuleMgr.hpp"
+#include "SolarSystem.hpp"
 
 #include <QDebug>
 #include <QSettings>
 #include <QOpenGLShaderProgram>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+// Minimal number of grid rows worth being computed in a separate thread
+static const int MIN_ROWS_PER_BLOCK = 8;
+// Sun and moon movements up to this angle (in radians) don't cause a new computation of the luminances
+static const float MAX_DIRECTION_CHANGE = 1e-5f;
 
 inline bool myisnan(double value)
 {
@@ -40,6 +51,10 @@ Atmosphere::Atmosphere(void)
 	, skyResolutionY(44)
 	, skyResolutionX(44)
 	, posGrid(NULL)
+	, dirGrid(NULL)
+	, dirGridValid(false)
+	, colorGridValid(false)
+	, gridAverageLuminance(0.f)
 	, posGridBuffer(QOpenGLBuffer::VertexBuffer)
 	, indicesBuffer(QOpenGLBuffer::IndexBuffer)
 	, colorGrid(NULL)
@@ -107,6 +122,8 @@ Atmosphere::~Atmosphere(void)
 {
 	delete [] posGrid;
 	posGrid = NULL;
+	delete [] dirGrid;
+	dirGrid = NULL;
 	delete[] colorGrid;
 	colorGrid = NULL;
 	delete atmoShaderProgram;
@@ -123,10 +140,14 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 		viewport = prj->getViewport();
 		delete[] colorGrid;
 		delete [] posGrid;
+		delete [] dirGrid;
 		skyResolutionY = StelApp::getInstance().getSettings()->value("landscape/atmosphereybin", 44).toInt();
 		skyResolutionX = (int)floor(0.5+skyResolutionY*(0.5*std::sqrt(3.0))*prj->getViewportWidth()/prj->getViewportHeight());
 		posGrid = new Vec2f[(1+skyResolutionX)*(1+skyResolutionY)];
+		dirGrid = new Vec3f[(1+skyResolutionX)*(1+skyResolutionY)];
 		colorGrid = new Vec4f[(1+skyResolutionX)*(1+skyResolutionY)];
+		dirGridValid = false;
+		colorGridValid = false;
 		float stepX = (float)prj->getViewportWidth() / (skyResolutionX-0.5);
 		float stepY = (float)prj->getViewportHeight() / skyResolutionY;
 		float viewport_left = (float)prj->getViewportPosX();
@@ -231,58 +252,125 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 		return;
 	}
 
-	// Calculate the atmosphere RGB for each point of the grid
-	float sunPos[3];
-	sunPos[0] = _sunPos[0];
-	sunPos[1] = _sunPos[1];
-	sunPos[2] = _sunPos[2];
+	// The directions of the grid points only depend on the view
+	const StelProjector::StelProjectorParams params = core->getCurrentStelProjectorParams();
+	ViewState view;
+	view.modelView = prj->getModelViewTransform()->getApproximateLinearTransfo();
+	view.viewportCenter = prj->getViewportCenter();
+	view.pixelPerRad = prj->getPixelPerRadAtCenter();
+	view.projectionType = core->getCurrentProjectionType();
+	view.flipHorz = params.flipHorz;
+	view.flipVert = params.flipVert;
+	view.widthStretch = params.widthStretch;
+	if (!dirGridValid || !(view==lastView))
+	{
+		dirGridValid = false;
+		colorGridValid = false;
+	}
 
-	float moon_pos[3];
-	moon_pos[0] = moonPos[0];
-	moon_pos[1] = moonPos[1];
-	moon_pos[2] = moonPos[2];
+	// The luminances only depend on these parameters
+	SkyState state;
+	state.sunPos.set(_sunPos[0], _sunPos[1], _sunPos[2]);
+	state.moonPos.set(moonPos[0], moonPos[1], moonPos[2]);
+	state.moonPhase = moonPhase;
+	int day;
+	StelUtils::getDateFromJulianDay(JD, &state.year, &state.month, &day);
+	state.latitude = latitude;
+	state.altitude = altitude;
+	state.temperature = temperature;
+	state.relativeHumidity = relativeHumidity;
+	state.eclipseFactor = eclipseFactor;
+	state.lightPollutionLuminance = lightPollutionLuminance;
+	// No Sun and Moon on the sky
+	// Details: https://bugs.launchpad.net/stellarium/+bug/1499699
+	state.flagPlanets = GETSTELMODULE(SolarSystem)->getFlagPlanets();
+
+	// A static view in a slowly changing sky doesn't need the whole grid every frame
+	if (colorGridValid && state.isCloseTo(lastSky))
+	{
+		if (!overrideAverageLuminance)
+			averageLuminance = gridAverageLuminance;
+		return;
+	}
+	lastView = view;
+	lastSky = state;
 
-	sky.setParamsv(sunPos, 5.f);
+	sky.setParamsv(state.sunPos, 5.f);
 
 	skyb.setLocation(latitude * M_PI/180., altitude, temperature, relativeHumidity);
-	skyb.setSunMoon(moon_pos[2], sunPos[2]);
-
-	// Calculate the date from the julian day.
-	int year, month, day;
-	StelUtils::getDateFromJulianDay(JD, &year, &month, &day);
-	skyb.setDate(year, month, moonPhase);
+	skyb.setSunMoon(state.moonPos[2], state.sunPos[2]);
+	skyb.setDate(state.year, state.month, moonPhase);
+
+	// Split the grid rows over the worker threads, the blocks are large enough to be worth a thread
+	const int pointCount = (1+skyResolutionX)*(1+skyResolutionY);
+	const int blockCount = qBound(1, (1+skyResolutionY)/MIN_ROWS_PER_BLOCK, QThreadPool::globalInstance()->maxThreadCount());
+	QVector<GridBlock> blocks(blockCount);
+	for (int b=0; b<blockCount; ++b)
+	{
+		GridBlock& block = blocks[b];
+		block.atmosphere = this;
+		block.prj = prj.data();
+		block.begin = (1+skyResolutionY)*b/blockCount*(1+skyResolutionX);
+		block.end = (1+skyResolutionY)*(b+1)/blockCount*(1+skyResolutionX);
+		block.unProject = !dirGridValid;
+		block.sumLuminance = 0.f;
+	}
+	if (blockCount==1)
+		computeGridBlock(blocks[0]);
+	else
+		QtConcurrent::blockingMap(blocks, &Atmosphere::computeGridBlock);
+	dirGridValid = true;
+	colorGridValid = true;
 
 	// Variables used to compute the average sky luminance
 	float sum_lum = 0.f;
+	foreach (const GridBlock& block, blocks)
+		sum_lum += block.sumLuminance;
+
+	colorGridBuffer.bind();
+	colorGridBuffer.write(0, colorGrid, pointCount*4*4);
+	colorGridBuffer.release();
+	
+	// Update average luminance
+	gridAverageLuminance = sum_lum/pointCount;
+	if (!overrideAverageLuminance)
+		averageLuminance = gridAverageLuminance;
+}
+
+void Atmosphere::computeGridBlock(GridBlock& block)
+{
+	Atmosphere* atm = block.atmosphere;
+	const Vec3f& sunPos = atm->lastSky.sunPos;
+	const Vec3f& moon_pos = atm->lastSky.moonPos;
+	const float eclipseFactor = atm->lastSky.eclipseFactor;
+	const float lightPollutionLuminance = atm->lastSky.lightPollutionLuminance;
 
 	Vec3d point(1., 0., 0.);
 	float lumi;
 
 	// Compute the sky color for every point above the ground
-	for (int i=0; i<(1+skyResolutionX)*(1+skyResolutionY); ++i)
+	for (int i=block.begin; i<block.end; ++i)
 	{
-		const Vec2f &v(posGrid[i]);
-		prj->unProject(v[0],v[1],point);
-
-		Q_ASSERT(fabs(point.lengthSquared()-1.0) < 1e-10);
-
-		// Use mirroring for sun only
-		if (point[2]<=0)
+		Vec3f& dir = atm->dirGrid[i];
+		if (block.unProject)
 		{
-			point[2] = -point[2];
-			// The sky below the ground is the symmetric of the one above :
-			// it looks nice and gives proper values for brightness estimation
-			// Use the Skybright.cpp 's models for brightness which gives better results.
-			lumi = skyb.getLuminance(moon_pos[0]*point[0]+moon_pos[1]*point[1]-
-					moon_pos[2]*point[2], sunPos[0]*point[0]+sunPos[1]*point[1]+
-					sunPos[2]*point[2], point[2]);
+			const Vec2f &v(atm->posGrid[i]);
+			block.prj->unProject(v[0],v[1],point);
+			Q_ASSERT(fabs(point.lengthSquared()-1.0) < 1e-10);
+			dir.set(point[0], point[1], point[2]);
 		}
+
+		// Use mirroring for sun only
+		// The sky below the ground is the symmetric of the one above :
+		// it looks nice and gives proper values for brightness estimation
+		const float z = std::fabs(dir[2]);
+		if (!atm->lastSky.flagPlanets)
+			lumi = 0.f;
 		else
 		{
 			// Use the Skybright.cpp 's models for brightness which gives better results.
-			lumi = skyb.getLuminance(moon_pos[0]*point[0]+moon_pos[1]*point[1]+
-					moon_pos[2]*point[2], sunPos[0]*point[0]+sunPos[1]*point[1]+
-					sunPos[2]*point[2], point[2]);
+			lumi = atm->skyb.getLuminance(moon_pos[0]*dir[0]+moon_pos[1]*dir[1]+moon_pos[2]*dir[2],
+					sunPos[0]*dir[0]+sunPos[1]*dir[1]+sunPos[2]*z, z);
 		}
 		lumi *= eclipseFactor;
 		// Add star background luminance
@@ -295,21 +383,38 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 		lumi += lightPollutionLuminance;
 
 		// Store for later statistics
-		sum_lum+=lumi;
+		block.sumLuminance+=lumi;
 
 		// Now need to compute the xy part of the color component
 		// This is done in the openGL shader
 		// Store the back projected position + luminance in the input color to the shader
-		colorGrid[i].set(point[0], point[1], point[2], lumi);
+		atm->colorGrid[i].set(dir[0], dir[1], z, lumi);
 	}
-	
-	colorGridBuffer.bind();
-	colorGridBuffer.write(0, colorGrid, (1+skyResolutionX)*(1+skyResolutionY)*4*4);
-	colorGridBuffer.release();
-	
-	// Update average luminance
-	if (!overrideAverageLuminance)
-		averageLuminance = sum_lum/((1+skyResolutionX)*(1+skyResolutionY));
+}
+
+bool Atmosphere::ViewState::operator==(const ViewState& other) const
+{
+	return std::equal(modelView.r, modelView.r+16, other.modelView.r)
+		&& viewportCenter==other.viewportCenter
+		&& pixelPerRad==other.pixelPerRad
+		&& projectionType==other.projectionType
+		&& flipHorz==other.flipHorz
+		&& flipVert==other.flipVert
+		&& widthStretch==other.widthStretch;
+}
+
+bool Atmosphere::SkyState::isCloseTo(const SkyState& other) const
+{
+	const float maxChange2 = MAX_DIRECTION_CHANGE*MAX_DIRECTION_CHANGE;
+	return (sunPos-other.sunPos).lengthSquared()<maxChange2
+		&& (moonPos-other.moonPos).lengthSquared()<maxChange2
+		&& std::fabs(moonPhase-other.moonPhase)<MAX_DIRECTION_CHANGE
+		&& year==other.year && month==other.month
+		&& latitude==other.latitude && altitude==other.altitude
+		&& temperature==other.temperature && relativeHumidity==other.relativeHumidity
+		&& eclipseFactor==other.eclipseFactor
+		&& lightPollutionLuminance==other.lightPollutionLuminance
+		&& flagPlanets==other.flagPlanets;
 }
 
 // override computable luminance. This is for special operations only, e.g. for scripting of brightness-balanced image export.
@@ -386,6 +491,7 @@ void Atmosphere::draw(StelCore* core)
 	for (int y=0;y<skyResolutionY;++y)
 	{
 		sPainter.glFuncs()->glDrawElements(GL_TRIANGLE_STRIP, (skyResolutionX+1)*2, GL_UNSIGNED_SHORT, reinterpret_cast<void*>(shift));
+		StelPainter::countDrawCall((skyResolutionX+1)*2);
 		shift += (skyResolutionX+1)*2*2;
 	}
 	indicesBuffer.release();
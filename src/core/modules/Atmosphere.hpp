@@ -80,12 +80,57 @@ public:
 	float getLightPollutionLuminance() const { return lightPollutionLuminance; }
 
 private:
+	//! The view parameters which determine the directions of the grid points
+	struct ViewState
+	{
+		Mat4d modelView;
+		Vec2f viewportCenter;
+		float pixelPerRad;
+		int projectionType;
+		bool flipHorz, flipVert;
+		float widthStretch;
+		bool operator==(const ViewState& other) const;
+	};
+	//! The parameters of the luminance model
+	struct SkyState
+	{
+		Vec3f sunPos, moonPos;
+		float moonPhase;
+		int year, month;
+		float latitude, altitude, temperature, relativeHumidity;
+		float eclipseFactor;
+		float lightPollutionLuminance;
+		bool flagPlanets;
+		//! Whether the luminances computed with the other state can be reused for this one
+		bool isCloseTo(const SkyState& other) const;
+	};
+	//! A range of grid points computed by one thread
+	struct GridBlock
+	{
+		Atmosphere* atmosphere;
+		const StelProjector* prj;
+		int begin, end;
+		bool unProject;
+		float sumLuminance;
+	};
+	static void computeGridBlock(GridBlock& block);
+
 	Vec4i viewport;
 	Skylight sky;
 	Skybright skyb;
 	int skyResolutionY,skyResolutionX;
 
 	Vec2f* posGrid;
+	//! The direction of each grid point, before mirroring the part below the horizon
+	Vec3f* dirGrid;
+	//! Whether dirGrid matches lastView
+	bool dirGridValid;
+	ViewState lastView;
+	//! Whether colorGrid matches lastSky and lastView
+	bool colorGridValid;
+	SkyState lastSky;
+	//! The average luminance of colorGrid
+	float gridAverageLuminance;
 	QOpenGLBuffer posGridBuffer;
 	QOpenGLBuffer indicesBuffer;
 	Vec4f* colorGrid;
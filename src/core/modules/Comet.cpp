@@ -33,6 +33,7 @@
 #include "StelFileMgr.hpp"
 #include "StelMovementMgr.hpp"
 #include "StelModuleMgr.hpp"
+#include "StelSphereGeometry.hpp"
 #include "LandscapeMgr.hpp"
 
 #include <QRegExp>
@@ -42,11 +43,12 @@
 #define COMET_TAIL_SLICES 16 // segments around the perimeter
 #define COMET_TAIL_STACKS 16 // cuts along the rotational axis
 
-// These are to avoid having index arrays for each comet when all are equal.
-bool Comet::createTailIndices=true;
-bool Comet::createTailTextureCoords=true;
+// These are to avoid having mesh arrays for each comet when all are equal.
 StelTextureSP Comet::comaTexture;
 StelTextureSP Comet::tailTexture;
+QVector<double> Comet::comaVertexArr; // computed only once for all Comets.
+QVector<float> Comet::comaTexCoordArr; // computed only once for all Comets.
+QVector<Vec3d> Comet::tailTemplateArr; // computed only once for all Comets.
 QVector<float> Comet::tailTexCoordArr; // computed only once for all Comets.
 QVector<unsigned short> Comet::tailIndices; // computed only once for all Comets.
 
@@ -92,6 +94,10 @@ Comet::Comet(const QString& englishName,
 	  tailBright(false),
 	  deltaJDEtail(15.0*StelCore::JD_MINUTE), // update tail geometry every 15 minutes only
 	  lastJDEtail(0.0),
+	  tailGeometryDirty(true),
+	  tailColorsDirty(true),
+	  tailColorsAtmosphere(false),
+	  tailColorsAtmLum(0.0f),
 	  dustTailWidthFactor(dustTailWidthFact),
 	  dustTailLengthFactor(dustTailLengthFact),
 	  dustTailBrightnessFactor(dustTailBrightnessFact)
@@ -100,9 +106,7 @@ Comet::Comet(const QString& englishName,
 	rotLocalToParent = Mat4d::identity();
 	texMap = StelApp::getInstance().getTextureManager().createTextureThread(StelFileMgr::getInstallationDir()+"/textures/"+texMapName, StelTexture::StelTextureParams(true, GL_LINEAR, GL_REPEAT));
 
-	gastailVertexArr.clear();
 	dusttailVertexArr.clear();
-	comaVertexArr.clear();
 	gastailColorArr.clear();
 	dusttailColorArr.clear();
 
@@ -326,99 +330,85 @@ void Comet::update(int deltaTime)
 {
 	Planet::update(deltaTime);
 
-	// The rest deals with updating tail geometries and brightness
-	StelCore* core=StelApp::getInstance().getCore();
-	double dateJDE=core->getJDE();
+	// Only the tail size estimate is kept up to date here: it is cheap and also used in the info string.
+	// Meshes, orientation and brightness of tails are prepared lazily in draw(), only for comets which pass
+	// the magnitude and viewport tests there. (There *are* folks downloading all MPC current comet elements...)
+	const double dateJDE=StelApp::getInstance().getCore()->getJDE();
 
 	// The CometOrbit is in fact available in userDataPtr!
 	CometOrbit* orbit=(CometOrbit*)userDataPtr;
 	Q_ASSERT(orbit);
 	if (!orbit->objectDateValid(dateJDE)) return; // don't do anything if out of useful date range. This allows having hundreds of comet elements.
 
-
 	//GZ: I think we can make deltaJDtail adaptive, depending on distance to sun! For some reason though, this leads to a crash!
 	//deltaJDtail=StelCore::JD_SECOND * qMax(1.0, qMin(eclipticPos.length(), 20.0));
 
-	if (fabs(lastJDEtail-dateJDE)>deltaJDEtail)
+	if (fabs(lastJDEtail-dateJDE)>deltaJDEtail && orbit->getUpdateTails())
 	{
 		lastJDEtail=dateJDE;
-
-		// The CometOrbit is in fact available in userDataPtr!
-		CometOrbit* orbit=(CometOrbit*)userDataPtr;
-		Q_ASSERT(orbit);
-		if (!orbit->objectDateValid(dateJDE)) return; // out of useful date range. This should allow having hundreds of comet elements.
-
-		if (orbit->getUpdateTails()){
-			// Compute lengths and orientations from orbit object, but only if required.
-			tailFactors=getComaDiameterAndTailLengthAU();
-
-			// Note that we use a diameter larger than what the formula returns. A scale factor of 1.2 is ad-hoc/empirical (GZ), but may look better.
-			computeComa(1.0f*tailFactors[0]); // TBD: APPARENTLY NO SCALING? REMOVE 1.0 and note above.
-
-			tailActive = (tailFactors[1] > tailFactors[0]); // Inhibit tails drawing if too short. Would be nice to include geometric projection angle, but this is too costly.
-
-			if (tailActive)
-			{
-				float gasTailEndRadius=qMax(tailFactors[0], 0.025f*tailFactors[1]) ; // This avoids too slim gas tails for bright comets like Hale-Bopp.
-				float gasparameter=gasTailEndRadius*gasTailEndRadius/(2.0f*tailFactors[1]); // parabola formula: z=r²/2p, so p=r²/2z
-				// The dust tail is thicker and usually shorter. The factors can be configured in the elements.
-				float dustparameter=gasTailEndRadius*gasTailEndRadius*dustTailWidthFactor*dustTailWidthFactor/(2.0f*dustTailLengthFactor*tailFactors[1]);
-
-				// Find valid parameters to create paraboloid vertex arrays: dustTail, gasTail.
-				computeParabola(gasparameter, gasTailEndRadius, -0.5f*gasparameter, gastailVertexArr,  tailTexCoordArr, tailIndices);
-				//gastailColorArr.fill(Vec3f(0.3,0.3,0.3), gastailVertexArr.length());
-				// Now we make a skewed parabola. Skew factor (xOffset, last arg) is rather ad-hoc/empirical. TBD later: Find physically correct solution.
-				computeParabola(dustparameter, dustTailWidthFactor*gasTailEndRadius, -0.5f*dustparameter, dusttailVertexArr, tailTexCoordArr, tailIndices, 25.0f*orbit->getVelocity().length());
-				//dusttailColorArr.fill(Vec3f(0.3,0.3,0.3), dusttailVertexArr.length());
-
-
-				// 2014-08 for 0.13.1 Moved from drawTail() to save lots of computation per frame (There *are* folks downloading all 730 MPC current comet elements...)
-				// Find rotation matrix from 0/0/1 to eclipticPosition: crossproduct for axis (normal vector), dotproduct for angle.
-				Vec3d eclposNrm=eclipticPos; eclposNrm.normalize();
-				gasTailRot=Mat4d::rotation(Vec3d(0.0, 0.0, 1.0)^(eclposNrm), std::acos(Vec3d(0.0, 0.0, 1.0).dot(eclposNrm)) );
-
-				Vec3d velocity=orbit->getVelocity(); // [AU/d]
-				// This was a try to rotate a straight parabola somewhat away from the antisolar direction.
-				//Mat4d dustTailRot=Mat4d::rotation(eclposNrm^(-velocity), 0.15f*std::acos(eclposNrm.dot(-velocity))); // GZ: This scale factor of 0.15 is empirical from photos of Halley and Hale-Bopp.
-				// The curved tail is curved towards positive X. We first rotate around the Z axis into a direction opposite of the motion vector, then again the antisolar rotation applies.
-				// In addition, we let the dust tail already start with a light tilt.
-				dustTailRot=gasTailRot * Mat4d::zrotation(atan2(velocity[1], velocity[0]) + M_PI) * Mat4d::yrotation(5.0f*velocity.length());
-
-				// Rotate vertex arrays:
-				Vec3d* gasVertices=(Vec3d*) (gastailVertexArr.data());
-				Vec3d* dustVertices=(Vec3d*) (dusttailVertexArr.data());
-				for (int i=0; i<COMET_TAIL_SLICES*COMET_TAIL_STACKS+1; ++i)
-				{
-					gasVertices[i].transfo4d(gasTailRot);
-					dustVertices[i].transfo4d(dustTailRot);
-				}
-			}
-			orbit->setUpdateTails(false); // don't update until position has been recalculated elsewhere
-		}
+		tailFactors=getComaDiameterAndTailLengthAU();
+		tailActive = (tailFactors[1] > tailFactors[0]); // Inhibit tails drawing if too short. Would be nice to include geometric projection angle, but this is too costly.
+		tailGeometryDirty=true;
+		orbit->setUpdateTails(false); // don't update until position has been recalculated elsewhere
 	}
+}
 
-	// And also update magnitude and tail brightness/extinction here.
-	const bool withAtmosphere=(core->getSkyDrawer()->getFlagHasAtmosphere());
-
-	StelToneReproducer* eye = core->getToneReproducer();
-	float lum = core->getSkyDrawer()->surfacebrightnessToLuminance(getVMagnitude(core)+13.0f); // How to calibrate?
-	// Get the luminance scaled between 0 and 1
-	float aLum =eye->adaptLuminanceScaled(lum);
+void Comet::computeTailGeometry()
+{
+	// The CometOrbit is in fact available in userDataPtr!
+	const CometOrbit* orbit=(const CometOrbit*)userDataPtr;
+	Q_ASSERT(orbit);
 
+	if (tailTemplateArr.isEmpty())
+		computeTemplates();
+
+	const float gasTailEndRadius=qMax(tailFactors[0], 0.025f*tailFactors[1]) ; // This avoids too slim gas tails for bright comets like Hale-Bopp.
+	const float gasparameter=gasTailEndRadius*gasTailEndRadius/(2.0f*tailFactors[1]); // parabola formula: z=r²/2p, so p=r²/2z
+	// The dust tail is thicker and usually shorter. The factors can be configured in the elements.
+	const float dustparameter=gasTailEndRadius*gasTailEndRadius*dustTailWidthFactor*dustTailWidthFactor/(2.0f*dustTailLengthFactor*tailFactors[1]);
+
+	// Find rotation matrix from 0/0/1 to eclipticPosition: crossproduct for axis (normal vector), dotproduct for angle.
+	Vec3d eclposNrm=eclipticPos; eclposNrm.normalize();
+	gasTailRot=Mat4d::rotation(Vec3d(0.0, 0.0, 1.0)^(eclposNrm), std::acos(Vec3d(0.0, 0.0, 1.0).dot(eclposNrm)) );
+
+	const Vec3d velocity=orbit->getVelocity(); // [AU/d]
+	// This was a try to rotate a straight parabola somewhat away from the antisolar direction.
+	//Mat4d dustTailRot=Mat4d::rotation(eclposNrm^(-velocity), 0.15f*std::acos(eclposNrm.dot(-velocity))); // GZ: This scale factor of 0.15 is empirical from photos of Halley and Hale-Bopp.
+	// The curved tail is curved towards positive X. We first rotate around the Z axis into a direction opposite of the motion vector, then again the antisolar rotation applies.
+	// In addition, we let the dust tail already start with a light tilt.
+	dustTailRot=gasTailRot * Mat4d::zrotation(atan2(velocity[1], velocity[0]) + M_PI) * Mat4d::yrotation(5.0f*velocity.length());
+
+	// The gas tail is a straight paraboloid: the template only needs scaling, shifting and rotation.
+	// Template z runs 0..1, and z=r²/2p gives the full tail length for r=gasTailEndRadius.
+	gasTailMat=gasTailRot * Mat4d::translation(Vec3d(0.0, 0.0, -0.5f*gasparameter))
+			* Mat4d::scaling(Vec3d(gasTailEndRadius, gasTailEndRadius, gasTailEndRadius*gasTailEndRadius/(2.0f*gasparameter)));
+
+	// Now we make a skewed parabola. Skew factor (xOffset) is rather ad-hoc/empirical. TBD later: Find physically correct solution.
+	// The bend is not linear, so this one still needs its own vertices. Rotation is applied as matrix when drawing.
+	const float dustRadius=dustTailWidthFactor*gasTailEndRadius;
+	const float dustLength=dustRadius*dustRadius/(2.0f*dustparameter);
+	const float dustZShift=-0.5f*dustparameter;
+	const float xOffset=25.0f*velocity.length();
+	dusttailVertexArr.resize(tailTemplateArr.size());
+	for (int i=0; i<tailTemplateArr.size(); ++i)
+	{
+		const Vec3d& t=tailTemplateArr.at(i);
+		const double z=dustLength*t[2]+dustZShift;
+		dusttailVertexArr[i].set(dustRadius*t[0]+xOffset*z*z, dustRadius*t[1], z);
+	}
 
-	// To make comet more apparent in overviews, take field of view into account:
-	const float fov=core->getProjection(core->getAltAzModelViewTransform())->getFov();
-	if (fov>20)
-		aLum*= (fov/20.0f);
+	tailGeometryDirty=false;
+	tailColorsDirty=true;
+}
 
-	// Now inhibit tail drawing if still too dim.
+bool Comet::computeTailColors(StelCore* core, float aLum)
+{
+	// Now inhibit tail drawing if too dim.
 	if (aLum<0.002f)
 	{
 		// Far too dim: don't even show tail...
-		tailBright=false;
-		return;
-	} else
-		tailBright=true;
+		return false;
+	}
 
 	// Separate factors, but avoid overly bright tails. I limit to about 0.7 for overlapping both tails which should not exceed full-white.
 	float gasMagFactor=qMin(0.9f*aLum, 0.7f);
@@ -427,6 +417,26 @@ void Comet::update(int deltaTime)
 	Vec3f gasColor(0.15f*gasMagFactor,0.35f*gasMagFactor,0.6f*gasMagFactor); // Orig color 0.15/0.15/0.6
 	Vec3f dustColor(dustMagFactor, dustMagFactor,0.6f*dustMagFactor);
 
+	const bool withAtmosphere=(core->getSkyDrawer()->getFlagHasAtmosphere());
+	const float avgAtmLum=withAtmosphere ? GETSTELMODULE(LandscapeMgr)->getAtmosphereAverageLuminance() : 0.0f;
+	// The extinction pattern only moves with the sky: keep the colors while the zenith stays within about a tenth of a degree.
+	const Vec3d zenith=core->altAzToJ2000(Vec3d(0.0, 0.0, 1.0), StelCore::RefractionOff);
+
+	if (!tailColorsDirty
+		&& withAtmosphere==tailColorsAtmosphere
+		&& (gasColor-tailColorsGas).lengthSquared()<1e-6f
+		&& (dustColor-tailColorsDust).lengthSquared()<1e-6f
+		&& fabs(avgAtmLum-tailColorsAtmLum)<0.01f*qMax(avgAtmLum, 0.1f)
+		&& zenith.dot(tailColorsZenith)>0.999998)
+		return true;
+
+	tailColorsDirty=false;
+	tailColorsAtmosphere=withAtmosphere;
+	tailColorsGas=gasColor;
+	tailColorsDust=dustColor;
+	tailColorsAtmLum=avgAtmLum;
+	tailColorsZenith=zenith;
+
 	if (withAtmosphere)
 	{
 		Extinction extinction=core->getSkyDrawer()->getExtinction();
@@ -435,16 +445,15 @@ void Comet::update(int deltaTime)
 		// I consider sky brightness over 1cd/m^2 as reason to shorten tail.
 		// Below this brightness, the tail brightness loss by this method is insignificant:
 		// Just counting through the vertices might make a spiral apperance. Maybe even better than stackwise? Let's see...
-		const float avgAtmLum=GETSTELMODULE(LandscapeMgr)->getAtmosphereAverageLuminance();
 		const float brightnessDecreasePerVertexFromHead=1.0f/(COMET_TAIL_SLICES*COMET_TAIL_STACKS)  * avgAtmLum;
 		float brightnessPerVertexFromHead=1.0f;
 
 		gastailColorArr.clear();
 		dusttailColorArr.clear();
-		for (int i=0; i<gastailVertexArr.size(); ++i)
+		for (int i=0; i<tailTemplateArr.size(); ++i)
 		{
 			// Gastail extinction:
-			Vec3d vertAltAz=core->j2000ToAltAz(gastailVertexArr.at(i), StelCore::RefractionOn);
+			Vec3d vertAltAz=core->j2000ToAltAz(gasTailMat*tailTemplateArr.at(i), StelCore::RefractionOn);
 			vertAltAz.normalize();
 			Q_ASSERT(fabs(vertAltAz.lengthSquared()-1.0) < 0.001);
 			float oneMag=0.0f;
@@ -453,7 +462,7 @@ void Comet::update(int deltaTime)
 			gastailColorArr.append(gasColor*extinctionFactor* brightnessPerVertexFromHead);
 
 			// dusttail extinction:
-			vertAltAz=core->j2000ToAltAz(dusttailVertexArr.at(i), StelCore::RefractionOn);
+			vertAltAz=core->j2000ToAltAz(dustTailRot*dusttailVertexArr.at(i), StelCore::RefractionOn);
 			vertAltAz.normalize();
 			Q_ASSERT(fabs(vertAltAz.lengthSquared()-1.0) < 0.001);
 			oneMag=0.0f;
@@ -466,12 +475,27 @@ void Comet::update(int deltaTime)
 	}
 	else // no atmosphere: set all vertices to same brightness.
 	{
-		gastailColorArr.fill(gasColor,   gastailVertexArr.length());
-		dusttailColorArr.fill(dustColor, dusttailVertexArr.length());
+		gastailColorArr.fill(gasColor,   tailTemplateArr.size());
+		dusttailColorArr.fill(dustColor, tailTemplateArr.size());
 	}
 	//qDebug() << "Comet " << getEnglishName() <<  "JDE: " << date << "gasR" << gasColor[0] << " dustR" << dustColor[0];
+	return true;
 }
 
+bool Comet::isTailInViewport(const StelCore* core) const
+{
+	// Bounding sphere around both tails: they start near the head and reach at most the gas tail length, plus the dust tail width.
+	const float tailLength=qMax(tailFactors[1], dustTailLengthFactor*tailFactors[1]);
+	const double radius=0.5*tailLength + dustTailWidthFactor*qMax(tailFactors[0], 0.025f*tailFactors[1]);
+	const Vec3d center=getHeliocentricEclipticPos() + gasTailRot.multiplyWithoutTranslation(Vec3d(0.0, 0.0, 0.5*tailLength));
+	Vec3d dir=StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(center-core->getObserverHeliocentricEclipticPos());
+	const double dist=dir.length();
+	if (dist<=radius)
+		return true;
+	dir/=dist;
+	const SphericalCap tailCap(dir, std::cos(std::asin(radius/dist)));
+	return core->getProjection(StelCore::FrameJ2000)->getBoundingCap().intersects(tailCap);
+}
 
 // Draw the Comet and all the related infos: name, circle etc... GZ: Taken from Planet.cpp 2013-11-05 and extended
 void Comet::draw(StelCore* core, float maxMagLabels, const QFont& planetNameFont)
@@ -543,11 +567,31 @@ void Comet::draw(StelCore* core, float maxMagLabels, const QFont& planetNameFont
 		return;
 	}
 
+	// Tails and coma are computed only from here on, i.e. for comets which are bright enough to be drawn.
+	if (tailFactors[0]<=0.0f)
+		return; // not yet computed in update()
+	if (tailGeometryDirty)
+		computeTailGeometry();
+
+	StelToneReproducer* eye = core->getToneReproducer();
+	float lum = core->getSkyDrawer()->surfacebrightnessToLuminance(getVMagnitude(core)+13.0f); // How to calibrate?
+	// Get the luminance scaled between 0 and 1
+	float aLum =eye->adaptLuminanceScaled(lum);
+
+	// To make comet more apparent in overviews, take field of view into account:
+	const float fov=prj->getFov();
+	if (fov>20)
+		aLum*= (fov/20.0f);
+
 	// but tails should also be drawn if comet core is off-screen...
-	if (tailActive && tailBright)
+	if (tailActive && isTailInViewport(core))
 	{
-		drawTail(core,transfo,true);  // gas tail
-		drawTail(core,transfo,false); // dust tail
+		tailBright=computeTailColors(core, aLum);
+		if (tailBright)
+		{
+			drawTail(core,transfo,true);  // gas tail
+			drawTail(core,transfo,false); // dust tail
+		}
 	}
 	//Coma: this is just a fan disk tilted towards the observer;-)
 	drawComa(core, transfo);
@@ -556,14 +600,17 @@ void Comet::draw(StelCore* core, float maxMagLabels, const QFont& planetNameFont
 
 void Comet::drawTail(StelCore* core, StelProjector::ModelViewTranformP transfo, bool gas)
 {	
-	StelPainter sPainter(core->getProjection(transfo));
+	// Both tails share the template mesh indices, and the gas tail even the template vertices.
+	StelProjector::ModelViewTranformP transfo2 = transfo->clone();
+	transfo2->combine(gas ? gasTailMat : dustTailRot);
+	StelPainter sPainter(core->getProjection(transfo2));
 	sPainter.setBlending(true, GL_ONE, GL_ONE);
 	sPainter.setCullFace(false);
 
 	tailTexture->bind();
 
 	if (gas) {
-		sPainter.setArrays((Vec3d*)gastailVertexArr.constData(), (Vec2f*)tailTexCoordArr.constData(), (Vec3f*)gastailColorArr.constData());
+		sPainter.setArrays((Vec3d*)tailTemplateArr.constData(), (Vec2f*)tailTexCoordArr.constData(), (Vec3f*)gastailColorArr.constData());
 		sPainter.drawFromArray(StelPainter::Triangles, tailIndices.size(), 0, true, tailIndices.constData());
 
 	} else {
@@ -579,7 +626,8 @@ void Comet::drawComa(StelCore* core, StelProjector::ModelViewTranformP transfo)
 	Vec3d eclposNrm=eclipticPos - core->getObserverHeliocentricEclipticPos()  ; eclposNrm.normalize();
 	Mat4d comarot=Mat4d::rotation(Vec3d(0.0, 0.0, 1.0)^(eclposNrm), std::acos(Vec3d(0.0, 0.0, 1.0).dot(eclposNrm)) );
 	StelProjector::ModelViewTranformP transfo2 = transfo->clone();
-	transfo2->combine(comarot);
+	// The template coma has unit diameter.
+	transfo2->combine(comarot*Mat4d::scaling(tailFactors[0]));
 	StelPainter sPainter(core->getProjection(transfo2));
 
 	sPainter.setBlending(true, GL_ONE, GL_ONE);
@@ -611,23 +659,21 @@ Vec2f Comet::getComaDiameterAndTailLengthAU()
 	return Vec2f(D, L);
 }
 
-void Comet::computeComa(const float diameter)
+//! create the shared meshes for all comets:
+//! The coma is a fan disk of unit diameter.
+//! The tail is a parabola shell of unit radius and unit length.
+//! Designed for slices=16, stacks=16, but should work with other sizes as well.
+//! (Maybe slices must be an even number.)
+// Parabola equation: z=x²/2p, here with r=1 at z=1. A tail of end radius R, parameter p, and shift zs along z is obtained
+// by scaling x,y with R and z with R²/2p and shifting by zs. This is done by matrix for the gas tail (gasTailMat) and with a bend
+// for the dust tail in computeTailGeometry().
+void Comet::computeTemplates()
 {
-	StelPainter::computeFanDisk(0.5f*diameter, 3, 3, comaVertexArr, comaTexCoordArr);
-}
+	StelPainter::computeFanDisk(0.5f, 3, 3, comaVertexArr, comaTexCoordArr);
 
-//! create parabola shell to represent a tail. Designed for slices=16, stacks=16, but should work with other sizes as well.
-//! (Maybe slices must be an even number.)
-// Parabola equation: z=x²/2p.
-// xOffset for the dust tail, this may introduce a bend. Units are x per sqrt(z).
-void Comet::computeParabola(const float parameter, const float radius, const float zshift,
-			    QVector<Vec3d>& vertexArr, QVector<float>& texCoordArr, QVector<unsigned short> &indices, const float xOffset) {
-
-	// keep the array and replace contents. However, using replace() is only slightly faster.
-	if (vertexArr.length() < ((COMET_TAIL_SLICES*COMET_TAIL_STACKS+1)))
-		vertexArr.resize((COMET_TAIL_SLICES*COMET_TAIL_STACKS+1));
-	if (createTailIndices) indices.clear();
-	if (createTailTextureCoords) texCoordArr.clear();
+	tailTemplateArr.clear();
+	tailTexCoordArr.clear();
+	tailIndices.clear();
 	int i;
 	// The parabola has triangular faces with vertices on two circles that are rotated against each other. 
 	float xa[2*COMET_TAIL_SLICES];
@@ -641,50 +687,44 @@ void Comet::computeParabola(const float parameter, const float radius, const flo
 		ya[i]=cos(i*da);
 	}
 	
-	vertexArr.replace(0, Vec3d(0.0, 0.0, zshift));
-	int vertexArrIndex=1;
-	if (createTailTextureCoords) texCoordArr << 0.5f << 0.5f;
+	tailTemplateArr.reserve(COMET_TAIL_SLICES*COMET_TAIL_STACKS+1);
+	tailTemplateArr << Vec3d(0.0, 0.0, 0.0);
+	tailTexCoordArr << 0.5f << 0.5f;
 	// define the indices lying on circles, starting at 1: odd rings have 1/slices+1/2slices, even-numbered rings straight 1/slices
 	// inner ring#1
 	int ring;
 	for (ring=1; ring<=COMET_TAIL_STACKS; ++ring){
-		z=ring*radius/COMET_TAIL_STACKS; z=z*z/(2*parameter) + zshift;
-		float xShift= xOffset*z*z;
+		z=(float)ring/COMET_TAIL_STACKS; z=z*z;
 		for (i=ring & 1; i<2*COMET_TAIL_SLICES; i+=2) { // i.e., ring1 has shifted vertices, ring2 has even ones.
-			x=xa[i]*radius*ring/COMET_TAIL_STACKS;
-			y=ya[i]*radius*ring/COMET_TAIL_STACKS;
-			vertexArr.replace(vertexArrIndex++, Vec3d(x+xShift, y, z));
-			if (createTailTextureCoords) texCoordArr << 0.5+ 0.5*x/radius << 0.5+0.5*y/radius;
+			x=xa[i]*ring/COMET_TAIL_STACKS;
+			y=ya[i]*ring/COMET_TAIL_STACKS;
+			tailTemplateArr << Vec3d(x, y, z);
+			tailTexCoordArr << 0.5+ 0.5*x << 0.5+0.5*y;
 		}
 	}
 	// now link the faces with indices.
-	if (createTailIndices)
-	{
-		for (i=1; i<COMET_TAIL_SLICES; ++i) indices << 0 << i << i+1;
-		indices << 0 << COMET_TAIL_SLICES << 1; // close inner fan.
-		// The other slices are a repeating pattern of 2 possibilities. Index @ring always is on the inner ring (slices-agon)
-		for (ring=1; ring<COMET_TAIL_STACKS; ring+=2) { // odd rings
-			const int first=(ring-1)*COMET_TAIL_SLICES+1;
-			for (i=0; i<COMET_TAIL_SLICES-1; ++i){
-				indices << first+i << first+COMET_TAIL_SLICES+i << first+COMET_TAIL_SLICES+1+i;
-				indices << first+i << first+COMET_TAIL_SLICES+1+i << first+1+i;
-			}
-			// closing slice: mesh with other indices...
-			indices << ring*COMET_TAIL_SLICES << (ring+1)*COMET_TAIL_SLICES << ring*COMET_TAIL_SLICES+1;
-			indices << ring*COMET_TAIL_SLICES << ring*COMET_TAIL_SLICES+1 << first;
+	for (i=1; i<COMET_TAIL_SLICES; ++i) tailIndices << 0 << i << i+1;
+	tailIndices << 0 << COMET_TAIL_SLICES << 1; // close inner fan.
+	// The other slices are a repeating pattern of 2 possibilities. Index @ring always is on the inner ring (slices-agon)
+	for (ring=1; ring<COMET_TAIL_STACKS; ring+=2) { // odd rings
+		const int first=(ring-1)*COMET_TAIL_SLICES+1;
+		for (i=0; i<COMET_TAIL_SLICES-1; ++i){
+			tailIndices << first+i << first+COMET_TAIL_SLICES+i << first+COMET_TAIL_SLICES+1+i;
+			tailIndices << first+i << first+COMET_TAIL_SLICES+1+i << first+1+i;
 		}
+		// closing slice: mesh with other indices...
+		tailIndices << ring*COMET_TAIL_SLICES << (ring+1)*COMET_TAIL_SLICES << ring*COMET_TAIL_SLICES+1;
+		tailIndices << ring*COMET_TAIL_SLICES << ring*COMET_TAIL_SLICES+1 << first;
+	}
 
-		for (ring=2; ring<COMET_TAIL_STACKS; ring+=2) { // even rings: different sequence.
-			const int first=(ring-1)*COMET_TAIL_SLICES+1;
-			for (i=0; i<COMET_TAIL_SLICES-1; ++i){
-				indices << first+i << first+COMET_TAIL_SLICES+i << first+1+i;
-				indices << first+1+i << first+COMET_TAIL_SLICES+i << first+COMET_TAIL_SLICES+1+i;
-			}
-			// closing slice: mesh with other indices...
-			indices << ring*COMET_TAIL_SLICES << (ring+1)*COMET_TAIL_SLICES << first;
-			indices << first << (ring+1)*COMET_TAIL_SLICES << ring*COMET_TAIL_SLICES+1;
+	for (ring=2; ring<COMET_TAIL_STACKS; ring+=2) { // even rings: different sequence.
+		const int first=(ring-1)*COMET_TAIL_SLICES+1;
+		for (i=0; i<COMET_TAIL_SLICES-1; ++i){
+			tailIndices << first+i << first+COMET_TAIL_SLICES+i << first+1+i;
+			tailIndices << first+1+i << first+COMET_TAIL_SLICES+i << first+COMET_TAIL_SLICES+1+i;
 		}
+		// closing slice: mesh with other indices...
+		tailIndices << ring*COMET_TAIL_SLICES << (ring+1)*COMET_TAIL_SLICES << first;
+		tailIndices << first << (ring+1)*COMET_TAIL_SLICES << ring*COMET_TAIL_SLICES+1;
 	}
-	createTailIndices=false;
-	createTailTextureCoords=false;
 }
@@ -105,7 +105,8 @@ public:
 	//! re-implementation of Planet's draw()
 	virtual void draw(StelCore* core, float maxMagLabels, const QFont& planetNameFont);
 
-	// re-implementation of Planet's update() to prepare tails (extinction etc). @param deltaTime: ms (since last call)
+	// re-implementation of Planet's update() to update tail size estimates. Tail geometry and extinction are prepared lazily in draw().
+	// @param deltaTime: ms (since last call)
 	virtual void update(int deltaTime);
 
 private:
@@ -115,21 +116,19 @@ private:
 	void drawTail(StelCore* core, StelProjector::ModelViewTranformP transfo, bool gas);
 	void drawComa(StelCore* core, StelProjector::ModelViewTranformP transfo);
 
-	//! compute a coma, faked as simple disk to be tilted towards the observer.
-	//! @param diameter Diameter of Coma [AU]
-	void computeComa(const float diameter);
-
-	//! compute tail shape. This is a paraboloid shell with triangular mesh (indexed vertices).
-	//! Try to call not for every frame...
-	//! To be more efficient, the arrays are only computed if they are empty.
-	//! @param parameter the parameter p of the parabola. z=r²/2p (r²=x²+y²)
-	//! @param lengthfactor The parabola will be lengthened. This shifts the visible focus, so it must be here.
-	//! @param vertexArr vertex array, collects x0, y0, z0, x1, y1, z1, ...
-	//! @param texCoordArr texture coordinates u0, v0, u1, v1, ...
-	//! @param colorArr vertex colors (if not textured) r0, g0, b0, r1, g1, b1, ...
-	//! @param indices into the former arrays (zero-starting), triplets forming triangles: t0,0, t0,1, t0,2, t1,0, t1,1, t1,2, ...
-	//! @param xOffset for the dust tail, this may introduce a bend. Units are x per sqrt(z).
-	void computeParabola(const float parameter, const float topradius, const float zshift, QVector<Vec3d>& vertexArr, QVector<float>& texCoordArr, QVector<unsigned short>& indices, const float xOffset=0.0f);
+	//! compute the meshes shared by all comets: coma and tail template. See Comet.cpp for details.
+	static void computeTemplates();
+
+	//! compute orientation and shape of both tails from the latest tailFactors. Called from draw() only when required.
+	void computeTailGeometry();
+
+	//! compute tail brightness and extinction, if anything relevant changed since the last call.
+	//! @param aLum adapted luminance of the comet.
+	//! @return false if the tail is too dim to be drawn.
+	bool computeTailColors(StelCore* core, float aLum);
+
+	//! @return true if the bounding sphere of the tails intersects the viewport.
+	bool isTailInViewport(const StelCore* core) const;
 
 	double absoluteMagnitude;
 	double slopeParameter;
@@ -144,21 +143,27 @@ private:
 	double deltaJDEtail;            //! like deltaJDE, but time difference between tail geometry updates.
 	double lastJDEtail;             //! like lastJDE, but time of last tail geometry update.
 	Mat4d gasTailRot;		//! rotation matrix for gas tail parabola
+	Mat4d gasTailMat;		//! scaling, shift and rotation of the template paraboloid to the gas tail
 	Mat4d dustTailRot;		//! rotation matrix for the skewed dust tail parabola
+	bool tailGeometryDirty;		//! true if tailFactors changed since the last computeTailGeometry()
+	bool tailColorsDirty;		//! true if gastailColorArr/dusttailColorArr must be recomputed
+	bool tailColorsAtmosphere;	//! last inputs of computeTailColors(), to detect changes
+	Vec3f tailColorsGas;
+	Vec3f tailColorsDust;
+	float tailColorsAtmLum;
+	Vec3d tailColorsZenith;
 	float dustTailWidthFactor;      //!< empirical individual broadening of the dust tail end, compared to the gas tail end. Actually, dust tail width=2*comaWidth*dustTailWidthFactor. Default 1.5
 	float dustTailLengthFactor;     //!< empirical individual length of dust tail relative to gas tail. Taken from ssystem.ini, typical value 0.3..0.5, default 0.4
 	float dustTailBrightnessFactor; //!< empirical individual brightness of dust tail relative to gas tail. Taken from ssystem.ini, default 1.5
-	QVector<double> comaVertexArr;
-	QVector<float> comaTexCoordArr; //  --> 2014-08: could also be declared static, but it is filled by StelPainter...
 
-	// These are to avoid having index arrays for each comet when all are equal.
-	static bool createTailIndices;
-	static bool createTailTextureCoords;
+	QVector<Vec3d> dusttailVertexArr; // computed in draw() when required, describes bent parabolic shape (along z axis) of dust tail. Rotation is applied when drawing.
+	QVector<Vec3f> gastailColorArr;    // computed in draw() when required, modulates gas tail brightness for extinction
+	QVector<Vec3f> dusttailColorArr;   // computed in draw() when required, modulates dust tail brightness for extinction
 
-	QVector<Vec3d> gastailVertexArr;  // computed frequently, describes parabolic shape (along z axis) of gas tail.
-	QVector<Vec3d> dusttailVertexArr; // computed frequently, describes parabolic shape (along z axis) of dust tail.
-	QVector<Vec3f> gastailColorArr;    // NEW computed for every 5 mins, modulates gas tail brightness for extinction
-	QVector<Vec3f> dusttailColorArr;   // NEW computed for every 5 mins, modulates dust tail brightness for extinction
+	// These are to avoid having mesh arrays for each comet when all are equal.
+	static QVector<double> comaVertexArr;   // computed only once for all comets: coma disk of unit diameter
+	static QVector<float> comaTexCoordArr;  // computed only once for all comets!
+	static QVector<Vec3d> tailTemplateArr;  // computed only once for all comets: paraboloid of unit radius and length
 	static QVector<float> tailTexCoordArr; // computed only once for all comets!
 	static QVector<unsigned short> tailIndices; // computed only once for all comets!
 	static StelTextureSP comaTexture;
@@ -38,6 +38,24 @@
 #include <QSettings>
 #include <QDebug>
 #include <QFontMetrics>
+#include <QHash>
+
+//! @class SkyCircle
+//! A great or small circle of a grid or line, tessellated in the frame of the grid or line.
+//! The vertices are only recomputed when the circle or the resolution changes, so that drawing
+//! the circle only costs the projection done by StelPainter::addPathToLineBatch().
+class SkyCircle
+{
+public:
+	SkyCircle() : d(0.), nbSegments(0) {}
+	//! Get the closed path along the border of the cap of normal n and d, made of nbSegments segments.
+	const QVector<Vec3d>& getVertices(const Vec3d& n, double d, int nbSegments);
+private:
+	Vec3d n;
+	double d;
+	int nbSegments;
+	QVector<Vec3d> vertices;
+};
 
 //! @class SkyGrid
 //! Class which manages a grid to display in the sky.
@@ -47,7 +65,7 @@ public:
 	// Create and precompute positions of a SkyGrid
 	SkyGrid(StelCore::FrameType frame);
 	virtual ~SkyGrid();
-	void draw(const StelCore* prj) const;
+	void draw(const StelCore* prj, StelPainter::LineBatch& lineBatch) const;
 	void setFontSize(double newFontSize);
 	void setColor(const Vec3f& c) {color = c;}
 	const Vec3f& getColor() {return color;}
@@ -56,10 +74,17 @@ public:
 	void setDisplayed(const bool displayed){fader = displayed;}
 	bool isDisplayed(void) const {return fader;}
 private:
+	//! Get the vertices of a meridian or parallel, reusing the tessellation of the previous frame if possible.
+	const QVector<Vec3d>& getCircleVertices(QHash<int, SkyCircle>& circles, QHash<int, SkyCircle>& oldCircles, int key,
+						const SphericalCap& cap, int nbSegments) const;
+
 	Vec3f color;
 	StelCore::FrameType frameType;
 	QFont font;
 	LinearFader fader;
+	//! Meridians and parallels drawn in the last frame, by their number of grid steps from longitude or latitude 0
+	mutable QHash<int, SkyCircle> meridians;
+	mutable QHash<int, SkyCircle> parallels;
 };
 
 //! @class SkyPoint
@@ -132,7 +157,7 @@ public:
 	// Create and precompute positions of a SkyGrid
 	SkyLine(SKY_LINE_TYPE _line_type = EQUATOR_J2000);
 	virtual ~SkyLine();
-	void draw(StelCore* core) const;
+	void draw(StelCore* core, StelPainter::LineBatch& lineBatch) const;
 	void setColor(const Vec3f& c) {color = c;}
 	const Vec3f& getColor() {return color;}
 	void update(double deltaTime) {fader.update((int)(deltaTime*1000));}
@@ -150,6 +175,7 @@ private:
 	LinearFader fader;
 	QFont font;
 	QString label;
+	mutable SkyCircle circle;
 };
 
 // rms added color as parameter
@@ -202,6 +228,60 @@ static double getClosestResolutionHMS(double pixelPerRad)
 	return 15.;
 }
 
+// Maximum distance in pixels between a circle and the segments of its cached tessellation
+static const double MAX_TESSELLATION_ERROR = 0.1;
+// Maximum length in pixels of the segments of a cached tessellation, like in the adaptive tesselation of StelPainter
+static const double MAX_SEGMENT_LENGTH = 50.;
+// Above this, the circles are tesselated every frame by StelPainter::drawSmallCircleArc(), which only subdivides the visible part.
+static const int MAX_CIRCLE_SEGMENTS = 4096;
+
+//! Return the number of segments of the cached circles for the scale of the projector, or 0 if the view is zoomed in too much.
+//! Only powers of 2 are used, so that the cached circles stay valid while zooming a bit.
+static int getCircleSegments(const StelProjectorP& prj)
+{
+	const double pixelPerRad = prj->getPixelPerRadAtCenter();
+	for (int nbSegments=64; nbSegments<=MAX_CIRCLE_SEGMENTS; nbSegments*=2)
+	{
+		// Distance between the middle of a segment of a great circle and the circle, and length of the segment
+		if ((1.-std::cos(M_PI/nbSegments))*pixelPerRad<=MAX_TESSELLATION_ERROR && 2.*M_PI/nbSegments*pixelPerRad<=MAX_SEGMENT_LENGTH)
+			return nbSegments;
+	}
+	return 0;
+}
+
+//! Return the viewport bounding cap enlarged by the length of a segment,
+//! so that it contains both ends of all segments intersecting the viewport.
+static SphericalCap getCullingCap(const SphericalCap& viewPortSphericalCap, int nbSegments)
+{
+	const double radius = std::acos(qBound(-1., viewPortSphericalCap.d, 1.)) + 2.*M_PI/nbSegments;
+	return SphericalCap(viewPortSphericalCap.n, radius<M_PI ? std::cos(radius) : -2.);
+}
+
+const QVector<Vec3d>& SkyCircle::getVertices(const Vec3d& an, double ad, int anbSegments)
+{
+	if (anbSegments==nbSegments && ad==d && an==n)
+		return vertices;
+	n = an;
+	d = ad;
+	nbSegments = anbSegments;
+
+	// Orthonormal base of the plane of the circle
+	Vec3d u = std::fabs(n[2])<0.9 ? n^Vec3d(0,0,1) : n^Vec3d(1,0,0);
+	u.normalize();
+	const Vec3d v = n^u;
+	const Vec3d center = n*d;
+	const double radius = std::sqrt(qMax(0., 1.-d*d));
+
+	vertices.resize(nbSegments+1);
+	for (int i=0; i<nbSegments; ++i)
+	{
+		const double angle = 2.*M_PI*i/nbSegments;
+		vertices[i] = center + (u*std::cos(angle) + v*std::sin(angle))*radius;
+	}
+	vertices[nbSegments] = vertices.at(0);
+	return vertices;
+}
+
 struct ViewportEdgeIntersectCallbackData
 {
 	ViewportEdgeIntersectCallbackData(StelPainter* p)
@@ -360,8 +440,18 @@ void viewportEdgeIntersectCallback(const Vec3d& screenPos, const Vec3d& directio
 	d->sPainter->setBlending(true);
 }
 
+const QVector<Vec3d>& SkyGrid::getCircleVertices(QHash<int, SkyCircle>& circles, QHash<int, SkyCircle>& oldCircles, int key,
+						  const SphericalCap& cap, int nbSegments) const
+{
+	QHash<int, SkyCircle>::iterator it = circles.find(key);
+	if (it==circles.end())
+		it = circles.insert(key, oldCircles.take(key));
+	return it->getVertices(cap.n, cap.d, nbSegments);
+}
+
 //! Draw the sky grid in the current frame
-void SkyGrid::draw(const StelCore* core) const
+//! Unless zoomed in a lot, the lines are only added to lineBatch, which is drawn later by GridLinesMgr.
+void SkyGrid::draw(const StelCore* core, StelPainter::LineBatch& lineBatch) const
 {
 	const StelProjectorP prj = core->getProjection(frameType, frameType!=StelCore::FrameAltAz ? StelCore::RefractionAuto : StelCore::RefractionOff);
 	if (!fader.getInterstate())
@@ -421,6 +511,15 @@ void SkyGrid::draw(const StelCore* core) const
 	userData.textColor = textColor;
 	userData.frameType = frameType;
 
+	const Vec4f lineColor(color[0], color[1], color[2], fader.getInterstate());
+	const int nbSegments = getCircleSegments(prj);
+	const SphericalCap cullingCap = nbSegments ? getCullingCap(viewPortSphericalCap, nbSegments) : viewPortSphericalCap;
+	// Only the tessellation of the circles drawn in the last frame is kept
+	QHash<int, SkyCircle> oldMeridians;
+	QHash<int, SkyCircle> oldParallels;
+	oldMeridians.swap(meridians);
+	oldParallels.swap(parallels);
+
 	/////////////////////////////////////////////////
 	// Draw all the meridians (great circles)
 	SphericalCap meridianSphericalCap(Vec3d(1,0,0), 0);
@@ -440,6 +539,12 @@ void SkyGrid::draw(const StelCore* core) const
 		{
 			if (viewPortSphericalCap.d<meridianSphericalCap.d && viewPortSphericalCap.contains(meridianSphericalCap.n))
 			{
+				if (nbSegments)
+				{
+					sPainter.addPathToLineBatch(lineBatch, getCircleVertices(meridians, oldMeridians, qRound(lon2/gridStepMeridianRad), meridianSphericalCap, nbSegments), cullingCap, lineColor, viewportEdgeIntersectCallback, &userData);
+					fpt.transfo4d(rotLon);
+					continue;
+				}
 				// The meridian is fully included in the viewport, draw it in 3 sub-arcs to avoid length > 180.
 				const Mat4d& rotLon120 = Mat4d::rotation(meridianSphericalCap.n, 120.*M_PI/180.);
 				Vec3d rotFpt=fpt;
@@ -456,6 +561,13 @@ void SkyGrid::draw(const StelCore* core) const
 				break;
 		}
 
+		if (nbSegments)
+		{
+			sPainter.addPathToLineBatch(lineBatch, getCircleVertices(meridians, oldMeridians, qRound(lon2/gridStepMeridianRad), meridianSphericalCap, nbSegments), cullingCap, lineColor, viewportEdgeIntersectCallback, &userData);
+			fpt.transfo4d(rotLon);
+			continue;
+		}
+
 		Vec3d middlePoint = p1+p2;
 		middlePoint.normalize();
 		if (!viewPortSphericalCap.contains(middlePoint))
@@ -483,6 +595,13 @@ void SkyGrid::draw(const StelCore* core) const
 			if (!SphericalCap::intersectionPoints(viewPortSphericalCap, meridianSphericalCap, p1, p2))
 				break;
 
+			if (nbSegments)
+			{
+				sPainter.addPathToLineBatch(lineBatch, getCircleVertices(meridians, oldMeridians, qRound(lon2/gridStepMeridianRad), meridianSphericalCap, nbSegments), cullingCap, lineColor, viewportEdgeIntersectCallback, &userData);
+				fpt.transfo4d(rotLon);
+				continue;
+			}
+
 			Vec3d middlePoint = p1+p2;
 			middlePoint.normalize();
 			if (!viewPortSphericalCap.contains(middlePoint))
@@ -519,6 +638,12 @@ void SkyGrid::draw(const StelCore* core) const
 			if ((viewPortSphericalCap.d<parallelSphericalCap.d && viewPortSphericalCap.contains(parallelSphericalCap.n))
 				|| (viewPortSphericalCap.d<-parallelSphericalCap.d && viewPortSphericalCap.contains(-parallelSphericalCap.n)))
 			{
+				if (nbSegments)
+				{
+					sPainter.addPathToLineBatch(lineBatch, getCircleVertices(parallels, oldParallels, qRound(lat2/gridStepParallelRad), parallelSphericalCap, nbSegments), cullingCap, lineColor, viewportEdgeIntersectCallback, &userData);
+					fpt.transfo4d(rotLon);
+					continue;
+				}
 				// The parallel is fully included in the viewport, draw it in 3 sub-arcs to avoid lengths >= 180 deg
 				static const Mat4d rotLon120 = Mat4d::zrotation(120.*M_PI/180.);
 				Vec3d rotFpt=fpt;
@@ -535,6 +660,13 @@ void SkyGrid::draw(const StelCore* core) const
 				break;
 		}
 
+		if (nbSegments)
+		{
+			sPainter.addPathToLineBatch(lineBatch, getCircleVertices(parallels, oldParallels, qRound(lat2/gridStepParallelRad), parallelSphericalCap, nbSegments), cullingCap, lineColor, viewportEdgeIntersectCallback, &userData);
+			fpt.transfo4d(rotLon);
+			continue;
+		}
+
 		// Draw the arc in 2 sub-arcs to avoid lengths > 180 deg
 		Vec3d middlePoint = p1-rotCenter+p2-rotCenter;
 		middlePoint.normalize();
@@ -573,6 +705,12 @@ void SkyGrid::draw(const StelCore* core) const
 				if ((viewPortSphericalCap.d<parallelSphericalCap.d && viewPortSphericalCap.contains(parallelSphericalCap.n))
 					 || (viewPortSphericalCap.d<-parallelSphericalCap.d && viewPortSphericalCap.contains(-parallelSphericalCap.n)))
 				{
+					if (nbSegments)
+					{
+						sPainter.addPathToLineBatch(lineBatch, getCircleVertices(parallels, oldParallels, qRound(lat2/gridStepParallelRad), parallelSphericalCap, nbSegments), cullingCap, lineColor, viewportEdgeIntersectCallback, &userData);
+						fpt.transfo4d(rotLon);
+						continue;
+					}
 					// The parallel is fully included in the viewport, draw it in 3 sub-arcs to avoid lengths >= 180 deg
 					static const Mat4d rotLon120 = Mat4d::zrotation(120.*M_PI/180.);
 					Vec3d rotFpt=fpt;
@@ -589,6 +727,13 @@ void SkyGrid::draw(const StelCore* core) const
 					break;
 			}
 
+			if (nbSegments)
+			{
+				sPainter.addPathToLineBatch(lineBatch, getCircleVertices(parallels, oldParallels, qRound(lat2/gridStepParallelRad), parallelSphericalCap, nbSegments), cullingCap, lineColor, viewportEdgeIntersectCallback, &userData);
+				fpt.transfo4d(rotLon);
+				continue;
+			}
+
 			// Draw the arc in 2 sub-arcs to avoid lengths > 180 deg
 			Vec3d middlePoint = p1-rotCenter+p2-rotCenter;
 			middlePoint.normalize();
@@ -700,7 +845,8 @@ void SkyLine::updateLabel()
 	}
 }
 
-void SkyLine::draw(StelCore *core) const
+//! Unless zoomed in a lot, the line is only added to lineBatch, which is drawn later by GridLinesMgr.
+void SkyLine::draw(StelCore *core, StelPainter::LineBatch& lineBatch) const
 {
 	if (!fader.getInterstate())
 		return;
@@ -723,6 +869,9 @@ void SkyLine::draw(StelCore *core) const
 	sPainter.setFont(font);
 	userData.textColor = textColor;	
 	userData.text = label;
+
+	const Vec4f lineColor(color[0], color[1], color[2], fader.getInterstate());
+	const int nbSegments = getCircleSegments(prj);
 	/////////////////////////////////////////////////
 	// Draw the line
 
@@ -749,6 +898,13 @@ void SkyLine::draw(StelCore *core) const
 		SphericalCap declinationCap(Vec3d(0,0,1), std::sin(lat));
 		const Vec3d rotCenter(0,0,declinationCap.d);
 
+		if (nbSegments)
+		{
+			sPainter.addPathToLineBatch(lineBatch, circle.getVertices(declinationCap.n, declinationCap.d, nbSegments), getCullingCap(viewPortSphericalCap, nbSegments),
+						    lineColor, viewportEdgeIntersectCallback, &userData);
+			return;
+		}
+
 		Vec3d p1, p2;
 		if (!SphericalCap::intersectionPoints(viewPortSphericalCap, declinationCap, p1, p2))
 		{
@@ -823,6 +979,13 @@ void SkyLine::draw(StelCore *core) const
 		fpt.set(0,0,1);
 	}
 
+	if (nbSegments)
+	{
+		sPainter.addPathToLineBatch(lineBatch, circle.getVertices(meridianSphericalCap.n, meridianSphericalCap.d, nbSegments), getCullingCap(viewPortSphericalCap, nbSegments),
+					    lineColor, viewportEdgeIntersectCallback, &userData);
+		return;
+	}
+
 	Vec3d p1, p2;
 	if (!SphericalCap::intersectionPoints(viewPortSphericalCap, meridianSphericalCap, p1, p2))
 	{
@@ -1305,40 +1468,56 @@ void GridLinesMgr::draw(StelCore* core)
 	if (!gridlinesDisplayed)
 		return;
 
-	galacticGrid->draw(core);
-	supergalacticGrid->draw(core);
-	eclJ2000Grid->draw(core);
+	lineBatch.clear();
+	galacticGrid->draw(core, lineBatch);
+	supergalacticGrid->draw(core, lineBatch);
+	eclJ2000Grid->draw(core, lineBatch);
 	// While ecliptic of J2000 may be helpful to get a feeling of the Z=0 plane of VSOP87,
 	// ecliptic of date is related to Earth and does not make much sense for the other planets.
 	// Of course, orbital plane of respective planet would be better, but is not implemented.
-	if (core->getCurrentPlanet()==earth)
+	const bool onEarth = core->getCurrentPlanet()==earth;
+	if (onEarth)
+	{
+		eclGrid->draw(core, lineBatch);
+		eclipticLine->draw(core, lineBatch);
+		precessionCircleN->draw(core, lineBatch);
+		precessionCircleS->draw(core, lineBatch);
+		colureLine_1->draw(core, lineBatch);
+		colureLine_2->draw(core, lineBatch);
+		longitudeLine->draw(core, lineBatch);
+	}
+
+	equJ2000Grid->draw(core, lineBatch);
+	equGrid->draw(core, lineBatch);
+	aziGrid->draw(core, lineBatch);
+	// Lines after grids, to be able to e.g. draw equators in different color!
+	galacticEquatorLine->draw(core, lineBatch);
+	supergalacticEquatorLine->draw(core, lineBatch);
+	eclipticJ2000Line->draw(core, lineBatch);
+	equatorJ2000Line->draw(core, lineBatch);
+	equatorLine->draw(core, lineBatch);
+	meridianLine->draw(core, lineBatch);
+	horizonLine->draw(core, lineBatch);
+	primeVerticalLine->draw(core, lineBatch);
+	circumpolarCircleN->draw(core, lineBatch);
+	circumpolarCircleS->draw(core, lineBatch);
+
+	// All lines are in viewport coordinates now, so any projector can draw them, in one call
+	if (!lineBatch.isEmpty())
+	{
+		StelPainter sPainter(core->getProjection(StelCore::FrameJ2000));
+		sPainter.setBlending(true);
+		sPainter.setLineSmooth(true);
+		sPainter.drawLineBatch(lineBatch);
+		sPainter.setLineSmooth(false);
+	}
+
+	if (onEarth)
 	{
-		eclGrid->draw(core);
-		eclipticLine->draw(core);
-		precessionCircleN->draw(core);
-		precessionCircleS->draw(core);
-		colureLine_1->draw(core);
-		colureLine_2->draw(core);
 		eclipticPoles->draw(core);
 		equinoxPoints->draw(core);
 		solsticePoints->draw(core);
-		longitudeLine->draw(core);
 	}
-
-	equJ2000Grid->draw(core);
-	equGrid->draw(core);
-	aziGrid->draw(core);
-	// Lines after grids, to be able to e.g. draw equators in different color!
-	galacticEquatorLine->draw(core);
-	supergalacticEquatorLine->draw(core);
-	eclipticJ2000Line->draw(core);	
-	equatorJ2000Line->draw(core);
-	equatorLine->draw(core);
-	meridianLine->draw(core);
-	horizonLine->draw(core);
-	primeVerticalLine->draw(core);
-	circumpolarCircleN->draw(core);
-	circumpolarCircleS->draw(core);
 	celestialJ2000Poles->draw(core);
 	celestialPoles->draw(core);
 	zenithNadir->draw(core);
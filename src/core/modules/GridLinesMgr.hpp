@@ -23,6 +23,7 @@
 
 #include "VecMath.hpp"
 #include "StelModule.hpp"
+#include "StelPainter.hpp"
 #include "Planet.hpp"
 
 class SkyGrid;
@@ -905,6 +906,7 @@ private:
 	SkyPoint * equinoxPoints;		// Equinox points
 	SkyPoint * solsticeJ2000Points;		// Solstice points of J2000
 	SkyPoint * solsticePoints;		// Solstice points
+	StelPainter::LineBatch lineBatch;	// Lines of all grids and great circles, drawn in one call
 };
 
 #endif // _GRIDLINESMGR_HPP_
@@ -24,6 +24,7 @@
 #include "StelTexture.hpp"
 #include "StelUtils.hpp"
 
+#include <QVarLengthArray>
 #include <QtMath>
 
 Meteor::Meteor(const StelCore* core, const StelTextureSP& bolideTexture)
@@ -210,9 +211,20 @@ void Meteor::draw(const StelCore* core, StelPainter& sPainter)
 	float bolideSize;
 	calculateThickness(core, thickness, bolideSize);
 
-	drawTrain(sPainter, thickness);
+	DrawBuffer buffer;
+	append(buffer, thickness, bolideSize);
+	buffer.draw(sPainter, m_bolideTexture);
+}
 
-	drawBolide(sPainter, bolideSize);
+void Meteor::append(DrawBuffer& buffer, float thickness, float bolideSize)
+{
+	if (!m_alive)
+	{
+		return;
+	}
+
+	appendTrain(buffer, thickness);
+	appendBolide(buffer, bolideSize);
 }
 
 Vec4f Meteor::getColorFromName(QString colorName)
@@ -369,7 +381,7 @@ void Meteor::calculateThickness(const StelCore* core, float& thickness, float& b
 	bolideSize = thickness*3;
 }
 
-void Meteor::drawBolide(StelPainter& sPainter, const float& bolideSize)
+void Meteor::appendBolide(DrawBuffer& buffer, const float& bolideSize)
 {
 	if (!bolideSize || !m_bolideTexture)
 	{
@@ -377,45 +389,30 @@ void Meteor::drawBolide(StelPainter& sPainter, const float& bolideSize)
 	}
 
 	// bolide
-	//
-	QVector<Vec3d> vertexArrayBolide;
-	QVector<Vec4f> colorArrayBolide;
-	Vec4f bolideColor = Vec4f(1, 1, 1, m_aptMag);
-
-	Vec3d topLeft = m_position;
-	topLeft[1] -= bolideSize;
-	vertexArrayBolide.push_back(radiantToAltAz(topLeft));
-	colorArrayBolide.push_back(bolideColor);
-
-	Vec3d topRight = m_position;
-	topRight[0] -= bolideSize;
-	vertexArrayBolide.push_back(radiantToAltAz(topRight));
-	colorArrayBolide.push_back(bolideColor);
-
-	Vec3d bottomRight = m_position;
-	bottomRight[1] += bolideSize;
-	vertexArrayBolide.push_back(radiantToAltAz(bottomRight));
-	colorArrayBolide.push_back(bolideColor);
-
-	Vec3d bottomLeft = m_position;
-	bottomLeft[0] += bolideSize;
-	vertexArrayBolide.push_back(radiantToAltAz(bottomLeft));
-	colorArrayBolide.push_back(bolideColor);
-
-	sPainter.setBlending(true, GL_ONE, GL_ONE);
-	sPainter.enableClientStates(true, true, true);
-	m_bolideTexture->bind();
-	static const float texCoordData[] = {1.,0., 0.,0., 0.,1., 1.,1.};
-	sPainter.setTexCoordPointer(2, GL_FLOAT, texCoordData);
-	sPainter.setColorPointer(4, GL_FLOAT, colorArrayBolide.constData());
-	sPainter.setVertexPointer(3, GL_DOUBLE, vertexArrayBolide.constData());
-	sPainter.drawFromArray(StelPainter::TriangleFan, vertexArrayBolide.size(), 0, true);
+	// the quad is split into two triangles, (0,1,2) and (0,2,3)
+	const Vec4f bolideColor = Vec4f(1, 1, 1, m_aptMag);
+	static const Vec2f texCoords[4] = {Vec2f(1.f,0.f), Vec2f(0.f,0.f), Vec2f(0.f,1.f), Vec2f(1.f,1.f)};
+	static const int quadIndices[6] = {0, 1, 2, 0, 2, 3};
+
+	Vec3d corners[4] = {m_position, m_position, m_position, m_position};
+	corners[0][1] -= bolideSize; // top left
+	corners[1][0] -= bolideSize; // top right
+	corners[2][1] += bolideSize; // bottom right
+	corners[3][0] += bolideSize; // bottom left
+	for (int i = 0; i < 4; ++i)
+	{
+		corners[i] = radiantToAltAz(corners[i]);
+	}
 
-	sPainter.setBlending(false);
-	sPainter.enableClientStates(false);
+	for (int i = 0; i < 6; ++i)
+	{
+		buffer.bolideVertices.append(corners[quadIndices[i]]);
+		buffer.bolideTexCoords.append(texCoords[quadIndices[i]]);
+		buffer.bolideColors.append(bolideColor);
+	}
 }
 
-void Meteor::drawTrain(StelPainter& sPainter, const float& thickness)
+void Meteor::appendTrain(DrawBuffer& buffer, const float& thickness)
 {
 	if (m_segments != m_lineColorVector.size() || 2*m_segments != m_trainColorVector.size())
 	{
@@ -424,11 +421,10 @@ void Meteor::drawTrain(StelPainter& sPainter, const float& thickness)
 	}
 
 	// train (triangular prism)
-	//
-	QVector<Vec3d> vertexArrayLine;
-	QVector<Vec3d> vertexArrayL;
-	QVector<Vec3d> vertexArrayR;
-	QVector<Vec3d> vertexArrayTop;
+	// the three sides are built from the edges B, L and R of the prism, the line is drawn along the axis
+	QVarLengthArray<Vec3d, 16> line(m_segments), edgeB(m_segments), edgeL(m_segments), edgeR(m_segments);
+	QVarLengthArray<Vec4f, 16> lineColors(m_segments);
+	QVarLengthArray<Vec4f, 32> trainColors(2*m_segments);
 
 	Vec3d posTrainB = m_posTrain;
 	posTrainB[0] += thickness*0.7;
@@ -445,47 +441,105 @@ void Meteor::drawTrain(StelPainter& sPainter, const float& thickness)
 
 		posi = m_posTrain;
 		posi[2] = height;
-		vertexArrayLine.push_back(radiantToAltAz(posi));
+		line[i] = radiantToAltAz(posi);
 
 		posi = posTrainB;
 		posi[2] = height;
-		vertexArrayL.push_back(radiantToAltAz(posi));
-		vertexArrayR.push_back(radiantToAltAz(posi));
+		edgeB[i] = radiantToAltAz(posi);
 
 		posi = posTrainL;
 		posi[2] = height;
-		vertexArrayL.push_back(radiantToAltAz(posi));
-		vertexArrayTop.push_back(radiantToAltAz(posi));
+		edgeL[i] = radiantToAltAz(posi);
 
 		posi = posTrainR;
 		posi[2] = height;
-		vertexArrayR.push_back(radiantToAltAz(posi));
-		vertexArrayTop.push_back(radiantToAltAz(posi));
+		edgeR[i] = radiantToAltAz(posi);
 
 		float mag = m_aptMag * ((float) i / (float) (m_segments-1));
-		m_lineColorVector[i][3] = mag;
-		m_trainColorVector[i*2][3] = mag;
-		m_trainColorVector[i*2+1][3] = mag;
+		lineColors[i] = m_lineColorVector.at(i);
+		lineColors[i][3] = mag;
+		trainColors[i*2] = m_trainColorVector.at(i*2);
+		trainColors[i*2][3] = mag;
+		trainColors[i*2+1] = m_trainColorVector.at(i*2+1);
+		trainColors[i*2+1][3] = mag;
+	}
+
+	// the line strip is stored as separate lines
+	for (int i = 0; i < m_segments-1; ++i)
+	{
+		buffer.lineVertices.append(line[i]);
+		buffer.lineVertices.append(line[i+1]);
+		buffer.lineColors.append(lineColors[i]);
+		buffer.lineColors.append(lineColors[i+1]);
 	}
 
-	sPainter.setBlending(true);
-	sPainter.enableClientStates(true, false, true);
 	if (thickness)
 	{
-		sPainter.setColorPointer(4, GL_FLOAT, m_trainColorVector.constData());
+		appendStrip(buffer, edgeB.constData(), edgeL.constData(), trainColors.constData());
+		appendStrip(buffer, edgeB.constData(), edgeR.constData(), trainColors.constData());
+		appendStrip(buffer, edgeL.constData(), edgeR.constData(), trainColors.constData());
+	}
+}
 
-		sPainter.setVertexPointer(3, GL_DOUBLE, vertexArrayL.constData());
-		sPainter.drawFromArray(StelPainter::TriangleStrip, vertexArrayL.size(), 0, true);
+void Meteor::appendStrip(DrawBuffer& buffer, const Vec3d* a, const Vec3d* b, const Vec4f* colors)
+{
+	// triangles of the strip a0, b0, a1, b1, ..., the strip vertex k has the color k
+	for (int i = 0; i < m_segments-1; ++i)
+	{
+		buffer.trainVertices.append(a[i]);
+		buffer.trainVertices.append(b[i]);
+		buffer.trainVertices.append(a[i+1]);
+		buffer.trainVertices.append(b[i]);
+		buffer.trainVertices.append(a[i+1]);
+		buffer.trainVertices.append(b[i+1]);
+		buffer.trainColors.append(colors[i*2]);
+		buffer.trainColors.append(colors[i*2+1]);
+		buffer.trainColors.append(colors[i*2+2]);
+		buffer.trainColors.append(colors[i*2+1]);
+		buffer.trainColors.append(colors[i*2+2]);
+		buffer.trainColors.append(colors[i*2+3]);
+	}
+}
 
-		sPainter.setVertexPointer(3, GL_DOUBLE, vertexArrayR.constData());
-		sPainter.drawFromArray(StelPainter::TriangleStrip, vertexArrayR.size(), 0, true);
+void Meteor::DrawBuffer::clear()
+{
+	// resize() keeps the allocated memory for the next frame
+	trainVertices.resize(0);
+	trainColors.resize(0);
+	lineVertices.resize(0);
+	lineColors.resize(0);
+	bolideVertices.resize(0);
+	bolideColors.resize(0);
+	bolideTexCoords.resize(0);
+}
 
-		sPainter.setVertexPointer(3, GL_DOUBLE, vertexArrayTop.constData());
-		sPainter.drawFromArray(StelPainter::TriangleStrip, vertexArrayTop.size(), 0, true);
+void Meteor::DrawBuffer::draw(StelPainter& sPainter, const StelTextureSP& bolideTexture)
+{
+	sPainter.setBlending(true);
+	sPainter.enableClientStates(true, false, true);
+	if (!trainVertices.isEmpty())
+	{
+		sPainter.setColorPointer(4, GL_FLOAT, trainColors.constData());
+		sPainter.setVertexPointer(3, GL_DOUBLE, trainVertices.constData());
+		sPainter.drawFromArray(StelPainter::Triangles, trainVertices.size(), 0, true);
+	}
+	if (!lineVertices.isEmpty())
+	{
+		sPainter.setColorPointer(4, GL_FLOAT, lineColors.constData());
+		sPainter.setVertexPointer(3, GL_DOUBLE, lineVertices.constData());
+		sPainter.drawFromArray(StelPainter::Lines, lineVertices.size(), 0, true);
+	}
+
+	if (!bolideVertices.isEmpty() && bolideTexture)
+	{
+		sPainter.setBlending(true, GL_ONE, GL_ONE);
+		sPainter.enableClientStates(true, true, true);
+		bolideTexture->bind();
+		sPainter.setTexCoordPointer(2, GL_FLOAT, bolideTexCoords.constData());
+		sPainter.setColorPointer(4, GL_FLOAT, bolideColors.constData());
+		sPainter.setVertexPointer(3, GL_DOUBLE, bolideVertices.constData());
+		sPainter.drawFromArray(StelPainter::Triangles, bolideVertices.size(), 0, true);
 	}
-	sPainter.setColorPointer(4, GL_FLOAT, m_lineColorVector.constData());
-	sPainter.setVertexPointer(3, GL_DOUBLE, vertexArrayLine.constData());
-	sPainter.drawFromArray(StelPainter::LineStrip, vertexArrayLine.size(), 0, true);
 
 	sPainter.setBlending(false);
 	sPainter.enableClientStates(false);
@@ -25,6 +25,7 @@
 
 #include <QList>
 #include <QPair>
+#include <QVector>
 
 class StelCore;
 class StelPainter;
@@ -45,6 +46,26 @@ public:
 	//! <colorName, intensity>
 	typedef QPair<QString, int> ColorPair;
 
+	//! Collects the trains and bolides of many meteors, so that all of them are drawn with three draw calls.
+	//! The buffer keeps its memory when cleared, so it can be reused in every frame without allocations.
+	class DrawBuffer
+	{
+	public:
+		//! Remove all meteors from the buffer.
+		void clear();
+		//! Draw the collected meteors.
+		void draw(StelPainter& sPainter, const StelTextureSP& bolideTexture);
+	private:
+		friend class Meteor;
+		QVector<Vec3d> trainVertices;
+		QVector<Vec4f> trainColors;
+		QVector<Vec3d> lineVertices;
+		QVector<Vec4f> lineColors;
+		QVector<Vec3d> bolideVertices;
+		QVector<Vec4f> bolideColors;
+		QVector<Vec2f> bolideTexCoords;
+	};
+
 	//! Create a Meteor object.
 	Meteor(const StelCore* core, const StelTextureSP &bolideTexture);
 	virtual ~Meteor();
@@ -59,8 +80,16 @@ public:
 	virtual bool update(double deltaTime);
 	
 	//! Draws the meteor.
+	//! When drawing many meteors, append() them to a DrawBuffer instead.
 	virtual void draw(const StelCore* core, StelPainter& sPainter);
 
+	//! Adds the meteor to a buffer which draws many meteors at once.
+	//! @param thickness, bolideSize the values given by calculateThickness() for the current frame.
+	void append(DrawBuffer& buffer, float thickness, float bolideSize);
+
+	//! Calculates the train thickness and bolide size, which only depend on the field of view.
+	static void calculateThickness(const StelCore* core, float &thickness, float &bolideSize);
+
 	//! Indicate if the meteor still visible.
 	bool isAlive() { return m_alive; }
 	//! Set meteor absolute magnitude.
@@ -75,14 +104,14 @@ private:
 	//! get RGB from color name
 	Vec4f getColorFromName(QString colorName);
 
-	//! Calculates the train thickness and bolide size.
-	void calculateThickness(const StelCore* core, float &thickness, float &bolideSize);
+	//! Adds the meteor bolide to the buffer.
+	void appendBolide(DrawBuffer& buffer, const float &bolideSize);
 
-	//! Draws the meteor bolide.
-	void drawBolide(StelPainter &sPainter, const float &bolideSize);
+	//! Adds the meteor train to the buffer.
+	void appendTrain(DrawBuffer& buffer, const float &thickness);
 
-	//! Draws the meteor train.
-	void drawTrain(StelPainter& sPainter, const float &thickness);
+	//! Adds the triangles of a strip between two edges of the train prism.
+	void appendStrip(DrawBuffer& buffer, const Vec3d* a, const Vec3d* b, const Vec4f* colors);
 
 	//! Calculates the z-component of a meteor as a function of meteor zenith angle
 	float meteorZ(float zenithAngle, float altitude);
@@ -38,11 +38,19 @@
 #include <QDebug>
 #include <QSettings>
 
+// Recompute the extinction of the vertices when the zenith moved by more than this angle (0.05 degrees, about 12s of time)
+static const double EXTINCTION_ZENITH_COS_TOLERANCE = std::cos(0.05*M_PI/180.);
+
 // Class which manages the displaying of the Milky Way
 MilkyWay::MilkyWay()
 	: color(1.f, 1.f, 1.f)
 	, intensity(1.)
 	, vertexArray()
+	, extinctionCoefficient(0.f)
+	, extinctionPressure(0.f)
+	, extinctionTemperature(0.f)
+	, vertexColor(-1.f, -1.f, -1.f)
+	, vertexColorWithExtinction(false)
 {
 	setObjectName("MilkyWay");
 	fader = new LinearFader();
@@ -94,6 +102,37 @@ double MilkyWay::getCallOrder(StelModuleActionName actionName) const
 void MilkyWay::setFlagShow(bool b){*fader = b; emit milkyWayDisplayedChanged(b);}
 bool MilkyWay::getFlagShow() const {return *fader;}
 
+bool MilkyWay::updateExtinctionFactors(const StelCore* core)
+{
+	const StelSkyDrawer* drawer=core->getSkyDrawer();
+	const Extinction& extinction=drawer->getExtinction();
+	const Refraction& refraction=drawer->getRefraction();
+	const Vec3d zenith=core->altAzToJ2000(Vec3d(0.,0.,1.), StelCore::RefractionOff);
+	if (extinctionFactors.size()==vertexArray->vertex.size()
+	    && zenith*extinctionZenith>=EXTINCTION_ZENITH_COS_TOLERANCE
+	    && extinction.getExtinctionCoefficient()==extinctionCoefficient
+	    && refraction.getPressure()==extinctionPressure
+	    && refraction.getTemperature()==extinctionTemperature)
+		return false;
+
+	// We must process the vertices to find geometric altitudes in order to compute vertex colors.
+	extinctionFactors.resize(vertexArray->vertex.size());
+	for (int i=0; i<vertexArray->vertex.size(); ++i)
+	{
+		Vec3d vertAltAz=core->j2000ToAltAz(vertexArray->vertex.at(i), StelCore::RefractionOn);
+		Q_ASSERT(fabs(vertAltAz.lengthSquared()-1.0) < 0.001);
+
+		float oneMag=0.0f;
+		extinction.forward(vertAltAz, &oneMag);
+		extinctionFactors[i]=std::pow(0.3f , oneMag); // drop of one magnitude: should be factor 2.5 or 40%. We take 30%, it looks more realistic.
+	}
+	extinctionZenith=zenith;
+	extinctionCoefficient=extinction.getExtinctionCoefficient();
+	extinctionPressure=refraction.getPressure();
+	extinctionTemperature=refraction.getTemperature();
+	return true;
+}
+
 void MilkyWay::draw(StelCore* core)
 {
 	if (!getFlagShow())
@@ -150,27 +189,27 @@ void MilkyWay::draw(StelCore* core)
 
 	const bool withExtinction=(drawer->getFlagHasAtmosphere() && drawer->getExtinction().getExtinctionCoefficient()>=0.01f);
 
+	bool extinctionChanged=false;
 	if (withExtinction)
 	{
-		// We must process the vertices to find geometric altitudes in order to compute vertex colors.
+		extinctionChanged=updateExtinctionFactors(core);
 		// Note that there is a visible boost of extinction for higher Bortle indices. I must reflect that as well.
-		const Extinction& extinction=drawer->getExtinction();
-		vertexArray->colors.clear();
+		c*=1.1f-bortle*0.1f;
+	}
 
-		for (int i=0; i<vertexArray->vertex.size(); ++i)
+	// With a static view and atmosphere, the vertex colors stay the same.
+	if (extinctionChanged || c!=vertexColor || withExtinction!=vertexColorWithExtinction)
+	{
+		if (withExtinction)
 		{
-			Vec3d vertAltAz=core->j2000ToAltAz(vertexArray->vertex.at(i), StelCore::RefractionOn);
-			Q_ASSERT(fabs(vertAltAz.lengthSquared()-1.0) < 0.001);
-
-			float oneMag=0.0f;
-			extinction.forward(vertAltAz, &oneMag);
-			float extinctionFactor=std::pow(0.3f , oneMag) * (1.1f-bortle*0.1f); // drop of one magnitude: should be factor 2.5 or 40%. We take 30%, it looks more realistic.
-			Vec3f thisColor=Vec3f(c[0]*extinctionFactor, c[1]*extinctionFactor, c[2]*extinctionFactor);
-			vertexArray->colors.append(thisColor);
+			for (int i=0; i<vertexArray->vertex.size(); ++i)
+				vertexArray->colors[i]=c*extinctionFactors.at(i);
 		}
+		else
+			vertexArray->colors.fill(c);
+		vertexColor=c;
+		vertexColorWithExtinction=withExtinction;
 	}
-	else
-		vertexArray->colors.fill(Vec3f(c[0], c[1], c[2]));
 
 	StelPainter sPainter(prj);
 	sPainter.setCullFace(true);
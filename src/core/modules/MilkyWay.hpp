@@ -24,6 +24,8 @@
 #include "VecMath.hpp"
 #include "StelTextureTypes.hpp"
 
+#include <QVector>
+
 //! @class MilkyWay 
 //! Manages the displaying of the Milky Way.
 class MilkyWay : public StelModule
@@ -92,12 +94,27 @@ signals:
 	void colorChanged(Vec3f color);
 
 private:
+	//! Recompute the extinction factors of the vertices if the zenith moved or the atmosphere changed since the last call.
+	//! @return true if the factors were recomputed
+	bool updateExtinctionFactors(const class StelCore* core);
+
 	StelTextureSP tex;
 	Vec3f color; // global color
 	double intensity;
 	class LinearFader* fader;
 
 	struct StelVertexArray* vertexArray;
+
+	// The extinction of a vertex only depends on its altitude, so it is only recomputed
+	// when the zenith moved a bit in J2000 coordinates, or when the atmosphere parameters change.
+	QVector<float> extinctionFactors;
+	Vec3d extinctionZenith;
+	float extinctionCoefficient;
+	float extinctionPressure;
+	float extinctionTemperature;
+	// Color and extinction state of the current vertex colors, which are only rebuilt when they change.
+	Vec3f vertexColor;
+	bool vertexColorWithExtinction;
 };
 
 #endif // _MILKYWAY_HPP_
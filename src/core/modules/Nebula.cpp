@@ -115,6 +115,7 @@ Nebula::Nebula()
 	, parallax(0.)
 	, parallaxErr(0.)
 	, nType()	
+	, catalogs(0)
 {
 }
 
@@ -451,7 +452,7 @@ float Nebula::getSurfaceArea(void) const
 		return M_PI*(majorAxisSize/2.f)*(minorAxisSize/2.f); // S = pi*a*b
 }
 
-void Nebula::drawHints(StelPainter& sPainter, float maxMagHints)
+bool Nebula::getHint(StelPainter& sPainter, float maxMagHints, StelTextureSP& texture, Vec3f& color, float& size, float& rotation)
 {
 	StelCore* core = StelApp::getInstance().getCore();
 	float lim = qMin(vMag, bMag);
@@ -487,161 +488,161 @@ void Nebula::drawHints(StelPainter& sPainter, float maxMagHints)
 	}
 
 	if (lim>maxMagHints)
-		return;
+		return false;
 
 	Vec3d win;
 	// Check visibility of DSO hints
 	if (!(sPainter.getProjector()->projectCheck(XYZ, win)))
-		return;
+		return false;
+
+	// Hints are drawn with additive blending, so a black hint would not show up at all
+	if (!objectInDisplayedType())
+		return false;
 
-	sPainter.setBlending(true, GL_ONE, GL_ONE);
 	float lum = 1.f;//qMin(1,4.f/getOnScreenSize(core))*0.8;
 
-	Vec3f color=circleColor;
+	color=circleColor;
 	switch (nType)
 	{
 		case NebGx:
-			Nebula::texGalaxy->bind();
+			texture = Nebula::texGalaxy;
 			color=galaxyColor;
 			break;
 		case NebIGx:
-			Nebula::texGalaxy->bind();
+			texture = Nebula::texGalaxy;
 			color=interactingGalaxyColor;
 			break;
 		case NebAGx:
-			Nebula::texGalaxy->bind();
+			texture = Nebula::texGalaxy;
 			color=activeGalaxyColor;
 			break;
 		case NebQSO:
-			Nebula::texGalaxy->bind();
+			texture = Nebula::texGalaxy;
 			color=quasarColor;
 			break;
 		case NebPossQSO:
-			Nebula::texGalaxy->bind();
+			texture = Nebula::texGalaxy;
 			color=possibleQuasarColor;
 			break;
 		case NebBLL:
-			Nebula::texGalaxy->bind();
+			texture = Nebula::texGalaxy;
 			color=blLacObjectColor;
 			break;
 		case NebBLA:
-			Nebula::texGalaxy->bind();
+			texture = Nebula::texGalaxy;
 			color=blazarColor;
 			break;
 		case NebRGx:
-			Nebula::texGalaxy->bind();
+			texture = Nebula::texGalaxy;
 			color=radioGalaxyColor;
 			break;
 		case NebOc:
-			Nebula::texOpenCluster->bind();
+			texture = Nebula::texOpenCluster;
 			color=openClusterColor;
 			break;
 		case NebSA:
-			Nebula::texOpenCluster->bind();
+			texture = Nebula::texOpenCluster;
 			color=stellarAssociationColor;
 			break;
 		case NebSC:
-			Nebula::texOpenCluster->bind();
+			texture = Nebula::texOpenCluster;
 			color=starCloudColor;
 			break;
 		case NebCl:
-			Nebula::texOpenCluster->bind();
+			texture = Nebula::texOpenCluster;
 			color=clusterColor;
 			break;
 		case NebGc:
-			Nebula::texGlobularCluster->bind();
+			texture = Nebula::texGlobularCluster;
 			color=globularClusterColor;
 			break;
 		case NebN:
-			Nebula::texDiffuseNebula->bind();
+			texture = Nebula::texDiffuseNebula;
 			color=nebulaColor;
 			break;
 		case NebHII:
-			Nebula::texDiffuseNebula->bind();
+			texture = Nebula::texDiffuseNebula;
 			color=hydrogenRegionColor;
 			break;
 		case NebMolCld:
-			Nebula::texDiffuseNebula->bind();
+			texture = Nebula::texDiffuseNebula;
 			color=molecularCloudColor;
 			break;
 		case NebYSO:
-			Nebula::texDiffuseNebula->bind();
+			texture = Nebula::texDiffuseNebula;
 			color=youngStellarObjectColor;
 			break;
 		case NebRn:		
-			Nebula::texDiffuseNebula->bind();
+			texture = Nebula::texDiffuseNebula;
 			color=reflectionNebulaColor;
 			break;
 		case NebSNR:
-			Nebula::texDiffuseNebula->bind();
+			texture = Nebula::texDiffuseNebula;
 			color=supernovaRemnantColor;
 			break;
 		case NebBn:
-			Nebula::texDiffuseNebula->bind();
+			texture = Nebula::texDiffuseNebula;
 			color=bipolarNebulaColor;
 			break;
 		case NebEn:
-			Nebula::texDiffuseNebula->bind();
+			texture = Nebula::texDiffuseNebula;
 			color=emissionNebulaColor;
 			break;
 		case NebPn:
-			Nebula::texPlanetaryNebula->bind();
+			texture = Nebula::texPlanetaryNebula;
 			color=planetaryNebulaColor;
 			break;
 		case NebPossPN:
-			Nebula::texPlanetaryNebula->bind();
+			texture = Nebula::texPlanetaryNebula;
 			color=possiblePlanetaryNebulaColor;
 			break;
 		case NebPPN:
-			Nebula::texPlanetaryNebula->bind();
+			texture = Nebula::texPlanetaryNebula;
 			color=protoplanetaryNebulaColor;
 			break;
 		case NebDn:		
-			Nebula::texDarkNebula->bind();
+			texture = Nebula::texDarkNebula;
 			color=darkNebulaColor;
 			break;
 		case NebCn:
-			Nebula::texOpenClusterWithNebulosity->bind();
+			texture = Nebula::texOpenClusterWithNebulosity;
 			color=clusterWithNebulosityColor;
 			break;
 		case NebEMO:
-			Nebula::texCircle->bind();
+			texture = Nebula::texCircle;
 			color=emissionObjectColor;
 			break;
 		default:
-			Nebula::texCircle->bind();
+			texture = Nebula::texCircle;
 	}
 
-	Vec3f col(color[0]*lum*hintsBrightness, color[1]*lum*hintsBrightness, color[2]*lum*hintsBrightness);
-	if (!objectInDisplayedType())
-		col = Vec3f(0.f,0.f,0.f);
-	sPainter.setColor(col[0], col[1], col[2], 1);
+	color *= lum*hintsBrightness;
 
-	float size = 6.0f;
-	float scaledSize = 0.0f;
+	size = 6.0f;
 	if (drawHintProportional)
 	{
+		float scaledSize;
 		if (majorAxisSize>0.)
 			scaledSize = majorAxisSize *0.5 *M_PI/180.*sPainter.getProjector()->getPixelPerRadAtCenter();
 		else
 			scaledSize = minorAxisSize *0.5 *M_PI/180.*sPainter.getProjector()->getPixelPerRadAtCenter();
+		size = qMax(size, scaledSize);
 	}
 
+	rotation = 0.f;
 	// Rotation looks good only for galaxies.
 	if ((nType <=NebQSO) || (nType==NebBLA) || (nType==NebBLL) )
 	{
-		// The rotation angle in drawSprite2dMode() is relative to screen. Make sure to compute correct angle from 90+orientationAngle.
+		// The rotation angle of the sprite is relative to screen. Make sure to compute correct angle from 90+orientationAngle.
 		// Find an on-screen direction vector from a point offset somewhat in declination from our object.
 		Vec3d XYZrel(XYZ);
 		XYZrel[2]*=0.99;
 		Vec3d XYrel;
 		sPainter.getProjector()->project(XYZrel, XYrel);
 		float screenAngle=atan2(XYrel[1]-XY[1], XYrel[0]-XY[0]);
-		sPainter.drawSprite2dMode(XY[0], XY[1], qMax(size, scaledSize), screenAngle*180./M_PI + orientationAngle);
+		rotation = screenAngle*180./M_PI + orientationAngle;
 	}
-	else	// no galaxy
-		sPainter.drawSprite2dMode(XY[0], XY[1], qMax(size, scaledSize));
-
+	return true;
 }
 
 void Nebula::drawLabel(StelPainter& sPainter, float maxMagLabel)
@@ -753,7 +754,31 @@ void Nebula::readDSO(QDataStream &in)
 	StelUtils::spheToRect(ra,dec,XYZ);
 	Q_ASSERT(fabs(XYZ.lengthSquared()-1.)<0.000000001);
 	nType = (Nebula::NebulaType)oType;
-	pointRegion = SphericalRegionP(new SphericalPoint(getJ2000EquatorialPos(NULL)));
+
+	catalogs = CatalogGroup(0);
+	if (M_nb>0)	catalogs |= CatM;
+	if (C_nb>0)	catalogs |= CatC;
+	if (NGC_nb>0)	catalogs |= CatNGC;
+	if (IC_nb>0)	catalogs |= CatIC;
+	if (B_nb>0)	catalogs |= CatB;
+	if (Sh2_nb>0)	catalogs |= CatSh2;
+	if (VdB_nb>0)	catalogs |= CatVdB;
+	if (RCW_nb>0)	catalogs |= CatRCW;
+	if (LDN_nb>0)	catalogs |= CatLDN;
+	if (LBN_nb>0)	catalogs |= CatLBN;
+	if (Cr_nb>0)	catalogs |= CatCr;
+	if (Mel_nb>0)	catalogs |= CatMel;
+	if (PGC_nb>0)	catalogs |= CatPGC;
+	if (UGC_nb>0)	catalogs |= CatUGC;
+	if (!Ced_nb.isEmpty())	catalogs |= CatCed;
+}
+
+bool Nebula::objectInDisplayedCatalog() const
+{
+	// Special case: objects without ID from current catalogs
+	if (static_cast<int>(catalogFilters)==static_cast<int>(AllCatalogs))
+		return true;
+	return (static_cast<int>(catalogs) & static_cast<int>(catalogFilters))!=0;
 }
 
 bool Nebula::objectInDisplayedType() const
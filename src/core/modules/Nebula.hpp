@@ -152,7 +152,6 @@ public:
 	QString getEnglishAliases() const;
 	QString getI18nAliases() const;
 	virtual double getAngularSize(const StelCore*) const;
-	virtual SphericalRegionP getRegion() const {return pointRegion;}
 
 	// Methods specific to Nebula
 	void setLabelColor(const Vec3f& v) {labelColor = v;}
@@ -198,9 +197,19 @@ private:
 	void readDSO(QDataStream& in);
 
 	void drawLabel(StelPainter& sPainter, float maxMagLabel);
-	void drawHints(StelPainter& sPainter, float maxMagHints);
+	//! Compute the hint sprite of this nebula, which NebulaMgr collects to draw all hints of a texture at once.
+	//! XY must be projected before calling this.
+	//! @param texture the marker texture for the type of the nebula
+	//! @param color the color of the sprite, including the hints brightness
+	//! @param size the half size of the sprite in pixel
+	//! @param rotation the rotation angle of the sprite in degree
+	//! @return false if no hint has to be drawn
+	bool getHint(StelPainter& sPainter, float maxMagHints, StelTextureSP& texture, Vec3f& color, float& size, float& rotation);
 
 	bool objectInDisplayedType() const;
+	//! Check whether the object is listed in one of the catalogs selected by the catalog filter.
+	//! Objects without any catalog designation are only displayed when all catalogs are selected.
+	bool objectInDisplayedCatalog() const;
 
 	//! Get the printable description of morphological nebula type.
 	//! @return the nebula morphological type string.
@@ -241,8 +250,7 @@ private:
 	Vec3d XYZ;                      // Cartesian equatorial position (J2000.0)
 	Vec3d XY;                       // Store temporary 2D position
 	NebulaType nType;
-
-	SphericalRegionP pointRegion;
+	CatalogGroup catalogs;		// Catalogs listing this object, derived from the catalog numbers when read
 
 	static StelTextureSP texCircle;                    // The symbolic circle texture
 	static StelTextureSP texGalaxy;                    // Type 0
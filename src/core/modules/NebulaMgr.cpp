@@ -277,6 +277,12 @@ void NebulaMgr::init()
 	// for DSO convertor (for developers!)
 	flagConverter = conf->value("devel/convert_dso_catalog", false).toBool();
 	flagDecimalCoordinates = conf->value("devel/convert_dso_decimal_coord", true).toBool();
+	// the catalog read by preload() has to be replaced by the converted one
+	if (flagConverter)
+	{
+		dsoStore.clear();
+		nebGrid.clear();
+	}
 
 	setFlagUseTypeFilters(conf->value("astro/flag_use_type_filter", false).toBool());
 
@@ -381,6 +387,8 @@ struct DrawNebulaFuncObject
 	void operator()(StelRegionObject* obj)
 	{
 		Nebula* n = static_cast<Nebula*>(obj);
+		// the grid holds the objects of all catalogs
+		if (!n->objectInDisplayedCatalog()) return;
 		StelSkyDrawer *drawer = core->getSkyDrawer();
 		// filter out DSOs which are too dim to be seen (e.g. for bino observers)
 		if ((drawer->getFlagNebulaMagnitudeLimit()) && (n->vMag > drawer->getCustomNebulaMagnitudeLimit())) return;
@@ -389,10 +397,42 @@ struct DrawNebulaFuncObject
 		{
 			float refmag_add=0; // value to adjust hints visibility threshold.
 			sPainter->getProjector()->project(n->XYZ,n->XY);
-			n->drawLabel(*sPainter, maxMagLabels-refmag_add);
-			n->drawHints(*sPainter, maxMagHints -refmag_add);
+			labelled.append(n);
+
+			StelTextureSP tex;
+			Vec3f color;
+			float size, rotation;
+			if (n->getHint(*sPainter, maxMagHints -refmag_add, tex, color, size, rotation))
+				sPainter->addSprite2dMode(getBatch(tex), n->XY[0], n->XY[1], size, rotation, Vec4f(color[0], color[1], color[2], 1.f));
+		}
+	}
+	//! Draw the collected hints with one draw call per texture, then the labels on top of them
+	void flush()
+	{
+		sPainter->setBlending(true, GL_ONE, GL_ONE);
+		for (int i=0; i<hintBatches.size(); ++i)
+		{
+			hintBatches.at(i).first->bind();
+			sPainter->drawSprite2dBatch(hintBatches.at(i).second);
 		}
+		foreach (Nebula* n, labelled)
+			n->drawLabel(*sPainter, maxMagLabels);
+		hintBatches.clear();
+		labelled.clear();
 	}
+	StelPainter::Sprite2dBatch& getBatch(const StelTextureSP& tex)
+	{
+		// there are only a handful of hint textures, a linear search is fine
+		for (int i=0; i<hintBatches.size(); ++i)
+		{
+			if (hintBatches.at(i).first==tex)
+				return hintBatches[i].second;
+		}
+		hintBatches.append(qMakePair(tex, StelPainter::Sprite2dBatch()));
+		return hintBatches.last().second;
+	}
+	QVector<QPair<StelTextureSP, StelPainter::Sprite2dBatch> > hintBatches;
+	QVector<Nebula*> labelled;
 	float maxMagHints;
 	float maxMagLabels;
 	StelPainter* sPainter;
@@ -407,17 +447,13 @@ void NebulaMgr::setCatalogFilters(Nebula::CatalogGroup cflags)
 	{
 		Nebula::catalogFilters = cflags;
 
-		dsoArray.clear();
-		dsoIndex.clear();
-		nebGrid.clear();
-		bool status = getFlagShow();
-
 		StelApp::getInstance().getStelObjectMgr().unSelect();
 
-		qWarning() << "Reloading DSO data...";
-		setFlagShow(false);
-		loadNebulaSet("default");		
-		setFlagShow(status);
+		// All catalogs are kept in memory once loaded, so changing the filter doesn't touch the file
+		if (dsoStore.isEmpty())
+			loadNebulaSet("default");
+		else
+			updateDisplayedObjects();
 
 		updateI18n(); // OK, update localized names of DSO
 
@@ -461,6 +497,7 @@ void NebulaMgr::draw(StelCore* core)
 	sPainter.setFont(nebulaFont);
 	DrawNebulaFuncObject func(maxMagHints, maxMagLabels, &sPainter, core, hintsFader.getInterstate()>0.0001);
 	nebGrid.processIntersectingPointInRegions(p.data(), func);
+	func.flush();
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 		drawPointer(core, sPainter);
@@ -550,6 +587,13 @@ NebulaP NebulaMgr::search(const QString& name)
 	return NebulaP();
 }
 
+void NebulaMgr::preload()
+{
+	const QString dsoCatalogPath = StelFileMgr::findFile("nebulae/default/catalog.dat");
+	if (!dsoCatalogPath.isEmpty())
+		loadDSOCatalog(dsoCatalogPath);
+}
+
 void NebulaMgr::loadNebulaSet(const QString& setName)
 {
 	QString srcCatalogPath		= StelFileMgr::findFile("nebulae/" + setName + "/catalog.txt");
@@ -1009,11 +1053,16 @@ bool NebulaMgr::loadDSOCatalog(const QString &filename)
 	if (!in.open(QIODevice::ReadOnly))
 		return false;
 
+	// Read the file in one go, parsing from memory avoids a lot of small reads
 	// TODO: Let's begin use gzipped data
 	// QDataStream ins(StelUtils::uncompress(in.readAll()));
-	QDataStream ins(&in);
+	const QByteArray data = in.readAll();
+	in.close();
+	QDataStream ins(data);
 	ins.setVersion(QDataStream::Qt_5_2);
 
+	dsoStore.clear();
+	nebGrid.clear();
 	int totalRecords=0;
 	while (!ins.atEnd())
 	{
@@ -1021,59 +1070,32 @@ bool NebulaMgr::loadDSOCatalog(const QString &filename)
 		NebulaP e = NebulaP(new Nebula);
 		e->readDSO(ins);
 
-		if (!objectInDisplayedCatalog(e)) continue;
-
-		dsoArray.append(e);
+		// Objects of all catalogs are kept, the catalog filter is applied in updateDisplayedObjects()
+		dsoStore.append(e);
 		nebGrid.insert(qSharedPointerCast<StelRegionObject>(e));
-		if (e->DSO_nb!=0)
-			dsoIndex.insert(e->DSO_nb, e);
 		++totalRecords;
 	}
-	in.close();
+	dsoStore.squeeze();
 	qDebug() << "Loaded" << totalRecords << "DSO records";
+
+	updateDisplayedObjects();
 	return true;
 }
 
-bool NebulaMgr::objectInDisplayedCatalog(NebulaP n)
+void NebulaMgr::updateDisplayedObjects()
 {
-	bool r = false;
-	Nebula::CatalogGroup catalogFilters = getCatalogFilters();
-	if ((catalogFilters&Nebula::CatM) && (n->M_nb>0))
-		r = true;
-	else if ((catalogFilters&Nebula::CatC) && (n->C_nb>0))
-		r = true;
-	else if ((catalogFilters&Nebula::CatNGC) && (n->NGC_nb>0))
-		r = true;
-	else if ((catalogFilters&Nebula::CatIC) && (n->IC_nb>0))
-		r = true;
-	else if ((catalogFilters&Nebula::CatB) && (n->B_nb>0))
-		r = true;
-	else if ((catalogFilters&Nebula::CatSh2) && (n->Sh2_nb>0))
-		r = true;
-	else if ((catalogFilters&Nebula::CatVdB) && (n->VdB_nb>0))
-		r = true;
-	else if ((catalogFilters&Nebula::CatRCW) && (n->RCW_nb>0))
-		r = true;
-	else if ((catalogFilters&Nebula::CatLDN) && (n->LDN_nb>0))
-		r = true;
-	else if ((catalogFilters&Nebula::CatLBN) && (n->LBN_nb>0))
-		r = true;
-	else if ((catalogFilters&Nebula::CatCr) && (n->Cr_nb>0))
-		r = true;
-	else if ((catalogFilters&Nebula::CatMel) && (n->Mel_nb>0))
-		r = true;
-	else if ((catalogFilters&Nebula::CatPGC) && (n->PGC_nb>0))
-		r = true;
-	else if ((catalogFilters&Nebula::CatUGC) && (n->UGC_nb>0))
-		r = true;
-	else if ((catalogFilters&Nebula::CatCed) && !(n->Ced_nb.isEmpty()))
-		r = true;
-
-	// Special case: objects without ID from current catalogs
-	if (catalogFilters==Nebula::AllCatalogs)
-		r = true;
-
-	return r;
+	dsoArray.clear();
+	dsoIndex.clear();
+	foreach (const NebulaP& e, dsoStore)
+	{
+		if (!e->objectInDisplayedCatalog())
+			continue;
+
+		dsoArray.append(e);
+		if (e->DSO_nb!=0)
+			dsoIndex.insert(e->DSO_nb, e);
+	}
+	qDebug() << "Displaying" << dsoArray.size() << "/" << dsoStore.size() << "DSO records";
 }
 
 bool NebulaMgr::loadDSONames(const QString &filename)
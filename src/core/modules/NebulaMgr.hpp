@@ -265,6 +265,9 @@ public:
 	//!  - call updateI18n() to translate names.
 	virtual void init();
 
+	//! Load the default DSO catalog, the catalog filters are applied in init().
+	virtual void preload();
+
 	//! Draws all nebula objects.
 	virtual void draw(StelCore* core);
 
@@ -306,14 +309,14 @@ public:
 	//! Compute the maximum magntiude for which hints will be displayed.
 	float computeMaxMagHint(const class StelSkyDrawer* skyDrawer) const;
 
-	bool objectInDisplayedCatalog(NebulaP n);
+	bool objectInDisplayedCatalog(NebulaP n) const { return n->objectInDisplayedCatalog(); }
 
 	//! Get designation for latest selected DSO with priority
 	//! @note using for bookmarks feature as example
 	//! @return a designation
 	QString getLatestSelectedDSODesignation();
 
-	//! Get the list of all deep-sky objects.
+	//! Get the list of all deep-sky objects from the displayed catalogs.
 	const QVector<NebulaP>& getAllDeepSkyObjects() const { return dsoArray; }
 
 	//! Get the list of deep-sky objects by type.
@@ -800,17 +803,21 @@ private:
 
 	// Load catalog of DSO
 	bool loadDSOCatalog(const QString& filename);
+	//! Rebuild dsoArray and dsoIndex from the loaded objects according to the current catalog filter.
+	void updateDisplayedObjects();
 	void convertDSOCatalog(const QString& in, const QString& out, bool decimal);
 	// Load proper names for DSO
 	bool loadDSONames(const QString& filename);
 
-	QVector<NebulaP> dsoArray;		// The DSO list
+	QVector<NebulaP> dsoStore;		// All loaded DSO, regardless of the catalog filter
+	QVector<NebulaP> dsoArray;		// The DSO list of the displayed catalogs
 	QHash<unsigned int, NebulaP> dsoIndex;
 
 	LinearFader hintsFader;
 	LinearFader flagShow;
 
-	//! The internal grid for fast positional lookup
+	//! The internal grid for fast positional lookup.
+	//! It contains all loaded DSO, hidden catalogs are skipped while drawing.
 	StelSphericalIndex nebGrid;
 
 	//! The amount of hints (between 0 and 10)
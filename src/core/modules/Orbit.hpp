@@ -32,6 +32,8 @@ private:
 
 class EllipticalOrbit : public Orbit
 {
+	// OrbitBatch copies the elements into its own arrays.
+	friend class OrbitBatch;
 public:
 	EllipticalOrbit(double pericenterDistance,
 			double eccentricity,
@@ -77,6 +79,8 @@ private:
 
 
 class CometOrbit : public Orbit {
+	// OrbitBatch copies the elements into its own arrays.
+	friend class OrbitBatch;
 public:
 	CometOrbit(double pericenterDistance,
 		   double eccentricity,
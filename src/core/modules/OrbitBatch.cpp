@@ -0,0 +1,186 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "OrbitBatch.hpp"
+#include "Orbit.hpp"
+
+#include <cmath>
+
+// Number of Laguerre-Conway passes. EllipticalOrbit uses 8 for its high-eccentricity case,
+// InitEll() in Orbit.cpp notes it usually converges after 2-3, occasionally 6 cycles.
+// Using the same fixed count for every body keeps the loops free of branches.
+#define KEPLER_ITERATIONS 8
+
+void OrbitBatch::clear()
+{
+	e.clear(); a.clear(); b.clear();
+	M0.clear(); n.clear(); epoch.clear();
+	Px.clear(); Py.clear(); Pz.clear();
+	Qx.clear(); Qy.clear(); Qz.clear();
+	posX.clear(); posY.clear(); posZ.clear();
+	meanAnomaly.clear(); eccAnomaly.clear();
+	sampleEcc.clear(); sampleM.clear(); sampleE.clear();
+	sampleJDE.clear();
+}
+
+int OrbitBatch::add(const EllipticalOrbit* orbit)
+{
+	Q_ASSERT(orbit);
+	const double ecc=orbit->eccentricity;
+	if (ecc<0.0 || ecc>=1.0 || orbit->period<=0.0)
+		return -1;
+
+	return append(ecc, orbit->pericenterDistance/(1.0-ecc), orbit->meanAnomalyAtEpoch, 2.0*M_PI/orbit->period,
+		      orbit->epoch, orbit->inclination, orbit->ascendingNode, orbit->argOfPeriapsis, orbit->rotateToVsop87);
+}
+
+int OrbitBatch::add(const CometOrbit* orbit)
+{
+	Q_ASSERT(orbit);
+	const double ecc=orbit->e;
+	if (ecc<0.0 || ecc>=1.0 || orbit->n<=0.0)
+		return -1;
+
+	// CometOrbit counts the mean anomaly from the time of perihelion, see InitEll() in Orbit.cpp.
+	return append(ecc, orbit->q/(1.0-ecc), 0.0, orbit->n,
+		      orbit->t0, orbit->i, orbit->Om, orbit->w, orbit->rotateToVsop87);
+}
+
+int OrbitBatch::append(const double ecc, const double semiMajor, const double meanAnomalyAtEpoch, const double meanMotion,
+		       const double epochJDE, const double inclination, const double ascendingNode, const double argOfPericenter,
+		       const double* rot)
+{
+	e.append(ecc);
+	a.append(semiMajor);
+	b.append(semiMajor*std::sqrt(1.0-ecc*ecc));
+	M0.append(meanAnomalyAtEpoch);
+	n.append(meanMotion);
+	epoch.append(epochJDE);
+
+	// Same orientation as EllipticalOrbit::positionAtE() and Init3D() in Orbit.cpp, followed by the rotation to VSOP87.
+	const Mat4d R = Mat4d::zrotation(ascendingNode) *
+			Mat4d::xrotation(inclination) *
+			Mat4d::zrotation(argOfPericenter);
+	const Vec3d P0=R.multiplyWithoutTranslation(Vec3d(1.,0.,0.));
+	const Vec3d Q0=R.multiplyWithoutTranslation(Vec3d(0.,1.,0.));
+	Px.append(rot[0]*P0[0] + rot[1]*P0[1] + rot[2]*P0[2]);
+	Py.append(rot[3]*P0[0] + rot[4]*P0[1] + rot[5]*P0[2]);
+	Pz.append(rot[6]*P0[0] + rot[7]*P0[1] + rot[8]*P0[2]);
+	Qx.append(rot[0]*Q0[0] + rot[1]*Q0[1] + rot[2]*Q0[2]);
+	Qy.append(rot[3]*Q0[0] + rot[4]*Q0[1] + rot[5]*Q0[2]);
+	Qz.append(rot[6]*Q0[0] + rot[7]*Q0[1] + rot[8]*Q0[2]);
+
+	const int count=e.size();
+	posX.resize(count);
+	posY.resize(count);
+	posZ.resize(count);
+	meanAnomaly.resize(count);
+	eccAnomaly.resize(count);
+	return count-1;
+}
+
+void OrbitBatch::computePositions(const double JDE)
+{
+	sampleJDE.fill(JDE, size());
+	solve(sampleJDE.constData());
+}
+
+void OrbitBatch::computePositions(const double* JDE)
+{
+	solve(JDE);
+}
+
+void OrbitBatch::samplePositions(const int i, const double startJDE, const double stepJDE, const int nSamples, Vec3d* out)
+{
+	Q_ASSERT(i>=0 && i<size());
+	sampleEcc.fill(e.at(i), nSamples);
+	sampleM.resize(nSamples);
+	sampleE.resize(nSamples);
+	double* M=sampleM.data();
+	const double m0=M0.at(i)+(startJDE-epoch.at(i))*n.at(i);
+	const double dM=stepJDE*n.at(i);
+	for (int k=0; k<nSamples; ++k)
+		M[k]=m0+k*dM;
+	solveKepler(nSamples, sampleEcc.constData(), M, sampleE.data());
+
+	const Vec3d P(Px.at(i), Py.at(i), Pz.at(i));
+	const Vec3d Q(Qx.at(i), Qy.at(i), Qz.at(i));
+	const double ecc=e.at(i);
+	const double* E=sampleE.constData();
+	for (int k=0; k<nSamples; ++k)
+		out[k]=P*(a.at(i)*(std::cos(E[k])-ecc)) + Q*(b.at(i)*std::sin(E[k]));
+}
+
+// Each of the loops below runs over all entries with identical work per entry,
+// which allows the compiler to process several bodies per SIMD instruction.
+void OrbitBatch::solveKepler(const int count, const double* ecc, double* M, double* E)
+{
+	// Mean anomaly reduced to [0, 2pi) and Heafner's starting value for E.
+	for (int i=0; i<count; ++i)
+	{
+		M[i]-=2.0*M_PI*std::floor(M[i]*(0.5/M_PI));
+		E[i]=M[i] + (M[i]<M_PI ? 0.85 : -0.85)*ecc[i];
+	}
+
+	// Laguerre-Conway iteration, cf. Heafner, Fundamental Ephemeris Computations p.73.
+	// For e<1, f1=1-e*cos(E) is always positive, so sign(f1) can be dropped.
+	for (int k=0; k<KEPLER_ITERATIONS; ++k)
+	{
+		for (int i=0; i<count; ++i)
+		{
+			const double f2=ecc[i]*std::sin(E[i]);
+			const double f=E[i]-f2-M[i];
+			const double f1=1.0-ecc[i]*std::cos(E[i]);
+			E[i]+=(-5.0*f)/(f1+std::sqrt(std::fabs(16.0*f1*f1-20.0*f*f2)));
+		}
+	}
+}
+
+void OrbitBatch::solve(const double* JDE)
+{
+	const int count=size();
+	double* M=meanAnomaly.data();
+	double* E=eccAnomaly.data();
+
+	const double* m0=M0.constData();
+	const double* mm=n.constData();
+	const double* ep=epoch.constData();
+	for (int i=0; i<count; ++i)
+		M[i]=m0[i] + (JDE[i]-ep[i])*mm[i];
+
+	const double* ecc=e.constData();
+	solveKepler(count, ecc, M, E);
+
+	// Position in the orbit plane, rotated into the VSOP87 frame.
+	const double* sa=a.constData();
+	const double* sb=b.constData();
+	const double* px=Px.constData(); const double* py=Py.constData(); const double* pz=Pz.constData();
+	const double* qx=Qx.constData(); const double* qy=Qy.constData(); const double* qz=Qz.constData();
+	double* x=posX.data();
+	double* y=posY.data();
+	double* z=posZ.data();
+	for (int i=0; i<count; ++i)
+	{
+		const double u=sa[i]*(std::cos(E[i])-ecc[i]);
+		const double v=sb[i]*std::sin(E[i]);
+		x[i]=px[i]*u + qx[i]*v;
+		y[i]=py[i]*u + qy[i]*v;
+		z[i]=pz[i]*u + qz[i]*v;
+	}
+}
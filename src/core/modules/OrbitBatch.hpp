@@ -0,0 +1,108 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _ORBITBATCH_HPP_
+#define _ORBITBATCH_HPP_
+
+#include "VecMath.hpp"
+
+#include <QVector>
+
+class EllipticalOrbit;
+class CometOrbit;
+
+//! @class OrbitBatch
+//! Bulk evaluator for many closed (e<1) Keplerian orbits.
+//! The orbital elements of all registered orbits are kept in structure-of-arrays form,
+//! with the orbit plane orientation and the rotation to VSOP87 already folded into two
+//! direction vectors P and Q per body. Kepler's equation is then solved for all bodies in
+//! one pass with a fixed number of Laguerre-Conway iterations, so that every body runs
+//! exactly the same instruction stream. The inner loops contain no branches and no calls
+//! besides sin/cos/sqrt/floor and can therefore be vectorized across bodies by the compiler.
+//! This is meant for the many thousands of minor planets which can be loaded via the
+//! Solar System Editor plugin (as comet_orbit, i.e. CometOrbit), where computing the orbits
+//! one object at a time dominates.
+//! Results agree with the positionAtTimevInVSOP87Coordinates() methods of EllipticalOrbit
+//! and CometOrbit to well below the accuracy of the orbital elements.
+class OrbitBatch
+{
+public:
+	OrbitBatch() {}
+
+	//! Remove all orbits from the batch.
+	void clear();
+	//! Register an elliptical orbit. The elements are copied, the orbit object is not referenced later.
+	//! @return index of the orbit in this batch, or -1 if the orbit cannot be handled (e>=1).
+	int add(const EllipticalOrbit* orbit);
+	//! Register the closed orbit of a CometOrbit. The elements are copied, the orbit object is not referenced later.
+	//! The velocity cached in the CometOrbit (used for comet tails) is not updated by the batch.
+	//! @return index of the orbit in this batch, or -1 if the orbit cannot be handled (parabolic or hyperbolic).
+	int add(const CometOrbit* orbit);
+	//! @return number of orbits in this batch.
+	int size() const { return e.size(); }
+	bool isEmpty() const { return e.isEmpty(); }
+
+	//! Compute positions of all orbits for the same date.
+	//! @param JDE Julian Day, TT.
+	void computePositions(const double JDE);
+	//! Compute positions of all orbits, each at its own date (e.g. corrected for light time).
+	//! @param JDE array of size() Julian Days, TT.
+	void computePositions(const double* JDE);
+	//! @return position of orbit @param i from the last computePositions() call,
+	//! in AU, in the "dynamical equinox and ecliptic J2000" (VSOP87) frame of the parent body.
+	Vec3d getPosition(const int i) const { return Vec3d(posX.at(i), posY.at(i), posZ.at(i)); }
+
+	//! Sample nSamples positions along orbit @param i, e.g. for drawing its orbit line.
+	//! The orbit is sampled at dates startJDE + k*stepJDE, k=0..nSamples-1, and the
+	//! samples are solved together in the same way as the bodies in computePositions().
+	//! @param out array of nSamples elements.
+	void samplePositions(const int i, const double startJDE, const double stepJDE, const int nSamples, Vec3d* out);
+
+private:
+	//! Append one orbit given by its elements (angles in radians, mean motion in rad/day)
+	//! and the rotation matrix of the orbit's parent frame to VSOP87.
+	//! @return index of the new entry.
+	int append(const double ecc, const double semiMajor, const double meanAnomalyAtEpoch, const double meanMotion,
+		   const double epochJDE, const double inclination, const double ascendingNode, const double argOfPericenter,
+		   const double* rotateToVsop87);
+	//! Compute mean anomalies for all bodies and fill posX/posY/posZ.
+	void solve(const double* JDE);
+	//! The batched kernel: solve Kepler's equation E-e*sin(E)=M for count independent entries.
+	//! M is reduced to [0, 2pi) in place.
+	static void solveKepler(const int count, const double* ecc, double* M, double* E);
+
+	// Orbital elements, one entry per body.
+	QVector<double> e;         // eccentricity
+	QVector<double> a;         // semimajor axis [AU]
+	QVector<double> b;         // semiminor axis [AU]
+	QVector<double> M0;        // mean anomaly at epoch [rad]
+	QVector<double> n;         // mean motion [rad/day]
+	QVector<double> epoch;     // epoch of elements, JDE
+	// Unit vectors towards pericenter (P) and 90 degrees ahead in the orbit plane (Q), in VSOP87 frame.
+	QVector<double> Px, Py, Pz;
+	QVector<double> Qx, Qy, Qz;
+	// Results of the last solve()
+	QVector<double> posX, posY, posZ;
+	// Scratch arrays: mean and eccentric anomaly, eccentricity and dates for the samples of samplePositions()
+	QVector<double> meanAnomaly, eccAnomaly;
+	QVector<double> sampleEcc, sampleM, sampleE;
+	QVector<double> sampleJDE;
+};
+
+#endif // _ORBITBATCH_HPP_
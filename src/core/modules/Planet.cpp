@@ -112,6 +112,7 @@ Planet::Planet(const QString& englishName,
 	  deltaOrbitJDE(0.0),
 	  orbitCached(false),
 	  closeOrbit(acloseOrbit),
+	  orbitBatched(false),
 	  englishName(englishName),
 	  nameI18(englishName),
 	  nativeName(""),
@@ -2117,7 +2118,10 @@ void Planet::drawSphere(StelPainter* painter, float screenSz, bool drawOnlyRing)
 	}
 	
 	if (!drawOnlyRing)
+	{
 		GL(gl->glDrawElements(GL_TRIANGLES, model.indiceArr.size(), GL_UNSIGNED_SHORT, model.indiceArr.constData()));
+		StelPainter::countDrawCall(model.indiceArr.size());
+	}
 
 	if (rings)
 	{
@@ -2158,6 +2162,7 @@ void Planet::drawSphere(StelPainter* painter, float screenSz, bool drawOnlyRing)
 			gl->glCullFace(GL_FRONT);
 					
 		GL(gl->glDrawElements(GL_TRIANGLES, ringModel.indiceArr.size(), GL_UNSIGNED_SHORT, ringModel.indiceArr.constData()));
+		StelPainter::countDrawCall(ringModel.indiceArr.size());
 		
 		if (eyePos[2]<0)
 			gl->glCullFace(GL_BACK);
@@ -318,6 +318,7 @@ public:
 	bool closeOrbit;                 // whether to connect the beginning of the orbit line to
 					 // the end: good for elliptical orbits, bad for parabolic
 					 // and hyperbolic orbits
+	bool orbitBatched;               // position and orbit line are computed in bulk by SolarSystem (see OrbitBatch)
 
 	static Vec3f orbitColor;
 	static void setOrbitColor(const Vec3f& oc) {orbitColor = oc;}
@@ -21,9 +21,6 @@
 
 #include "Skybright.hpp"
 #include "StelUtils.hpp"
-#include "StelApp.hpp"
-#include "StelModuleMgr.hpp"
-#include "SolarSystem.hpp"
 
 Skybright::Skybright() : SN(1.f)
 {
@@ -97,11 +94,6 @@ float Skybright::getLuminance( float cosDistMoon,
                                const float cosDistSun,
                                const float cosDistZenith) const
 {
-	// No Sun and Moon on the sky
-	// Details: https://bugs.launchpad.net/stellarium/+bug/1499699
-	if (!GETSTELMODULE(SolarSystem)->getFlagPlanets())
-		return 0.f;
-
 	// Air mass
 	const float bKX = stelpow10f(-0.4f * K * (1.f / (cosDistZenith + 0.025f*StelUtils::fastExp(-11.f*cosDistZenith))));
 
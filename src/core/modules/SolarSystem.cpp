@@ -429,6 +429,37 @@ void SolarSystem::loadPlanets()
 	foreach (const PlanetP& planet, systemPlanets)
 		if(planet->parent != sun || !planet->satellites.isEmpty())
 			shadowPlanetCount++;
+
+	rebuildOrbitBatch();
+}
+
+void SolarSystem::rebuildOrbitBatch()
+{
+	foreach (Planet* p, orbitBatchPlanets)
+		p->orbitBatched=false;
+	orbitBatch.clear();
+	orbitBatchPlanets.clear();
+	orbitBatchJDE.clear();
+	// Only bodies orbiting the sun: for them the heliocentric position is the position relative to the parent,
+	// so Planet does not need to refresh its orbit line when the position is set from outside.
+	foreach (const PlanetP& p, systemPlanets)
+	{
+		if (p->parent != sun || p->osculatingFunc || !p->userDataPtr)
+			continue;
+		int index=-1;
+		if (p->coordFunc == &ellipticalOrbitPosFunc)
+			index=orbitBatch.add(static_cast<EllipticalOrbit*>(p->userDataPtr));
+		// Minor planets from the Solar System Editor use comet_orbit. Real comets are left out,
+		// their tails need the velocity which CometOrbit caches while computing the position.
+		else if (p->coordFunc == &cometOrbitPosFunc && p->getPlanetType() != Planet::isComet)
+			index=orbitBatch.add(static_cast<CometOrbit*>(p->userDataPtr));
+		if (index >= 0)
+		{
+			p->orbitBatched=true;
+			orbitBatchPlanets.append(p.data());
+		}
+	}
+	orbitBatchJDE.resize(orbitBatchPlanets.size());
 }
 
 bool SolarSystem::loadPlanets(const QString& filePath)
@@ -1074,14 +1105,19 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 // The order is not important since the position is computed relatively to the mother body
 void SolarSystem::computePositions(double dateJDE, const Vec3d& observerPos)
 {
+	computeBatchedPositions(dateJDE, observerPos);
+
 	if (flagLightTravelTime)
 	{
 		foreach (PlanetP p, systemPlanets)
 		{
-			p->computePositionWithoutOrbits(dateJDE);
+			if (!p->orbitBatched)
+				p->computePositionWithoutOrbits(dateJDE);
 		}
 		foreach (PlanetP p, systemPlanets)
 		{
+			if (p->orbitBatched)
+				continue;
 			const double light_speed_correction = (p->getHeliocentricEclipticPos()-observerPos).length() * (AU / (SPEED_OF_LIGHT * 86400));
 			p->computePosition(dateJDE-light_speed_correction);
 		}
@@ -1090,12 +1126,54 @@ void SolarSystem::computePositions(double dateJDE, const Vec3d& observerPos)
 	{
 		foreach (PlanetP p, systemPlanets)
 		{
-			p->computePosition(dateJDE);
+			if (!p->orbitBatched)
+				p->computePosition(dateJDE);
 		}
 	}
 	computeTransMatrices(dateJDE, observerPos);
 }
 
+void SolarSystem::computeBatchedPositions(double dateJDE, const Vec3d& observerPos)
+{
+	const int count=orbitBatchPlanets.size();
+	if (count==0)
+		return;
+
+	orbitBatch.computePositions(dateJDE);
+	if (flagLightTravelTime)
+	{
+		// The parent is the sun, so the position from the batch is already heliocentric.
+		for (int i=0; i<count; ++i)
+			orbitBatchJDE[i] = dateJDE - (orbitBatch.getPosition(i)-observerPos).length() * (AU / (SPEED_OF_LIGHT * 86400));
+		orbitBatch.computePositions(orbitBatchJDE.constData());
+	}
+	else
+		orbitBatchJDE.fill(dateJDE);
+
+	for (int i=0; i<count; ++i)
+	{
+		Planet* p=orbitBatchPlanets.at(i);
+		const double jde=orbitBatchJDE.at(i);
+		p->eclipticPos=orbitBatch.getPosition(i);
+		p->lastJDE=jde;
+
+		if (p->orbitFader.getInterstate()<=0.000001 || p->deltaOrbitJDE<=0)
+			continue;
+		// A complete orbit line is needed after large time jumps or when orbits have just been switched on.
+		// Smaller steps only add a few points at the ends and are left to Planet::computePosition().
+		if (!p->orbitCached || fabs(p->lastOrbitJDE-jde)>=(ORBIT_SEGMENTS-1)*p->deltaOrbitJDE)
+		{
+			orbitBatch.samplePositions(i, jde-(ORBIT_SEGMENTS/2)*p->deltaOrbitJDE, p->deltaOrbitJDE, ORBIT_SEGMENTS, p->orbitP);
+			for (int d=0; d<ORBIT_SEGMENTS; d++)
+				p->orbit[d]=p->getHeliocentricPos(p->orbitP[d]);
+			p->lastOrbitJDE=jde;
+			p->orbitCached=true;
+		}
+		else
+			p->computePosition(jde);
+	}
+}
+
 // Compute the transformation matrix for every elements of the solar system.
 // The elements have to be ordered hierarchically, eg. it's important to compute earth before moon.
 void SolarSystem::computeTransMatrices(double dateJDE, const Vec3d& observerPos)
@@ -1997,6 +2075,9 @@ void SolarSystem::reloadPlanets()
 	Comet::tailTexture.clear();
 	Comet::comaTexture.clear();
 
+	orbitBatch.clear();
+	orbitBatchPlanets.clear();
+
 	// Re-load the ssystem.ini file
 	loadPlanets();	
 	computePositions(core->getJDE());
@@ -28,6 +28,7 @@
 #include "StelObjectModule.hpp"
 #include "StelTextureTypes.hpp"
 #include "Planet.hpp"
+#include "OrbitBatch.hpp"
 #include "StelGui.hpp"
 
 #include <QFont>
@@ -826,6 +827,15 @@ private:
 	//! observerPos is needed for light travel time computation.
 	void computeTransMatrices(double dateJDE, const Vec3d& observerPos = Vec3d(0.));
 
+	//! Collect all closed heliocentric ell_orbit and comet_orbit orbits (mostly minor planets) into orbitBatch.
+	//! Must be called whenever systemPlanets changes.
+	void rebuildOrbitBatch();
+
+	//! Compute positions (and full orbit lines, where required) of all bodies in orbitBatch in one pass.
+	//! These bodies are skipped in the per-Planet loops of computePositions().
+	//! observerPos is needed for light travel time computation.
+	void computeBatchedPositions(double dateJDE, const Vec3d& observerPos);
+
 	//! Draw a nice animated pointer around the object.
 	void drawPointer(const StelCore* core);
 
@@ -898,6 +908,10 @@ private:
 	QHash<QString, QString> planetNativeNamesMap;
 
 	QList<Orbit*> orbits;           // Pointers on created elliptical orbits
+
+	OrbitBatch orbitBatch;                  // Heliocentric elliptical orbits, evaluated in bulk
+	QVector<Planet*> orbitBatchPlanets;     // The bodies for the entries of orbitBatch, same order
+	QVector<double> orbitBatchJDE;          // Scratch array with light time corrected dates
 };
 
 
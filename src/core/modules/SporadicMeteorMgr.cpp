@@ -73,14 +73,18 @@ void SporadicMeteorMgr::update(double deltaTime)
 	}
 
 	// step through and update all active meteors
-	foreach (SporadicMeteor* m, activeMeteors)
+	// a dead meteor is replaced by the last one, so the order of the list is not kept
+	for (int i = 0; i < activeMeteors.size(); )
 	{
-		if (!m->update(deltaTime))
+		if (activeMeteors.at(i)->update(deltaTime))
 		{
-			//important to delete when no longer active
-			delete m;
-			activeMeteors.removeOne(m);
+			++i;
+			continue;
 		}
+		//important to delete when no longer active
+		delete activeMeteors.at(i);
+		activeMeteors[i] = activeMeteors.last();
+		activeMeteors.removeLast();
 	}
 
 	StelCore* core = StelApp::getInstance().getCore();
@@ -131,12 +135,17 @@ void SporadicMeteorMgr::draw(StelCore* core)
 		return;
 	}
 
-	// step through and draw all active meteors
-	StelPainter sPainter(core->getProjection(StelCore::FrameAltAz));
+	// collect all active meteors, and draw them at once
+	float thickness, bolideSize;
+	Meteor::calculateThickness(core, thickness, bolideSize);
+	m_drawBuffer.clear();
 	foreach (SporadicMeteor* m, activeMeteors)
 	{
-		m->draw(core, sPainter);
+		m->append(m_drawBuffer, thickness, bolideSize);
 	}
+
+	StelPainter sPainter(core->getProjection(StelCore::FrameAltAz));
+	m_drawBuffer.draw(sPainter, m_bolideTexture);
 }
 
 void SporadicMeteorMgr::setZHR(int zhr)
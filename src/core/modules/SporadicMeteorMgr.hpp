@@ -70,6 +70,7 @@ signals:
 
 private:
 	QList<SporadicMeteor*> activeMeteors;
+	Meteor::DrawBuffer m_drawBuffer;
 	StelTextureSP m_bolideTexture;
 	int m_zhr;
 	int m_maxVelocity;
@@ -110,6 +110,98 @@ QStringList initStringListFromFile(const QString& file_name)
 	return list;
 }
 
+// The parsed star data files are cached in binary form, since reading them back is much faster than parsing the text.
+// Increment this number when the content or the format of the cached tables change.
+static const quint32 StarDataCacheVersion = 1;
+
+QDataStream& operator<<(QDataStream& out, const varstar& v)
+{
+	out << v.designation << v.vtype << v.maxmag << v.mflag << v.min1mag << v.min2mag
+	    << v.photosys << v.epoch << v.period << v.Mm << v.stype;
+	return out;
+}
+
+QDataStream& operator>>(QDataStream& in, varstar& v)
+{
+	in >> v.designation >> v.vtype >> v.maxmag >> v.mflag >> v.min1mag >> v.min2mag
+	   >> v.photosys >> v.epoch >> v.period >> v.Mm >> v.stype;
+	return in;
+}
+
+QDataStream& operator<<(QDataStream& out, const wds& w)
+{
+	out << w.designation << w.observation << w.positionAngle << w.separation;
+	return out;
+}
+
+QDataStream& operator>>(QDataStream& in, wds& w)
+{
+	in >> w.designation >> w.observation >> w.positionAngle >> w.separation;
+	return in;
+}
+
+// Get the MD5 sum of an opened data file, which is at its beginning again afterwards
+static QByteArray starDataChecksum(QFile& file)
+{
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	hash.addData(&file);
+	file.seek(0);
+	return hash.result();
+}
+
+// Get the cache file for a data file. Files with the same name in different directories
+// (like the star names of the sky cultures) get different cache files.
+static QString starDataCachePath(const QString& dataFile)
+{
+	const QFileInfo info(dataFile);
+	const QByteArray pathHash = QCryptographicHash::hash(info.absoluteFilePath().toUtf8(), QCryptographicHash::Md5).toHex().left(12);
+	return StelFileMgr::getCacheDir() + "/stars/" + info.completeBaseName() + "_" + pathHash + ".dat";
+}
+
+// Open the cache of a data file for reading.
+// Returns false if there is no cache, or it was made from a different version of the data file.
+static bool openStarDataCache(QFile& cache, QDataStream& in, const QByteArray& checksum)
+{
+	if (!cache.open(QIODevice::ReadOnly))
+		return false;
+	in.setDevice(&cache);
+	in.setVersion(QDataStream::Qt_5_2);
+	quint32 version;
+	QByteArray cachedChecksum;
+	in >> version >> cachedChecksum;
+	if (in.status()==QDataStream::Ok && version==StarDataCacheVersion && cachedChecksum==checksum)
+		return true;
+	cache.close();
+	return false;
+}
+
+// Create the cache of a data file, the tables have to be written to the stream afterwards
+static bool createStarDataCache(QFile& cache, QDataStream& out, const QByteArray& checksum)
+{
+	QDir().mkpath(QFileInfo(cache).absolutePath());
+	if (!cache.open(QIODevice::WriteOnly))
+	{
+		qWarning() << "WARNING - could not write star data cache" << QDir::toNativeSeparators(cache.fileName());
+		return false;
+	}
+	out.setDevice(&cache);
+	out.setVersion(QDataStream::Qt_5_2);
+	out.resetStatus();
+	out << StarDataCacheVersion << checksum;
+	return true;
+}
+
+// Close the cache after writing, an incomplete cache is removed
+static void closeStarDataCache(QFile& cache, QDataStream& out)
+{
+	cache.close();
+	if (out.status()!=QDataStream::Ok || cache.error()!=QFileDevice::NoError)
+	{
+		qWarning() << "WARNING - could not write star data cache" << QDir::toNativeSeparators(cache.fileName());
+		cache.remove();
+	}
+}
+
 QString StarMgr::convertToSpectralType(int index)
 {
 	if (index < 0 || index >= spectral_array.size())
@@ -422,7 +514,7 @@ void StarMgr::init()
 
 	loadData(starSettings);
 
-	populateStarsDesignations();
+	// the designations were loaded by preload()
 	populateHipparcosLists();
 
 	starFont.setPixelSize(StelApp::getInstance().getBaseFontSize());
@@ -688,6 +780,33 @@ int StarMgr::loadCommonNames(const QString& commonNameFile)
 		return 0;
 	}
 
+	// The references are added to the ones of the previously loaded sky cultures
+	QHash<int, QString> references;
+	const QByteArray checksum = starDataChecksum(cnFile);
+	QFile cache(starDataCachePath(commonNameFile));
+	QDataStream cacheStream;
+	if (openStarDataCache(cache, cacheStream, checksum))
+	{
+		cacheStream >> commonNamesMap >> additionalNamesMap >> commonNamesIndex >> additionalNamesIndex >> references;
+		cache.close();
+		if (cacheStream.status()==QDataStream::Ok)
+		{
+			cnFile.close();
+			commonNamesMapI18n = commonNamesMap;
+			additionalNamesMapI18n = additionalNamesMap;
+			commonNamesIndexI18n = commonNamesIndex;
+			additionalNamesIndexI18n = additionalNamesIndex;
+			addReferences(references);
+			qDebug() << "Loaded" << commonNamesMap.size() << "common star names from cache";
+			return 1;
+		}
+		commonNamesMap.clear();
+		additionalNamesMap.clear();
+		commonNamesIndex.clear();
+		additionalNamesIndex.clear();
+		references.clear();
+	}
+
 	int readOk=0;
 	int totalRecords=0;
 	int lineNumber=0;
@@ -765,21 +884,39 @@ int StarMgr::loadCommonNames(const QString& commonNameFile)
 			QString reference = recordRx.capturedTexts().at(3).trimmed();
 			if (!reference.isEmpty())
 			{
-				if (referenceMap.find(hip)!=referenceMap.end())
-					referenceMap[hip] = referenceMap[hip].append("," + reference);
+				if (references.find(hip)!=references.end())
+					references[hip] = references[hip].append("," + reference);
 				else
-					referenceMap[hip] = reference;
+					references[hip] = reference;
 			}
 
 			readOk++;
 		}
 	}
 	cnFile.close();
+	addReferences(references);
+
+	if (createStarDataCache(cache, cacheStream, checksum))
+	{
+		cacheStream << commonNamesMap << additionalNamesMap << commonNamesIndex << additionalNamesIndex << references;
+		closeStarDataCache(cache, cacheStream);
+	}
 
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "common star names";
 	return 1;
 }
 
+void StarMgr::addReferences(const QHash<int, QString>& references)
+{
+	for (QHash<int, QString>::const_iterator it=references.constBegin(); it!=references.constEnd(); ++it)
+	{
+		if (referenceMap.find(it.key())!=referenceMap.end())
+			referenceMap[it.key()].append("," + it.value());
+		else
+			referenceMap[it.key()] = it.value();
+	}
+}
+
 
 // Load scientific names from file
 void StarMgr::loadSciNames(const QString& sciNameFile)
@@ -796,6 +933,24 @@ void StarMgr::loadSciNames(const QString& sciNameFile)
 		qWarning() << "WARNING - could not open" << QDir::toNativeSeparators(sciNameFile);
 		return;
 	}
+	const QByteArray checksum = starDataChecksum(snFile);
+	QFile cache(starDataCachePath(sciNameFile));
+	QDataStream cacheStream;
+	if (openStarDataCache(cache, cacheStream, checksum))
+	{
+		cacheStream >> sciNamesMapI18n >> sciNamesIndexI18n >> sciAdditionalNamesMapI18n >> sciAdditionalNamesIndexI18n;
+		cache.close();
+		if (cacheStream.status()==QDataStream::Ok)
+		{
+			snFile.close();
+			qDebug() << "Loaded" << sciNamesMapI18n.size() + sciAdditionalNamesMapI18n.size() << "scientific star names from cache";
+			return;
+		}
+		sciNamesMapI18n.clear();
+		sciNamesIndexI18n.clear();
+		sciAdditionalNamesMapI18n.clear();
+		sciAdditionalNamesIndexI18n.clear();
+	}
 	const QStringList& allRecords = QString::fromUtf8(snFile.readAll()).split('\n');
 	snFile.close();
 
@@ -856,6 +1011,12 @@ void StarMgr::loadSciNames(const QString& sciNameFile)
 		}
 	}
 
+	if (createStarDataCache(cache, cacheStream, checksum))
+	{
+		cacheStream << sciNamesMapI18n << sciNamesIndexI18n << sciAdditionalNamesMapI18n << sciAdditionalNamesIndexI18n;
+		closeStarDataCache(cache, cacheStream);
+	}
+
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "scientific star names";
 }
 
@@ -872,6 +1033,22 @@ void StarMgr::loadGcvs(const QString& GcvsFile)
 		qWarning() << "WARNING - could not open" << QDir::toNativeSeparators(GcvsFile);
 		return;
 	}
+	const QByteArray checksum = starDataChecksum(vsFile);
+	QFile cache(starDataCachePath(GcvsFile));
+	QDataStream cacheStream;
+	if (openStarDataCache(cache, cacheStream, checksum))
+	{
+		cacheStream >> varStarsMapI18n >> varStarsIndexI18n;
+		cache.close();
+		if (cacheStream.status()==QDataStream::Ok)
+		{
+			vsFile.close();
+			qDebug() << "Loaded" << varStarsMapI18n.size() << "variable stars from cache";
+			return;
+		}
+		varStarsMapI18n.clear();
+		varStarsIndexI18n.clear();
+	}
 	const QStringList& allRecords = QString::fromUtf8(vsFile.readAll()).split('\n');
 	vsFile.close();
 
@@ -931,6 +1108,12 @@ void StarMgr::loadGcvs(const QString& GcvsFile)
 		++readOk;
 	}
 
+	if (createStarDataCache(cache, cacheStream, checksum))
+	{
+		cacheStream << varStarsMapI18n << varStarsIndexI18n;
+		closeStarDataCache(cache, cacheStream);
+	}
+
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "variable stars";
 }
 
@@ -947,6 +1130,22 @@ void StarMgr::loadWds(const QString& WdsFile)
 		qWarning() << "WARNING - could not open" << QDir::toNativeSeparators(WdsFile);
 		return;
 	}
+	const QByteArray checksum = starDataChecksum(dsFile);
+	QFile cache(starDataCachePath(WdsFile));
+	QDataStream cacheStream;
+	if (openStarDataCache(cache, cacheStream, checksum))
+	{
+		cacheStream >> wdsStarsMapI18n >> wdsStarsIndexI18n;
+		cache.close();
+		if (cacheStream.status()==QDataStream::Ok)
+		{
+			dsFile.close();
+			qDebug() << "Loaded" << wdsStarsMapI18n.size() << "double stars from cache";
+			return;
+		}
+		wdsStarsMapI18n.clear();
+		wdsStarsIndexI18n.clear();
+	}
 	const QStringList& allRecords = QString::fromUtf8(dsFile.readAll()).split('\n');
 	dsFile.close();
 
@@ -990,6 +1189,12 @@ void StarMgr::loadWds(const QString& WdsFile)
 		++readOk;
 	}
 
+	if (createStarDataCache(cache, cacheStream, checksum))
+	{
+		cacheStream << wdsStarsMapI18n << wdsStarsIndexI18n;
+		closeStarDataCache(cache, cacheStream);
+	}
+
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "double stars";
 }
 
@@ -1010,6 +1215,26 @@ void StarMgr::loadCrossIdentificationData(const QString& crossIdFile)
 		qWarning() << "WARNING - could not open" << QDir::toNativeSeparators(crossIdFile);
 		return;
 	}
+	const QByteArray checksum = starDataChecksum(ciFile);
+	QFile cache(starDataCachePath(crossIdFile));
+	QDataStream cacheStream;
+	if (openStarDataCache(cache, cacheStream, checksum))
+	{
+		cacheStream >> saoStarsMap >> saoStarsIndex >> hdStarsMap >> hdStarsIndex >> hrStarsMap >> hrStarsIndex;
+		cache.close();
+		if (cacheStream.status()==QDataStream::Ok)
+		{
+			ciFile.close();
+			qDebug() << "Loaded cross-identification data for" << saoStarsMap.size() << "SAO," << hdStarsMap.size() << "HD and" << hrStarsMap.size() << "HR stars from cache";
+			return;
+		}
+		saoStarsMap.clear();
+		saoStarsIndex.clear();
+		hdStarsMap.clear();
+		hdStarsIndex.clear();
+		hrStarsMap.clear();
+		hrStarsIndex.clear();
+	}
 	const QStringList& allRecords = QString::fromUtf8(ciFile.readAll()).split('\n');
 	ciFile.close();
 
@@ -1072,6 +1297,12 @@ void StarMgr::loadCrossIdentificationData(const QString& crossIdFile)
 		}
 	}
 
+	if (createStarDataCache(cache, cacheStream, checksum))
+	{
+		cacheStream << saoStarsMap << saoStarsIndex << hdStarsMap << hdStarsIndex << hrStarsMap << hrStarsIndex;
+		closeStarDataCache(cache, cacheStream);
+	}
+
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "cross-identification data records for stars";
 }
 
@@ -1116,8 +1347,12 @@ void StarMgr::draw(StelCore* core)
 	// Prepare a table for storing precomputed RCMag for all ZoneArrays
 	RCMag rcmag_table[RCMAG_TABLE_SIZE];
 	
+	// Take over the levels which finished loading in the background since the last frame
+	foreach(ZoneArray* z, gridLevels)
+		z->updateLoading();
+
 	// Draw all the stars of all the selected zones
-	foreach(const ZoneArray* z, gridLevels)
+	foreach(ZoneArray* z, gridLevels)
 	{
 		int limitMagIndex=RCMAG_TABLE_SIZE;
 		const float mag_min = 0.001f*z->mag_min;
@@ -1146,6 +1381,13 @@ void StarMgr::draw(StelCore* core)
 		}
 		lastMaxSearchLevel = z->level;
 
+		// The faint levels are only loaded once they become visible, they are drawn as soon as they are ready
+		if (!z->isLoaded())
+		{
+			z->startLoading();
+			continue;
+		}
+
 		unsigned int maxMagStarName = 0;
 		if (labelsFader.getInterstate()>0.f)
 		{
@@ -1228,6 +1470,8 @@ QList<StelObjectP > StarMgr::searchAround(const Vec3d& vv, double limFov, const
 	f = cos(limFov * M_PI/180.);
 	foreach(ZoneArray* z, gridLevels)
 	{
+		if (!z->isLoaded())
+			continue;
 		//qDebug() << "search inside(" << it->first << "):";
 		int zone;
 		for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
@@ -1713,6 +1957,11 @@ void StarMgr::updateSkyCulture(const QString& skyCultureDir)
 	updateI18n();
 }
 
+void StarMgr::preload()
+{
+	populateStarsDesignations();
+}
+
 void StarMgr::populateStarsDesignations()
 {
 	QString fic;
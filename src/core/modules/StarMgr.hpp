@@ -116,6 +116,9 @@ public:
 	//! - Lets various display flags from the ini parser object
 	virtual void init();
 
+	//! Load the star designations, variable and double star data, and the cross-identification data.
+	virtual void preload();
+
 	//! Draw the stars and the star selection indicator if necessary.
 	virtual void draw(StelCore* core);
 
@@ -361,6 +364,8 @@ private:
 	//! @param the path to a file containing the common names for bright stars.
 	//! @note Stellarium doesn't support sky cultures made prior version 0.10.6 now!
 	int loadCommonNames(const QString& commonNameFile);
+	//! Append the references of the star names of a sky culture to the known ones.
+	static void addReferences(const QHash<int, QString>& references);
 
 	//! Loads scientific names for stars from a file.
 	//! Called when the SkyCulture is updated.
@@ -377,6 +382,8 @@ private:
 
 	//! Loads cross-identification data from a file.
 	//! @param the path to a file containing the cross-identification data.
+	//! @note Like the other star data files, the parsed tables are cached in binary form in the cache directory.
+	//! The cache is rebuilt when the MD5 sum of the file changes.
 	void loadCrossIdentificationData(const QString& crossIdFile);
 
 	//! Gets the maximum search level.
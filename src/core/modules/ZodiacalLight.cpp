@@ -40,12 +40,20 @@
 #include <QDebug>
 #include <QSettings>
 
+// Recompute the extinction of the vertices when the zenith moved by more than this angle (0.05 degrees, about 12s of time)
+static const double EXTINCTION_ZENITH_COS_TOLERANCE = std::cos(0.05*M_PI/180.);
+
 // Class which manages the displaying of the Zodiacal Light
 ZodiacalLight::ZodiacalLight()
 	: color(1.f, 1.f, 1.f)
 	, intensity(1.)
 	, lastJD(-1.0E6)
 	, vertexArray()
+	, extinctionCoefficient(0.f)
+	, extinctionPressure(0.f)
+	, extinctionTemperature(0.f)
+	, vertexColor(-1.f, -1.f, -1.f)
+	, vertexColorWithExtinction(false)
 {
 	setObjectName("ZodiacalLight");
 	fader = new LinearFader();
@@ -134,6 +142,8 @@ void ZodiacalLight::update(double deltaTime)
 			vertexArray->vertex.replace(i, rotMat * tmp);
 		}
 		lastJD=currentJD;
+		// The altitudes of the vertices changed
+		extinctionFactors.clear();
 	}
 }
 
@@ -158,6 +168,45 @@ bool ZodiacalLight::getFlagShow() const
 	return *fader;
 }
 
+bool ZodiacalLight::updateExtinctionFactors(const StelCore* core)
+{
+	const StelSkyDrawer* drawer=core->getSkyDrawer();
+	const Extinction& extinction=drawer->getExtinction();
+	const Refraction& refraction=drawer->getRefraction();
+	const Vec3d zenith=core->altAzToEquinoxEqu(Vec3d(0.,0.,1.), StelCore::RefractionOff);
+	if (extinctionFactors.size()==vertexArray->vertex.size()
+	    && zenith*extinctionZenith>=EXTINCTION_ZENITH_COS_TOLERANCE
+	    && extinction.getExtinctionCoefficient()==extinctionCoefficient
+	    && refraction.getPressure()==extinctionPressure
+	    && refraction.getTemperature()==extinctionTemperature)
+		return false;
+
+	// We must process the vertices to find geometric altitudes in order to compute vertex colors.
+	const double epsDate=getPrecessionAngleVondrakCurrentEpsilonA();
+	extinctionFactors.resize(vertexArray->vertex.size());
+	for (int i=0; i<vertexArray->vertex.size(); ++i)
+	{
+		Vec3d eclPos=vertexArray->vertex.at(i);
+		Q_ASSERT(fabs(eclPos.lengthSquared()-1.0) < 0.001f);
+		double ecLon, ecLat, ra, dec;
+		StelUtils::rectToSphe(&ecLon, &ecLat, eclPos);
+		StelUtils::eclToEqu(ecLon, ecLat, epsDate, &ra, &dec);
+		Vec3d eqPos;
+		StelUtils::spheToRect(ra, dec, eqPos);
+		Vec3d vertAltAz=core->equinoxEquToAltAz(eqPos, StelCore::RefractionOn);
+		Q_ASSERT(fabs(vertAltAz.lengthSquared()-1.0) < 0.001f);
+
+		float oneMag=0.0f;
+		extinction.forward(vertAltAz, &oneMag);
+		extinctionFactors[i]=std::pow(0.4f , oneMag); // drop of one magnitude: factor 2.5 or 40%
+	}
+	extinctionZenith=zenith;
+	extinctionCoefficient=extinction.getExtinctionCoefficient();
+	extinctionPressure=refraction.getPressure();
+	extinctionTemperature=refraction.getTemperature();
+	return true;
+}
+
 void ZodiacalLight::draw(StelCore* core)
 {
 	if (!getFlagShow() || (getIntensity()<0.01) )
@@ -214,34 +263,29 @@ void ZodiacalLight::draw(StelCore* core)
 
 	const bool withExtinction=(drawer->getFlagHasAtmosphere() && drawer->getExtinction().getExtinctionCoefficient()>=0.01f);
 
-	if ((withExtinction) && (core->getCurrentLocation().planetName=="Earth")) // If anybody switches on atmosphere on the moon, there will be no extinction.
+	// If anybody switches on atmosphere on the moon, there will be no extinction.
+	const bool withEarthExtinction=withExtinction && core->getCurrentLocation().planetName=="Earth";
+	bool extinctionChanged=false;
+	if (withEarthExtinction)
 	{
-		// We must process the vertices to find geometric altitudes in order to compute vertex colors.
-		const Extinction& extinction=drawer->getExtinction();
-		const double epsDate=getPrecessionAngleVondrakCurrentEpsilonA();
-		vertexArray->colors.clear();
+		extinctionChanged=updateExtinctionFactors(core);
+		// further reduced by light pollution
+		c*=1.f/bortle;
+	}
 
-		for (int i=0; i<vertexArray->vertex.size(); ++i)
+	// With a static view and atmosphere, the vertex colors stay the same.
+	if (extinctionChanged || c!=vertexColor || withEarthExtinction!=vertexColorWithExtinction)
+	{
+		if (withEarthExtinction)
 		{
-			Vec3d eclPos=vertexArray->vertex.at(i);
-			Q_ASSERT(fabs(eclPos.lengthSquared()-1.0) < 0.001f);
-			double ecLon, ecLat, ra, dec;
-			StelUtils::rectToSphe(&ecLon, &ecLat, eclPos);
-			StelUtils::eclToEqu(ecLon, ecLat, epsDate, &ra, &dec);
-			Vec3d eqPos;
-			StelUtils::spheToRect(ra, dec, eqPos);
-			Vec3d vertAltAz=core->equinoxEquToAltAz(eqPos, StelCore::RefractionOn);
-			Q_ASSERT(fabs(vertAltAz.lengthSquared()-1.0) < 0.001f);
-
-			float oneMag=0.0f;
-			extinction.forward(vertAltAz, &oneMag);
-			float extinctionFactor=std::pow(0.4f , oneMag)/bortle; // drop of one magnitude: factor 2.5 or 40%, and further reduced by light pollution
-			Vec3f thisColor=Vec3f(c[0]*extinctionFactor, c[1]*extinctionFactor, c[2]*extinctionFactor);
-			vertexArray->colors.append(thisColor);
+			for (int i=0; i<vertexArray->vertex.size(); ++i)
+				vertexArray->colors[i]=c*extinctionFactors.at(i);
 		}
+		else
+			vertexArray->colors.fill(c);
+		vertexColor=c;
+		vertexColorWithExtinction=withEarthExtinction;
 	}
-	else
-		vertexArray->colors.fill(Vec3f(c[0], c[1], c[2]));
 
 	StelPainter sPainter(prj);
 	sPainter.setCullFace(true);
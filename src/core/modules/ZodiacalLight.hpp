@@ -123,6 +123,11 @@ signals:
 	void colorChanged(Vec3f color);
 	
 private:
+	//! Recompute the extinction factors of the vertices if they were moved, or the zenith moved
+	//! or the atmosphere changed since the last call.
+	//! @return true if the factors were recomputed
+	bool updateExtinctionFactors(const class StelCore* core);
+
 	StelTextureSP tex;
 	Vec3f color; // global color
 	double intensity;
@@ -131,6 +136,17 @@ private:
 
 	struct StelVertexArray* vertexArray;
 	QVector<Vec3d> eclipticalVertices;
+
+	// The extinction of a vertex only depends on its altitude, so it is only recomputed when update() moved the vertices,
+	// when the zenith moved a bit in equatorial coordinates, or when the atmosphere parameters change.
+	QVector<float> extinctionFactors;
+	Vec3d extinctionZenith;
+	float extinctionCoefficient;
+	float extinctionPressure;
+	float extinctionTemperature;
+	// Color and extinction state of the current vertex colors, which are only rebuilt when they change.
+	Vec3f vertexColor;
+	bool vertexColorWithExtinction;
 };
 
 #endif // _ZODIACALLIGHT_HPP_
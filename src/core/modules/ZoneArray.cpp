@@ -27,6 +27,7 @@
 #include <QDebug>
 #include <QFile>
 #include <QDir>
+#include <QtConcurrent>
 #ifdef Q_OS_WIN
 #include <io.h>
 #include <windows.h>
@@ -233,7 +234,10 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 			dbStr += "error - bad file type ";
 			break;
 	}
-	if (rval && rval->isInitialized())
+	// The Hipparcos levels are needed for the Hipparcos index and the star names, all others are loaded on demand
+	if (rval && rval->isInitialized() && type==0)
+		rval->load();
+	if (rval && rval->isInitialized() && rval->getNrOfStars()>0)
 	{
 		dbStr += QString("%1").arg(rval->getNrOfStars());
 		qDebug() << dbStr;
@@ -255,11 +259,53 @@ ZoneArray::ZoneArray(const QString& fname, QFile* file, int level, int mag_min,
 			 int mag_range, int mag_steps)
 			: fname(fname), level(level), mag_min(mag_min),
 			  mag_range(mag_range), mag_steps(mag_steps),
-			  star_position_scale(0.0), nr_of_stars(0), zones(0), file(file)
+			  star_position_scale(0.0), nr_of_stars(0), zones(0), file(file),
+			  data_offset(0), use_mmap(false), loaded(false), loader(NULL)
 {
 	nr_of_zones = StelGeodesicGrid::nrOfZones(level);	
 }
 
+ZoneArray::~ZoneArray()
+{
+	// the subclass destructors already waited for a running load
+	Q_ASSERT(loader==NULL);
+	nr_of_zones = 0;
+}
+
+bool ZoneArray::load()
+{
+	if (loaded)
+		return nr_of_stars>0;
+	bool ok;
+	if (loader)
+	{
+		ok = loader->result();
+		delete loader;
+		loader = NULL;
+	}
+	else
+		ok = loadStars();
+	attachStars(ok);
+	loaded = true;
+	return ok;
+}
+
+void ZoneArray::startLoading()
+{
+	if (loaded || loader)
+		return;
+	qDebug() << "Loading star catalog level" << level << "in the background:" << QDir::toNativeSeparators(fname);
+	loader = new QFuture<bool>(QtConcurrent::run(this, &ZoneArray::loadStars));
+}
+
+bool ZoneArray::updateLoading()
+{
+	if (!loader || !loader->isFinished())
+		return false;
+	load();
+	return true;
+}
+
 bool ZoneArray::readFile(QFile& file, void *data, qint64 size)
 {
 	int parts = 256;
@@ -369,73 +415,72 @@ SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mm
 		}
 		else
 		{
-			if (use_mmap)
-			{
-				mmap_start = file->map(file->pos(), sizeof(Star)*nr_of_stars);
-				if (mmap_start == 0)
-				{
-					qDebug() << "ERROR: SpecialZoneArray(" << level
-						 << ")::SpecialZoneArray: QFile(" << file->fileName()
-						 << ".map(" << file->pos()
-						 << ',' << sizeof(Star)*nr_of_stars
-						 << ") failed: " << file->errorString();
-					stars = 0;
-					nr_of_stars = 0;
-					delete[] getZones();
-					zones = 0;
-					nr_of_zones = 0;
-				}
-				else
-				{
-					stars = (Star*)mmap_start;
-					Star *s = stars;
-					for (unsigned int z=0;z<nr_of_zones;z++)
-					{
-
-						getZones()[z].stars = s;
-						s += getZones()[z].size;
-					}
-				}
-				file->close();
-			}
-			else
-			{
-				stars = new Star[nr_of_stars];
-				if (stars == 0)
-				{
-					qDebug() << "ERROR: SpecialZoneArray(" << level
-						 << ")::SpecialZoneArray: no memory (3)";
-					exit(1);
-				}
-				if (!readFile(*file,stars,sizeof(Star)*nr_of_stars))
-				{
-					delete[] stars;
-					stars = 0;
-					nr_of_stars = 0;
-					delete[] getZones();
-					zones = 0;
-					nr_of_zones = 0;
-				}
-				else
-				{
-					Star *s = stars;
-					for (unsigned int z=0;z<nr_of_zones;z++)
-					{
-						getZones()[z].stars = s;
-						s += getZones()[z].size;
-					}
-				}
-				file->close();
-			}
+			// the stars are mapped or read by loadStars()
+			data_offset = file->pos();
+			this->use_mmap = use_mmap;
 		}
 		// GZ: Some diagnostics to understand the undocumented vars around mag.
 		// qDebug() << "SpecialZoneArray: mag_min=" << mag_min << ", mag_steps=" << mag_steps << ", mag_range=" << mag_range ;
 	}
 }
 
+template<class Star>
+bool SpecialZoneArray<Star>::loadStars()
+{
+	const qint64 size = sizeof(Star)*nr_of_stars;
+	if (use_mmap)
+	{
+		// Mapping costs almost nothing, the zones are paged in by the OS when they are drawn the first time
+		mmap_start = file->map(data_offset, size);
+		if (mmap_start != 0)
+		{
+			stars = (Star*)mmap_start;
+			return true;
+		}
+		qDebug() << "ERROR: SpecialZoneArray(" << level
+			 << ")::loadStars: QFile(" << file->fileName()
+			 << ".map(" << data_offset
+			 << ',' << size
+			 << ") failed: " << file->errorString() << ", reading the file instead";
+	}
+
+	stars = new Star[nr_of_stars];
+	if (!file->seek(data_offset) || !readFile(*file,stars,size))
+	{
+		qDebug() << "Error reading stars from catalog:" << file->fileName();
+		delete[] stars;
+		stars = 0;
+		return false;
+	}
+	return true;
+}
+
+template<class Star>
+void SpecialZoneArray<Star>::attachStars(bool ok)
+{
+	Star *s = stars;
+	for (unsigned int z=0;z<nr_of_zones;z++)
+	{
+		if (!ok)
+			getZones()[z].size = 0;
+		getZones()[z].stars = s;
+		s += getZones()[z].size;
+	}
+	if (!ok)
+		nr_of_stars = 0;
+	// a mapping stays valid after closing
+	file->close();
+}
+
 template<class Star>
 SpecialZoneArray<Star>::~SpecialZoneArray(void)
 {
+	if (loader)
+	{
+		loader->waitForFinished();
+		delete loader;
+		loader = NULL;
+	}
 	if (stars)
 	{
 		if (mmap_start != 0)
@@ -446,9 +491,10 @@ SpecialZoneArray<Star>::~SpecialZoneArray(void)
 		{
 			delete[] stars;
 		}
-		delete file;
 		stars = 0;
 	}
+	delete file;
+	file = NULL;
 	if (zones)
 	{
 		delete[] getZones();
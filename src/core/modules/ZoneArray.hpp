@@ -33,6 +33,7 @@
 #include <QString>
 #include <QFile>
 #include <QDebug>
+#include <QFuture>
 
 #ifdef __OpenBSD__
 #include <unistd.h>
@@ -73,6 +74,11 @@ struct HipIndexStruct
 //! instance of this class is never created directly; the named constructor
 //! returns an instance of one of its subclasses. All it really does is
 //! bootstrap the loading process.
+//!
+//! The header and the zone sizes are read when the array is created, the stars
+//! themselves may be loaded later: Hipparcos levels are loaded right away, because
+//! the Hipparcos index needs them, all other levels are loaded in a worker thread
+//! with startLoading() when they are first needed for drawing.
 class ZoneArray
 {
 public:
@@ -83,10 +89,7 @@ public:
 	//! @param use_mmap whether or not to mmap the star catalog
 	//! @return an instance of SpecialZoneArray or HipZoneArray
 	static ZoneArray *create(const QString &extended_file_name, bool use_mmap);
-	virtual ~ZoneArray()
-	{
-		nr_of_zones = 0;
-	}
+	virtual ~ZoneArray();
 
 	//! Get the total number of stars in this catalog.
 	unsigned int getNrOfStars() const { return nr_of_stars; }
@@ -108,6 +111,18 @@ public:
 	//! @return @c true if at least one zone was loaded, otherwise @c false
 	bool isInitialized(void) const { return (nr_of_zones>0); }
 
+	//! Get whether the stars of this level are available. Only then draw() and searchAround() may be called.
+	bool isLoaded() const { return loaded; }
+	//! Load the stars, waiting for a running background load.
+	//! @return @c false if the star data could not be read, the level is empty then
+	bool load();
+	//! Start loading the stars in a worker thread, unless it is already loaded or loading.
+	void startLoading();
+	//! Check whether a background load has finished, and make the stars available if so.
+	//! Has to be called in the main thread.
+	//! @return @c true if the level became available with this call
+	bool updateLoading();
+
 	//! Initialize the ZoneData struct at the given index.
 	void initTriangle(int index, const Vec3f &c0, const Vec3f &c1, const Vec3f &c2);
 	
@@ -135,12 +150,23 @@ protected:
 	//! @return @c true if successful, or @c false if an error occurred
 	static bool readFile(QFile& file, void *data, qint64 size);
 
+	//! Map or read the star data. May run in a worker thread, so the zones are not touched.
+	virtual bool loadStars() = 0;
+	//! Make the zones point to the loaded star data, or empty them if loading failed. Runs in the main thread.
+	virtual void attachStars(bool ok) = 0;
+
 	//! Protected constructor. Initializes fields and does not load anything.
 	ZoneArray(const QString& fname, QFile* file, int level, int mag_min, int mag_range, int mag_steps);
 	unsigned int nr_of_zones;
 	unsigned int nr_of_stars;
 	ZoneData *zones;
 	QFile* file;
+	//! Position of the star data in the file
+	qint64 data_offset;
+	bool use_mmap;
+	bool loaded;
+	//! The running background load, if any
+	QFuture<bool>* loader;
 };
 
 //! @class SpecialZoneArray
@@ -188,6 +214,9 @@ protected:
 	virtual void searchAround(const StelCore* core, int index,const Vec3d &v,double cosLimFov,
 					  QList<StelObjectP > &result);
 
+	virtual bool loadStars();
+	virtual void attachStars(bool ok);
+
 	Star *stars;
 private:
 	uchar *mmap_start;
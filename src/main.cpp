@@ -146,6 +146,18 @@ int main(int argc, char **argv)
 
 	QGuiApplication::setDesktopSettingsAware(false);
 
+	// The platform plugin is chosen when the application is created, so --headless can't wait for the CLIProcessor
+	bool headless = false;
+	for (int i=1; i<argc; ++i)
+	{
+		if (qstrcmp(argv[i], "--")==0)
+			break;
+		if (qstrcmp(argv[i], "--headless")==0)
+			headless = true;
+	}
+	if (headless && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+
 #ifndef USE_QUICKVIEW
 	QApplication::setStyle(QStyleFactory::create("Fusion"));
 	// The QApplication MUST be created before the StelFileMgr is initialized.
@@ -165,9 +177,12 @@ int main(int argc, char **argv)
 
 	QPixmap pixmap(StelFileMgr::findFile("data/splash.png"));
 	QSplashScreen splash(pixmap);
-	splash.show();
-	splash.showMessage(StelUtils::getApplicationVersion() , Qt::AlignLeft, Qt::white);
-	app.processEvents();
+	if (!headless)
+	{
+		splash.show();
+		splash.showMessage(StelUtils::getApplicationVersion() , Qt::AlignLeft, Qt::white);
+		app.processEvents();
+	}
 
 	// Log command line arguments.
 	QString argStr;
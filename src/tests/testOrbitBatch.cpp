@@ -0,0 +1,186 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testOrbitBatch.hpp"
+
+#include <QVector>
+#include <QDebug>
+#include <QtGlobal>
+
+#include "Orbit.hpp"
+#include "OrbitBatch.hpp"
+
+QTEST_GUILESS_MAIN(TestOrbitBatch)
+
+// Allowed difference to the reference positions [AU], about 1.5km.
+#define ERROR_LIMIT 1e-8
+
+void TestOrbitBatch::initTestCase()
+{
+	// A reproducible spread of orbits covering the three solver branches of EllipticalOrbit::eccentricAnomaly().
+	qsrand(1234);
+	for (int i=0; i<2000; ++i)
+	{
+		const double ecc = (i%10==0) ? 0.0 : (qrand()%9700)/10000.0;
+		const double q = 0.3 + (qrand()%5000)/100.0;
+		const double a = q/(1.0-ecc);
+		const double period = 365.25*a*std::sqrt(a);
+		const double inclination = (qrand()%18000)/100.*M_PI/180.;
+		const double node = (qrand()%36000)/100.*M_PI/180.;
+		const double argOfPericenter = (qrand()%36000)/100.*M_PI/180.;
+		const double meanAnomaly = (qrand()%36000)/100.*M_PI/180.;
+		const double epoch = 2457800.5;
+		orbits.append(new EllipticalOrbit(q, ecc, inclination, node, argOfPericenter, meanAnomaly,
+						  period, epoch, 0.0, 0.0, 0.0));
+		const double meanMotion = 2.0*M_PI/period;
+		references.append(new CometOrbit(q, ecc, inclination, node, argOfPericenter, epoch-meanAnomaly/meanMotion,
+						 1e10, meanMotion, 0.0, 0.0, 0.0));
+	}
+}
+
+void TestOrbitBatch::cleanupTestCase()
+{
+	qDeleteAll(orbits);
+	orbits.clear();
+	qDeleteAll(references);
+	references.clear();
+}
+
+void TestOrbitBatch::testPositions()
+{
+	OrbitBatch batch;
+	foreach (const EllipticalOrbit* orb, orbits)
+		QVERIFY(batch.add(orb)>=0);
+	QCOMPARE(batch.size(), orbits.size());
+
+	const double dates[] = { 2451545.0, 2457800.5, 2460000.25, 2415020.0 };
+	for (unsigned int d=0; d<sizeof(dates)/sizeof(dates[0]); ++d)
+	{
+		batch.computePositions(dates[d]);
+		for (int i=0; i<orbits.size(); ++i)
+		{
+			double xyz[3];
+			references.at(i)->positionAtTimevInVSOP87Coordinates(dates[d], xyz, false);
+			const double error = (batch.getPosition(i)-Vec3d(xyz[0], xyz[1], xyz[2])).length();
+			QVERIFY2(error<ERROR_LIMIT, qPrintable(QString("orbit %1 JDE %2 error %3 AU").arg(i).arg(dates[d], 0, 'f', 2).arg(error)));
+		}
+	}
+}
+
+void TestOrbitBatch::testLightTimeDates()
+{
+	OrbitBatch batch;
+	QVector<double> jde;
+	foreach (const EllipticalOrbit* orb, orbits)
+	{
+		batch.add(orb);
+		jde.append(2457800.5 - 0.01*jde.size());
+	}
+	batch.computePositions(jde.constData());
+	for (int i=0; i<orbits.size(); ++i)
+	{
+		double xyz[3];
+		references.at(i)->positionAtTimevInVSOP87Coordinates(jde.at(i), xyz, false);
+		QVERIFY((batch.getPosition(i)-Vec3d(xyz[0], xyz[1], xyz[2])).length()<ERROR_LIMIT);
+	}
+}
+
+void TestOrbitBatch::testSamples()
+{
+	OrbitBatch batch;
+	for (int i=0; i<10; ++i)
+		batch.add(orbits.at(i));
+
+	const int nSamples=360;
+	QVector<Vec3d> samples(nSamples);
+	for (int i=0; i<batch.size(); ++i)
+	{
+		const double step=orbits.at(i)->getPeriod()/nSamples;
+		const double start=2457800.5-180.*step;
+		batch.samplePositions(i, start, step, nSamples, samples.data());
+		for (int k=0; k<nSamples; ++k)
+		{
+			double xyz[3];
+			references.at(i)->positionAtTimevInVSOP87Coordinates(start+k*step, xyz, false);
+			QVERIFY((samples.at(k)-Vec3d(xyz[0], xyz[1], xyz[2])).length()<ERROR_LIMIT);
+		}
+	}
+}
+
+void TestOrbitBatch::testCometOrbit()
+{
+	// Elements of (101429) 1998 VF31 as written to ssystem.ini by the Solar System Editor (coord_func=comet_orbit),
+	// converted the same way as in SolarSystem::loadPlanets().
+	const double eccentricity=0.1004355;
+	const double semiMajorAxis=1.5241747;
+	const double meanMotion=0.52378364*M_PI/180.;
+	const double epoch=2457600.5;
+	const double meanAnomaly=46.17851*M_PI/180.;
+	CometOrbit minorPlanet(semiMajorAxis*(1.0-eccentricity), eccentricity, 31.29724*M_PI/180.,
+			       221.31431*M_PI/180., 310.53931*M_PI/180., epoch-meanAnomaly/meanMotion,
+			       1000, meanMotion, 0.0, 0.0, 0.0);
+	// A hyperbolic comet_orbit, which must be left to CometOrbit.
+	const CometOrbit hyperbolic(1.2, 1.0002, 0.5, 1.0, 2.0, 2457600.5, 1000, 0.01720209895/std::pow(1.2/0.0002, 1.5), 0.0, 0.0, 0.0);
+
+	OrbitBatch batch;
+	QCOMPARE(batch.add(&hyperbolic), -1);
+	const int index=batch.add(&minorPlanet);
+	QCOMPARE(index, 0);
+	// The CometOrbit copies from the test data set, which have eccentricities up to 0.97.
+	foreach (const CometOrbit* orb, references)
+		QVERIFY(batch.add(orb)>=0);
+	QCOMPARE(batch.size(), references.size()+1);
+
+	const double dates[] = { 2451545.0, 2457600.5, 2460000.25 };
+	for (unsigned int d=0; d<sizeof(dates)/sizeof(dates[0]); ++d)
+	{
+		batch.computePositions(dates[d]);
+		double xyz[3];
+		for (int i=0; i<=references.size(); ++i)
+		{
+			CometOrbit* reference=(i==index ? &minorPlanet : references.at(i-1));
+			reference->positionAtTimevInVSOP87Coordinates(dates[d], xyz, false);
+			const double error = (batch.getPosition(i)-Vec3d(xyz[0], xyz[1], xyz[2])).length();
+			QVERIFY2(error<ERROR_LIMIT, qPrintable(QString("orbit %1 JDE %2 error %3 AU").arg(i).arg(dates[d], 0, 'f', 2).arg(error)));
+		}
+	}
+}
+
+void TestOrbitBatch::benchmarkBatch()
+{
+	OrbitBatch batch;
+	foreach (const EllipticalOrbit* orb, orbits)
+		batch.add(orb);
+	double jde=2457800.5;
+	QBENCHMARK {
+		batch.computePositions(jde);
+		jde+=1.0;
+	}
+}
+
+void TestOrbitBatch::benchmarkSingle()
+{
+	double jde=2457800.5;
+	double xyz[3];
+	QBENCHMARK {
+		foreach (const EllipticalOrbit* orb, orbits)
+			orb->positionAtTimevInVSOP87Coordinates(jde, xyz);
+		jde+=1.0;
+	}
+}
@@ -0,0 +1,116 @@
+/*
+ * Stellarium
+ * Copyright (C) 2017 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelZoneIndex.hpp"
+
+#include <QDebug>
+#include <QtGlobal>
+#include <algorithm>
+
+#include "StelZoneIndex.hpp"
+#include "StelUtils.hpp"
+
+QTEST_GUILESS_MAIN(TestStelZoneIndex)
+
+void TestStelZoneIndex::initTestCase()
+{
+	// A reproducible set of positions spread over the whole sky, about the size of the Quasars catalog
+	qsrand(4321);
+	for (int i=0; i<5000; ++i)
+	{
+		Vec3d pos;
+		const double ra = (qrand()%36000)/100.*M_PI/180.;
+		const double dec = std::asin((qrand()%20001)/10000.-1.);
+		StelUtils::spheToRect(ra, dec, pos);
+		points.append(pos);
+	}
+	// some exact duplicates and points on the poles and the zone corners
+	points.append(points.at(0));
+	points.append(Vec3d(0., 0., 1.));
+	points.append(Vec3d(0., 0., -1.));
+	points.append(Vec3d(1., 0., 0.));
+}
+
+void TestStelZoneIndex::testFindAround()
+{
+	StelZoneIndex index;
+	index.setPositions(points);
+	QCOMPARE(index.size(), points.size());
+
+	const double radii[] = { 0.1, 1., 5., 20., 60., 180. };
+	for (int d=0; d<50; ++d)
+	{
+		const Vec3d v = points.at((d*97)%points.size());
+		for (unsigned int r=0; r<sizeof(radii)/sizeof(radii[0]); ++r)
+		{
+			const double cosLimit = std::cos(radii[r]*M_PI/180.);
+			QVector<int> expected;
+			for (int i=0; i<points.size(); ++i)
+			{
+				if (points.at(i)*v>=cosLimit)
+					expected.append(i);
+			}
+			QVector<int> found;
+			index.findAround(v, radii[r], found);
+			std::sort(found.begin(), found.end());
+			QVERIFY2(found==expected, qPrintable(QString("direction %1, radius %2: found %3 instead of %4 objects")
+							     .arg(d).arg(radii[r]).arg(found.size()).arg(expected.size())));
+		}
+	}
+
+	index.clear();
+	QCOMPARE(index.size(), 0);
+	QVector<int> found;
+	index.findAround(Vec3d(1., 0., 0.), 10., found);
+	QVERIFY(found.isEmpty());
+}
+
+void TestStelZoneIndex::testFindInRegion()
+{
+	StelZoneIndex index;
+	index.setPositions(points);
+
+	// A quarter of the sky, bounded by two great circles
+	QVector<SphericalCap> region;
+	region << SphericalCap(Vec3d(1., 0., 0.), 0.) << SphericalCap(Vec3d(0., 1., 0.), 0.);
+
+	QVector<int> found;
+	index.findInRegion(region, found);
+	QVERIFY(found.size()<points.size());
+
+	std::sort(found.begin(), found.end());
+	QVERIFY(std::adjacent_find(found.begin(), found.end())==found.end());
+	// all objects inside of the region must be found, the objects outside are only those of the border zones
+	for (int i=0; i<points.size(); ++i)
+	{
+		if (points.at(i)[0]>=0. && points.at(i)[1]>=0.)
+			QVERIFY2(std::binary_search(found.begin(), found.end(), i), qPrintable(QString("object %1 not found").arg(i)));
+	}
+}
+
+void TestStelZoneIndex::benchmarkFindAround()
+{
+	StelZoneIndex index;
+	index.setPositions(points);
+	QVector<int> found;
+	QBENCHMARK {
+		found.clear();
+		index.findAround(Vec3d(0.3, 0.4, 0.5), 2., found);
+	}
+}